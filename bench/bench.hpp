@@ -0,0 +1,30 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+// 重复调用 fn 直到累计超过 min_ms, 返回单次调用的平均毫秒数
+template <typename F>
+double measure(F&& fn, double min_ms = 200.0) {
+    typedef std::chrono::steady_clock Clock;
+    fn();
+    size_t runs = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0.0;
+    do {
+        fn();
+        runs++;
+        elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    } while (elapsed < min_ms);
+    return elapsed / runs;
+}
+
+// 防止被测结果被优化掉
+extern volatile double bench_sink;
+
+void benchBytecode();
+void benchBigInt();
+void benchSolver();
+void benchAnim();
+void benchEcs();
+void benchExport();
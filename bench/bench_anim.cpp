@@ -0,0 +1,63 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "anim.hpp"
+
+#define BENCH_ANIM_CHANNELS 10000
+#define BENCH_ANIM_KEYS 32
+
+// 每个通道的关键帧时间各不相同, 同一时刻各通道落在不同的段上
+static void fill(TrackSet& tracks, std::mt19937& rng) {
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    std::vector<float> times(BENCH_ANIM_KEYS), values(BENCH_ANIM_KEYS * tracks.components());
+    std::vector<Easing> easing(BENCH_ANIM_KEYS);
+    for (int c = 0; c < BENCH_ANIM_CHANNELS; c++) {
+        float t = 0.0f;
+        for (int k = 0; k < BENCH_ANIM_KEYS; k++) {
+            times[k] = t;
+            t += 0.1f + 0.2f * (uniform(rng) + 1.0f);
+            easing[k] = (Easing)(rng() % 6);
+        }
+        for (float& v : values) v = uniform(rng);
+        if (tracks.type() == TrackType::Quat) {
+            // 关键帧须为单位四元数
+            for (int k = 0; k < BENCH_ANIM_KEYS; k++) {
+                float* q = &values[k * 4];
+                float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+                for (int i = 0; i < 4; i++) q[i] /= length;
+            }
+        }
+        tracks.addChannel(times.data(), values.data(), BENCH_ANIM_KEYS, easing.data());
+    }
+}
+
+// 顺序播放 (每帧 1/60 秒, 游标 O(1) 定位) 与随机跳转 (二分查找) 下每毫秒采样的通道数
+void benchAnim() {
+    std::mt19937 rng(3);
+    const TrackType types[] = {TrackType::Float, TrackType::Vec3, TrackType::Quat};
+    const char* names[] = {"float", "vec3", "quat (slerp)"};
+    printf("%-14s %10s %18s %18s\n", "track", "channels", "play channels/ms", "seek channels/ms");
+    for (int i = 0; i < 3; i++) {
+        TrackSet tracks(types[i]);
+        fill(tracks, rng);
+        float duration = tracks.duration();
+
+        float time = 0.0f;
+        double play_ms = measure([&]() {
+            time += 1.0f / 60.0f;
+            if (time > duration) time = 0.0f;
+            tracks.sample(time);
+            bench_sink = tracks.output(0)[0];
+        });
+        std::uniform_real_distribution<float> seek(0.0f, duration);
+        double seek_ms = measure([&]() {
+            tracks.sample(seek(rng));
+            bench_sink = tracks.output(0)[0];
+        });
+        printf("%-14s %10d %18.0f %18.0f\n", names[i], BENCH_ANIM_CHANNELS,
+               BENCH_ANIM_CHANNELS / play_ms, BENCH_ANIM_CHANNELS / seek_ms);
+    }
+}
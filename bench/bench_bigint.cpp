@@ -0,0 +1,40 @@
+#include "bench.hpp"
+
+#include <random>
+
+#include "bigint.hpp"
+
+// 随机的 digits 位十进制整数, 最高 limb 不为零
+static calc::BigInt randomInteger(size_t digits, std::mt19937& rng) {
+    calc::Limbs limbs((digits + BIGINT_DIGITS - 1) / BIGINT_DIGITS);
+    for (uint32_t& limb : limbs) limb = rng() % BIGINT_BASE;
+    limbs.back() = limbs.back() % (BIGINT_BASE - 1) + 1;
+    return calc::BigInt(false, std::move(limbs));
+}
+
+static const char* algorithm(size_t limbs) {
+    if (limbs >= BIGINT_NTT_THRESHOLD) return "NTT";
+    if (limbs >= BIGINT_TOOM3_THRESHOLD) return "Toom-3";
+    if (limbs >= BIGINT_KARATSUBA_THRESHOLD) return "Karatsuba";
+    return "schoolbook";
+}
+
+// 等长随机整数相乘, 以及乘积树阶乘, 规模到 10^6 位
+void benchBigInt() {
+    std::mt19937 rng(42);
+    printf("%-10s %-11s %12s %12s\n", "digits", "multiply", "ms", "mul/s");
+    for (size_t digits = 1000; digits <= 1000000; digits *= 10) {
+        calc::BigInt a = randomInteger(digits, rng), b = randomInteger(digits, rng);
+        double ms = measure([&]() { bench_sink = (double)(a * b).size(); }, digits >= 1000000 ? 1000.0 : 200.0);
+        printf("%-10zu %-11s %12.3f %12.1f\n", digits, algorithm(a.size()), ms, 1000.0 / ms);
+    }
+
+    printf("%-10s %12s %12s\n", "n!", "digits", "ms");
+    const uint32_t factorials[] = {1000, 10000, 100000, 250000};
+    for (uint32_t n : factorials) {
+        size_t digits = 0;
+        double ms = measure([&]() { digits = calc::BigInt::factorial(n).digitCount(); }, 0.0);
+        bench_sink = (double)digits;
+        printf("%-10u %12zu %12.3f\n", n, digits, ms);
+    }
+}
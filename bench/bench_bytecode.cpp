@@ -0,0 +1,64 @@
+#include "bench.hpp"
+
+#include <vector>
+
+#include "bytecode.hpp"
+#include "expr_parser.hpp"
+
+#define BENCH_BYTECODE_SAMPLES 100000
+
+static const char* expressions[] = {
+    "x^2 + y^2",
+    "sin(x) * cos(y) + x^2 / (1 + y^2)",
+    "sqrt(x*x + y*y + z*z) - 1",
+    "exp(-(x*x + y*y)) * log(2 + sin(3*x))",
+    "(x + 1)*(x + 2)*(x + 3)*(x + 4) - y*z",
+};
+
+// 同一表达式在 BENCH_BYTECODE_SAMPLES 组变量上分别用递归求值、字节码 VM 与 fast_math 优化后的 VM 计算,
+// 并给出按树展开、优化前 DAG 与 fast_math 优化后的运算节点数
+void benchBytecode() {
+    std::vector<double> vars(3 * BENCH_BYTECODE_SAMPLES);
+    for (size_t i = 0; i < BENCH_BYTECODE_SAMPLES; i++) {
+        vars[3 * i] = -2.0 + 4.0 * i / BENCH_BYTECODE_SAMPLES;
+        vars[3 * i + 1] = 0.5 + 0.001 * (i % 1000);
+        vars[3 * i + 2] = 1.0 - 0.0005 * (i % 2000);
+    }
+
+    printf("%-42s %12s %12s %12s %8s %16s\n", "expression", "tree Meval/s", "VM Meval/s", "fast Meval/s", "speedup",
+           "tree/dag/fast ops");
+    for (const char* src : expressions) {
+        calc::ExprPool pool;
+        calc::ExprParser parser;
+        int root = parser.parse(src, pool);
+        calc::Program program, fast;
+        calc::OptimizeStats stats;
+        if (root < 0 || !calc::compile(pool, root, program) || !calc::compile(pool, root, fast, true, true, &stats)) {
+            printf("%-42s failed to compile\n", src);
+            continue;
+        }
+        calc::VM vm, fast_vm;
+        vm.load(program);
+        fast_vm.load(fast);
+
+        double tree_ms = measure([&]() {
+            double sum = 0.0;
+            for (size_t i = 0; i < BENCH_BYTECODE_SAMPLES; i++) sum += calc::evaluateTree(pool, root, &vars[3 * i]);
+            bench_sink = sum;
+        });
+        double vm_ms = measure([&]() {
+            double sum = 0.0;
+            for (size_t i = 0; i < BENCH_BYTECODE_SAMPLES; i++) sum += vm.run(&vars[3 * i]);
+            bench_sink = sum;
+        });
+        double fast_ms = measure([&]() {
+            double sum = 0.0;
+            for (size_t i = 0; i < BENCH_BYTECODE_SAMPLES; i++) sum += fast_vm.run(&vars[3 * i]);
+            bench_sink = sum;
+        });
+        char ops[32];
+        snprintf(ops, sizeof(ops), "%zu/%zu/%zu", stats.tree_nodes, stats.before, stats.after);
+        printf("%-42s %12.1f %12.1f %12.1f %7.2fx %16s\n", src, BENCH_BYTECODE_SAMPLES / tree_ms / 1000.0,
+               BENCH_BYTECODE_SAMPLES / vm_ms / 1000.0, BENCH_BYTECODE_SAMPLES / fast_ms / 1000.0, tree_ms / vm_ms, ops);
+    }
+}
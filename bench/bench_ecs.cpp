@@ -0,0 +1,66 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <vector>
+
+#include "registry.hpp"
+#include "systems.hpp"
+
+#define BENCH_ECS_ENTITIES 100000
+#define BENCH_ECS_CHANNELS 64
+// 每帧更新的目标耗时
+#define BENCH_ECS_TARGET_MS 1.0
+
+// 10 万个带 Transform 与 Animator 的实体, 每帧动画改写所有旋转, 再重算全部 world / normal 矩阵
+void benchEcs() {
+    Animation animation;
+    const float times[] = {0.0f, 1.0f, 2.0f};
+    for (int c = 0; c < BENCH_ECS_CHANNELS; c++) {
+        glm::vec3 axis = glm::normalize(glm::vec3(std::sin((float)c), std::cos((float)c), 0.5f));
+        glm::quat keys[3] = {glm::angleAxis(0.0f, axis), glm::angleAxis(3.0f, axis), glm::angleAxis(6.0f, axis)};
+        animation.addQuat(times, keys, 3);
+    }
+    std::vector<Clip> clips(1);
+    clips[0].animation = &animation;
+
+    Registry registry;
+    registry.transforms().reserve(BENCH_ECS_ENTITIES);
+    registry.animators().reserve(BENCH_ECS_ENTITIES);
+    for (int i = 0; i < BENCH_ECS_ENTITIES; i++) {
+        Entity entity = registry.create();
+        Transform transform;
+        transform.position = glm::vec3((float)(i % 100), (float)(i / 100 % 100), (float)(i / 10000));
+        transform.scale = glm::vec3(0.5f + 0.001f * (i % 500));
+        registry.transforms().add(entity, transform);
+        registry.animators().add(entity, {0, i % BENCH_ECS_CHANNELS});
+    }
+
+    TransformSystem transforms;
+    ThreadPool& pool = ThreadPool::global();
+    ThreadPool serial(0);
+    transforms.update(registry, pool);
+
+    double idle_ms = measure([&]() { transforms.update(registry, pool); });
+    double animation_ms = measure([&]() { updateAnimation(registry, clips, 1.0f / 60.0f); });
+    double trs_ms = measure([&]() {
+        updateAnimation(registry, clips, 1.0f / 60.0f);
+        transforms.update(registry, serial);
+    }) - animation_ms;
+    double frame_ms = measure([&]() {
+        updateAnimation(registry, clips, 1.0f / 60.0f);
+        transforms.update(registry, pool);
+        bench_sink = transforms.world(0)[3][0];
+    });
+    printf("%d entities, %zu threads\n", BENCH_ECS_ENTITIES, pool.size() + 1);
+    printf("  nothing dirty    %8.3f ms\n", idle_ms);
+    printf("  animation        %8.3f ms\n", animation_ms);
+    printf("  TRS, one thread  %8.3f ms\n", trs_ms);
+    printf("  animation + TRS  %8.3f ms (%zu transforms recomputed)\n", frame_ms, transforms.updated());
+    // 动画写回是串行的, TRS 按层内区段并行, 按两者的单线程耗时估计达到目标所需的核数
+    if (animation_ms < BENCH_ECS_TARGET_MS) {
+        printf("  target %.1f ms: %s, needs about %.0f cores\n", BENCH_ECS_TARGET_MS,
+               frame_ms <= BENCH_ECS_TARGET_MS ? "met" : "missed", std::ceil(trs_ms / (BENCH_ECS_TARGET_MS - animation_ms)));
+    } else {
+        printf("  target %.1f ms: missed, animation alone exceeds it\n", BENCH_ECS_TARGET_MS);
+    }
+}
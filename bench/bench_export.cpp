@@ -0,0 +1,67 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <string>
+
+#include "mesh_export.hpp"
+
+#define BENCH_EXPORT_TRIANGLES 10000000
+
+namespace fs = std::filesystem;
+
+// 起伏的网格面, 每格两个三角形, 三角形数不少于 BENCH_EXPORT_TRIANGLES
+static MeshData gridMesh() {
+    int quads = (int)std::ceil(std::sqrt(BENCH_EXPORT_TRIANGLES / 2.0));
+    int side = quads + 1;
+    MeshData mesh;
+    mesh.vertices.reserve((size_t)side * side * MESH_VERTEX_FLOATS);
+    for (int j = 0; j < side; j++) {
+        for (int i = 0; i < side; i++) {
+            float u = (float)i / quads, v = (float)j / quads;
+            float height = 0.1f * std::sin(20.0f * u) * std::cos(20.0f * v);
+            float dx = 2.0f * std::cos(20.0f * u) * std::cos(20.0f * v);
+            float dz = -2.0f * std::sin(20.0f * u) * std::sin(20.0f * v);
+            float length = std::sqrt(dx * dx + dz * dz + 1.0f);
+            const float vertex[MESH_VERTEX_FLOATS] = {u, height, v, u, v, -dx / length, 1.0f / length, -dz / length};
+            mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + MESH_VERTEX_FLOATS);
+        }
+    }
+    mesh.indices.reserve((size_t)quads * quads * 6);
+    for (int j = 0; j < quads; j++) {
+        for (int i = 0; i < quads; i++) {
+            unsigned int a = j * side + i, b = a + 1, c = a + side, d = c + 1;
+            const unsigned int quad[6] = {a, c, b, b, c, d};
+            mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+        }
+    }
+    return mesh;
+}
+
+// 每种格式写到临时目录, 按文件大小与耗时计算吞吐量, 文件写完即删除
+void benchExport() {
+    MeshData mesh = gridMesh();
+    printf("%zu vertices, %zu triangles\n", mesh.vertexCount(), mesh.indices.size() / 3);
+
+    const struct {
+        const char* name;
+        MeshFormat format;
+    } formats[] = {{"ply", MeshFormat::PLY}, {"obj", MeshFormat::OBJ}, {"glb", MeshFormat::GLB}};
+    for (const auto& entry : formats) {
+        std::string path = (fs::temp_directory_path() / (std::string("geocal-bench-export.") + entry.name)).string();
+        bool ok = true;
+        double ms = measure([&]() {
+            MeshExporter exporter;
+            ok = ok && exporter.write(path, mesh, entry.format);
+        }, 0.0);
+        std::error_code ec;
+        uintmax_t bytes = ok ? fs::file_size(path, ec) : 0;
+        fs::remove(path, ec);
+        if (!ok) {
+            printf("  %s  failed\n", entry.name);
+            continue;
+        }
+        double mb = (double)bytes / (1 << 20);
+        printf("  %s  %8.1f MB  %8.1f ms  %8.1f MB/s\n", entry.name, mb, ms, mb / (ms / 1000.0));
+    }
+}
\ No newline at end of file
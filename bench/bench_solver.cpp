@@ -0,0 +1,57 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "expr_parser.hpp"
+#include "solver.hpp"
+#include "thread_pool.hpp"
+
+struct IntegralCase {
+    const char* f;
+    double a, b;
+    double exact;
+};
+
+// 常见的积分测试题: 光滑, 端点导数奇异, 峰状, 振荡
+static const IntegralCase integrals[] = {
+    {"x^2", 0.0, 1.0, 1.0 / 3.0},
+    {"sin(x)", 0.0, M_PI, 2.0},
+    {"exp(-x*x)", -5.0, 5.0, std::sqrt(M_PI) * std::erf(5.0)},
+    {"4/(1 + x*x)", 0.0, 1.0, M_PI},
+    {"log(x)", 1.0, 2.0, 2.0 * M_LN2 - 1.0},
+    {"sqrt(x)", 0.0, 1.0, 2.0 / 3.0},
+    {"x*log(x)", 0.0, 1.0, -0.25},
+    {"1/(1e-4 + (x - 0.3)^2)", 0.0, 1.0, 100.0 * (std::atan(70.0) + std::atan(30.0))},
+    {"cos(50*x)", 0.0, 1.0, std::sin(50.0) / 50.0},
+    {"abs(x - 1/3)", 0.0, 1.0, 5.0 / 18.0},
+};
+
+// 每个积分反复求解, 报告每秒积分次数与相对真值的误差
+void benchSolver() {
+    calc::NumericSolver solver(ThreadPool::global());
+    printf("%-26s %14s %12s %12s\n", "integrand", "interval", "integrals/s", "abs error");
+    double total_ms = 0.0;
+    for (const IntegralCase& c : integrals) {
+        calc::ExprPool pool;
+        calc::ExprParser parser;
+        int root = parser.parse(c.f, pool);
+        calc::Program program;
+        if (root < 0 || !calc::compile(pool, root, program)) {
+            printf("%-26s failed to compile\n", c.f);
+            continue;
+        }
+        int slot = (int)(std::find(program.variables.begin(), program.variables.end(), "x") - program.variables.begin());
+        double value = NAN;
+        double ms = measure([&]() {
+            solver.integrate(program, slot, c.a, c.b, value);
+            bench_sink = value;
+        });
+        total_ms += ms;
+        char interval[32];
+        snprintf(interval, sizeof(interval), "[%g, %g]", c.a, c.b);
+        printf("%-26s %14s %12.0f %12.2e\n", c.f, interval, 1000.0 / ms, std::fabs(value - c.exact));
+    }
+    size_t count = sizeof(integrals) / sizeof(integrals[0]);
+    printf("suite: %.0f integrals/s\n", count * 1000.0 / total_ms);
+}
@@ -0,0 +1,33 @@
+#include <cstring>
+
+#include "bench.hpp"
+
+volatile double bench_sink = 0.0;
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+static const Benchmark benchmarks[] = {
+    {"bytecode", benchBytecode},
+    {"bigint", benchBigInt},
+    {"solver", benchSolver},
+    {"anim", benchAnim},
+    {"ecs", benchEcs},
+    {"export", benchExport},
+};
+
+// 不带参数时运行全部基准, 否则只运行名字出现在参数中的
+int main(int argc, char** argv) {
+    for (const Benchmark& bench : benchmarks) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], bench.name) == 0) selected = true;
+        }
+        if (!selected) continue;
+        printf("== %s\n", bench.name);
+        bench.run();
+    }
+    return 0;
+}
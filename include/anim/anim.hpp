@@ -1,10 +1,114 @@
 #pragma once
 
-//#include "../../3rdlibs/glm/glm/glm.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+// 每批采样的通道数, 先逐通道定位关键帧并收集到连续的暂存数组, 再整批插值
+#define ANIM_BATCH 256
+// 游标向前推进超过该段数时改用二分查找 (跳转播放)
+#define ANIM_CURSOR_STEPS 4
+
+// 关键帧到下一帧之间的缓动曲线
+enum class Easing : uint8_t {
+    Linear,
+    Step,           // 保持当前帧的值直到下一帧
+    SmoothStep,
+    EaseIn,         // 三次
+    EaseOut,
+    EaseInOut,
+};
+
+float ease(Easing easing, float t);
+
+enum class TrackType {
+    Float,
+    Vec3,
+    Quat,           // 球面插值, 分量顺序 x, y, z, w
+};
+
+// 一组同类型的通道, 所有通道的关键帧按结构数组 (SoA) 连续存放
+// 每个通道记住上次采样所在的段, 顺序播放时定位为 O(1), 时间倒退或跳转时退回二分查找
+class TrackSet final {
+private:
+    TrackType _type;
+    int _components;
+    std::vector<float> _times;
+    std::vector<float> _values[4];          // 按分量分开存放
+    std::vector<Easing> _easing;            // 第 i 帧到第 i + 1 帧的缓动
+    std::vector<uint32_t> _first;           // 通道的第一帧在上面数组中的下标
+    std::vector<uint32_t> _count;
+    std::vector<uint32_t> _cursor;          // 相对于 _first 的段号
+    std::vector<float> _output[4];          // 最近一次采样的结果, 按通道排列
+    float _duration;
+
+    // 整批插值用的暂存: 两端的值与缓动后的参数
+    std::vector<float> _from[4];
+    std::vector<float> _to[4];
+    std::vector<float> _t;
+private:
+    // 返回 [from, to] 两帧的下标与两帧之间缓动后的参数
+    void locate(size_t channel, float time, uint32_t& from, uint32_t& to, float& t);
+public:
+    TrackSet(TrackType type);
+
+    // times 须严格递增; values 每帧 components() 个分量连续存放; easing 为空时全部线性
+    // 返回通道编号
+    int addChannel(const float* times, const float* values, size_t count, const Easing* easing = nullptr);
+    void clear();
+    // 游标回到开头, 用于从头播放
+    void rewind();
+
+    // 所有通道采样到 time, 超出关键帧范围时取两端的值
+    void sample(float time);
+
+    inline float scalar(int channel) const { return _output[0][channel]; }
+    inline glm::vec3 vec3(int channel) const {
+        return glm::vec3(_output[0][channel], _output[1][channel], _output[2][channel]);
+    }
+    inline glm::quat quat(int channel) const {
+        return glm::quat(_output[3][channel], _output[0][channel], _output[1][channel], _output[2][channel]);
+    }
+    // 第 component 个分量的连续输出数组
+    inline const float* output(int component) const { return _output[component].data(); }
+
+    inline TrackType type() const { return _type; }
+    inline int components() const { return _components; }
+    inline size_t channelCount() const { return _first.size(); }
+    inline size_t keyCount() const { return _times.size(); }
+    inline float duration() const { return _duration; }
+};
+
+// 由 float / vec3 / quat 三组通道组成的动画片段
 class Animation {
 private:
     float _duration;
+    bool _loop;
+    TrackSet _floats;
+    TrackSet _vec3s;
+    TrackSet _quats;
+public:
+    Animation(bool loop = true);
+
+    int addFloat(const float* times, const float* values, size_t count, const Easing* easing = nullptr);
+    int addVec3(const float* times, const glm::vec3* values, size_t count, const Easing* easing = nullptr);
+    // 关键帧在加入时归一化
+    int addQuat(const float* times, const glm::quat* values, size_t count, const Easing* easing = nullptr);
+
+    // 循环播放时 time 按时长取模
+    void sample(float time);
 
+    inline float scalar(int channel) const { return _floats.scalar(channel); }
+    inline glm::vec3 vec3(int channel) const { return _vec3s.vec3(channel); }
+    inline glm::quat quat(int channel) const { return _quats.quat(channel); }
 
-};
\ No newline at end of file
+    inline const TrackSet& floats() const { return _floats; }
+    inline const TrackSet& vec3s() const { return _vec3s; }
+    inline const TrackSet& quats() const { return _quats; }
+    inline float duration() const { return _duration; }
+    inline bool loop() const { return _loop; }
+    inline void setLoop(bool loop) { _loop = loop; }
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "bytecode.hpp"
+
+// 每次解释一条指令处理的点数, 寄存器按块展开
+#define BATCH_BLOCK 256
+#define BATCH_OP_COUNT ((int)calc::Op::Max + 1)
+
+namespace calc {
+
+    enum class BatchIsa {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512,
+    };
+
+    using UnaryKernel = void (*)(const double* a, double* dst, size_t n);
+    using BinaryKernel = void (*)(const double* a, const double* b, double* dst, size_t n);
+
+    // 为空的项回退到 applyUnary / applyBinary 的逐点循环
+    struct BatchKernels {
+        BatchIsa isa;
+        UnaryKernel unary[BATCH_OP_COUNT];
+        BinaryKernel binary[BATCH_OP_COUNT];
+    };
+
+    // 运行时检测 CPU 与操作系统都支持的最高指令集
+    BatchIsa detectBatchIsa();
+    const char* batchIsaName(BatchIsa isa);
+    // 不高于 isa 且当前 CPU 可用的内核表
+    const BatchKernels* batchKernels(BatchIsa isa);
+
+    // 批量求值: 对一组变量数组逐块执行字节码, 块内由 SIMD 内核处理
+    // sin / cos / tan / exp / log 使用多项式近似, 超出约化范围的点回退到标量函数
+    class BatchEvaluator final {
+    private:
+        const Program* _program;
+        const BatchKernels* _kernels;
+        std::vector<const double*> _registers;
+        std::vector<double> _scratch;
+        std::vector<double> _zeros;
+    private:
+        inline double* temp(uint16_t reg) {
+            return _scratch.data() + (size_t)(reg - _program->tempBase()) * BATCH_BLOCK;
+        }
+    public:
+        // isa 高于 CPU 支持时降级
+        explicit BatchEvaluator(BatchIsa isa = detectBatchIsa());
+
+        void load(const Program& program);
+
+        // vars[i] 对应 Program::variables[i], 为空时视为 0
+        void evaluate(const double* const* vars, double* out, size_t count);
+
+        // 常用形式, 缺省的坐标传 nullptr
+        void evaluate(const double* x, const double* y, const double* z, double* out, size_t count);
+
+        inline BatchIsa isa() const { return _kernels->isa; }
+    };
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "bigdecimal.hpp"
+#include "expr.hpp"
+
+// 精确阶乘的上限
+#define BIG_FACT_LIMIT 1000000
+
+namespace calc {
+
+    // 以 BigDecimal 对表达式求值
+    // 表达式需由开启 setExactLiterals 的 ExprParser 解析且未经优化, 字面量从源文本重新读取
+    // 支持 + - * / ^ (整数指数), sqrt, abs, floor, ceil, fact, min, max 与 pi, e
+    class BigEvaluator final {
+    private:
+        size_t _digits;
+        size_t _limbs;
+        StopCallback _stop;
+        std::string _error;
+    private:
+        bool fail(const std::string& message);
+    public:
+        BigEvaluator(size_t digits, StopCallback stop = nullptr);
+
+        bool evaluate(const std::string& src, const ExprPool& pool, int root, BigDecimal& out);
+
+        inline size_t digits() const { return _digits; }
+        inline size_t limbs() const { return _limbs; }
+        inline const std::string& error() const { return _error; }
+    };
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "bigint.hpp"
+
+// 精确结果超过这个 limb 数时改为按精度舍入
+#define BIGDECIMAL_EXACT_LIMIT (1u << 21)
+// 运算中额外保留的 limb 数
+#define BIGDECIMAL_GUARD_LIMBS 2
+
+namespace calc {
+
+    // 返回 true 时长时间的计算尽快结束, 结果不再有意义
+    using StopCallback = std::function<bool()>;
+
+    // 十进制浮点数: mantissa * BASE^exponent
+    // exact 为 true 时没有经过舍入, 整数与有限小数的加减乘保持精确
+    class BigDecimal {
+    private:
+        BigInt _mantissa;
+        int64_t _exponent;
+        bool _exact;
+    private:
+        void normalize();
+    public:
+        BigDecimal();
+        BigDecimal(const BigInt& mantissa, int64_t exponent = 0, bool exact = true);
+
+        // 形如 123, 1.5, .25, 6.02e23
+        static bool parse(const std::string& text, BigDecimal& out);
+        static BigDecimal fromDouble(double value);
+
+        inline const BigInt& mantissa() const { return _mantissa; }
+        inline int64_t exponent() const { return _exponent; }
+        inline bool isExact() const { return _exact; }
+        inline bool isZero() const { return _mantissa.isZero(); }
+        inline bool isNegative() const { return _mantissa.isNegative(); }
+        inline bool isInteger() const { return _exponent >= 0; }
+
+        // 只保留最高的 limbs 个 limb, 按被舍去部分的最高 limb 四舍五入
+        BigDecimal rounded(size_t limbs) const;
+        // 精确值过大时舍入到 limbs
+        BigDecimal limited(size_t limbs) const;
+
+        // 整数部分 (向零取整)
+        BigInt toInteger() const;
+        double toDouble() const;
+
+        BigDecimal operator-() const;
+        static int compare(const BigDecimal& a, const BigDecimal& b);
+
+        static BigDecimal add(const BigDecimal& a, const BigDecimal& b, size_t limbs);
+        static BigDecimal mul(const BigDecimal& a, const BigDecimal& b, size_t limbs);
+        static BigDecimal div(const BigDecimal& a, const BigDecimal& b, size_t limbs);
+        static BigDecimal reciprocal(const BigDecimal& a, size_t limbs);
+        static BigDecimal sqrt(const BigDecimal& a, size_t limbs);
+        static BigDecimal pow(const BigDecimal& a, int64_t exponent, size_t limbs);
+
+        // 二分拆分求常数, stop 可以为空
+        static BigDecimal pi(size_t limbs, const StopCallback& stop);
+        static BigDecimal e(size_t limbs, const StopCallback& stop);
+
+        // 保留 digits 位有效数字; 精确整数在 max_chars 以内时完整输出
+        std::string toString(size_t digits, size_t max_chars) const;
+    };
+
+}
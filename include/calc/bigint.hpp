@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 以 1e9 为基的 limb, 十进制输出无需换基
+#define BIGINT_BASE 1000000000u
+#define BIGINT_DIGITS 9
+
+// 乘法算法切换点 (按较短操作数的 limb 数)
+#define BIGINT_KARATSUBA_THRESHOLD 40
+#define BIGINT_TOOM3_THRESHOLD 160
+#define BIGINT_NTT_THRESHOLD 1200
+
+namespace calc {
+
+    using Limbs = std::vector<uint32_t>;
+
+    // 任意精度整数, 符号与小端 limb 数组分开存放, 零的 limb 数组为空
+    class BigInt {
+    private:
+        bool _negative;
+        Limbs _limbs;
+    private:
+        void trim();
+    public:
+        BigInt();
+        BigInt(int64_t value);
+        BigInt(bool negative, Limbs limbs);
+
+        // 只接受可选的符号加十进制数字
+        static bool parse(const std::string& text, BigInt& out);
+        std::string toString() const;
+
+        inline bool isZero() const { return _limbs.empty(); }
+        inline bool isNegative() const { return _negative; }
+        inline const Limbs& limbs() const { return _limbs; }
+        inline size_t size() const { return _limbs.size(); }
+        size_t digitCount() const;
+
+        BigInt operator-() const;
+        BigInt abs() const;
+
+        friend BigInt operator+(const BigInt& a, const BigInt& b);
+        friend BigInt operator-(const BigInt& a, const BigInt& b);
+        friend BigInt operator*(const BigInt& a, const BigInt& b);
+        BigInt& operator+=(const BigInt& b);
+        BigInt& operator-=(const BigInt& b);
+        BigInt& operator*=(const BigInt& b);
+
+        // 乘以 BASE^n / 截去低 n 个 limb (向零取整)
+        BigInt shiftLimbs(size_t n) const;
+        BigInt truncateLimbs(size_t n) const;
+
+        BigInt mulSmall(uint32_t m) const;
+        // 向零取整, remainder 与被除数同号
+        BigInt divSmall(uint32_t d, uint32_t* remainder = nullptr) const;
+
+        static int compare(const BigInt& a, const BigInt& b);
+        static int compareMagnitude(const BigInt& a, const BigInt& b);
+
+        BigInt pow(uint64_t exponent) const;
+        // 乘积树, 各层两两相乘使操作数规模平衡, 便于走到快速乘法
+        static BigInt factorial(uint32_t n);
+        static BigInt product(uint64_t first, uint64_t last);
+
+        // 估算值 mantissa * BASE^exponent, 用于初值
+        double toDouble(int64_t* exponent_limbs = nullptr) const;
+    };
+
+    inline bool operator==(const BigInt& a, const BigInt& b) { return BigInt::compare(a, b) == 0; }
+    inline bool operator<(const BigInt& a, const BigInt& b) { return BigInt::compare(a, b) < 0; }
+
+    // 无符号 limb 数组乘法, 按规模在 schoolbook / Karatsuba / Toom-3 / NTT 之间选择
+    Limbs multiplyLimbs(const Limbs& a, const Limbs& b);
+
+}
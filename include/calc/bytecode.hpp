@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "expr.hpp"
+#include "optimizer.hpp"
+
+namespace calc {
+
+    // 三地址指令, 操作数均为寄存器下标
+    struct Instr {
+        Op op;
+        uint16_t dst;
+        uint16_t a;
+        uint16_t b;
+    };
+
+    // 寄存器布局: [变量 | 常量 | 临时], 变量与常量在执行前一次性写入
+    struct Program {
+        std::vector<Instr> code;
+        std::vector<double> constants;
+        std::vector<std::string> variables;
+        uint16_t register_count = 0;
+        uint16_t result = 0;
+
+        inline uint16_t constantBase() const { return (uint16_t)variables.size(); }
+        inline uint16_t tempBase() const { return (uint16_t)(variables.size() + constants.size()); }
+
+        int slot(const std::string& name) const;
+        // 变量是否被指令或结果读取
+        bool uses(const std::string& name) const;
+        void clear();
+    };
+
+    // 将以 root 为根的子图降为字节码, 临时寄存器按最后一次使用回收
+    // 默认先经过 optimize, 所有后端 (VM / 批量 / JIT) 都执行优化后的程序
+    // fast_math 与 stats 见 optimize, 未优化时忽略
+    // root 无效或临时寄存器超过 16 位编号时返回 false, 不输出任何信息
+    bool compile(const ExprPool& pool, int root, Program& program, bool optimized = true, bool fast_math = false,
+                 OptimizeStats* stats = nullptr);
+
+    class VM final {
+    private:
+        const Program* _program;
+        std::vector<double> _registers;
+    public:
+        VM();
+
+        // 预分配寄存器并写入常量, 之后的 run 不再分配内存
+        void load(const Program& program);
+
+        // vars 按 Program::variables 的顺序排列
+        double run(const double* vars);
+    };
+
+}
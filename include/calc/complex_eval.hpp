@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "bytecode.hpp"
+
+// 每次解释一条指令处理的点数
+#define COMPLEX_BLOCK 256
+
+namespace calc {
+
+    // 复数批量求值: 每个寄存器按块存放, 实部与虚部分成两个数组 (SoA),
+    // 加减乘除等逐分量的循环可以直接被编译器向量化
+    // 变量 z 为复平面上的点, x / y 为它的实部 / 虚部, i 为虚数单位
+    // 程序应以 compile(..., optimized = false) 生成, 实数域的常量折叠会把 sqrt(-1) 之类折叠成 nan
+    class ComplexEvaluator final {
+    private:
+        enum class Binding {
+            Z,
+            Re,
+            Im,
+            Unit,
+            Unused,
+        };
+
+        const Program* _program;
+        std::vector<double> _re;
+        std::vector<double> _im;
+        std::vector<double> _pow;
+        std::vector<Binding> _bindings;
+        std::string _error;
+    private:
+        inline double* re(uint16_t reg) { return _re.data() + (size_t)reg * COMPLEX_BLOCK; }
+        inline double* im(uint16_t reg) { return _im.data() + (size_t)reg * COMPLEX_BLOCK; }
+        void powBlock(const double* ar, const double* ai, int exponent, double* dr, double* di, size_t n);
+    public:
+        ComplexEvaluator();
+
+        // 程序用到 z / x / y / i 以外的变量时返回 false
+        bool load(const Program& program);
+
+        // 对 count 个点 (re[k], im[k]) 求值
+        void evaluate(const double* re, const double* im, double* out_re, double* out_im, size_t count);
+
+        inline const std::string& error() const { return _error; }
+    };
+
+}
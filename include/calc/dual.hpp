@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "batch.hpp"
+#include "bytecode.hpp"
+
+// 求偏导的变量个数, 对应槽位 0, 1, 2 的 x, y, z
+#define DUAL_WIDTH 3
+
+namespace calc {
+
+    // 前向自动微分: 每个寄存器携带值与对 x, y, z 的偏导 (对偶数), 一遍求值同时得到 f 与 ∇f
+    // 与 BatchEvaluator 相同, 按 BATCH_BLOCK 个点分块执行字节码, 值和各偏导分别连续存放,
+    // sin / cos / exp / log 等的值与导数因子也由同一套 SIMD 内核计算
+    // 其它变量视为常数; floor / ceil 的导数取 0, 不连续点处不做特殊处理
+    class DualEvaluator final {
+    private:
+        const Program* _program;
+        const BatchKernels* _kernels;
+        // 寄存器 r 的第 c 个分量 (0 为值, 1..3 为偏导) 位于 (r * (DUAL_WIDTH + 1) + c) * BATCH_BLOCK
+        std::vector<double> _registers;
+        std::vector<double> _scratch;   // 本条指令的值与对两个操作数的偏导因子
+        std::vector<const double*> _points;     // run 的单点输入
+    private:
+        inline double* lane(uint16_t reg, int component) {
+            return _registers.data() + ((size_t)reg * (DUAL_WIDTH + 1) + component) * BATCH_BLOCK;
+        }
+        void unary(Op op, const double* a, double* dst, size_t n) const;
+    public:
+        explicit DualEvaluator(BatchIsa isa = detectBatchIsa());
+
+        void load(const Program& program);
+
+        // vars 与 BatchEvaluator::evaluate 相同; gradient[k] 可以为空, 表示不需要对该变量的偏导
+        void evaluate(const double* const* vars, double* out, double* const* gradient, size_t count);
+        void evaluate(const double* x, const double* y, const double* z, double* out,
+                      double* grad_x, double* grad_y, double* grad_z, size_t count);
+
+        // 单点求值, gradient 写入 DUAL_WIDTH 个偏导
+        double run(const double* vars, double* gradient);
+    };
+
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Const 节点的来源: 普通常数, 或 pi / e; 非负值为字面量在源文本中的偏移
+#define EXPR_CONST_PLAIN -1
+#define EXPR_CONST_PI -2
+#define EXPR_CONST_E -3
+// 节点下标表的初始容量
+#define EXPR_INDEX_INITIAL 32
+
+namespace calc {
+
+    enum class Op : uint8_t {
+        Const,
+        Var,
+        // 一元
+        Neg,
+        Sin,
+        Cos,
+        Tan,
+        Asin,
+        Acos,
+        Atan,
+        Sinh,
+        Cosh,
+        Tanh,
+        Exp,
+        Log,
+        Log10,
+        Sqrt,
+        Abs,
+        Floor,
+        Ceil,
+        Fact,
+        // 二元
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Pow,
+        Min,
+        Max,
+    };
+
+    inline bool isUnary(Op op) { return op >= Op::Neg && op <= Op::Fact; }
+    inline bool isBinary(Op op) { return op >= Op::Add; }
+    const char* opName(Op op);
+
+    struct Node {
+        Op op;
+        int a;          // 子节点下标, 不存在时为 -1
+        int b;
+        int slot;       // Var 的变量槽位; Const 的来源, 见 EXPR_CONST_*
+        double value;   // Const 的值
+    };
+
+    inline bool isCommutative(Op op) { return op == Op::Add || op == Op::Mul; }
+
+    // 以数组存放的表达式 DAG, 子节点总在父节点之前, 下标即拓扑序
+    // 节点经过哈希合并 (hash-consing), 相同的子表达式只存一份
+    class ExprPool {
+    private:
+        std::vector<Node> _nodes;
+        std::vector<std::string> _variables;
+        // 线性探测的开放寻址表, 存放节点下标, -1 为空位; 容量为 2 的幂, 装载率不超过 1/2
+        // 节点本身已在 _nodes 中, 表里只放下标, 插入不分配内存, clear 也只需重置一小块
+        std::vector<int> _index;
+    private:
+        static size_t hash(const Node& node);
+        static bool equal(const Node& lhs, const Node& rhs);
+        // node 所在的位置, 不存在时为应插入的空位
+        size_t find(const Node& node) const;
+        void grow();
+        int intern(const Node& node);
+    public:
+        // 预先登记 x, y, z 为槽位 0, 1, 2
+        ExprPool();
+
+        // 登记变量并返回槽位, 不创建节点
+        int declare(const std::string& name);
+
+        // source 不同的常数不会合并, 供高精度求值回到字面量
+        int constant(double value, int source = EXPR_CONST_PLAIN);
+        int variable(const std::string& name);
+        int unary(Op op, int a);
+        // 可交换运算的操作数按下标排序, 使 x*y 与 y*x 合并为同一节点
+        int binary(Op op, int a, int b);
+        void clear();
+        // 丢弃下标 >= size 的节点, 供增量解析回滚
+        void truncate(size_t size);
+
+        int slot(const std::string& name) const;
+
+        inline const Node& operator[](int index) const { return _nodes[index]; }
+        inline const std::vector<Node>& nodes() const { return _nodes; }
+        inline const std::vector<std::string>& variables() const { return _variables; }
+        inline size_t size() const { return _nodes.size(); }
+    };
+
+    double applyUnary(Op op, double a);
+    double applyBinary(Op op, double a, double b);
+
+    // 递归求值, 作为其它后端的参照实现
+    double evaluateTree(const ExprPool& pool, int root, const double* vars);
+
+}
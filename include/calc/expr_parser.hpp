@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "expr.hpp"
+#include "lexer.hpp"
+
+#define EXPR_MAX_DEPTH 256
+
+namespace calc {
+
+    struct ParseError {
+        std::string message;
+        size_t position = 0;
+    };
+
+    // 查找内置函数, 返回参数个数, 未知时返回 0
+    int lookupFunction(const char* name, size_t length, Op& op);
+
+    // 递归下降解析, 支持 + - * / ^ ! 与函数调用, 数字或右括号后紧跟标识符/左括号时视为隐式乘法
+    class ExprParser final {
+    private:
+        const std::string* _src;
+        std::vector<Token> _tokens;
+        size_t _pos;
+        int _depth;
+        ExprPool* _pool;
+        ParseError _error;
+        bool _exact_literals;
+    private:
+        inline const Token& peek() const { return _tokens[_pos]; }
+        bool fail(const char* message);
+        int parseAdditive();
+        int parseMultiplicative();
+        int parseUnary();
+        int parsePower();
+        int parsePostfix();
+        int parsePrimary();
+    public:
+        ExprParser();
+
+        // 成功返回根节点下标, 失败返回 -1 并记录错误
+        int parse(const std::string& src, ExprPool& pool);
+
+        inline const ParseError& error() const { return _error; }
+        // 开启后常数节点记录字面量位置与 pi / e, 供 BigEvaluator 使用
+        inline void setExactLiterals(bool enable) { _exact_literals = enable; }
+    };
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "bytecode.hpp"
+
+namespace calc {
+
+    // 闭区间 [lo, hi]; 两端为 nan 表示空集 (整个区间都在定义域之外)
+    struct Interval {
+        double lo;
+        double hi;
+
+        inline bool isEmpty() const { return std::isnan(lo) || std::isnan(hi); }
+        inline bool contains(double v) const { return lo <= v && v <= hi; }
+        inline double width() const { return hi - lo; }
+
+        static inline Interval point(double v) { return {v, v}; }
+        static inline Interval empty() { return {NAN, NAN}; }
+        static inline Interval entire() { return {-INFINITY, INFINITY}; }
+    };
+
+    // 保证包含真实值域的区间扩展, 结果向外放宽 1 ulp 抵消舍入误差
+    // 部分越出定义域的区间只取定义域内的部分, 例如 sqrt([-1, 4]) = [0, 2]
+    Interval applyUnary(Op op, Interval a);
+    Interval applyBinary(Op op, Interval a, Interval b);
+
+    // 逐条指令做区间运算, 用于判断一个区域内 f 是否可能为 0
+    class IntervalEvaluator final {
+    private:
+        const Program* _program;
+        std::vector<Interval> _registers;
+    public:
+        IntervalEvaluator();
+
+        void load(const Program& program);
+
+        // vars 按 Program::variables 的顺序排列
+        Interval run(const Interval* vars);
+    };
+
+}
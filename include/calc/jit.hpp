@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+
+#include "bytecode.hpp"
+
+namespace calc {
+
+    // 把字节码翻译为 x86-64 (System V) 机器码, 放在 mmap 得到的页中执行
+    // 其它平台, 或系统禁止可执行内存时 compile 返回 false, 调用方应回退到 VM
+    class JitFunction final {
+    private:
+        using Entry = double (*)(const double* vars);
+
+        void* _memory;
+        size_t _size;
+        Entry _entry;
+    public:
+        JitFunction();
+        ~JitFunction();
+        JitFunction(const JitFunction&) = delete;
+        JitFunction& operator=(const JitFunction&) = delete;
+
+        static bool supported();
+
+        bool compile(const Program& program);
+        // 编译后与 VM 交叉校验, 结果不一致时释放代码并返回 false
+        bool compileVerified(const Program& program);
+        void release();
+
+        inline bool ready() const { return _entry != nullptr; }
+        inline double operator()(const double* vars) const { return _entry(vars); }
+    };
+
+    // 对同一组输入比较 JIT 与 VM 的结果, 要求逐位相同 (nan 视为相等), 返回不一致的样本数
+    size_t crossCheck(const Program& program, const JitFunction& jit, VM& vm, size_t samples);
+
+    // 优先使用 JIT, 不可用或交叉校验失败时回退到 VM
+    class Evaluator final {
+    private:
+        VM _vm;
+        JitFunction _jit;
+        const JitFunction* _code;
+    public:
+        Evaluator();
+
+        void load(const Program& program, bool allow_jit = true);
+        // 使用调用方已编译并校验过的代码 (JitFunction 只读, 可被多个线程共享), 未就绪时回退到 VM
+        void load(const Program& program, const JitFunction& shared);
+
+        inline double run(const double* vars) { return _code ? (*_code)(vars) : _vm.run(vars); }
+        inline bool jitted() const { return _code != nullptr; }
+    };
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace calc {
+
+    enum class TokenKind : uint8_t {
+        Number,
+        Ident,
+        Plus,
+        Minus,
+        Star,
+        Slash,
+        Caret,
+        LParen,
+        RParen,
+        Comma,
+        Bang,
+        End,
+        Invalid,
+    };
+
+    struct Token {
+        TokenKind kind;
+        uint32_t begin;
+        uint32_t length;
+        double value;
+    };
+
+    // 从 pos 开始 (跳过空白) 读取一个记号, 返回记号之后的位置
+    size_t lexToken(const char* src, size_t length, size_t pos, Token& token);
+
+    // 读取全部记号, 末尾追加 End
+    void tokenize(const std::string& src, std::vector<Token>& tokens);
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "expr.hpp"
+#include "lexer.hpp"
+
+namespace calc {
+
+    struct LivePreview {
+        bool valid = false;
+        bool constant = false;      // 不含变量时才有数值结果
+        double value = 0.0;
+        int root = -1;
+        std::string error;
+        size_t position = 0;
+    };
+
+    // 面向计算器显示区的增量解析器, 编辑只发生在末尾
+    // 用调度场算法逐记号推进, 操作数栈与运算符栈是持久化链表, 每个记号前的状态只需 O(1) 保存
+    // 追加或删除字符时只回滚到受影响的最后几个记号重新词法分析与解析, 单次编辑的代价与表达式长度无关
+    // 语法与 ExprParser 一致: 优先级 加减 < 乘除(含隐式乘法) < 取负 < 乘方(右结合) < 阶乘
+    class IncrementalParser final {
+    private:
+        enum class Kind : uint8_t {
+            Binary,
+            Neg,
+            LParen,
+            Call,       // 已读到 '(' 的函数调用
+            Pending,    // 函数名, 取决于下一个记号是否为 '('
+        };
+
+        struct Operand {
+            int node;
+            double value;
+            bool constant;
+        };
+
+        struct Operator {
+            Kind kind;
+            Op op;
+            uint8_t arity;
+            uint8_t args;
+            uint32_t begin;
+            uint32_t length;
+        };
+
+        template <typename T>
+        struct Cell {
+            T item;
+            int next;
+        };
+
+        struct State {
+            int operands = -1;          // 两个栈的栈顶, -1 为空
+            int operators = -1;
+            size_t operand_cells = 0;   // 回滚时截断的位置
+            size_t operator_cells = 0;
+            size_t pool_size = 0;
+            bool expect_operand = true;
+            bool after_number = false;
+            const char* error = nullptr;
+            uint32_t error_position = 0;
+        };
+
+        std::string _text;
+        std::vector<Token> _tokens;
+        std::vector<State> _states;     // _states[i] 为处理第 i 个记号之前的状态
+        std::vector<Cell<Operand>> _operands;
+        std::vector<Cell<Operator>> _operators;
+        ExprPool _pool;
+
+        bool _preview_dirty;
+        LivePreview _preview;
+    private:
+        void pushOperand(State& state, Operand operand);
+        Operand popOperand(State& state);
+        void pushOperator(State& state, Operator op);
+        inline const Operator* topOperator(const State& state) const {
+            return state.operators < 0 ? nullptr : &_operators[state.operators].item;
+        }
+        inline void popOperator(State& state) { state.operators = _operators[state.operators].next; }
+
+        bool fail(State& state, const char* message, uint32_t position);
+        const char* unexpected(const State& state) const;
+        void reduce(State& state);
+        void pushBinary(State& state, Op op, uint32_t position);
+        void resolvePending(State& state);
+        void operand(State& state, const Token& token);
+        void step(State& state, const Token& token);
+        void reparseFrom(size_t first);
+    public:
+        IncrementalParser();
+
+        void assign(const std::string& text);
+        void append(const char* text);
+        // 删除末尾 count 个字符
+        void pop(size_t count = 1);
+        void clear();
+
+        // 对当前状态补全剩余运算符, 结果按编辑缓存
+        const LivePreview& preview();
+
+        inline const std::string& text() const { return _text; }
+        inline size_t tokenCount() const { return _tokens.size(); }
+        inline const ExprPool& pool() const { return _pool; }
+    };
+
+}
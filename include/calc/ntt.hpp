@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace calc {
+
+    // 三个 NTT 友好素数上分别做卷积, 再用 CRT 合并; 乘积长度上限 2^23 个 limb
+    #define NTT_MAX_LENGTH (1u << 23)
+
+    // 以 1e9 为基的小端 limb 数组相乘, out 需要 na + nb 个元素
+    // a == b 且 na == nb 时只做一次正变换
+    void nttMultiply(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out);
+
+}
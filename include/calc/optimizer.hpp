@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+#include "expr.hpp"
+
+namespace calc {
+
+    struct OptimizeStats {
+        size_t tree_nodes = 0;      // 按树展开时的运算节点数, 即逐节点求值的工作量
+        size_t before = 0;          // 优化前 DAG 中可达的运算节点数
+        size_t after = 0;
+    };
+
+    // 把 src 中 root 可达的部分原样复制到 dst (保持变量槽位), 丢弃不可达节点
+    int extract(const ExprPool& src, int root, ExprPool& dst);
+
+    // 在 dst 中重建并化简:
+    // 常量折叠, 借助哈希合并完成公共子表达式消除, 强度削减 (c 为 2 的幂时 x/c -> x*(1/c)),
+    // 恒等式 (x-0, x*1, x^1, --x ...) 以及 x^0 这类使整棵子树失效的分支删除
+    // 默认只做对所有输入 (包括 inf / nan / -0) 与解释器结果相同的改写;
+    // fast_math 时另外把 x*0 化为 0, x/c 化为 x*(1/c), x^n (|n| <= 4 的整数) 展开为乘法,
+    // 有限输入的结果与解释器相差几个 ulp, inf / nan 输入下 x*0 的结果不同
+    int optimize(const ExprPool& src, int root, ExprPool& dst, bool fast_math = false, OptimizeStats* stats = nullptr);
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "bytecode.hpp"
+#include "thread_pool.hpp"
+
+// solve 未给出区间时的默认搜索范围 [-SOLVE_DEFAULT_RANGE, SOLVE_DEFAULT_RANGE]
+#define SOLVE_DEFAULT_RANGE 10.0
+// 扫描变号区间的采样段数
+#define SOLVE_SAMPLES 4096
+#define SOLVE_MAX_ITERATIONS 100
+// 收敛点处 |f| 相对于区间端点函数值的上限, 超过时视为间断点 (如 tan 的极点) 而非零点
+#define SOLVE_RESIDUAL 1e-9
+// 不变号的切点根 (如 x^2) 只在极值点处 |f| 足够小时才接受
+#define SOLVE_TOUCH_RESIDUAL 1e-12
+// 积分区间固定切成的块数, 与线程数无关, 保证结果可复现
+#define INTEGRATE_CHUNKS 64
+#define INTEGRATE_MAX_DEPTH 60
+#define INTEGRATE_REL_TOLERANCE 1e-12
+#define INTEGRATE_ABS_TOLERANCE 1e-14
+
+namespace calc {
+
+    using StopCallback = std::function<bool()>;
+
+    // 在表达式之上提供的数值命令, 参数本身都是表达式:
+    //   solve(f, x)  solve(f, x, a, b)              区间内 f = 0 的全部实根
+    //   integrate(f, a, b)  integrate(f, x, a, b)   自适应 Gauss-Kronrod (G7-K15) 积分
+    //   d/dx(f, a)                                   f 在 x = a 处的导数, 由前向自动微分得到
+    // f 中除自变量以外不能出现其它变量; solve 与 d/dx 的自变量只能是 x, y 或 z
+    // 并行部分都按与线程数无关的固定方式切块, 再按顺序合并, 相同输入在任意线程数下结果一致
+    class NumericSolver final {
+    private:
+        ThreadPool& _pool;
+        StopCallback _stop;
+        std::string _error;
+    private:
+        bool fail(const std::string& message);
+        inline bool stopped() const { return _stop && _stop(); }
+        bool constant(const std::string& src, double& value);
+        bool function(const std::string& src, const std::string& variable, bool differentiable,
+                      Program& program, int& slot);
+    public:
+        NumericSolver(ThreadPool& pool, StopCallback stop = nullptr);
+
+        // 文本是否为上述命令之一
+        static bool isCommand(const std::string& src);
+        // 执行命令并把结果格式化为文本, 多个根以 ", " 分隔
+        bool run(const std::string& src, std::string& result);
+
+        // 以 slot 号变量为自变量 (slot < DUAL_WIDTH), 其余变量取 0, 根按从小到大排列
+        bool roots(const Program& program, int slot, double a, double b, std::vector<double>& out);
+        bool integrate(const Program& program, int slot, double a, double b, double& value,
+                       double* error_estimate = nullptr);
+        bool derivative(const Program& program, int slot, double at, double& value);
+
+        inline const std::string& error() const { return _error; }
+    };
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+
+#include "gap_buffer.hpp"
+#include "glsl_lexer.hpp"
+
+struct ShaderMarker {
+    int line;   // 从 1 开始
+    std::string message;
+};
+
+// 解析 printShaderLog 输出的编译日志, 兼容 NVIDIA / AMD / Mesa / Apple 的格式
+std::vector<ShaderMarker> parseShaderLog(const std::string& log);
+
+class CodeEditor final {
+private:
+    struct Line {
+        size_t start;
+        std::vector<GlslToken> tokens;
+        bool comment_in = false;
+        bool comment_out = false;
+        bool dirty = true;
+    };
+
+    GapBuffer _buffer;
+    std::vector<Line> _lines;
+    std::vector<ShaderMarker> _markers;
+    std::string _scratch;
+
+    size_t _cursor_line;
+    size_t _cursor_col;
+    bool _focused;
+    bool _modified;
+    bool _scroll_to_cursor;
+    unsigned long _revision;
+    size_t _dirty_from;
+    size_t _dirty_to;
+private:
+    size_t lineLength(size_t line) const;
+    size_t cursorOffset() const;
+    void insertText(const char* text, size_t len);
+    void eraseBackward();
+    void eraseForward();
+    void markDirty(size_t from, size_t to);
+    void shiftStarts(size_t first_line, long delta);
+    void rebuildLines();
+    void relex();
+    void handleKeyboard();
+    const ShaderMarker* markerAt(size_t line) const;
+public:
+    CodeEditor();
+
+    void setText(const std::string& text);
+    std::string getText() const;
+    void setMarkers(std::vector<ShaderMarker> markers);
+    inline void clearMarkers() { _markers.clear(); }
+
+    // 只绘制可见行, 返回本帧内容是否被修改
+    bool render(const char* id, const ImVec2& size);
+
+    inline bool isFocused() const { return _focused; }
+    inline bool isModified() const { return _modified; }
+    inline void markSaved() { _modified = false; }
+    inline size_t lineCount() const { return _lines.size(); }
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 可增长的间隙缓冲区, 编辑点附近的插入与删除为 O(1) 均摊
+class GapBuffer final {
+private:
+    std::vector<char> _data;
+    size_t _gap_begin;
+    size_t _gap_end;
+private:
+    void moveGap(size_t pos);
+    void grow(size_t required);
+public:
+    GapBuffer(size_t capacity = 4096);
+
+    void assign(const std::string& text);
+    void insert(size_t pos, const char* text, size_t len);
+    void erase(size_t pos, size_t len);
+    void clear();
+
+    std::string text() const;
+    // 将 [pos, pos + len) 拷贝到 dst, 不移动间隙
+    void copy(size_t pos, size_t len, std::string& dst) const;
+
+    inline size_t size() const { return _data.size() - (_gap_end - _gap_begin); }
+    inline bool empty() const { return size() == 0; }
+    inline char at(size_t pos) const {
+        return pos < _gap_begin ? _data[pos] : _data[pos + (_gap_end - _gap_begin)];
+    }
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+enum class GlslTokenKind {
+    Text,
+    Keyword,
+    Type,
+    Builtin,
+    Number,
+    Comment,
+    Preprocessor,
+    Punctuation,
+};
+
+struct GlslToken {
+    unsigned int begin;
+    unsigned int length;
+    GlslTokenKind kind;
+};
+
+// 对单行进行词法分析, in_comment 为行首是否处于块注释中, 返回行尾是否仍处于块注释中
+bool lexGlslLine(const char* line, size_t length, bool in_comment, std::vector<GlslToken>& tokens);
@@ -24,6 +24,11 @@ namespace Enum {
         Key_X,
         Key_Y,
         Key_Z,
+        Key_I,
+        Key_Comma,
+        Key_Solve,
+        Key_Integrate,
+        Key_Derivative,
         Key_Equal,
         Key_BackSpace,
         Key_AC,
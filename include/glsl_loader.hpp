@@ -5,26 +5,20 @@
 #include <sstream>
 #include <string>
 
-inline void loadShaderSource(const char* path, char* dst, unsigned int size) {
-    memset(dst, 1, sizeof(char) *  size);
+inline std::string loadShaderSource(const char* path) {
     std::ifstream stream(path, std::ios::in);
-    std::string line = "";
-    std::stringstream ss;
-    while (getline(stream, line)) {
-        ss << line << "\n";
-    }
     if (!stream.is_open()) {
         printf("\x1b[31;1m[Open File Error] Failed to open file: %s\n\x1b[0m", path);
+        return std::string();
     }
-
-    std::string content = ss.str();
-    size_t length = content.copy(dst, content.length());
-    dst[length] = '\0';
+    std::stringstream ss;
+    ss << stream.rdbuf();
 
     stream.close();
+    return ss.str();
 }
 
-inline void writeShaderSource(const char* path, char* src) {
+inline void writeShaderSource(const char* path, const std::string& src) {
     std::ofstream stream(path, std::ios::trunc);
     if (stream.is_open()) {
         stream << src;
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include "imgui.h"
+
+// 每根坐标轴上, 以摄像机最近点为中心向两侧各标注的刻度数
+#define GRID_LABEL_COUNT 10
+#define GRID_MIN_SPACING 1e-4f
+// 次网格为主网格的 1/GRID_SUBDIVISIONS
+#define GRID_SUBDIVISIONS 10.0f
+
+// 无限网格: 数学坐标的 xy 平面 (OpenGL 的 y = 0 平面) 由全屏三角形在片元着色器中逐像素求出,
+// 主网格间距取不超过摄像机到原点距离的 10 的幂, 缩放时自动切换, 开销与视角无关
+// 刻度标签全部加入同一个 ImDrawList, 共用 ImGui 的字体图集, 随界面一次绘制
+class AxisGrid final {
+private:
+    float _major;
+public:
+    AxisGrid();
+
+    void update(const glm::vec3& camera_pos);
+    inline float major() const { return _major; }
+    inline float minor() const { return _major / GRID_SUBDIVISIONS; }
+
+    // viewport 为视口在窗口中的左上角与大小 (像素)
+    void drawLabels(ImDrawList* list, const glm::mat4& view_proj, const glm::vec3& camera_pos,
+                    const ImVec2& origin, const ImVec2& size) const;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "jit.hpp"
+#include "line_batch.hpp"
+#include "thread_pool.hpp"
+
+// 视图宽度上的初始段数, 段宽取不超过视图宽度 / 64 的 2 的幂
+#define CURVE_BASE_SEGMENTS 64
+// 无论多平直都至少再细分的层数, 避免漏掉比初始段窄的特征
+#define CURVE_MIN_DEPTH 2
+// 中点偏离弦超过该像素数时细分
+#define CURVE_FLATNESS_PX 0.5
+// 最细一层上跨越超过该像素数的段进一步检查是否间断, 折线在间断处断开
+#define CURVE_JUMP_PX 32.0
+// 判断间断时额外二分的层数
+#define CURVE_JUMP_DEPTH 24
+// 采样范围向两侧各多出一个视图宽度, 在此范围内平移不需要重新采样
+#define CURVE_MARGIN 1.0
+// 点的纵坐标限制在视图中心上下若干个视图高度之内, 避免 float 溢出
+#define CURVE_Y_LIMIT 1.0e4
+#define CURVE_CACHE_LIMIT (1 << 21)
+// 每个并行任务处理的初始段数, 同一任务内的段一起逐层批量求值
+#define CURVE_TASK_GRAIN 16
+#define CURVE_MAX_COUNT 256
+#define CURVE_LINE_WIDTH 2.0f
+#define CURVE_AXIS_WIDTH 1.0f
+
+// y = f(x) 曲线图: 按曲率与间断自适应递归细分, 采样点都落在二进分点 k * 2^-n 上,
+// 不同层级与不同视图共享同一批 x, 以 x 为键缓存 f(x), 平移缩放时大部分点直接复用
+// 所有曲线与坐标轴合并为一个 LineBatch, 一次绘制调用画完
+class CurvePlot final {
+private:
+    struct Curve {
+        std::string source;
+        calc::Program program;
+        std::unique_ptr<calc::JitFunction> jit;     // 各采样线程共享, 不可用时为未就绪状态
+        uint32_t color;
+        std::unordered_map<double, double> cache;
+    };
+
+    ThreadPool& _pool;
+    std::vector<Curve> _curves;
+    LineBatch _batch;
+    std::vector<LinePoint> _points;
+
+    int _width, _height;
+    double _center_x, _center_y;
+    double _scale;                      // 每像素对应的长度
+
+    // 上一次采样时的范围与尺度, 点坐标相对于 (_origin_x, _origin_y) 存为 float
+    bool _dirty;
+    double _sampled_x0, _sampled_x1;
+    double _sampled_scale;
+    double _origin_x, _origin_y;
+private:
+    bool needsResample() const;
+    void resample();
+public:
+    CurvePlot(ThreadPool& pool, int width, int height);
+
+    CurvePlot(const CurvePlot&) = delete;
+    CurvePlot& operator=(const CurvePlot&) = delete;
+
+    // 只允许使用 x
+    static bool validate(const calc::Program& program, std::string& error);
+
+    // 添加曲线, 相同的表达式替换原有曲线; 失败时返回 false 并写入 error
+    bool add(const std::string& source, const calc::Program& program, std::string& error);
+    void clear();
+    void resize(int width, int height);
+
+    // 以像素为单位平移, dy 向上为正
+    void pan(float dx, float dy);
+    // 以像素 (x, y) 为中心缩放, factor < 1 时放大
+    void zoom(float factor, float x, float y);
+    void resetView();
+
+    // 视图超出已采样的范围或尺度变化超过 2 倍时重新采样并上传
+    void update();
+    inline void bind(unsigned int binding = 0) const { _batch.bind(binding); }
+
+    // 相对于采样原点的正交投影
+    glm::mat4 viewProjection() const;
+
+    inline bool isLoaded() const { return !_curves.empty(); }
+    inline size_t curveCount() const { return _curves.size(); }
+    inline size_t pointCount() const { return _batch.pointCount(); }
+    inline unsigned int vertexCount() const { return _batch.vertexCount(); }
+    inline int width() const { return _width; }
+    inline int height() const { return _height; }
+};
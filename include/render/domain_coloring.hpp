@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+
+#include "complex_eval.hpp"
+#include "thread_pool.hpp"
+
+#define DOMAIN_TILE_SIZE 64
+// 视图改变后第一遍每 8x8 像素求一个点, 之后步长逐级减半直到 1
+#define DOMAIN_COARSE_STEP 8
+// 每帧用于求值的时间, 超出后剩余的块留到下一帧
+#define DOMAIN_FRAME_BUDGET_MS 8.0
+
+// 复函数 f(z) 的定义域着色: 色相表示 arg f, 亮度随 log2|f| 周期变化
+// 画面按块在线程池中求值并逐块上传到纹理, 平移缩放时先给出粗略结果再逐步细化
+class DomainColoring final {
+private:
+    ThreadPool& _pool;
+    calc::Program _program;
+    bool _loaded;
+
+    unsigned int _texture_id;
+    int _width, _height;
+    std::vector<uint32_t> _pixels;      // RGBA8, 第 0 行在底部, 与纹理一致
+
+    double _center_re, _center_im;
+    double _scale;                      // 每像素对应的复平面长度
+
+    int _step;                          // 当前细化的步长, 0 表示已是全分辨率
+    size_t _next_tile;
+private:
+    inline int tilesX() const { return (_width + DOMAIN_TILE_SIZE - 1) / DOMAIN_TILE_SIZE; }
+    inline int tilesY() const { return (_height + DOMAIN_TILE_SIZE - 1) / DOMAIN_TILE_SIZE; }
+    void restart();
+    void shadeTile(calc::ComplexEvaluator& evaluator, size_t tile, int step);
+    void uploadTile(size_t tile);
+public:
+    DomainColoring(ThreadPool& pool, int width, int height);
+    ~DomainColoring();
+
+    DomainColoring(const DomainColoring&) = delete;
+    DomainColoring& operator=(const DomainColoring&) = delete;
+
+    // 程序需以 compile(..., optimized = false) 生成, 失败时返回 false 并写入 error
+    bool load(const calc::Program& program, std::string& error);
+    inline void unload() { _loaded = false; }
+    void resize(int width, int height);
+
+    // 以像素为单位平移, dy 向上为正
+    void pan(float dx, float dy);
+    // 以像素 (x, y) 为中心缩放, factor < 1 时放大
+    void zoom(float factor, float x, float y);
+    void resetView();
+
+    // 在帧预算内求值若干块并上传
+    void update();
+    void bind(unsigned int slot = 0) const;
+
+    inline bool isLoaded() const { return _loaded; }
+    inline bool isRefining() const { return _loaded && _step > 0; }
+    inline int step() const { return _step; }
+    inline double scale() const { return _scale; }
+    inline double centerRe() const { return _center_re; }
+    inline double centerIm() const { return _center_im; }
+};
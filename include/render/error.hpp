@@ -3,17 +3,25 @@
 #include "error.hpp"
 #include <cstdlib>
 #include <iostream>
+#include <string>
 
-inline void printShaderLog(unsigned int shader) {
+inline std::string getShaderLog(unsigned int shader) {
     int len = 0;
     int chWritten = 0;
-    char *log;
+    std::string log;
     glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &len);
     if (len > 0) {
-        log = (char *)malloc(len);
-        glGetShaderInfoLog(shader, len, &chWritten, log);
+        log.resize(len);
+        glGetShaderInfoLog(shader, len, &chWritten, &log[0]);
+        log.resize(chWritten);
+    }
+    return log;
+}
+
+inline void printShaderLog(unsigned int shader) {
+    std::string log = getShaderLog(shader);
+    if (!log.empty()) {
         std::cout << "\x1b[33;1m[Shader Error]\x1b[0m: " << log << std::endl;
-        free(log);
     }
 }
 
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "geo.hpp"
+#include "bytecode.hpp"
+
+#define FUNCTION_SURFACE_PRECISION 160
+// 超出该高度的顶点所在的三角形不绘制, 避免渐近线附近拉出长条
+#define FUNCTION_SURFACE_HEIGHT_LIMIT 8.0f
+
+// z = f(x, y) 在 [-extent, extent]^2 上的曲面, 顶点布局与 Sphere 相同 (位置, 纹理坐标, 法线)
+// 数学坐标 (x, y, z) 对应 OpenGL 的 (x, z, -y); 法线由 DualEvaluator 一遍求出的 ∇f 精确给出
+class FunctionSurface final : public Geo {
+private:
+    std::vector<float> _vertices;
+    std::vector<unsigned int> _indices;
+public:
+    FunctionSurface(const calc::Program& program, int precision = FUNCTION_SURFACE_PRECISION, float extent = 2.0f);
+
+    // 只允许使用 x 与 y
+    static bool validate(const calc::Program& program, std::string& error);
+
+    inline const void* getVertices() override { return _vertices.data(); }
+    inline const void* getIndices() override { return _indices.data(); }
+    inline unsigned int getSize() override { return (unsigned int)(_vertices.size() * sizeof(float)); }
+    inline unsigned int getCount() override { return (unsigned int)_indices.size(); }
+};
@@ -6,6 +6,7 @@
 
 class Geo {
 public:
+    virtual ~Geo() = default;
     virtual const void* getVertices() = 0;
     virtual const void* getIndices() = 0;
     virtual unsigned int getSize() = 0;
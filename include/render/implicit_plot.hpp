@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "geo.hpp"
+#include "bytecode.hpp"
+#include "thread_pool.hpp"
+
+// 每个并行任务处理的单元数
+#define IMPLICIT_GRAIN 64
+#define IMPLICIT_SURFACE_RESOLUTION 128
+#define IMPLICIT_POINT_SIZE 3.0f
+
+struct ImplicitStats {
+    size_t interval_evals = 0;      // 区间求值次数
+    size_t uniform_evals = 0;       // 同分辨率的均匀网格需要的求值次数
+    size_t leaves = 0;              // 可能含有零点的像素 / 体素
+};
+
+// 以区间运算驱动的四叉树 (2D) / 八叉树 (3D) 细分
+// 逐层并行处理, 区间不含 0 的单元连同整棵子树一起丢弃, 只有存活的单元继续细分到分辨率
+// 区间运算是保守的, 结果不会漏掉零点, 但可能多出少量相邻的单元
+class ImplicitPlotter final {
+public:
+    struct Cell2 {
+        int x, y;
+    };
+    struct Cell3 {
+        int x, y, z;
+    };
+private:
+    ThreadPool& _pool;
+public:
+    ImplicitPlotter(ThreadPool& pool);
+
+    // f(x, y) = 0 在 [min, max] 上, 划分为 resolution x resolution 个像素
+    void plot2D(const calc::Program& program, const double* min, const double* max, int resolution,
+                std::vector<Cell2>& cells, ImplicitStats* stats = nullptr);
+    // f(x, y, z) = 0, 划分为 resolution^3 个体素
+    void plot3D(const calc::Program& program, const double* min, const double* max, int resolution,
+                std::vector<Cell3>& cells, ImplicitStats* stats = nullptr);
+};
+
+// f(x, y, z) = 0 在 [-extent, extent]^3 上的隐式曲面, 以八叉树找到的体素中心作为点绘制 (GL_POINTS)
+// 顶点布局与 Sphere 相同, 法线取 ∇f 的方向
+class ImplicitSurface final : public Geo {
+private:
+    std::vector<float> _vertices;
+    std::vector<unsigned int> _indices;
+    ImplicitStats _stats;
+public:
+    ImplicitSurface(ThreadPool& pool, const calc::Program& program,
+                    int resolution = IMPLICIT_SURFACE_RESOLUTION, float extent = 2.0f);
+
+    // 只允许使用 x, y 与 z
+    static bool validate(const calc::Program& program, std::string& error);
+
+    inline const ImplicitStats& stats() const { return _stats; }
+
+    inline const void* getVertices() override { return _vertices.data(); }
+    inline const void* getIndices() override { return _indices.data(); }
+    inline unsigned int getSize() override { return (unsigned int)(_vertices.size() * sizeof(float)); }
+    inline unsigned int getCount() override { return (unsigned int)_indices.size(); }
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glad/glad.h"
+
+// 折线上的一个点, 与 line_vertex.glsl 中的 LinePoint (std430) 布局一致
+// y 为 NaN 的点是断点, 相邻两条线段都不绘制, 多条折线以断点分隔后放入同一个缓冲
+struct LinePoint {
+    float x, y;
+    uint32_t color;     // RGBA8, R 在最低字节
+    float width;        // 屏幕像素
+};
+
+// 粗线批量绘制: 所有点放在一个 SSBO 中, 顶点着色器按 gl_VertexID 取出线段两端,
+// 在屏幕空间扩展为宽 width 的四边形, 任意多条折线只需一次 glDrawArrays
+class LineBatch final {
+private:
+    unsigned int _buffer_id;
+    size_t _capacity;       // 字节
+    size_t _count;          // 点数
+public:
+    LineBatch();
+    ~LineBatch();
+
+    LineBatch(const LineBatch&) = delete;
+    LineBatch& operator=(const LineBatch&) = delete;
+
+    // 容量不足时按 2 倍扩容, 否则原地更新
+    void upload(const std::vector<LinePoint>& points);
+    void bind(unsigned int binding = 0) const;
+
+    // 每条线段 6 个顶点 (两个三角形)
+    inline unsigned int vertexCount() const { return _count > 1 ? (unsigned int)(_count - 1) * 6 : 0; }
+    inline size_t pointCount() const { return _count; }
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "geo.hpp"
+#include "bytecode.hpp"
+#include "mapped_file.hpp"
+
+#define MESH_CACHE_DIR "../cache"
+#define MESH_CACHE_EXTENSION ".mesh"
+#define MESH_CACHE_MAGIC "GEOMESH"
+// 文件布局改变时递增, 旧文件视为未命中并被覆盖
+#define MESH_CACHE_VERSION 2
+// 顶点块与索引块按页对齐, 映射后的指针直接交给 glBufferData
+#define MESH_CACHE_ALIGNMENT 4096
+#define MESH_CACHE_BYTE_ORDER 0x01020304u
+// 缓存目录的总大小上限, 超出时删除最久未写入的文件
+#define MESH_CACHE_BUDGET_MB 1024
+
+// 缓存文件头, 之后依次是对齐的顶点块 (每个顶点 vertex_floats 个 float) 与索引块 (uint32)
+struct MeshCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;            // 写入时的 MESH_CACHE_BYTE_ORDER, 字节序不同的机器上不会命中
+    uint64_t key;                   // 生成参数的内容哈希
+    uint32_t max_index;             // 写入时统计的最大索引, 命中时只校验它而不扫描整个索引块
+    uint32_t vertex_floats;
+    uint64_t vertex_count;
+    uint64_t index_count;
+    uint64_t vertex_offset;
+    uint64_t index_offset;
+    uint64_t file_size;
+};
+static_assert(sizeof(MeshCacheHeader) == 72, "MeshCacheHeader must have no padding");
+
+// 生成参数的 64 位 FNV-1a 哈希
+// 第一项是生成器的名称与修订号, 生成算法改变时修改修订号, 旧的缓存自然失效
+class MeshKey final {
+private:
+    uint64_t _hash;
+private:
+    void mix(const void* data, size_t size);
+public:
+    MeshKey(const char* generator);
+
+    MeshKey& add(int value);
+    MeshKey& add(float value);
+    MeshKey& add(const std::string& text);
+    // 按优化后的字节码计算, 书写上不同但化简结果相同的表达式共用一份缓存
+    MeshKey& add(const calc::Program& program);
+
+    inline uint64_t value() const { return _hash; }
+};
+
+// 直接引用映射文件中的顶点与索引, 生命周期内文件保持映射
+class CachedMesh final : public Geo {
+private:
+    MappedFile _file;
+    const MeshCacheHeader* _header;
+public:
+    CachedMesh();
+
+    // 校验文件头与各块的范围, 不符时返回 false
+    bool open(const std::string& path, uint64_t key);
+
+    inline const void* getVertices() override { return _file.data() + _header->vertex_offset; }
+    inline const void* getIndices() override { return _file.data() + _header->index_offset; }
+    inline unsigned int getSize() override {
+        return (unsigned int)(_header->vertex_count * _header->vertex_floats * sizeof(float));
+    }
+    inline unsigned int getCount() override { return (unsigned int)_header->index_count; }
+};
+
+// 生成代价高的网格 (隐式曲面, 高精度的 z = f(x, y)) 的磁盘缓存, 每个键一个文件
+// 写入先落到临时文件再改名, 进程中途退出不会留下半个缓存文件
+class MeshCache final {
+private:
+    std::string _dir;
+    size_t _budget;
+    size_t _hits;
+    size_t _misses;
+private:
+    std::string path(uint64_t key) const;
+    // 总大小超出预算时按写入时间从旧到新删除
+    void prune();
+public:
+    MeshCache(const std::string& dir = MESH_CACHE_DIR, size_t budget = (size_t)MESH_CACHE_BUDGET_MB << 20);
+
+    // 未命中时返回 nullptr
+    CachedMesh* load(uint64_t key);
+    bool store(uint64_t key, Geo& geo);
+
+    inline size_t hits() const { return _hits; }
+    inline size_t misses() const { return _misses; }
+};
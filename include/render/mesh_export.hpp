@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "async_task.hpp"
+#include "geo.hpp"
+
+// 与 Geo 的顶点布局一致: 位置 3, 纹理坐标 2, 法线 3
+#define MESH_VERTEX_FLOATS 8
+// 三角面分批格式化, 每批之间检查取消并上报进度
+#define MESH_EXPORT_BATCH (1 << 16)
+#define MESH_EXPORT_TIMEOUT_SECONDS 600.0
+
+enum class MeshFormat {
+    PLY,        // 二进制 PLY
+    OBJ,        // Wavefront OBJ 文本
+    GLB,        // glTF 2.0 二进制
+};
+
+// 导出用的网格快照: 后台线程写文件期间渲染线程可以继续替换或释放原来的 Geo
+struct MeshData {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    bool points = false;            // 索引表示点而不是三角形 (隐式曲面)
+
+    static std::shared_ptr<MeshData> snapshot(Geo& geo, bool points);
+
+    inline size_t vertexCount() const { return vertices.size() / MESH_VERTEX_FLOATS; }
+};
+
+// 顶点与索引数组按原样整块写出 (PLY 声明本机字节序, GLB 的 BIN 块直接引用两块数组),
+// 只有需要逐项改写的部分 (PLY 的面, OBJ 文本) 在 BufferedWriter 的缓冲区中就地格式化, 不构造中间字符串
+class MeshExporter final {
+private:
+    std::string _error;
+    TaskContext* _context;
+private:
+    bool fail(const std::string& message);
+    bool stopped() const;
+    void progress(size_t done, size_t total) const;
+    bool writePLY(FILE* file, const MeshData& mesh);
+    bool writeOBJ(FILE* file, const MeshData& mesh);
+    bool writeGLB(FILE* file, const MeshData& mesh);
+public:
+    MeshExporter(TaskContext* context = nullptr);
+
+    // 按扩展名 (.ply / .obj / .glb) 确定格式
+    static bool formatFromPath(const std::string& path, MeshFormat& format);
+
+    // 失败或取消时删除写了一半的文件
+    bool write(const std::string& path, const MeshData& mesh);
+    bool write(const std::string& path, const MeshData& mesh, MeshFormat format);
+
+    inline const std::string& error() const { return _error; }
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "async_task.hpp"
+#include "mapped_file.hpp"
+#include "thread_pool.hpp"
+
+// 叶节点与内部节点 LOD 抽样最多的点数; 显存池按这个大小划分槽位, 每个节点占一个槽位
+#define POINT_NODE_CAPACITY 8192
+#define POINT_MAX_DEPTH 20
+// 内部节点至多抽取子树点数的 1 / POINT_SAMPLE_RATIO
+#define POINT_SAMPLE_RATIO 4
+// 文本按块并行解析, 块边界对齐到换行
+#define POINT_PARSE_CHUNK (4 << 20)
+// 读取源数据时每个并行任务处理的点数
+#define POINT_PARTITION_GRAIN (1 << 16)
+// 顶层节点按 2^POINT_GRID_DEPTH 的网格计数后一次分发到点文件, 之后在每个网格单元内就地细分 (不超过 10)
+#define POINT_GRID_DEPTH 6
+// 分发时源数据按固定数目的条带并行计数与写出, 结果与线程数无关
+#define POINT_SCATTER_STRIPES 8
+// 点文件与文本解析结果的临时文件所在目录, 文件映射后即删除
+#define POINT_SPILL_DIR "../cache"
+// 节点内相邻点在屏幕上的估计间距超过该像素数时细化到子节点
+#define POINT_SPACING_PX 2.0f
+// 每帧最多上传的节点数, 避免一次上传过多造成卡顿
+#define POINT_UPLOADS_PER_FRAME 32
+#define POINT_GPU_BUDGET_MB 256
+#define POINT_SIZE 2.0f
+#define POINT_LOAD_TIMEOUT_SECONDS 600.0
+
+struct PointNode {
+    glm::vec3 min, max;
+    uint32_t first, count;      // 绘制的点: 叶节点在 points 中, 内部节点在 samples 中
+    uint64_t total;             // 子树中的点数
+    int first_child;            // 非空子节点连续存放, 叶节点为 -1
+    int child_count;
+
+    inline bool isLeaf() const { return first_child < 0; }
+};
+
+// 点云八叉树, 与 GL 无关, 在后台线程中构建
+// 点与抽样存放在映射的临时文件中而不是堆上, 上传节点时由操作系统按需换入, 内存紧张时直接丢弃
+// 坐标换到 OpenGL 坐标系 (x, z, -y) 并减去 origin, 远离原点的数据也能保持 float 精度
+struct PointOctree {
+    MappedFile points;                  // glm::vec3, 按节点排列, 每个叶节点的点连续存放
+    MappedFile samples;                 // 内部节点从子树中等距抽出的点, 同样按节点连续存放
+    std::vector<PointNode> nodes;       // nodes[0] 为根, 子节点连续存放
+    glm::dvec3 origin;                  // 数据坐标
+    glm::vec3 lower, upper;             // 点的实际包围盒, 根节点是包住它的立方体
+    int depth = 0;
+
+    inline const glm::vec3* drawPoints(const PointNode& node) const {
+        return (const glm::vec3*)(node.isLeaf() ? points.data() : samples.data()) + node.first;
+    }
+};
+
+// 构建时按下标读取局部坐标的点: 二进制 XYZ 直接读映射的源文件并转换坐标, 文本先解析到临时文件
+struct PointSource {
+    const char* data = nullptr;
+    size_t count = 0;
+    bool convert = false;               // data 为数据坐标的 float32 三元组, 否则已是局部坐标的 glm::vec3
+    glm::dvec3 origin;
+
+    // [first, first + n) 的局部坐标; 已是局部坐标时直接指向 data, 否则转换到 buffer 中
+    const glm::vec3* read(size_t first, size_t n, glm::vec3* buffer) const;
+};
+
+// 读取 CSV / 空白分隔的文本 (每行前三列为 x, y, z, 其余列与无法解析的行被忽略)
+// 或二进制 XYZ (.bin / .xyzb, 连续的小端 float32 三元组), 文件以内存映射方式读取
+// 文本按块并行解析, 数字的连续 8 位一次转换 (SWAR)
+// 构建不在堆上保留点: 先按顶层网格计数, 再从源数据一次分发到映射的点文件中, 网格单元内在文件中就地划分
+// 堆内存只有网格计数 (POINT_SCATTER_STRIPES * 8^POINT_GRID_DEPTH 个 uint32) 与节点表
+class PointCloudBuilder final {
+private:
+    ThreadPool& _pool;
+    std::string _error;
+private:
+    bool fail(const std::string& message);
+    bool parseText(const char* data, size_t size, MappedFile& spill, PointSource& source, TaskContext& context);
+    bool parseBinary(const char* data, size_t size, PointSource& source);
+    // 求包围盒, 把点按网格单元的 Morton 序写入 tree.points 并建立顶层节点, chunks 为仍超出容量的网格单元节点
+    bool distribute(const PointSource& source, PointOctree& tree, std::vector<int>& chunks, TaskContext& context);
+    // 在 tree.points 中就地细分 chunk 的子树; subtree[0] 为 chunk 自身, 其余节点的子节点下标相对于 subtree
+    void refine(PointOctree& tree, int chunk, std::vector<PointNode>& subtree, int& depth);
+    bool sample(PointOctree& tree, TaskContext& context);
+public:
+    PointCloudBuilder(ThreadPool& pool);
+
+    bool load(const std::string& path, PointOctree& tree, TaskContext& context);
+
+    inline const std::string& error() const { return _error; }
+};
+
+// 点云的后台加载与按视图流式上传
+// 显存池是一块固定大小的缓冲, 划分为 POINT_NODE_CAPACITY 个点的槽位
+// 每帧从根开始按屏幕上的大小优先细化可见节点, 子节点全部就绪前继续绘制父节点, 不出现空洞
+// 不再需要的槽位按最近使用时间回收, 所有可见节点用一次 glMultiDrawArrays 绘制
+class PointCloud final {
+private:
+    ThreadPool& _pool;
+    AsyncTask _task;
+    std::shared_ptr<PointOctree> _loading;
+    std::shared_ptr<PointOctree> _tree;
+    std::string _path;
+    std::string _status;
+
+    unsigned int _vao;
+    unsigned int _buffer;
+    size_t _budget;                     // 字节
+    int _slot_count;
+    std::vector<int> _node_slot;        // 节点所在的槽位, -1 表示不在显存中
+    std::vector<int> _slot_node;        // 槽位中的节点, -1 表示空闲
+    std::vector<uint64_t> _slot_frame;  // 槽位最近一次被使用的帧
+    uint64_t _frame;
+
+    std::vector<int> _firsts;
+    std::vector<int> _counts;
+    size_t _drawn_points;
+    size_t _resident;
+    glm::mat4 _model;
+private:
+    void allocate();
+    void release();
+    // 为节点分配槽位并上传, 没有可回收的槽位时返回 false
+    bool upload(int node);
+public:
+    PointCloud(ThreadPool& pool, size_t budget = (size_t)POINT_GPU_BUDGET_MB << 20);
+    ~PointCloud();
+
+    PointCloud(const PointCloud&) = delete;
+    PointCloud& operator=(const PointCloud&) = delete;
+
+    // 在后台线程加载, 正在进行的加载会被取消
+    void load(const std::string& path);
+    void cancel();
+    void clear();
+    // 每帧调用, 加载完成时替换当前的点云
+    void poll();
+
+    // 修改显存预算, 已上传的节点全部丢弃, 之后按需重新上传
+    void setBudget(size_t bytes);
+
+    // 选出当前视图下要绘制的节点, 上传缺少的节点; fov_y 为弧度, viewport_height 为像素
+    void update(const glm::mat4& view_proj, const glm::vec3& camera_pos, float fov_y, float viewport_height);
+    void draw() const;
+
+    // 把点云缩放平移到原点附近 [-1, 1] 的范围内
+    inline const glm::mat4& model() const { return _model; }
+    // 点在局部坐标中的高度范围, 供着色
+    glm::vec2 heightRange() const;
+
+    inline bool isLoaded() const { return _tree != nullptr; }
+    inline bool loading() const { return _task.running(); }
+    inline float progress() const { return _task.progress(); }
+    inline const std::string& status() const { return _status; }
+    inline size_t pointCount() const { return _tree ? (size_t)_tree->nodes[0].total : 0; }
+    inline size_t nodeCount() const { return _tree ? _tree->nodes.size() : 0; }
+    inline size_t residentNodes() const { return _resident; }
+    inline size_t drawnPoints() const { return _drawn_points; }
+    inline size_t drawnNodes() const { return _counts.size(); }
+    inline size_t budget() const { return _budget; }
+};
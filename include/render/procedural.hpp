@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "texture.hpp"
+#include "thread_pool.hpp"
+
+enum class ProceduralKind {
+    Checkerboard,
+    Gradient,
+    Noise,
+};
+
+enum class NoiseType {
+    Perlin,
+    Value,
+};
+
+enum class GradientShape {
+    Horizontal,
+    Vertical,
+    Radial,
+};
+
+struct ProceduralParams {
+    ProceduralKind kind = ProceduralKind::Checkerboard;
+    int width = 512;
+    int height = 512;
+    unsigned char color_a[4] = {0, 0, 0, 255};
+    unsigned char color_b[4] = {255, 255, 255, 255};
+
+    // Checkerboard
+    int tile_size = 32;
+    // Gradient
+    GradientShape shape = GradientShape::Horizontal;
+    // Noise: frequency 为整张纹理上的晶格数, 取整数以保证可平铺
+    NoiseType noise = NoiseType::Perlin;
+    int frequency = 8;
+    int octaves = 4;
+    int lacunarity = 2;
+    float gain = 0.5f;
+    uint32_t seed = 0;
+
+    static ProceduralParams checkerboard(int width, int height, int tileSize);
+    static ProceduralParams gradient(int width, int height, GradientShape shape);
+    static ProceduralParams fbm(int width, int height, NoiseType type, int frequency, int octaves, uint32_t seed = 0);
+
+    bool operator==(const ProceduralParams& other) const;
+    uint64_t hash() const;
+};
+
+// 生成 RGBA8 像素, 按行并行, 行内按晶格区间展开为可向量化的循环
+// 缓存持有像素的强引用, 按字节数限定总量, 超出时淘汰最久未使用的条目
+class ProceduralGenerator final {
+private:
+    struct Entry {
+        ProceduralParams params;
+        uint64_t hash;
+        std::shared_ptr<const unsigned char[]> pixels;
+        size_t bytes;
+        uint64_t last_used;
+    };
+
+    ThreadPool& _pool;
+    std::mutex _mutex;
+    std::vector<Entry> _cache;
+    size_t _cache_bytes = 0;
+    uint64_t _clock = 0;
+private:
+    void fillCheckerboard(const ProceduralParams& p, unsigned char* dst);
+    void fillGradient(const ProceduralParams& p, unsigned char* dst);
+    void fillNoise(const ProceduralParams& p, unsigned char* dst);
+    void evict(size_t incoming);
+public:
+    ProceduralGenerator(ThreadPool& pool);
+
+    std::shared_ptr<const unsigned char[]> generate(const ProceduralParams& params);
+    Texture* createTexture(const ProceduralParams& params);
+
+    void clearCache();
+};
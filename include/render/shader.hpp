@@ -1,8 +1,9 @@
 #pragma once
 
 #include "glad/glad.h"
+#include <cstdint>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 #include "glm/glm.hpp"
 
@@ -21,11 +22,17 @@ class Shader final {
 private:
     unsigned int renderer_id;
     std::string* file_paths;
-    std::unordered_map<std::string, int> uniform_cache;
+    struct UniformSlot {
+        uint64_t hash;
+        std::string name;
+        int location;
+    };
+    // 按名字哈希线性查找, 每帧设置 uniform 时不构造临时字符串
+    std::vector<UniformSlot> uniform_cache;
 private:
     unsigned int compileShader(unsigned int type, const char* source, ShaderType s_type);
     unsigned int createShader();
-    int getUniformLocation(const std::string& name);
+    int getUniformLocation(const char* name);
 public:
     Shader(std::string* filePaths);
     ~Shader();
@@ -34,12 +41,15 @@ public:
     void Unbind() const;
 
     static std::string parseShader(const std::string& filePath);
+    // 仅编译单个着色器阶段, 返回编译日志 (成功时为空)
+    static std::string checkSource(unsigned int type, const std::string& source);
     
-    void setUniform1i(const std::string& name, int value);
-    void setUniform1f(const std::string& name, float value);
-    void setUniform2f(const std::string& name, float v0, float v1);
-    void setUniform3f(const std::string& name, float v0, float v1, float v2);
-    void setUniformMat4f(const std::string& name, glm::mat4& mat);
+    void setUniform1i(const char* name, int value);
+    void setUniform1f(const char* name, float value);
+    void setUniform2f(const char* name, float v0, float v1);
+    void setUniform3f(const char* name, float v0, float v1, float v2);
+    void setUniformMat3f(const char* name, const glm::mat3& mat);
+    void setUniformMat4f(const char* name, const glm::mat4& mat);
 };
 
 
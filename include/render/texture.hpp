@@ -2,58 +2,41 @@
 
 #include "glad/glad.h"
 #include "stb_image.h"
+#include <cstdint>
 #include <string>
-#include <random>
 
+class TextureLoader;
 
 class Texture final {
+    friend class TextureLoader;
 private:
     unsigned int texture_id;
     std::string file_path;
-    unsigned char* data;
     int width, height, BPP;
+    bool ready;
+    // 异步加载尚未完成时指向加载器, 析构时据此取消
+    TextureLoader* loader;
+    uint32_t load_id;
+private:
+    void allocate(int width, int height, int channels);
 public:
+    // 空纹理, 在异步加载完成前显示占位图
+    Texture();
     Texture(const std::string& filePath);
-    Texture(int width, int height, const unsigned char* data);
+    Texture(int width, int height, const unsigned char* data, int channels = 3);
     ~Texture();
-    void Bind(unsigned int slot = 0) const;
-    void Unbind() const;
-};
-
-inline void createCheckboardTexture(unsigned char* textureBuffer, int width, int height, int tileSize) {
-    for (int i = 0; i < height; ++i) {
-        for (int j = 0; j < width; ++j) {
-            int cellColor = ((i / tileSize) + (j / tileSize)) % 2 == 0 ? 255 : 0;
-            int index = (i * width + j) * 3; // 每个像素3个通道（R,G,B）
 
-            textureBuffer[index] = cellColor;
-            textureBuffer[index + 1] = cellColor;
-            textureBuffer[index + 2] = cellColor;
-        }
-    }
-}
+    // 从当前绑定的 GL_PIXEL_UNPACK_BUFFER (pixels 为缓冲区内偏移) 或内存上传, 重新创建不可变存储
+    void upload(int width, int height, int channels, const void* pixels);
 
-// 生成柏林噪声
-inline int berlinNoise(int x, int y) {
-    int n = x * 671 + y * 1511;
-    n = (n << 13) ^ n;
-    return (n * (n * n * 15731 + 789221) + 1376312589) & 0x7fffffff;
-}
-
-inline void createBerlinNoiseTexture(unsigned char* textureBuffer, int width, int height, int tileSize) {
-    std::mt19937 rng(std::random_device{}());
-    std::uniform_int_distribution<int> dist(0, 255);
-
-    for (int i = 0; i < height; ++i) {
-        for (int j = 0; j < width; ++j) {
-            int noiseValue = berlinNoise(j / tileSize, i / tileSize) % 256;
-            int index = (i * width + j) * 3; // 每个像素3个通道（R,G,B）
+    void Bind(unsigned int slot = 0) const;
+    void Unbind() const;
 
-            int grayValue = dist(rng) * noiseValue / 255;
+    inline bool isReady() const { return ready; }
+    inline int getWidth() const { return width; }
+    inline int getHeight() const { return height; }
+    inline int getChannels() const { return BPP; }
 
-            textureBuffer[index] = grayValue;
-            textureBuffer[index + 1] = grayValue;
-            textureBuffer[index + 2] = grayValue;
-        }
-    }
-}
\ No newline at end of file
+    static unsigned int internalFormat(int channels);
+    static unsigned int pixelFormat(int channels);
+};
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "texture.hpp"
+#include "thread_pool.hpp"
+
+#define TEXTURE_PBO_COUNT 2
+
+// 在工作线程上解码图像, 主线程通过像素解包缓冲区 (PBO) 上传
+class TextureLoader final {
+public:
+    // pixels 用 malloc 分配 (与 stbi_image_free 相同), 失败时为空
+    struct Image {
+        unsigned char* pixels;
+        int width, height, channels;
+    };
+    // 在工作线程上产生像素
+    using Producer = std::function<Image()>;
+    // 在主线程的 poll 中接收像素, 返回后像素即被释放
+    using Receiver = std::function<void(const Image& image)>;
+private:
+    // 工作线程只持有加载编号, 由 poll 在主线程上查回纹理; 纹理已析构时编号查不到, 像素直接丢弃
+    // 不含字符串等需要堆分配的成员, poll 可以整批拷贝到帧内存
+    struct Decoded {
+        uint32_t id;
+        unsigned char* pixels;
+        int width, height, channels;
+    };
+
+    // texture 与 receive 二选一
+    struct Target {
+        Texture* texture;
+        Receiver receive;
+        std::string path;
+    };
+
+    struct Shared {
+        std::mutex mutex;
+        std::vector<Decoded> done;
+        bool closed = false;        // 加载器已析构, 之后完成的解码自行释放像素
+    };
+
+    ThreadPool& _pool;
+    std::shared_ptr<Shared> _shared;
+    std::unordered_map<uint32_t, Target> _targets;
+    uint32_t _next_id;
+    std::atomic<int> _pending;
+    unsigned int _pbos[TEXTURE_PBO_COUNT];
+    size_t _pbo_sizes[TEXTURE_PBO_COUNT];
+    int _pbo_index;
+private:
+    void upload(Texture* target, Decoded& image);
+    uint32_t submit(Target target, Producer produce);
+public:
+    TextureLoader(ThreadPool& pool);
+    ~TextureLoader();
+
+    // 立即返回显示占位图的纹理, 解码完成后在 poll 中替换为真实内容
+    Texture* load(const std::string& path);
+    // 像素交给 receive 而不是 Texture, 返回请求编号; 用于纹理数组等自行管理显存的使用者
+    uint32_t request(Producer produce, Receiver receive, const std::string& name = "");
+    // 由 Texture 析构或请求方放弃时调用, 之后完成的解码不再上传
+    void cancel(uint32_t id);
+
+    // 在工作线程上解码图像文件
+    static Producer file(const std::string& path);
+
+    // 主线程每帧调用, 最多上传 max_uploads 张解码完成的图像
+    void poll(int max_uploads = 2);
+
+    inline bool idle() const { return _pending.load() == 0; }
+};
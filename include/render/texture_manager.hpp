@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glad/glad.h"
+#include "texture_loader.hpp"
+
+#define TEXTURE_ARRAY_MIN_LAYERS 4
+#define TEXTURE_MIN_DOWNSAMPLE 64
+
+// 将尺寸与格式相同的纹理打包到同一个 GL_TEXTURE_2D_ARRAY 的不同层,
+// 不同材质的物体只需绑定一次数组, 通过层号区分, 从而可以合批绘制
+class TextureManager final {
+private:
+    struct Bucket {
+        unsigned int texture_id;
+        int width, height, channels, levels;
+        int capacity;
+        std::vector<int> owners;    // 层 -> 纹理编号, 空闲为 -1
+        bool mips_dirty;
+    };
+
+    struct Entry {
+        int bucket;
+        int layer;
+        int width, height, channels;
+        size_t bytes;
+        uint64_t last_used;
+        bool resident;
+        bool alive;
+        // 逐出后经 TextureLoader 重新产生像素; 为空的纹理只降采样, 不逐出
+        TextureLoader::Producer source;
+        uint32_t reload;            // 进行中的重新加载请求, 0 表示没有
+    };
+
+    TextureLoader& _loader;
+    std::vector<Bucket> _buckets;
+    std::vector<Entry> _textures;
+    unsigned int _fallback;
+    size_t _budget;
+    size_t _allocated;
+    uint64_t _frame;
+private:
+    int findBucket(int width, int height, int channels);
+    // exact 时只多分配一层, 用于预算紧张时的降采样
+    int allocateLayer(int bucket, int owner, bool exact = false);
+    // shrink 时把数组收缩到已用层数, 空闲层占用的显存立即归还
+    void freeLayer(int bucket, int layer, bool shrink = false);
+    void resize(int bucket, int capacity);
+    void generateMips(Bucket& bucket);
+    void upload(int id, const void* pixels);
+    void restore(int id, const TextureLoader::Image& image);
+    bool canDownsample(int id) const;
+    bool downsample(int id);
+    size_t layerBytes(const Bucket& bucket) const;
+public:
+    TextureManager(TextureLoader& loader, size_t budget = 256 * 1024 * 1024);
+    ~TextureManager();
+
+    // 返回纹理编号, 像素为紧密排列的 8 位通道; source 用于逐出后重新加载
+    int add(const void* pixels, int width, int height, int channels, TextureLoader::Producer source = nullptr);
+    void remove(int id);
+
+    // 绑定纹理所在的数组, 首次采样前才生成 mipmap
+    // 纹理已被逐出时排队重新加载并返回 false, 加载完成前调用方改用 bindFallback
+    bool bind(int id, unsigned int slot = 0);
+    // 绑定 1x1 白色的单层数组, 层号为 0
+    void bindFallback(unsigned int slot = 0);
+    inline int layer(int id) const { return _textures[id].layer; }
+    inline int bucket(int id) const { return _textures[id].bucket; }
+    inline bool isResident(int id) const { return _textures[id].resident; }
+    inline size_t textureBytes(int id) const { return _textures[id].resident ? _textures[id].bytes : 0; }
+
+    void beginFrame();
+    // 超出预算时按最近最少使用的顺序先降采样, 无法再降时逐出
+    void enforceBudget();
+
+    inline void setBudget(size_t bytes) { _budget = bytes; }
+    inline size_t budget() const { return _budget; }
+    inline size_t allocatedBytes() const { return _allocated; }
+    size_t residentBytes() const;
+    inline size_t arrayCount() const { return _buckets.size(); }
+};
@@ -3,7 +3,10 @@
 #include "glad/glad.h"
 
 #include "vertex_buffer.hpp"
-#include <vector>
+#include <array>
+#include <cassert>
+
+#define MAX_VERTEX_ELEMENTS 8
 
 struct VertexBufferElement;
 class VertexBufferLayout;
@@ -35,28 +38,28 @@ struct VertexBufferElement {
     }
 };
 
+// 属性数量固定上限, 布局对象不涉及堆分配
 class VertexBufferLayout {
 private:
-    std::vector<VertexBufferElement> elements;
+    std::array<VertexBufferElement, MAX_VERTEX_ELEMENTS> elements;
+    unsigned int count;
     unsigned int stride;
-public:
-    VertexBufferLayout() : stride(0) {}
-
-    void push_float(unsigned int count) {
-        elements.push_back({ GL_FLOAT, count, GL_FALSE});
-        stride += VertexBufferElement::getSize(GL_FLOAT) * count;
-    }
-
-    void push_unsigned_int(unsigned int count) {
-        elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
-        stride += VertexBufferElement::getSize(GL_UNSIGNED_INT) * count;
+private:
+    // 超出上限的属性被丢弃, 调试构建下直接断言
+    void push(unsigned int type, unsigned int n) {
+        assert(count < MAX_VERTEX_ELEMENTS && "too many vertex attributes");
+        if (count >= MAX_VERTEX_ELEMENTS) return;
+        elements[count++] = { type, n, GL_FALSE };
+        stride += VertexBufferElement::getSize(type) * n;
     }
+public:
+    VertexBufferLayout() : count(0), stride(0) {}
 
-    void push_unsigned_byte(unsigned int count) {
-        elements.push_back({ GL_UNSIGNED_BYTE, count, GL_FALSE });
-        stride += VertexBufferElement::getSize(GL_UNSIGNED_BYTE) * count;
-    }
+    void push_float(unsigned int n) { push(GL_FLOAT, n); }
+    void push_unsigned_int(unsigned int n) { push(GL_UNSIGNED_INT, n); }
+    void push_unsigned_byte(unsigned int n) { push(GL_UNSIGNED_BYTE, n); }
 
-    inline std::vector<VertexBufferElement> getElement() const { return elements; }
+    inline const std::array<VertexBufferElement, MAX_VERTEX_ELEMENTS>& getElement() const { return elements; }
+    inline unsigned int getCount() const { return count; }
     inline unsigned int getStride() const { return stride; }
 };
\ No newline at end of file
@@ -14,23 +14,49 @@
 #include "index_buffer.hpp"
 #include "vertex_buffer.hpp"
 #include "texture.hpp"
+#include "texture_loader.hpp"
+#include "procedural.hpp"
+#include "texture_manager.hpp"
+#include "arena.hpp"
+#include "alloc_stats.hpp"
+#include "async_task.hpp"
 #include "shader.hpp"
 #include "anim.hpp"
 #include "ui.hpp"
 #include "parser.hpp"
 #include "analyzer.hpp"
 #include "scene.hpp"
+#include "code_editor.hpp"
+#include "live_parser.hpp"
+#include "domain_coloring.hpp"
+#include "function_surface.hpp"
+#include "implicit_plot.hpp"
+#include "curve_plot.hpp"
+#include "point_cloud.hpp"
+#include "mesh_export.hpp"
+#include "mesh_cache.hpp"
+#include "axis_grid.hpp"
+#include "big_eval.hpp"
+#include "solver.hpp"
 
 #define UINEXT ImGui::SameLine();
 #define UIDIVIDER ImGui::Separator();
 
 #define DISPLAY_BUFFER_SIZE 1024
-#define EDITOR_BUFFER_SIZE 2048
+#define DATASET_PATH_SIZE 512
+#define EVAL_TIMEOUT_SECONDS 10.0
+#define BIG_EVAL_TIMEOUT_SECONDS 120.0
 
 #define vertexPath "../resources/shader/vertex.glsl"
 #define fragPath "../resources/shader/frag.glsl"
-#define axisVertexPath "../resources/shader/axis_vertex.glsl"
-#define axisFragPath "../resources/shader/axis_frag.glsl"
+#define gridVertexPath "../resources/shader/grid_vertex.glsl"
+#define gridFragPath "../resources/shader/grid_frag.glsl"
+#define domainVertexPath "../resources/shader/domain_vertex.glsl"
+#define domainFragPath "../resources/shader/domain_frag.glsl"
+#define lineVertexPath "../resources/shader/line_vertex.glsl"
+#define lineFragPath "../resources/shader/line_frag.glsl"
+#define pointVertexPath "../resources/shader/point_vertex.glsl"
+#define pointFragPath "../resources/shader/point_frag.glsl"
 #define texPath "../resources/img/image.png"
 #define fontPath1 "../resources/font/JetBrainsMonoNerdFontMono-Regular.ttf"
 #define fontPath2 "../resources/font/JetBrainsMonoNerdFontMono-SemiBold.ttf"
@@ -46,6 +72,7 @@ enum Mode {
 class Renderer {
 private:
     int _precision = 48;
+    int _sphere_precision;
     // 窗口信息
     int _width;
     int _height;
@@ -67,11 +94,30 @@ private:
     std::unordered_map<std::string, VertexBuffer*>  _vbos;
     std::unordered_map<std::string, IndexBuffer*>   _ibos;
     std::unordered_map<std::string, Texture*>       _texs;
+    std::unordered_map<std::string, int>            _tex_ids;
     std::unordered_map<std::string, Shader*>        _shaders;
+    TextureLoader* _tex_loader;
+    ProceduralGenerator* _procedural;
+    TextureManager* _tex_manager;
+    DomainColoring* _domain;        // Complex 模式下在视口中显示 f(z) 的定义域着色
+    const char* _algebra_geo;       // Algebra 模式下绘制的几何体, "Surface" / "Implicit", 为空时绘制球体
+    CurvePlot* _plot;               // Algebra 模式下 y = f(x) 的曲线图
+    bool _plot_view;                // 最近一次编译的是曲线, 视口显示曲线图
+    AxisGrid _grid;                 // Axis mode 下的无限网格与刻度
+    PointCloud* _cloud;             // 从文件加载的散点数据, 加载后在 3D 视图中代替球体与曲面
+    char _dataset_path[DATASET_PATH_SIZE];
+    int _cloud_budget_mb = POINT_GPU_BUDGET_MB;
+    MeshCache* _mesh_cache;         // 曲面网格的磁盘缓存, 以表达式编译后的字节码为键
+    AsyncTask* _export_task;        // 在后台把当前的几何体写成 PLY / OBJ / GLB
+    std::string _export_status;
+    char _export_path[DATASET_PATH_SIZE];
+    int _texture_budget_mb = 256;
+    bool _first_frame;
     float _lightColor[3];
     float _lightPos[3];
 
-    char _editor_buffer[EDITOR_BUFFER_SIZE];
+    CodeEditor* _editor;
+    int _editor_file;
     bool _is_editing;
     ShaderType _current_shader_src;
 
@@ -80,15 +126,23 @@ private:
     float _clear_color;
 
     std::string _display_buffer;
-    core::Parser* _parser;
-    core::Analyzer* _analyzer;
+    AsyncTask* _eval_task;
+    std::string _eval_status;       // 最近一次求值失败, 取消或超时的提示
+    calc::IncrementalParser* _live_parser;     // 随输入增量解析, 用于显示区下方的实时预览
+    bool _big_numbers = false;      // Numeric 模式下使用任意精度求值
+    int _big_digits = 64;           // 任意精度的有效数字位数
 
     bool _axis_mode;
     bool _show_demo;
     bool _modify_presicion;
+    bool _show_stats;
+    uint64_t _frame_allocs;
+    size_t _frame_arena_peak;
 
     friend class UI;
     UI* _ui;
+    friend class Interface;
+    Scene* _scene;                  // 每帧的更新与绘制都交给场景
 
     enum Theme {
         Light =  0,
@@ -105,8 +159,14 @@ private:
         "none",
         vertexPath, 
         fragPath, 
-        axisVertexPath,
-        axisFragPath};
+        gridVertexPath,
+        gridFragPath,
+        domainVertexPath,
+        domainFragPath,
+        lineVertexPath,
+        lineFragPath,
+        pointVertexPath,
+        pointFragPath};
 public:
     Renderer(int w, int h, const char* name);
     ~Renderer();
@@ -123,9 +183,24 @@ public:
     void popDisplay();
     inline std::string getDisplay() const { return _display_buffer; }
     void attachParser();
+    // 在后台线程求值, 完成后于 pollEvaluation 中写回显示区
     void executeParser();
+    void cancelEvaluation();
+    void pollEvaluation();
+    // 复制当前 3D 视图中的几何体, 按 _export_path 的扩展名在后台写出
+    void exportMesh();
+    void pollExport();
 private:
     void processInput(GLFWwindow *window);
+    // Complex 模式下在视口内拖动平移, 滚轮缩放
+    void processDomainInput();
+    // 曲线图中拖动平移, 滚轮缩放
+    void processPlotInput();
+    // 以显示区的表达式作为 f(z) 编译并交给 _domain
+    void compileComplex();
+    // 以显示区的表达式作为 z = f(x, y) 生成曲面网格, 法线来自自动微分
+    // 表达式含有 z 时视为隐式曲面 f(x, y, z) = 0, 由区间八叉树求出体素点; 只含 x 时加入曲线图
+    void compileSurface();
     void toggle_frame_mode();
     void toggle(bool* value);
 };
\ No newline at end of file
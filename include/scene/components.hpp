@@ -0,0 +1,31 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include "entity.hpp"
+
+// 相对于父节点的平移, 旋转与缩放; 修改后须调用 transforms().markDirty, TransformSystem 只重算脏节点及其子树
+// world 与 normal (world 左上 3x3 的逆转置) 由 TransformSystem 写入它自己的稠密数组, 不放在组件中
+struct Transform {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+    Entity parent = ENTITY_NULL;    // 只能经由 Registry::setParent 修改
+};
+
+// 场景网格表中的下标
+struct MeshRef {
+    int mesh = -1;
+    bool visible = true;
+};
+
+struct Material {
+    int texture = -1;               // TextureManager 中的纹理, -1 表示不绑定
+};
+
+// 旋转由动画片段中的一个四元数通道驱动
+struct Animator {
+    int clip = -1;                  // 场景片段表中的下标
+    int channel = -1;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+// 实体 = 低 24 位下标 + 高 8 位版本, 下标被回收复用后旧的句柄不再有效
+typedef uint32_t Entity;
+#define ENTITY_INDEX_BITS 24
+#define ENTITY_INDEX_MASK ((1u << ENTITY_INDEX_BITS) - 1)
+#define ENTITY_NULL 0xffffffffu
+
+inline uint32_t entityIndex(Entity entity) { return entity & ENTITY_INDEX_MASK; }
@@ -1,15 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
 #include "scene.hpp"
-#include "../anim/anim.hpp"
+#include "registry.hpp"
+#include "systems.hpp"
+
+// 球体绕 y 轴自转的角速度 (弧度 / 秒)
+#define SPIN_SPEED 0.5f
+
+class Renderer;
 
+// 视口中的内容: Complex 模式的定义域着色, 曲线图, 点云, 或者由实体组成的 3D 场景
+// 3D 场景中的球体与代数曲面都是实体, 绘制所需的 GL 对象按网格名称在 Renderer 中查找
 class Interface final : public Scene {
+private:
+    struct Mesh {
+        std::string name;           // Renderer::_vaos 等表中的键
+        unsigned int primitive;     // GL_TRIANGLES / GL_POINTS
+    };
+
+    Renderer* _rd;
+    Registry _registry;
+    std::vector<Mesh> _meshes;
+    std::vector<Clip> _clips;
+    TransformSystem _transforms;
+    Entity _sphere;
+    Entity _surface;                // Algebra 模式下的 z = f(x, y) 或 f(x, y, z) = 0
+private:
+    int addMesh(const std::string& name, unsigned int primitive);
+    int findMesh(const std::string& name) const;
+    void renderEntities(const glm::mat4& view);
+    void renderGrid(const glm::mat4& view);
 public:
-    void onUpdate() override {
-        
-    }
-    void onRender() override {
-
-    }
-    void onImGuiRender() override {
-        
-    }
-};
\ No newline at end of file
+    Interface(Renderer* rd);
+    ~Interface();
+
+    void onUpdate(float delta_time) override;
+    void onRender() override;
+    void onImGuiRender() override;
+
+    inline Registry& registry() { return _registry; }
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "components.hpp"
+
+#define POOL_NONE 0xffffffffu
+
+// 稀疏集合: 组件紧密排列在 data 中, 系统顺序遍历连续数组
+// sparse 按实体下标查到稠密下标, 删除时与末尾交换, 增删查都是 O(1)
+// 每个组件另有一个与 data 同序的脏标记字节, 新增或覆盖时置位, 由处理该组件的系统清除
+template<class T>
+class ComponentPool final {
+private:
+    std::vector<uint32_t> _sparse;
+    std::vector<Entity> _dense;
+    std::vector<T> _data;
+    std::vector<uint8_t> _dirty;
+    uint64_t _revision = 0;
+public:
+    T& add(Entity entity, const T& value) {
+        uint32_t index = entityIndex(entity);
+        if (index >= _sparse.size()) _sparse.resize(index + 1, POOL_NONE);
+        if (_sparse[index] != POOL_NONE) {
+            // 已有该组件时覆盖
+            _dense[_sparse[index]] = entity;
+            _dirty[_sparse[index]] = 1;
+            return _data[_sparse[index]] = value;
+        }
+        _sparse[index] = (uint32_t)_dense.size();
+        _dense.push_back(entity);
+        _data.push_back(value);
+        _dirty.push_back(1);
+        _revision++;
+        return _data.back();
+    }
+
+    void remove(Entity entity) {
+        if (!has(entity)) return;
+        uint32_t slot = _sparse[entityIndex(entity)];
+        uint32_t last = (uint32_t)_dense.size() - 1;
+        if (slot != last) {
+            _dense[slot] = _dense[last];
+            _data[slot] = std::move(_data[last]);
+            _dirty[slot] = _dirty[last];
+            _sparse[entityIndex(_dense[slot])] = slot;
+        }
+        _dense.pop_back();
+        _data.pop_back();
+        _dirty.pop_back();
+        _sparse[entityIndex(entity)] = POOL_NONE;
+        _revision++;
+    }
+
+    // 按 order (新位置 -> 旧的稠密下标) 重排稠密数组
+    void reorder(const std::vector<uint32_t>& order) {
+        std::vector<Entity> dense(order.size());
+        std::vector<T> data(order.size());
+        std::vector<uint8_t> dirty(order.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            dense[i] = _dense[order[i]];
+            data[i] = std::move(_data[order[i]]);
+            dirty[i] = _dirty[order[i]];
+            _sparse[entityIndex(dense[i])] = (uint32_t)i;
+        }
+        _dense.swap(dense);
+        _data.swap(data);
+        _dirty.swap(dirty);
+        _revision++;
+    }
+
+    inline bool has(Entity entity) const {
+        uint32_t index = entityIndex(entity);
+        return index < _sparse.size() && _sparse[index] != POOL_NONE && _dense[_sparse[index]] == entity;
+    }
+    // 稠密下标, 不存在时返回 POOL_NONE
+    inline uint32_t indexOf(Entity entity) const { return has(entity) ? _sparse[entityIndex(entity)] : POOL_NONE; }
+    // 不存在时返回 nullptr
+    inline T* find(Entity entity) { return has(entity) ? &_data[_sparse[entityIndex(entity)]] : nullptr; }
+    inline T& get(Entity entity) { return _data[_sparse[entityIndex(entity)]]; }
+    // 修改组件后调用, 不存在时忽略
+    inline void markDirty(Entity entity) {
+        if (has(entity)) _dirty[_sparse[entityIndex(entity)]] = 1;
+    }
+
+    void clear() {
+        _sparse.clear();
+        _dense.clear();
+        _data.clear();
+        _dirty.clear();
+        _revision++;
+    }
+    void reserve(size_t count) {
+        _dense.reserve(count);
+        _data.reserve(count);
+        _dirty.reserve(count);
+    }
+
+    inline size_t size() const { return _dense.size(); }
+    inline T* data() { return _data.data(); }
+    inline const T* data() const { return _data.data(); }
+    inline uint8_t* dirty() { return _dirty.data(); }
+    inline const Entity* entities() const { return _dense.data(); }
+    // 增删, 重排或者结构上的其它改变 (如 Transform 的父节点) 都会使其递增
+    inline uint64_t revision() const { return _revision; }
+    inline void touch() { _revision++; }
+};
+
+// 实体的分配与各组件池
+class Registry final {
+private:
+    std::vector<Entity> _slots;         // 每个下标当前 (或下一个) 实体的句柄
+    std::vector<uint32_t> _free;
+    size_t _alive;
+
+    ComponentPool<Transform> _transforms;
+    ComponentPool<MeshRef> _meshes;
+    ComponentPool<Material> _materials;
+    ComponentPool<Animator> _animators;
+public:
+    Registry();
+
+    Entity create();
+    // 同时删除实体的所有组件
+    void destroy(Entity entity);
+    bool alive(Entity entity) const;
+    void clear();
+
+    // Transform 的父节点只经由这里修改; parent 为 ENTITY_NULL 时成为根节点, 会成环时不做修改
+    void setParent(Entity child, Entity parent);
+
+    inline ComponentPool<Transform>& transforms() { return _transforms; }
+    inline ComponentPool<MeshRef>& meshes() { return _meshes; }
+    inline ComponentPool<Material>& materials() { return _materials; }
+    inline ComponentPool<Animator>& animators() { return _animators; }
+
+    inline size_t size() const { return _alive; }
+};
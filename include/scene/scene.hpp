@@ -1,10 +1,11 @@
-#pragma once 
+#pragma once
 
+// Renderer::run 每帧依次调用 onImGuiRender, onUpdate 与 onRender
 class Scene {
 public:
     Scene();
     virtual ~Scene();
-    virtual void onUpdate() = 0;
+    virtual void onUpdate(float delta_time) = 0;
     virtual void onRender() = 0;
     virtual void onImGuiRender();
-};
\ No newline at end of file
+};
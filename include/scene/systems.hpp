@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "anim.hpp"
+#include "registry.hpp"
+#include "thread_pool.hpp"
+
+// 每个并行任务处理的 Transform 数, 须为 4 的倍数, 同时组合的 4 个节点不会跨任务
+#define SCENE_TRANSFORM_GRAIN 8192
+
+// 播放中的动画片段, 同一片段的所有通道每帧只整批采样一次
+struct Clip {
+    Animation* animation = nullptr;
+    float time = 0.0f;
+    float speed = 1.0f;
+};
+
+// 推进并采样所有片段, 再把各 Animator 的通道写入实体的旋转
+void updateAnimation(Registry& registry, std::vector<Clip>& clips, float delta_time);
+
+// 层级变换: Transform 池按广度优先排列 (父节点总在子节点之前, 同一层连续存放)
+// 逐层处理, 层内按连续的区段并行; 只有自身或祖先为脏的节点才重算 world 与 normal
+// 结果按分量存放在系统自己的稠密数组中 (SoA), 相邻的 4 个节点用 SIMD 一起组合
+// 脏标记在 update 中向子节点传播, 结束时清零; 没有脏节点的层按 16 字节整段跳过
+class TransformSystem final {
+private:
+    uint64_t _revision;             // 上次排序时 Transform 池的 revision
+    std::vector<uint32_t> _levels;  // 各层在稠密数组中的起点, 末尾为节点总数
+    std::vector<uint32_t> _parents; // 父节点的稠密下标, 根节点为节点总数 (分量数组末尾的单位矩阵)
+    size_t _stride;                 // 每个分量数组的长度, 即节点总数加 1
+    std::vector<float> _world;      // world 前三行的 12 个分量数组, 按列排列, 第四行恒为 (0, 0, 0, 1)
+    std::vector<float> _normal;     // normal 的 9 个分量数组, 按列排列
+    size_t _updated;
+private:
+    // 按深度重排 Transform 池, 重建 _levels 与 _parents, 所有节点标记为脏
+    void sort(Registry& registry);
+    // 组合 [first, first + count) 中 mask 置位的节点, count 不超过 4; root 表示这些节点都没有父节点
+    void compose(const Transform* data, size_t first, size_t count, uint32_t mask, bool root);
+public:
+    TransformSystem();
+
+    void update(Registry& registry, ThreadPool& pool);
+
+    // 稠密下标为 index 的 Transform 在上一次 update 后的结果, 池在此之后增删或重排时下标失效
+    glm::mat4 world(size_t index) const;
+    glm::mat3 normal(size_t index) const;
+
+    // 上一次 update 重算的节点数
+    inline size_t updated() const { return _updated; }
+    inline size_t depth() const { return _levels.empty() ? 0 : _levels.size() - 1; }
+};
\ No newline at end of file
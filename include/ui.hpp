@@ -14,7 +14,10 @@ public:
     void imguiLayout();
     void imguiMainTabBar();
     void imguiOperationPanel();    
+    void imguiLivePreview();
+    void imguiEvaluationStatus();
     void imguiGLSLEditor();
+    void imguiStats();
     void initEditor();
 
 };
\ No newline at end of file
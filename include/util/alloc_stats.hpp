@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+// 统计经由全局 operator new 的分配次数与字节数 (替换了全局 operator new)
+namespace AllocStats {
+    uint64_t allocationCount();
+    uint64_t allocatedBytes();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#define ARENA_DEFAULT_BLOCK (256 * 1024)
+
+// 线性 (bump) 分配器, 只能整体重置; 重置时将多个块合并为一个, 稳定状态下不再向全局堆申请内存
+class LinearArena final {
+private:
+    struct Block {
+        unsigned char* data;
+        size_t size;
+    };
+
+    std::vector<Block> _blocks;
+    size_t _block_size;
+    size_t _offset;
+    size_t _used;
+    size_t _peak;
+private:
+    void addBlock(size_t min_size);
+public:
+    LinearArena(size_t block_size = ARENA_DEFAULT_BLOCK);
+    ~LinearArena();
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+    void reset();
+
+    template <typename T>
+    inline T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    struct Marker {
+        size_t block;
+        size_t offset;
+        size_t used;
+    };
+
+    // 记录与回滚位置, 回滚时释放记录之后新增的块
+    inline Marker mark() const { return {_blocks.empty() ? 0 : _blocks.size() - 1, _offset, _used}; }
+    void rewind(Marker marker);
+
+    inline size_t used() const { return _used; }
+    // 自创建以来的最高占用 (高水位), reset 与 rewind 不清零
+    inline size_t peak() const { return _peak; }
+    size_t capacity() const;
+};
+
+// 将 LinearArena 适配为 std::pmr 内存资源, deallocate 为空操作
+class ArenaResource final : public std::pmr::memory_resource {
+private:
+    LinearArena& _arena;
+protected:
+    void* do_allocate(size_t bytes, size_t align) override { return _arena.allocate(bytes, align); }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+public:
+    ArenaResource(LinearArena& arena) : _arena(arena) {}
+    inline LinearArena& arena() { return _arena; }
+};
+
+// 主线程每帧使用的临时内存, 在帧末 reset
+LinearArena& frameArena();
+std::pmr::memory_resource* frameResource();
+
+// 每个线程独立的临时内存, 通过 ScratchScope 在作用域结束时回滚
+LinearArena& scratchArena();
+std::pmr::memory_resource* scratchResource();
+
+class ScratchScope final {
+private:
+    LinearArena& _arena;
+    LinearArena::Marker _marker;
+public:
+    ScratchScope() : _arena(scratchArena()), _marker(_arena.mark()) {}
+    ~ScratchScope() { _arena.rewind(_marker); }
+    inline std::pmr::memory_resource* resource() { return scratchResource(); }
+
+    template <typename T>
+    inline T* allocateArray(size_t count) { return _arena.allocateArray<T>(count); }
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+enum class TaskState {
+    Idle,
+    Running,
+    Done,
+    Failed,
+    Cancelled,
+    TimedOut,
+};
+
+// 任务函数通过它轮询取消与超时, 并上报进度
+class TaskContext final {
+private:
+    std::atomic<bool> _cancel;
+    std::atomic<float> _progress;
+    std::chrono::steady_clock::time_point _deadline;
+
+    friend class AsyncTask;
+public:
+    TaskContext();
+
+    inline bool cancelRequested() const { return _cancel.load(std::memory_order_relaxed); }
+    inline bool expired() const { return std::chrono::steady_clock::now() >= _deadline; }
+    inline bool shouldStop() const { return cancelRequested() || expired(); }
+
+    // [0, 1], 小于 0 表示进度未知
+    inline void setProgress(float progress) { _progress.store(progress, std::memory_order_relaxed); }
+    inline float progress() const { return _progress.load(std::memory_order_relaxed); }
+};
+
+// 在独立线程上运行的可取消任务, 结果在渲染线程通过 poll 取回
+// 不放进 ThreadPool: 无法中断的计算 (如外部解析库) 会一直占着工作线程, 拖慢纹理解码
+// 取消或超时后立即返回给界面并 detach 该线程, 它结束后自行丢弃结果, 共享状态由线程持有的 shared_ptr 保活
+// 析构时通知当前任务取消, 最多等待 ASYNC_TASK_SHUTDOWN_MS, 仍未结束 (如卡在无法中断的计算中) 则 detach, 不阻塞退出
+#define ASYNC_TASK_SHUTDOWN_MS 200
+
+class AsyncTask final {
+public:
+    // 返回结果字符串; 失败时写入 error 并返回空串
+    using Function = std::function<std::string(TaskContext& context, std::string& error)>;
+private:
+    struct Shared {
+        TaskContext context;
+        std::mutex mutex;
+        std::condition_variable done;
+        bool finished = false;
+        std::string result;
+        std::string error;
+    };
+
+    std::shared_ptr<Shared> _shared;
+    std::thread _thread;                // 当前任务, 被放弃的任务不再持有
+    TaskState _state;
+    std::chrono::steady_clock::time_point _start;
+private:
+    // 通知取消并 detach 当前线程
+    void abandon();
+public:
+    AsyncTask();
+    ~AsyncTask();
+
+    AsyncTask(const AsyncTask&) = delete;
+    AsyncTask& operator=(const AsyncTask&) = delete;
+
+    // 已有任务在运行时返回 false
+    bool start(Function fn, double timeout_seconds);
+    void cancel();
+
+    // 每帧调用, 状态从 Running 变为结束状态的那一帧返回 true
+    bool poll();
+
+    inline TaskState state() const { return _state; }
+    inline bool running() const { return _state == TaskState::Running; }
+    float progress() const;
+    double elapsed() const;
+
+    // 仅在 poll 返回 true 之后有效
+    std::string result() const;
+    std::string error() const;
+};
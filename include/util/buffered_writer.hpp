@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define BUFFERED_WRITER_CAPACITY (1 << 20)
+
+// 攒满缓冲区后一次 fwrite, 大块数据绕过缓冲区直接写出
+class BufferedWriter final {
+private:
+    FILE* _file;
+    std::vector<char> _buffer;
+    size_t _used;
+    bool _failed;
+public:
+    BufferedWriter(FILE* file, size_t capacity = BUFFERED_WRITER_CAPACITY);
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    void write(const char* data, size_t size);
+    inline void write(const std::string& text) { write(text.data(), text.size()); }
+    inline void put(char c) {
+        if (_used == _buffer.size()) flush();
+        _buffer[_used++] = c;
+    }
+    // 在缓冲区中预留 size 字节 (不超过容量) 供调用者直接格式化, 再以 commit 提交实际写入的字节数
+    inline char* reserve(size_t size) {
+        if (_used + size > _buffer.size()) flush();
+        return _buffer.data() + _used;
+    }
+    inline void commit(size_t size) { _used += size; }
+    // 返回此前所有写入是否成功
+    bool flush();
+
+    inline bool failed() const { return _failed; }
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// 只读内存映射文件, 空文件映射成功但 data() 为空
+// 也可以创建可写的临时文件, 用作超出内存的数据的溢出区, 由操作系统按需换入换出
+class MappedFile final {
+private:
+    const char* _data;
+    size_t _size;
+    bool _open;                 // 空文件没有映射, 不能用 _data 判断
+    bool _writable;
+#if defined(_WIN32)
+    void* _file;
+    void* _mapping;
+#endif
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 失败时返回 false, 之前映射的文件会被关闭
+    bool open(const std::string& path);
+    // 创建 size 字节的临时文件并以读写方式映射, 映射关闭 (包括进程退出) 后文件自动删除
+    bool createTemporary(const std::string& path, size_t size);
+    void close();
+
+    inline const char* data() const { return _data; }
+    // 仅 createTemporary 打开的映射可写, 否则返回 nullptr
+    inline char* writableData() const { return _writable ? const_cast<char*>(_data) : nullptr; }
+    inline size_t size() const { return _size; }
+    inline bool isOpen() const { return _open; }
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool final {
+private:
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _jobs;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _stop;
+private:
+    void workerLoop();
+public:
+    // count 为负时使用 hardware_concurrency - 1 (至少 1 个)
+    // 为 0 时不创建工作线程: parallelFor 整段在调用线程上执行, submit 就地执行任务
+    ThreadPool(int count = -1);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job);
+
+    // 将 [0, count) 按 grain 切块并行执行, 调用线程也参与, 阻塞直到全部完成
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& fn);
+
+    inline size_t size() const { return _workers.size(); }
+
+    static ThreadPool& global();
+};
@@ -0,0 +1,12 @@
+#version 460 core
+
+in vec2 TexCoord;
+
+out vec4 FragColor;
+
+uniform sampler2D samp;
+
+void main(void)
+{
+    FragColor = vec4(texture(samp, TexCoord).rgb, 1.0);
+}
@@ -0,0 +1,11 @@
+#version 460 core
+
+out vec2 TexCoord;
+
+void main(void)
+{
+    // 不需要顶点缓冲, 三个顶点组成覆盖整个视口的三角形
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TexCoord = pos;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
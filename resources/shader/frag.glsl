@@ -3,16 +3,17 @@
 in vec2 TexCoord;
 in vec3 Normal;
 in vec3 FragPos;
+flat in float Layer;
 
 out vec4 FragColor;
 
-uniform sampler2D samp;
+uniform sampler2DArray samp;
 uniform vec3 lightColor;
 uniform vec3 lightPos;
 uniform vec3 viewPos;
 
 void main(void) {
-    vec4 texColor = texture(samp, TexCoord);
+    vec4 texColor = texture(samp, vec3(TexCoord, Layer));
     float ambientStrength = 0.2;
     vec3 ambeint = ambientStrength * lightColor;
 
@@ -0,0 +1,80 @@
+#version 460 core
+
+in vec2 NDC;
+
+out vec4 FragColor;
+
+uniform mat4 view_proj;
+uniform mat4 inv_view_proj;
+uniform vec3 camera_pos;
+uniform float major;            // 主网格间距
+uniform float minor;            // 次网格间距
+uniform float pixel_angle;      // 单个像素对应的视角 (弧度)
+
+// 到最近网格线的距离 (像素) 换算为覆盖率, 网格单元小于数个像素时淡出, 避免摩尔纹
+float gridLine(vec2 coord, float spacing)
+{
+    vec2 g = coord / spacing;
+    vec2 d = fwidth(g);
+    vec2 l = abs(fract(g - 0.5) - 0.5) / max(d, vec2(1e-6));
+    float line = 1.0 - min(min(l.x, l.y), 1.0);
+    return line * (1.0 - smoothstep(0.15, 0.35, max(d.x, d.y)));
+}
+
+float axisLine(float coord)
+{
+    float d = fwidth(coord);
+    return 1.0 - min(abs(coord) / max(1.5 * d, 1e-6), 1.0);
+}
+
+float clipDepth(vec3 p)
+{
+    vec4 clip = view_proj * vec4(p, 1.0);
+    return clip.z / clip.w * 0.5 + 0.5;
+}
+
+void main(void)
+{
+    vec4 near = inv_view_proj * vec4(NDC, -1.0, 1.0);
+    vec4 far = inv_view_proj * vec4(NDC, 1.0, 1.0);
+    vec3 origin = near.xyz / near.w;
+    vec3 dir = far.xyz / far.w - origin;
+
+    vec4 color = vec4(0.0);
+    float depth = 1.0;
+
+    // y = 0 平面上的网格, 求导在分支之外进行
+    float t = -origin.y / dir.y;
+    vec3 p = origin + t * dir;
+    float minor_line = gridLine(p.xz, minor);
+    float major_line = gridLine(p.xz, major);
+    float axis_x = axisLine(p.z);
+    float axis_y = axisLine(p.x);
+    if (t > 0.0) {
+        float fade = 1.0 - smoothstep(40.0, 80.0, length(p - camera_pos) / major);
+        color = vec4(vec3(0.5), 0.25 * minor_line);
+        color = mix(color, vec4(vec3(0.6), 0.6), major_line);
+        color = mix(color, vec4(0.9, 0.35, 0.35, 1.0), axis_x);
+        color = mix(color, vec4(0.35, 0.8, 0.35, 1.0), axis_y);
+        color.a *= fade;
+        depth = clipDepth(p);
+    }
+
+    // 竖直的 z 轴: 视线与 y 轴的最近点距离小于一个像素时着色
+    vec2 o = origin.xz, d = dir.xz;
+    float s = -dot(o, d) / max(dot(d, d), 1e-12);
+    if (s > 0.0) {
+        vec3 q = origin + s * dir;
+        float width = s * length(dir) * pixel_angle;
+        float coverage = 1.0 - min(length(q.xz) / (1.5 * width), 1.0);
+        float z_depth = clipDepth(q);
+        if (coverage > 0.0 && (z_depth < depth || color.a < 0.01)) {
+            color = vec4(0.35, 0.55, 0.95, coverage);
+            depth = z_depth;
+        }
+    }
+
+    if (color.a < 0.01) discard;
+    FragColor = color;
+    gl_FragDepth = depth;
+}
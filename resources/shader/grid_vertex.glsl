@@ -0,0 +1,11 @@
+#version 460 core
+
+out vec2 NDC;
+
+void main(void)
+{
+    // 与定义域着色相同, 三个顶点组成覆盖整个视口的三角形
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    NDC = pos;
+    gl_Position = vec4(pos, 0.0, 1.0);
+}
@@ -0,0 +1,10 @@
+#version 460 core
+
+in vec4 Color;
+
+out vec4 FragColor;
+
+void main(void)
+{
+    FragColor = Color;
+}
@@ -0,0 +1,54 @@
+#version 460 core
+
+struct LinePoint {
+    vec2 position;
+    uint color;
+    float width;
+};
+
+layout(std430, binding = 0) readonly buffer Points {
+    LinePoint points[];
+};
+
+uniform mat4 view_proj;
+uniform vec2 viewport;
+
+out vec4 Color;
+
+// 每条线段两个三角形, 依次为 (端点, 法向一侧)
+const int corner_end[6] = int[6](0, 1, 1, 0, 1, 0);
+const float corner_side[6] = float[6](-1.0, -1.0, 1.0, -1.0, 1.0, 1.0);
+
+void main(void)
+{
+    int segment = gl_VertexID / 6;
+    int corner = gl_VertexID % 6;
+    LinePoint a = points[segment];
+    LinePoint b = points[segment + 1];
+
+    // 断点两侧的线段退化到裁剪空间之外
+    if (isnan(a.position.y) || isnan(b.position.y)) {
+        Color = vec4(0.0);
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    vec4 clip_a = view_proj * vec4(a.position, 0.0, 1.0);
+    vec4 clip_b = view_proj * vec4(b.position, 0.0, 1.0);
+    vec2 screen_a = clip_a.xy / clip_a.w * 0.5 * viewport;
+    vec2 screen_b = clip_b.xy / clip_b.w * 0.5 * viewport;
+
+    vec2 dir = screen_b - screen_a;
+    float len = length(dir);
+    dir = len > 1e-6 ? dir / len : vec2(1.0, 0.0);
+    vec2 normal = vec2(-dir.y, dir.x);
+
+    // 沿线段方向各延长半个线宽, 相邻线段在拐角处相互覆盖, 不留缺口
+    int end = corner_end[corner];
+    float half_width = 0.5 * a.width;
+    vec2 pos = end == 0 ? screen_a - dir * half_width : screen_b + dir * half_width;
+    pos += normal * corner_side[corner] * half_width;
+
+    Color = unpackUnorm4x8(a.color);
+    gl_Position = vec4(pos / (0.5 * viewport), 0.0, 1.0);
+}
@@ -0,0 +1,24 @@
+#version 460 core
+
+layout(location = 0) in vec3 position;
+
+uniform mat4 mvp;
+uniform vec2 height_range;      // 局部坐标中点的最低与最高高度
+
+out vec3 Color;
+
+// 按高度从深蓝经青绿渐变到黄色
+vec3 heightColor(float t)
+{
+    vec3 low = vec3(0.15, 0.2, 0.6);
+    vec3 mid = vec3(0.1, 0.7, 0.6);
+    vec3 high = vec3(0.95, 0.85, 0.25);
+    return t < 0.5 ? mix(low, mid, t * 2.0) : mix(mid, high, t * 2.0 - 1.0);
+}
+
+void main(void)
+{
+    gl_Position = mvp * vec4(position, 1.0);
+    float t = (position.y - height_range.x) / max(height_range.y - height_range.x, 1e-6);
+    Color = heightColor(clamp(t, 0.0, 1.0));
+}
@@ -3,19 +3,24 @@
 layout (location = 0) in vec3 aLocation;
 layout (location = 1) in vec2 aTexCoord;
 layout (location = 2) in vec3 aNormal;
+layout (location = 3) in float aLayer;
 
 out vec2 TexCoord;
 out vec3 Normal;
 out vec3 FragPos;
+flat out float Layer;
 
 uniform mat4 model_matrix;
 uniform mat4 proj_matrix;
 uniform mat4 view_matrix;
+// model_matrix 左上 3x3 的逆转置, 在 CPU 上随变换一起算好
+uniform mat3 normal_matrix;
 
 void main(void)
 {
     gl_Position = proj_matrix * view_matrix * model_matrix * vec4(aLocation, 1.0);
     FragPos = (model_matrix * vec4(aLocation, 1.0)).xyz;
     TexCoord = aTexCoord;
-    Normal = mat3(transpose(inverse(model_matrix))) * aNormal;
+    Layer = aLayer;
+    Normal = normal_matrix * aNormal;
 }
@@ -1,2 +1,269 @@
 #include "anim.hpp"
 
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ANIM_SSE2
+#endif
+
+namespace {
+
+    // 线性插值: out = a + (b - a) * t
+    void lerpBatch(const float* a, const float* b, const float* t, float* out, size_t n) {
+        size_t i = 0;
+#ifdef ANIM_SSE2
+        for (; i + 4 <= n; i += 4) {
+            __m128 va = _mm_loadu_ps(a + i);
+            __m128 vb = _mm_loadu_ps(b + i);
+            __m128 vt = _mm_loadu_ps(t + i);
+            _mm_storeu_ps(out + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), vt)));
+        }
+#endif
+        for (; i < n; i++) out[i] = a[i] + (b[i] - a[i]) * t[i];
+    }
+
+    // 球面插值的多项式近似 (Eberly, "A Fast and Accurate Algorithm for Computing SLERP")
+    // 只用乘加, 不需要 acos / sin; 单精度下与精确值的误差在 1e-4 以内
+    const float SLERP_MU = 1.85298109240830f;
+    const float SLERP_U[8] = {
+        1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9),
+        1.0f / (5 * 11), 1.0f / (6 * 13), 1.0f / (7 * 15), SLERP_MU / (8 * 17),
+    };
+    const float SLERP_V[8] = {
+        1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9,
+        5.0f / 11, 6.0f / 13, 7.0f / 15, SLERP_MU * 8 / 17,
+    };
+
+    // 返回两端的权重, x 为两个四元数的点积 (已取非负)
+    inline void slerpWeights(float x, float t, float& wa, float& wb) {
+        float xm1 = x - 1.0f, d = 1.0f - t, t2 = t * t, d2 = d * d;
+        float ca = 1.0f, cb = 1.0f;
+        for (int i = 7; i >= 0; i--) {
+            ca = 1.0f + (SLERP_U[i] * d2 - SLERP_V[i]) * xm1 * ca;
+            cb = 1.0f + (SLERP_U[i] * t2 - SLERP_V[i]) * xm1 * cb;
+        }
+        wa = d * ca;
+        wb = t * cb;
+    }
+
+    // a, b, out 各为 x, y, z, w 四个分量数组; 点积为负时翻转 b, 走较短的弧
+    void slerpBatch(const std::vector<float>* a, const std::vector<float>* b, const float* t,
+                    std::vector<float>* out, size_t offset, size_t n) {
+        const float *ax = a[0].data(), *ay = a[1].data(), *az = a[2].data(), *aw = a[3].data();
+        const float *bx = b[0].data(), *by = b[1].data(), *bz = b[2].data(), *bw = b[3].data();
+        float *ox = out[0].data() + offset, *oy = out[1].data() + offset;
+        float *oz = out[2].data() + offset, *ow = out[3].data() + offset;
+        size_t i = 0;
+#ifdef ANIM_SSE2
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (; i + 4 <= n; i += 4) {
+            __m128 qax = _mm_loadu_ps(ax + i), qay = _mm_loadu_ps(ay + i);
+            __m128 qaz = _mm_loadu_ps(az + i), qaw = _mm_loadu_ps(aw + i);
+            __m128 qbx = _mm_loadu_ps(bx + i), qby = _mm_loadu_ps(by + i);
+            __m128 qbz = _mm_loadu_ps(bz + i), qbw = _mm_loadu_ps(bw + i);
+            __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qax, qbx), _mm_mul_ps(qay, qby)),
+                                    _mm_add_ps(_mm_mul_ps(qaz, qbz), _mm_mul_ps(qaw, qbw)));
+            __m128 flip = _mm_and_ps(dot, sign);
+            __m128 x = _mm_xor_ps(dot, flip);
+
+            __m128 vt = _mm_loadu_ps(t + i);
+            __m128 xm1 = _mm_sub_ps(x, one);
+            __m128 d = _mm_sub_ps(one, vt);
+            __m128 t2 = _mm_mul_ps(vt, vt), d2 = _mm_mul_ps(d, d);
+            __m128 ca = one, cb = one;
+            for (int k = 7; k >= 0; k--) {
+                __m128 u = _mm_set1_ps(SLERP_U[k]), v = _mm_set1_ps(SLERP_V[k]);
+                ca = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, d2), v), xm1), ca));
+                cb = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, t2), v), xm1), cb));
+            }
+            __m128 wa = _mm_mul_ps(d, ca);
+            __m128 wb = _mm_xor_ps(_mm_mul_ps(vt, cb), flip);
+            _mm_storeu_ps(ox + i, _mm_add_ps(_mm_mul_ps(qax, wa), _mm_mul_ps(qbx, wb)));
+            _mm_storeu_ps(oy + i, _mm_add_ps(_mm_mul_ps(qay, wa), _mm_mul_ps(qby, wb)));
+            _mm_storeu_ps(oz + i, _mm_add_ps(_mm_mul_ps(qaz, wa), _mm_mul_ps(qbz, wb)));
+            _mm_storeu_ps(ow + i, _mm_add_ps(_mm_mul_ps(qaw, wa), _mm_mul_ps(qbw, wb)));
+        }
+#endif
+        for (; i < n; i++) {
+            float dot = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i] + aw[i] * bw[i];
+            float wa, wb;
+            slerpWeights(std::fabs(dot), t[i], wa, wb);
+            if (dot < 0.0f) wb = -wb;
+            ox[i] = ax[i] * wa + bx[i] * wb;
+            oy[i] = ay[i] * wa + by[i] * wb;
+            oz[i] = az[i] * wa + bz[i] * wb;
+            ow[i] = aw[i] * wa + bw[i] * wb;
+        }
+    }
+
+}
+
+float ease(Easing easing, float t) {
+    switch (easing) {
+        case Easing::Linear: return t;
+        case Easing::Step: return 0.0f;
+        case Easing::SmoothStep: return t * t * (3.0f - 2.0f * t);
+        case Easing::EaseIn: return t * t * t;
+        case Easing::EaseOut: {
+            float u = 1.0f - t;
+            return 1.0f - u * u * u;
+        }
+        case Easing::EaseInOut: {
+            if (t < 0.5f) return 4.0f * t * t * t;
+            float u = 2.0f - 2.0f * t;
+            return 1.0f - 0.5f * u * u * u;
+        }
+    }
+    return t;
+}
+
+TrackSet::TrackSet(TrackType type)
+    : _type(type), _duration(0.0f)
+{
+    _components = type == TrackType::Float ? 1 : type == TrackType::Vec3 ? 3 : 4;
+    for (int c = 0; c < _components; c++) {
+        _from[c].resize(ANIM_BATCH);
+        _to[c].resize(ANIM_BATCH);
+    }
+    _t.resize(ANIM_BATCH);
+}
+
+int TrackSet::addChannel(const float* times, const float* values, size_t count, const Easing* easing) {
+    if (count == 0) return -1;
+    _first.push_back((uint32_t)_times.size());
+    _count.push_back((uint32_t)count);
+    _cursor.push_back(0);
+    _times.insert(_times.end(), times, times + count);
+    for (size_t k = 0; k < count; k++) {
+        for (int c = 0; c < _components; c++) _values[c].push_back(values[k * _components + c]);
+        _easing.push_back(easing ? easing[k] : Easing::Linear);
+    }
+    for (int c = 0; c < _components; c++) _output[c].push_back(values[c]);
+    _duration = std::max(_duration, times[count - 1]);
+    return (int)_first.size() - 1;
+}
+
+void TrackSet::clear() {
+    _times.clear();
+    _easing.clear();
+    _first.clear();
+    _count.clear();
+    _cursor.clear();
+    for (int c = 0; c < _components; c++) {
+        _values[c].clear();
+        _output[c].clear();
+    }
+    _duration = 0.0f;
+}
+
+void TrackSet::rewind() {
+    std::fill(_cursor.begin(), _cursor.end(), 0);
+}
+
+void TrackSet::locate(size_t channel, float time, uint32_t& from, uint32_t& to, float& t) {
+    uint32_t first = _first[channel], count = _count[channel];
+    const float* times = _times.data() + first;
+    t = 0.0f;
+    if (count == 1 || time <= times[0]) {
+        from = to = first;
+        return;
+    }
+    if (time >= times[count - 1]) {
+        from = to = first + count - 1;
+        _cursor[channel] = count - 2;
+        return;
+    }
+
+    // 段 k 覆盖 [times[k], times[k + 1]), 顺序播放时通常仍在原段或下一段
+    uint32_t k = _cursor[channel];
+    if (time < times[k]) {
+        k = (uint32_t)(std::upper_bound(times, times + count, time) - times) - 1;
+    } else {
+        int steps = 0;
+        while (time >= times[k + 1]) {
+            if (++steps > ANIM_CURSOR_STEPS) {
+                k = (uint32_t)(std::upper_bound(times + k, times + count, time) - times) - 1;
+                break;
+            }
+            k++;
+        }
+    }
+    _cursor[channel] = k;
+    from = first + k;
+    to = from + 1;
+    t = ease(_easing[from], (time - times[k]) / (times[k + 1] - times[k]));
+}
+
+void TrackSet::sample(float time) {
+    size_t channels = _first.size();
+    for (size_t base = 0; base < channels; base += ANIM_BATCH) {
+        size_t n = std::min<size_t>(ANIM_BATCH, channels - base);
+        // 定位与收集是逐通道的标量代码, 之后的插值在连续数组上整批进行
+        for (size_t i = 0; i < n; i++) {
+            uint32_t from, to;
+            locate(base + i, time, from, to, _t[i]);
+            for (int c = 0; c < _components; c++) {
+                _from[c][i] = _values[c][from];
+                _to[c][i] = _values[c][to];
+            }
+        }
+        if (_type == TrackType::Quat) {
+            slerpBatch(_from, _to, _t.data(), _output, base, n);
+        } else {
+            for (int c = 0; c < _components; c++) {
+                lerpBatch(_from[c].data(), _to[c].data(), _t.data(), _output[c].data() + base, n);
+            }
+        }
+    }
+}
+
+Animation::Animation(bool loop)
+    : _duration(0.0f), _loop(loop),
+      _floats(TrackType::Float), _vec3s(TrackType::Vec3), _quats(TrackType::Quat)
+{
+}
+
+int Animation::addFloat(const float* times, const float* values, size_t count, const Easing* easing) {
+    int channel = _floats.addChannel(times, values, count, easing);
+    _duration = std::max(_duration, _floats.duration());
+    return channel;
+}
+
+int Animation::addVec3(const float* times, const glm::vec3* values, size_t count, const Easing* easing) {
+    std::vector<float> flat(count * 3);
+    for (size_t k = 0; k < count; k++) {
+        flat[k * 3 + 0] = values[k].x;
+        flat[k * 3 + 1] = values[k].y;
+        flat[k * 3 + 2] = values[k].z;
+    }
+    int channel = _vec3s.addChannel(times, flat.data(), count, easing);
+    _duration = std::max(_duration, _vec3s.duration());
+    return channel;
+}
+
+int Animation::addQuat(const float* times, const glm::quat* values, size_t count, const Easing* easing) {
+    std::vector<float> flat(count * 4);
+    for (size_t k = 0; k < count; k++) {
+        glm::quat q = glm::normalize(values[k]);
+        flat[k * 4 + 0] = q.x;
+        flat[k * 4 + 1] = q.y;
+        flat[k * 4 + 2] = q.z;
+        flat[k * 4 + 3] = q.w;
+    }
+    int channel = _quats.addChannel(times, flat.data(), count, easing);
+    _duration = std::max(_duration, _quats.duration());
+    return channel;
+}
+
+void Animation::sample(float time) {
+    if (_loop && _duration > 0.0f) {
+        time = std::fmod(time, _duration);
+        if (time < 0.0f) time += _duration;
+    }
+    _floats.sample(time);
+    _vec3s.sample(time);
+    _quats.sample(time);
+}
\ No newline at end of file
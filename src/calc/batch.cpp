@@ -0,0 +1,134 @@
+#include "batch.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace calc {
+
+    // 分别在 batch_sse2.cpp / batch_avx2.cpp / batch_avx512.cpp 中定义, 未以对应指令集编译时返回空
+    const BatchKernels* batchKernelsSse2();
+    const BatchKernels* batchKernelsAvx2();
+    const BatchKernels* batchKernelsAvx512();
+
+    static const BatchKernels* scalarKernels() {
+        static const BatchKernels kernels = {BatchIsa::Scalar, {}, {}};
+        return &kernels;
+    }
+
+    BatchIsa detectBatchIsa() {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return BatchIsa::AVX512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return BatchIsa::AVX2;
+        return BatchIsa::SSE2;
+#elif defined(_MSC_VER) && defined(_M_X64)
+        int info[4];
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool fma = (info[2] & (1 << 12)) != 0;
+        unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+        __cpuidex(info, 7, 0);
+        bool avx2 = (info[1] & (1 << 5)) != 0;
+        bool avx512f = (info[1] & (1 << 16)) != 0;
+        // 操作系统需要保存 YMM / ZMM 状态
+        if (avx512f && (xcr0 & 0xe6) == 0xe6) return BatchIsa::AVX512;
+        if (avx2 && fma && (xcr0 & 0x6) == 0x6) return BatchIsa::AVX2;
+        return BatchIsa::SSE2;
+#else
+        return BatchIsa::Scalar;
+#endif
+    }
+
+    const char* batchIsaName(BatchIsa isa) {
+        switch (isa) {
+            case BatchIsa::Scalar: return "scalar";
+            case BatchIsa::SSE2:   return "SSE2";
+            case BatchIsa::AVX2:   return "AVX2";
+            case BatchIsa::AVX512: return "AVX-512";
+        }
+        return "?";
+    }
+
+    const BatchKernels* batchKernels(BatchIsa isa) {
+        const BatchKernels* kernels = nullptr;
+        isa = std::min(isa, detectBatchIsa());
+        if (isa >= BatchIsa::AVX512) kernels = batchKernelsAvx512();
+        if (!kernels && isa >= BatchIsa::AVX2) kernels = batchKernelsAvx2();
+        if (!kernels && isa >= BatchIsa::SSE2) kernels = batchKernelsSse2();
+        if (!kernels) kernels = scalarKernels();
+        return kernels;
+    }
+
+    BatchEvaluator::BatchEvaluator(BatchIsa isa)
+        : _program(nullptr), _kernels(batchKernels(isa)), _zeros(BATCH_BLOCK, 0.0)
+    {
+    }
+
+    void BatchEvaluator::load(const Program& program) {
+        _program = &program;
+        size_t temp_count = program.register_count - program.tempBase();
+        _scratch.assign(std::max<size_t>(temp_count + program.constants.size(), 1) * BATCH_BLOCK, 0.0);
+        _registers.assign(program.register_count, _zeros.data());
+
+        // 常量展开成整块放在临时寄存器之后, 内核不需要区分标量与数组
+        double* constants = _scratch.data() + temp_count * BATCH_BLOCK;
+        for (size_t i = 0; i < program.constants.size(); i++) {
+            double* block = constants + i * BATCH_BLOCK;
+            std::fill(block, block + BATCH_BLOCK, program.constants[i]);
+            _registers[program.constantBase() + i] = block;
+        }
+        for (size_t reg = program.tempBase(); reg < program.register_count; reg++) {
+            _registers[reg] = temp((uint16_t)reg);
+        }
+    }
+
+    void BatchEvaluator::evaluate(const double* const* vars, double* out, size_t count) {
+        const Program& program = *_program;
+        size_t var_count = program.variables.size();
+        for (size_t base = 0; base < count; base += BATCH_BLOCK) {
+            size_t n = std::min<size_t>(BATCH_BLOCK, count - base);
+            for (size_t v = 0; v < var_count; v++) {
+                _registers[v] = vars[v] ? vars[v] + base : _zeros.data();
+            }
+
+            for (const Instr& in : program.code) {
+                const double* a = _registers[in.a];
+                double* dst = temp(in.dst);
+                if (isUnary(in.op)) {
+                    UnaryKernel kernel = _kernels->unary[(int)in.op];
+                    if (kernel) {
+                        kernel(a, dst, n);
+                    } else {
+                        for (size_t i = 0; i < n; i++) dst[i] = applyUnary(in.op, a[i]);
+                    }
+                } else {
+                    const double* b = _registers[in.b];
+                    BinaryKernel kernel = _kernels->binary[(int)in.op];
+                    if (kernel) {
+                        kernel(a, b, dst, n);
+                    } else {
+                        for (size_t i = 0; i < n; i++) dst[i] = applyBinary(in.op, a[i], b[i]);
+                    }
+                }
+            }
+            memcpy(out + base, _registers[program.result], n * sizeof(double));
+        }
+    }
+
+    void BatchEvaluator::evaluate(const double* x, const double* y, const double* z, double* out, size_t count) {
+        const double* xyz[3] = {x, y, z};
+        size_t var_count = _program->variables.size();
+        if (var_count <= 3) {
+            evaluate(xyz, out, count);
+            return;
+        }
+        std::vector<const double*> vars(var_count, nullptr);
+        std::copy(xyz, xyz + 3, vars.begin());
+        evaluate(vars.data(), out, count);
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "batch.hpp"
+
+// 本文件单独以 -mavx2 -mfma 编译, 只有在 detectBatchIsa 确认支持后才会被调用
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+
+#include <immintrin.h>
+
+typedef __m256d V;
+typedef __m256d M;
+#define LANES 4
+#define BATCH_HAS_ROUND
+
+static inline V vload(const double* p) { return _mm256_loadu_pd(p); }
+static inline void vstore(double* p, V v) { _mm256_storeu_pd(p, v); }
+static inline V vset(double x) { return _mm256_set1_pd(x); }
+static inline V vseti(long long x) { return _mm256_castsi256_pd(_mm256_set1_epi64x(x)); }
+static inline V vadd(V a, V b) { return _mm256_add_pd(a, b); }
+static inline V vsub(V a, V b) { return _mm256_sub_pd(a, b); }
+static inline V vmul(V a, V b) { return _mm256_mul_pd(a, b); }
+static inline V vdiv(V a, V b) { return _mm256_div_pd(a, b); }
+static inline V vfma(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+static inline V vsqrt(V a) { return _mm256_sqrt_pd(a); }
+static inline V vfloor(V a) { return _mm256_floor_pd(a); }
+static inline V vceil(V a) { return _mm256_ceil_pd(a); }
+static inline V vand(V a, V b) { return _mm256_and_pd(a, b); }
+static inline V vxor(V a, V b) { return _mm256_xor_pd(a, b); }
+static inline M vlt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+static inline M vnle(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_NLE_UQ); }
+static inline M vmor(M a, M b) { return _mm256_or_pd(a, b); }
+static inline bool vany(M m) { return _mm256_movemask_pd(m) != 0; }
+static inline V vselect(M m, V a, V b) { return _mm256_blendv_pd(b, a, m); }
+static inline V vaddi(V a, V b) { return _mm256_castsi256_pd(_mm256_add_epi64(_mm256_castpd_si256(a), _mm256_castpd_si256(b))); }
+static inline V vsubi(V a, V b) { return _mm256_castsi256_pd(_mm256_sub_epi64(_mm256_castpd_si256(a), _mm256_castpd_si256(b))); }
+#define vslli(a, n) _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(a), n))
+#define vsrli(a, n) _mm256_castsi256_pd(_mm256_srli_epi64(_mm256_castpd_si256(a), n))
+
+#include "batch_simd.inl"
+
+namespace calc {
+
+    const BatchKernels* batchKernelsAvx2() {
+        static const BatchKernels kernels = makeKernels(BatchIsa::AVX2);
+        return &kernels;
+    }
+
+}
+
+#else
+
+namespace calc {
+
+    const BatchKernels* batchKernelsAvx2() {
+        return nullptr;
+    }
+
+}
+
+#endif
\ No newline at end of file
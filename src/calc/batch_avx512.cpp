@@ -0,0 +1,59 @@
+#include "batch.hpp"
+
+// 本文件单独以 -mavx512f 编译, 只有在 detectBatchIsa 确认支持后才会被调用
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+
+typedef __m512d V;
+typedef __mmask8 M;
+#define LANES 8
+#define BATCH_HAS_ROUND
+
+static inline V vload(const double* p) { return _mm512_loadu_pd(p); }
+static inline void vstore(double* p, V v) { _mm512_storeu_pd(p, v); }
+static inline V vset(double x) { return _mm512_set1_pd(x); }
+static inline V vseti(long long x) { return _mm512_castsi512_pd(_mm512_set1_epi64(x)); }
+static inline V vadd(V a, V b) { return _mm512_add_pd(a, b); }
+static inline V vsub(V a, V b) { return _mm512_sub_pd(a, b); }
+static inline V vmul(V a, V b) { return _mm512_mul_pd(a, b); }
+static inline V vdiv(V a, V b) { return _mm512_div_pd(a, b); }
+static inline V vfma(V a, V b, V c) { return _mm512_fmadd_pd(a, b, c); }
+static inline V vsqrt(V a) { return _mm512_sqrt_pd(a); }
+static inline V vfloor(V a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+static inline V vceil(V a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC); }
+// AVX-512F 没有浮点位运算, 借用 64 位整数指令
+static inline V vand(V a, V b) { return _mm512_castsi512_pd(_mm512_and_epi64(_mm512_castpd_si512(a), _mm512_castpd_si512(b))); }
+static inline V vxor(V a, V b) { return _mm512_castsi512_pd(_mm512_xor_epi64(_mm512_castpd_si512(a), _mm512_castpd_si512(b))); }
+static inline M vlt(V a, V b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+static inline M vnle(V a, V b) { return _mm512_cmp_pd_mask(a, b, _CMP_NLE_UQ); }
+static inline M vmor(M a, M b) { return a | b; }
+static inline bool vany(M m) { return m != 0; }
+static inline V vselect(M m, V a, V b) { return _mm512_mask_blend_pd(m, b, a); }
+static inline V vaddi(V a, V b) { return _mm512_castsi512_pd(_mm512_add_epi64(_mm512_castpd_si512(a), _mm512_castpd_si512(b))); }
+static inline V vsubi(V a, V b) { return _mm512_castsi512_pd(_mm512_sub_epi64(_mm512_castpd_si512(a), _mm512_castpd_si512(b))); }
+#define vslli(a, n) _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_castpd_si512(a), n))
+#define vsrli(a, n) _mm512_castsi512_pd(_mm512_srli_epi64(_mm512_castpd_si512(a), n))
+
+#include "batch_simd.inl"
+
+namespace calc {
+
+    const BatchKernels* batchKernelsAvx512() {
+        static const BatchKernels kernels = makeKernels(BatchIsa::AVX512);
+        return &kernels;
+    }
+
+}
+
+#else
+
+namespace calc {
+
+    const BatchKernels* batchKernelsAvx512() {
+        return nullptr;
+    }
+
+}
+
+#endif
\ No newline at end of file
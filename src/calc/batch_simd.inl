@@ -0,0 +1,263 @@
+// 各指令集共用的批量内核, 由 batch_sse2.cpp / batch_avx2.cpp / batch_avx512.cpp 包含
+// 这些文件以更高的指令集编译, 这里不要使用会在其它编译单元中重复实例化的内联模板 (如 std::min)
+// 包含前需要定义 V, M, LANES 以及 vload / vstore / vset / vseti / vadd / vsub / vmul / vdiv / vfma
+// vsqrt / vand / vxor / vlt / vnle / vmor / vany / vselect / vaddi / vsubi / vslli / vsrli
+
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+    using namespace calc;
+
+    const double MAGIC = 6755399441055744.0;   // 1.5 * 2^52, 加上后低位即为就近取整的整数
+
+    // 以 pi/2 约化, 余项在 [-pi/4, pi/4], 超过该范围的 |x| 交给标量路径
+    const double TRIG_LIMIT = 1e5;
+    const double TWO_OVER_PI = 6.36619772367581382433e-01;
+    const double PIO2_1 = 1.57079632673412561417e+00;
+    const double PIO2_2 = 6.07710050630396597660e-11;
+    const double PIO2_2T = 2.02226624879595063154e-21;
+
+    const double LN2_HI = 6.93147180369123816490e-01;
+    const double LN2_LO = 1.90821492927058770002e-10;
+    const double LOG2E = 1.44269504088896338700e+00;
+    const double EXP_LIMIT = 708.0;
+
+    inline V vabs(V x) { return vand(x, vseti(0x7fffffffffffffffLL)); }
+
+    // 整数值的 double (|q| < 2^51) 转为其二进制补码位
+    inline V vbits(V t) { return vsubi(t, vset(MAGIC)); }
+
+    // 2^52 量级的魔数把 bits 中的小整数转回 double
+    inline V vfrombits(V bits) { return vsub(vaddi(bits, vset(MAGIC)), vset(MAGIC)); }
+
+    // 返回 sin(x + offset * pi/2)
+    inline V vsinq(V x, double offset) {
+        V t = vfma(x, vset(TWO_OVER_PI), vset(MAGIC));
+        V q = vsub(t, vset(MAGIC));
+        V r = vfma(q, vset(-PIO2_1), x);
+        r = vfma(q, vset(-PIO2_2), r);
+        r = vfma(q, vset(-PIO2_2T), r);
+        V quadrant = vbits(vadd(t, vset(offset)));
+
+        V z = vmul(r, r);
+        V ps = vset(1.58962301576546568060e-10);
+        ps = vfma(ps, z, vset(-2.50507477628578072866e-8));
+        ps = vfma(ps, z, vset(2.75573136213857245213e-6));
+        ps = vfma(ps, z, vset(-1.98412698295895385996e-4));
+        ps = vfma(ps, z, vset(8.33333333332211858878e-3));
+        ps = vfma(ps, z, vset(-1.66666666666666307295e-1));
+        V s = vfma(vmul(r, z), ps, r);
+
+        V pc = vset(-1.13585365213876817300e-11);
+        pc = vfma(pc, z, vset(2.08757008419747316778e-9));
+        pc = vfma(pc, z, vset(-2.75573141792967388112e-7));
+        pc = vfma(pc, z, vset(2.48015872888517045348e-5));
+        pc = vfma(pc, z, vset(-1.38888888888730564116e-3));
+        pc = vfma(pc, z, vset(4.16666666666665929218e-2));
+        V c = vfma(vmul(z, z), pc, vfma(z, vset(-0.5), vset(1.0)));
+
+        // 象限奇数取 cos 多项式, 第 2, 3 象限取反
+        M odd = vlt(vset(0.5), vfrombits(vand(quadrant, vseti(1))));
+        V result = vselect(odd, c, s);
+        return vxor(result, vand(vslli(quadrant, 62), vseti((long long)0x8000000000000000ULL)));
+    }
+
+    inline M trigOutOfRange(V x) { return vnle(vabs(x), vset(TRIG_LIMIT)); }
+
+    inline V vexp(V x) {
+        V t = vfma(x, vset(LOG2E), vset(MAGIC));
+        V n = vsub(t, vset(MAGIC));
+        V r = vfma(n, vset(-LN2_HI), x);
+        r = vfma(n, vset(-LN2_LO), r);
+
+        // |r| <= ln2/2, 泰勒展开到 12 阶
+        V p = vset(1.0 / 479001600.0);
+        p = vfma(p, r, vset(1.0 / 39916800.0));
+        p = vfma(p, r, vset(1.0 / 3628800.0));
+        p = vfma(p, r, vset(1.0 / 362880.0));
+        p = vfma(p, r, vset(1.0 / 40320.0));
+        p = vfma(p, r, vset(1.0 / 5040.0));
+        p = vfma(p, r, vset(1.0 / 720.0));
+        p = vfma(p, r, vset(1.0 / 120.0));
+        p = vfma(p, r, vset(1.0 / 24.0));
+        p = vfma(p, r, vset(1.0 / 6.0));
+        p = vfma(p, r, vset(0.5));
+        p = vfma(p, r, vset(1.0));
+        p = vfma(p, r, vset(1.0));
+
+        V scale = vslli(vaddi(vbits(t), vseti(1023)), 52);
+        return vmul(p, scale);
+    }
+
+    inline M expOutOfRange(V x) {
+        return vmor(vnle(x, vset(EXP_LIMIT)), vnle(vset(-EXP_LIMIT), x));
+    }
+
+    inline V vlog(V x) {
+        V exponent = vsubi(vsrli(x, 52), vseti(1023));
+        V m = vxor(vand(x, vseti(0x000fffffffffffffLL)), vseti(0x3ff0000000000000LL));
+
+        // 尾数折到 [sqrt(2)/2, sqrt(2)), 使 s 的范围对称
+        M big = vlt(vset(1.41421356237309504880), m);
+        m = vselect(big, vmul(m, vset(0.5)), m);
+        V e = vadd(vfrombits(exponent), vselect(big, vset(1.0), vset(0.0)));
+
+        // log(m) = 2 atanh(s), s = (m - 1) / (m + 1), |s| < 0.172
+        V f = vsub(m, vset(1.0));
+        V s = vdiv(f, vadd(f, vset(2.0)));
+        V z = vmul(s, s);
+        V p = vset(2.0 / 21.0);
+        p = vfma(p, z, vset(2.0 / 19.0));
+        p = vfma(p, z, vset(2.0 / 17.0));
+        p = vfma(p, z, vset(2.0 / 15.0));
+        p = vfma(p, z, vset(2.0 / 13.0));
+        p = vfma(p, z, vset(2.0 / 11.0));
+        p = vfma(p, z, vset(2.0 / 9.0));
+        p = vfma(p, z, vset(2.0 / 7.0));
+        p = vfma(p, z, vset(2.0 / 5.0));
+        p = vfma(p, z, vset(2.0 / 3.0));
+        V logm = vfma(vmul(s, z), p, vadd(s, s));
+
+        return vfma(e, vset(LN2_HI), vfma(e, vset(LN2_LO), logm));
+    }
+
+    // 0, 负数, 非规格化数, inf 与 nan 都交给标量路径
+    inline M logOutOfRange(V x) {
+        return vmor(vnle(vset(DBL_MIN), x), vnle(x, vset(DBL_MAX)));
+    }
+
+    template <typename F, typename S>
+    inline void binaryLoop(const double* a, const double* b, double* dst, size_t n, F vector, S scalar) {
+        size_t i = 0;
+        for (; i + LANES <= n; i += LANES) vstore(dst + i, vector(vload(a + i), vload(b + i)));
+        for (; i < n; i++) dst[i] = scalar(a[i], b[i]);
+    }
+
+    template <typename F, typename S>
+    inline void unaryLoop(const double* a, double* dst, size_t n, F vector, S scalar) {
+        size_t i = 0;
+        for (; i + LANES <= n; i += LANES) vstore(dst + i, vector(vload(a + i)));
+        for (; i < n; i++) dst[i] = scalar(a[i]);
+    }
+
+    // 任一通道超出范围时整组用标量函数重算, dst 可能与 a 重合, 所以先保留输入
+    template <typename F, typename R, typename S>
+    inline void guardedLoop(const double* a, double* dst, size_t n, F vector, R out_of_range, S scalar) {
+        size_t i = 0;
+        for (; i + LANES <= n; i += LANES) {
+            V x = vload(a + i);
+            if (vany(out_of_range(x))) {
+                double lanes[LANES];
+                vstore(lanes, x);
+                for (int j = 0; j < LANES; j++) dst[i + j] = scalar(lanes[j]);
+            } else {
+                vstore(dst + i, vector(x));
+            }
+        }
+        for (; i < n; i++) dst[i] = scalar(a[i]);
+    }
+
+    void kernelAdd(const double* a, const double* b, double* dst, size_t n) {
+        binaryLoop(a, b, dst, n, [](V x, V y) { return vadd(x, y); }, [](double x, double y) { return x + y; });
+    }
+
+    void kernelSub(const double* a, const double* b, double* dst, size_t n) {
+        binaryLoop(a, b, dst, n, [](V x, V y) { return vsub(x, y); }, [](double x, double y) { return x - y; });
+    }
+
+    void kernelMul(const double* a, const double* b, double* dst, size_t n) {
+        binaryLoop(a, b, dst, n, [](V x, V y) { return vmul(x, y); }, [](double x, double y) { return x * y; });
+    }
+
+    void kernelDiv(const double* a, const double* b, double* dst, size_t n) {
+        binaryLoop(a, b, dst, n, [](V x, V y) { return vdiv(x, y); }, [](double x, double y) { return x / y; });
+    }
+
+    // 与 std::min / std::max 的 nan 语义保持一致
+    void kernelMin(const double* a, const double* b, double* dst, size_t n) {
+        binaryLoop(a, b, dst, n, [](V x, V y) { return vselect(vlt(y, x), y, x); },
+                   [](double x, double y) { return y < x ? y : x; });
+    }
+
+    void kernelMax(const double* a, const double* b, double* dst, size_t n) {
+        binaryLoop(a, b, dst, n, [](V x, V y) { return vselect(vlt(x, y), y, x); },
+                   [](double x, double y) { return x < y ? y : x; });
+    }
+
+    void kernelNeg(const double* a, double* dst, size_t n) {
+        unaryLoop(a, dst, n, [](V x) { return vxor(x, vseti((long long)0x8000000000000000ULL)); },
+                  [](double x) { return -x; });
+    }
+
+    void kernelAbs(const double* a, double* dst, size_t n) {
+        unaryLoop(a, dst, n, [](V x) { return vabs(x); }, [](double x) { return std::fabs(x); });
+    }
+
+    void kernelSqrt(const double* a, double* dst, size_t n) {
+        unaryLoop(a, dst, n, [](V x) { return vsqrt(x); }, [](double x) { return std::sqrt(x); });
+    }
+
+    void kernelSin(const double* a, double* dst, size_t n) {
+        guardedLoop(a, dst, n, [](V x) { return vsinq(x, 0.0); }, trigOutOfRange, [](double x) { return std::sin(x); });
+    }
+
+    void kernelCos(const double* a, double* dst, size_t n) {
+        guardedLoop(a, dst, n, [](V x) { return vsinq(x, 1.0); }, trigOutOfRange, [](double x) { return std::cos(x); });
+    }
+
+    void kernelTan(const double* a, double* dst, size_t n) {
+        guardedLoop(a, dst, n, [](V x) { return vdiv(vsinq(x, 0.0), vsinq(x, 1.0)); }, trigOutOfRange,
+                    [](double x) { return std::tan(x); });
+    }
+
+    void kernelExp(const double* a, double* dst, size_t n) {
+        guardedLoop(a, dst, n, vexp, expOutOfRange, [](double x) { return std::exp(x); });
+    }
+
+    void kernelLog(const double* a, double* dst, size_t n) {
+        guardedLoop(a, dst, n, vlog, logOutOfRange, [](double x) { return std::log(x); });
+    }
+
+    void kernelLog10(const double* a, double* dst, size_t n) {
+        guardedLoop(a, dst, n, [](V x) { return vmul(vlog(x), vset(0.43429448190325182765)); }, logOutOfRange,
+                    [](double x) { return std::log10(x); });
+    }
+
+#ifdef BATCH_HAS_ROUND
+    void kernelFloor(const double* a, double* dst, size_t n) {
+        unaryLoop(a, dst, n, [](V x) { return vfloor(x); }, [](double x) { return std::floor(x); });
+    }
+
+    void kernelCeil(const double* a, double* dst, size_t n) {
+        unaryLoop(a, dst, n, [](V x) { return vceil(x); }, [](double x) { return std::ceil(x); });
+    }
+#endif
+
+    BatchKernels makeKernels(BatchIsa isa) {
+        BatchKernels k = {};
+        k.isa = isa;
+        k.binary[(int)Op::Add] = kernelAdd;
+        k.binary[(int)Op::Sub] = kernelSub;
+        k.binary[(int)Op::Mul] = kernelMul;
+        k.binary[(int)Op::Div] = kernelDiv;
+        k.binary[(int)Op::Min] = kernelMin;
+        k.binary[(int)Op::Max] = kernelMax;
+        k.unary[(int)Op::Neg] = kernelNeg;
+        k.unary[(int)Op::Abs] = kernelAbs;
+        k.unary[(int)Op::Sqrt] = kernelSqrt;
+        k.unary[(int)Op::Sin] = kernelSin;
+        k.unary[(int)Op::Cos] = kernelCos;
+        k.unary[(int)Op::Tan] = kernelTan;
+        k.unary[(int)Op::Exp] = kernelExp;
+        k.unary[(int)Op::Log] = kernelLog;
+        k.unary[(int)Op::Log10] = kernelLog10;
+#ifdef BATCH_HAS_ROUND
+        k.unary[(int)Op::Floor] = kernelFloor;
+        k.unary[(int)Op::Ceil] = kernelCeil;
+#endif
+        return k;
+    }
+
+}
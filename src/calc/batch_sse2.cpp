@@ -0,0 +1,54 @@
+#include "batch.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+
+#include <emmintrin.h>
+
+typedef __m128d V;
+typedef __m128d M;
+#define LANES 2
+
+static inline V vload(const double* p) { return _mm_loadu_pd(p); }
+static inline void vstore(double* p, V v) { _mm_storeu_pd(p, v); }
+static inline V vset(double x) { return _mm_set1_pd(x); }
+static inline V vseti(long long x) { return _mm_castsi128_pd(_mm_set1_epi64x(x)); }
+static inline V vadd(V a, V b) { return _mm_add_pd(a, b); }
+static inline V vsub(V a, V b) { return _mm_sub_pd(a, b); }
+static inline V vmul(V a, V b) { return _mm_mul_pd(a, b); }
+static inline V vdiv(V a, V b) { return _mm_div_pd(a, b); }
+static inline V vfma(V a, V b, V c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+static inline V vsqrt(V a) { return _mm_sqrt_pd(a); }
+static inline V vand(V a, V b) { return _mm_and_pd(a, b); }
+static inline V vxor(V a, V b) { return _mm_xor_pd(a, b); }
+static inline M vlt(V a, V b) { return _mm_cmplt_pd(a, b); }
+static inline M vnle(V a, V b) { return _mm_cmpnle_pd(a, b); }
+static inline M vmor(M a, M b) { return _mm_or_pd(a, b); }
+static inline bool vany(M m) { return _mm_movemask_pd(m) != 0; }
+static inline V vselect(M m, V a, V b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+static inline V vaddi(V a, V b) { return _mm_castsi128_pd(_mm_add_epi64(_mm_castpd_si128(a), _mm_castpd_si128(b))); }
+static inline V vsubi(V a, V b) { return _mm_castsi128_pd(_mm_sub_epi64(_mm_castpd_si128(a), _mm_castpd_si128(b))); }
+#define vslli(a, n) _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(a), n))
+#define vsrli(a, n) _mm_castsi128_pd(_mm_srli_epi64(_mm_castpd_si128(a), n))
+
+#include "batch_simd.inl"
+
+namespace calc {
+
+    const BatchKernels* batchKernelsSse2() {
+        static const BatchKernels kernels = makeKernels(BatchIsa::SSE2);
+        return &kernels;
+    }
+
+}
+
+#else
+
+namespace calc {
+
+    const BatchKernels* batchKernelsSse2() {
+        return nullptr;
+    }
+
+}
+
+#endif
\ No newline at end of file
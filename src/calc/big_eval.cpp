@@ -0,0 +1,135 @@
+#include "big_eval.hpp"
+
+#include <vector>
+
+#include "lexer.hpp"
+
+namespace calc {
+
+    BigEvaluator::BigEvaluator(size_t digits, StopCallback stop)
+        : _digits(digits), _stop(std::move(stop))
+    {
+        _limbs = (digits + BIGINT_DIGITS - 1) / BIGINT_DIGITS + BIGDECIMAL_GUARD_LIMBS;
+    }
+
+    bool BigEvaluator::fail(const std::string& message) {
+        _error = message;
+        return false;
+    }
+
+    // 取出整数值, 超出 int64 范围或带小数时返回 false
+    static bool integerValue(const BigDecimal& value, int64_t& out) {
+        if (!value.isInteger() || value.mantissa().size() + (size_t)value.exponent() > 2) return false;
+        BigInt integer = value.toInteger();
+        out = 0;
+        const Limbs& limbs = integer.limbs();
+        for (size_t i = limbs.size(); i-- > 0;) out = out * BIGINT_BASE + limbs[i];
+        if (integer.isNegative()) out = -out;
+        return true;
+    }
+
+    bool BigEvaluator::evaluate(const std::string& src, const ExprPool& pool, int root, BigDecimal& out) {
+        _error.clear();
+        if (root < 0 || root >= (int)pool.size()) return fail("empty expression");
+
+        // 只计算根可达的节点
+        std::vector<char> live(root + 1, 0);
+        live[root] = 1;
+        for (int i = root; i >= 0; i--) {
+            if (!live[i]) continue;
+            const Node& node = pool[i];
+            if (node.a >= 0) live[node.a] = 1;
+            if (node.b >= 0) live[node.b] = 1;
+        }
+
+        std::vector<BigDecimal> values(root + 1);
+        BigDecimal pi, e;
+        bool has_pi = false, has_e = false;
+        for (int i = 0; i <= root; i++) {
+            if (!live[i]) continue;
+            if (_stop && _stop()) return fail("cancelled");
+            const Node& node = pool[i];
+            const BigDecimal& a = node.a >= 0 ? values[node.a] : values[i];
+            const BigDecimal& b = node.b >= 0 ? values[node.b] : values[i];
+            BigDecimal& r = values[i];
+            int64_t n = 0;
+            switch (node.op) {
+                case Op::Const:
+                    if (node.slot == EXPR_CONST_PI) {
+                        if (!has_pi) pi = BigDecimal::pi(_limbs, _stop), has_pi = true;
+                        r = pi;
+                    } else if (node.slot == EXPR_CONST_E) {
+                        if (!has_e) e = BigDecimal::e(_limbs, _stop), has_e = true;
+                        r = e;
+                    } else if (node.slot >= 0 && (size_t)node.slot < src.size()) {
+                        Token token;
+                        lexToken(src.data(), src.size(), (size_t)node.slot, token);
+                        if (token.kind != TokenKind::Number ||
+                            !BigDecimal::parse(src.substr(token.begin, token.length), r)) {
+                            return fail("invalid number");
+                        }
+                    } else {
+                        r = BigDecimal::fromDouble(node.value);
+                    }
+                    break;
+                case Op::Var:
+                    return fail("variables are not supported in arbitrary precision");
+                case Op::Neg:
+                    r = -a;
+                    break;
+                case Op::Add:
+                    r = BigDecimal::add(a, b, _limbs);
+                    break;
+                case Op::Sub:
+                    r = BigDecimal::add(a, -b, _limbs);
+                    break;
+                case Op::Mul:
+                    r = BigDecimal::mul(a, b, _limbs);
+                    break;
+                case Op::Div:
+                    if (b.isZero()) return fail("division by zero");
+                    r = BigDecimal::div(a, b, _limbs);
+                    break;
+                case Op::Pow:
+                    if (!integerValue(b, n)) return fail("only integer exponents are supported in arbitrary precision");
+                    if (a.isZero() && n < 0) return fail("division by zero");
+                    r = BigDecimal::pow(a, n, _limbs);
+                    break;
+                case Op::Sqrt:
+                    if (a.isNegative()) return fail("sqrt of a negative number");
+                    r = BigDecimal::sqrt(a, _limbs);
+                    break;
+                case Op::Abs:
+                    r = a.isNegative() ? -a : a;
+                    break;
+                case Op::Floor:
+                case Op::Ceil: {
+                    r = BigDecimal(a.toInteger());
+                    // 有小数部分时向零取整后再修正方向
+                    if (!a.isInteger()) {
+                        if (node.op == Op::Floor && a.isNegative()) r = BigDecimal::add(r, BigDecimal(BigInt(-1)), _limbs);
+                        if (node.op == Op::Ceil && !a.isNegative()) r = BigDecimal::add(r, BigDecimal(BigInt(1)), _limbs);
+                    }
+                    break;
+                }
+                case Op::Fact:
+                    if (!integerValue(a, n) || n < 0) return fail("factorial needs a non-negative integer");
+                    if (n > BIG_FACT_LIMIT) return fail("factorial argument too large");
+                    r = BigDecimal(BigInt::factorial((uint32_t)n));
+                    break;
+                case Op::Min:
+                    r = BigDecimal::compare(a, b) <= 0 ? a : b;
+                    break;
+                case Op::Max:
+                    r = BigDecimal::compare(a, b) >= 0 ? a : b;
+                    break;
+                default:
+                    return fail(std::string("'") + opName(node.op) + "' is not supported in arbitrary precision");
+            }
+        }
+        if (_stop && _stop()) return fail("cancelled");
+        out = values[root];
+        return true;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include "bigdecimal.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace calc {
+
+    BigDecimal::BigDecimal()
+        : _exponent(0), _exact(true)
+    {
+    }
+
+    BigDecimal::BigDecimal(const BigInt& mantissa, int64_t exponent, bool exact)
+        : _mantissa(mantissa), _exponent(exponent), _exact(exact)
+    {
+        normalize();
+    }
+
+    void BigDecimal::normalize() {
+        if (_mantissa.isZero()) {
+            _exponent = 0;
+            return;
+        }
+        const Limbs& limbs = _mantissa.limbs();
+        size_t zeros = 0;
+        while (zeros < limbs.size() && limbs[zeros] == 0) zeros++;
+        if (zeros) {
+            _mantissa = _mantissa.truncateLimbs(zeros);
+            _exponent += (int64_t)zeros;
+        }
+    }
+
+    bool BigDecimal::parse(const std::string& text, BigDecimal& out) {
+        std::string digits;
+        int64_t exponent10 = 0;
+        size_t i = 0;
+        bool negative = false;
+        if (i < text.size() && (text[i] == '-' || text[i] == '+')) negative = text[i++] == '-';
+        bool any = false;
+        for (; i < text.size() && isdigit((unsigned char)text[i]); i++, any = true) digits += text[i];
+        if (i < text.size() && text[i] == '.') {
+            for (i++; i < text.size() && isdigit((unsigned char)text[i]); i++, any = true) {
+                digits += text[i];
+                exponent10--;
+            }
+        }
+        if (!any) return false;
+        if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+            char* end = nullptr;
+            long long e = strtoll(text.c_str() + i + 1, &end, 10);
+            if (end == text.c_str() + i + 1) return false;
+            exponent10 += e;
+            i = end - text.c_str();
+        }
+        if (i != text.size()) return false;
+
+        // 把十进制指数补齐到 limb 的整数倍
+        int64_t rem = exponent10 % BIGINT_DIGITS;
+        if (rem < 0) rem += BIGINT_DIGITS;
+        digits.append((size_t)rem, '0');
+        exponent10 -= rem;
+
+        BigInt mantissa;
+        BigInt::parse(digits, mantissa);
+        out = BigDecimal(negative ? -mantissa : mantissa, exponent10 / BIGINT_DIGITS, true);
+        return true;
+    }
+
+    BigDecimal BigDecimal::fromDouble(double value) {
+        if (value == 0.0 || !std::isfinite(value)) return BigDecimal();
+        // 缩放到 [BASE, BASE^2) 后取整, 保留约 18 位
+        int64_t exponent = 0;
+        double magnitude = std::fabs(value);
+        while (magnitude >= (double)BIGINT_BASE * BIGINT_BASE) {
+            magnitude /= BIGINT_BASE;
+            exponent++;
+        }
+        while (magnitude < (double)BIGINT_BASE) {
+            magnitude *= BIGINT_BASE;
+            exponent--;
+        }
+        BigInt mantissa((int64_t)magnitude);
+        return BigDecimal(value < 0 ? -mantissa : mantissa, exponent, false);
+    }
+
+    BigDecimal BigDecimal::rounded(size_t limbs) const {
+        size_t n = _mantissa.size();
+        if (n <= limbs) return *this;
+        size_t drop = n - limbs;
+        BigInt kept = _mantissa.truncateLimbs(drop);
+        if (_mantissa.limbs()[drop - 1] >= BIGINT_BASE / 2) {
+            kept = kept + (kept.isNegative() ? BigInt(-1) : BigInt(1));
+        }
+        return BigDecimal(kept, _exponent + (int64_t)drop, false);
+    }
+
+    BigDecimal BigDecimal::limited(size_t limbs) const {
+        if (_exact && _mantissa.size() <= BIGDECIMAL_EXACT_LIMIT) return *this;
+        return rounded(limbs);
+    }
+
+    BigInt BigDecimal::toInteger() const {
+        if (_exponent >= 0) return _mantissa.shiftLimbs((size_t)_exponent);
+        return _mantissa.truncateLimbs((size_t)(-_exponent));
+    }
+
+    double BigDecimal::toDouble() const {
+        int64_t extra = 0;
+        double m = _mantissa.toDouble(&extra);
+        return m * std::pow((double)BIGINT_BASE, (double)(extra + _exponent));
+    }
+
+    BigDecimal BigDecimal::operator-() const {
+        return BigDecimal(-_mantissa, _exponent, _exact);
+    }
+
+    int BigDecimal::compare(const BigDecimal& a, const BigDecimal& b) {
+        BigDecimal d = add(a, -b, std::max(a._mantissa.size(), b._mantissa.size()) + 2);
+        if (d.isZero()) return 0;
+        return d.isNegative() ? -1 : 1;
+    }
+
+    BigDecimal BigDecimal::add(const BigDecimal& a, const BigDecimal& b, size_t limbs) {
+        if (a.isZero()) return b.limited(limbs);
+        if (b.isZero()) return a.limited(limbs);
+        bool exact = a._exact && b._exact;
+
+        // 非精确时, 较小的一方完全落在精度之外就可以忽略
+        int64_t top_a = a._exponent + (int64_t)a._mantissa.size();
+        int64_t top_b = b._exponent + (int64_t)b._mantissa.size();
+        int64_t low = std::min(a._exponent, b._exponent);
+        int64_t span = std::max(top_a, top_b) - low;
+        if (!exact || span > (int64_t)BIGDECIMAL_EXACT_LIMIT) {
+            if (top_a - top_b > (int64_t)limbs + 2) return BigDecimal(a._mantissa, a._exponent, false).rounded(limbs);
+            if (top_b - top_a > (int64_t)limbs + 2) return BigDecimal(b._mantissa, b._exponent, false).rounded(limbs);
+            exact = false;
+        }
+
+        BigInt ma = a._mantissa.shiftLimbs((size_t)(a._exponent - low));
+        BigInt mb = b._mantissa.shiftLimbs((size_t)(b._exponent - low));
+        return BigDecimal(ma + mb, low, exact).limited(limbs);
+    }
+
+    BigDecimal BigDecimal::mul(const BigDecimal& a, const BigDecimal& b, size_t limbs) {
+        if (a._exact && b._exact) {
+            return BigDecimal(a._mantissa * b._mantissa, a._exponent + b._exponent, true).limited(limbs);
+        }
+        BigDecimal ra = a.rounded(limbs), rb = b.rounded(limbs);
+        return BigDecimal(ra._mantissa * rb._mantissa, ra._exponent + rb._exponent, false).rounded(limbs);
+    }
+
+    BigDecimal BigDecimal::reciprocal(const BigDecimal& a, size_t limbs) {
+        size_t target = limbs + BIGDECIMAL_GUARD_LIMBS;
+        BigDecimal ad = a.rounded(target);
+        int64_t extra = 0;
+        double m = ad._mantissa.toDouble(&extra);
+        BigDecimal x = fromDouble(1.0 / m);
+        x._exponent -= extra + ad._exponent;
+
+        // Newton: x <- x + x (1 - a x), 每轮精度翻倍
+        const BigDecimal one(BigInt(1));
+        size_t p = 2;
+        for (int final_pass = 0; final_pass < 2;) {
+            p = std::min(p * 2, target);
+            BigDecimal residual = add(one, -mul(ad.rounded(p + 1), x, p + 2), p + 2);
+            x = add(x, mul(x, residual, p + 1), p + 1);
+            if (p == target) final_pass++;
+        }
+        return x.rounded(limbs);
+    }
+
+    BigDecimal BigDecimal::div(const BigDecimal& a, const BigDecimal& b, size_t limbs) {
+        return mul(a, reciprocal(b, limbs + 1), limbs);
+    }
+
+    BigDecimal BigDecimal::sqrt(const BigDecimal& a, size_t limbs) {
+        if (a.isZero()) return a;
+        size_t target = limbs + BIGDECIMAL_GUARD_LIMBS;
+        BigDecimal ad = a.rounded(target);
+        int64_t extra = 0;
+        double m = ad._mantissa.toDouble(&extra);
+        int64_t total = extra + ad._exponent;
+        if (total % 2 != 0) {
+            m *= BIGINT_BASE;
+            total--;
+        }
+        BigDecimal y = fromDouble(1.0 / std::sqrt(m));
+        y._exponent -= total / 2;
+
+        // 先求 1/sqrt(a): y <- y + y (1 - a y^2) / 2, 避免每轮除法
+        const BigDecimal one(BigInt(1));
+        const BigDecimal half(BigInt(BIGINT_BASE / 2), -1);
+        size_t p = 2;
+        for (int final_pass = 0; final_pass < 2;) {
+            p = std::min(p * 2, target);
+            BigDecimal y2 = mul(y, y, p + 2);
+            BigDecimal residual = add(one, -mul(ad.rounded(p + 1), y2, p + 2), p + 2);
+            y = add(y, mul(mul(y, residual, p + 1), half, p + 1), p + 1);
+            if (p == target) final_pass++;
+        }
+        BigDecimal result = mul(ad, y, limbs);
+
+        // 完全平方数给出精确结果
+        if (a._exact && a.isInteger()) {
+            BigInt candidate = add(result, BigDecimal(BigInt(BIGINT_BASE / 2), -1), limbs + 1).toInteger();
+            if (candidate * candidate == a.toInteger()) return BigDecimal(candidate);
+        }
+        return result;
+    }
+
+    BigDecimal BigDecimal::pow(const BigDecimal& a, int64_t exponent, size_t limbs) {
+        if (exponent < 0) {
+            // 负指数在求倒数前多留一位
+            return reciprocal(pow(a, -exponent, limbs + 1), limbs);
+        }
+        BigDecimal result(BigInt(1)), base = a;
+        uint64_t e = (uint64_t)exponent;
+        while (e) {
+            if (e & 1) result = mul(result, base, limbs + 1);
+            e >>= 1;
+            if (e) base = mul(base, base, limbs + 1);
+        }
+        return result.limited(limbs);
+    }
+
+    struct ChudnovskyTerm {
+        BigInt p, q, t;
+    };
+
+    // Chudnovsky 级数的二分拆分
+    static ChudnovskyTerm chudnovsky(uint64_t a, uint64_t b, const StopCallback& stop) {
+        ChudnovskyTerm r;
+        if (stop && b - a > 64 && stop()) return r;
+        if (b - a == 1) {
+            if (a == 0) {
+                r.p = BigInt(1);
+                r.q = BigInt(1);
+            } else {
+                r.p = BigInt((int64_t)(6 * a - 5)).mulSmall((uint32_t)(2 * a - 1)).mulSmall((uint32_t)(6 * a - 1));
+                r.q = BigInt((int64_t)a).mulSmall((uint32_t)a).mulSmall((uint32_t)a) * BigInt(10939058860032000LL);
+            }
+            r.t = r.p * BigInt((int64_t)(13591409 + 545140134 * a));
+            if (a & 1) r.t = -r.t;
+            return r;
+        }
+        uint64_t m = (a + b) / 2;
+        ChudnovskyTerm left = chudnovsky(a, m, stop);
+        ChudnovskyTerm right = chudnovsky(m, b, stop);
+        r.p = left.p * right.p;
+        r.q = left.q * right.q;
+        r.t = right.q * left.t + left.p * right.t;
+        return r;
+    }
+
+    BigDecimal BigDecimal::pi(size_t limbs, const StopCallback& stop) {
+        size_t work = limbs + BIGDECIMAL_GUARD_LIMBS;
+        // 每项约 14.18 位
+        uint64_t terms = (uint64_t)((double)work * BIGINT_DIGITS / 14.181647462725477) + 2;
+        ChudnovskyTerm s = chudnovsky(0, terms, stop);
+        if (stop && stop()) return BigDecimal();
+        BigDecimal numerator = mul(BigDecimal(s.q.mulSmall(426880)), sqrt(BigDecimal(BigInt(10005)), work), work);
+        BigDecimal result = div(numerator, BigDecimal(s.t), work).rounded(limbs);
+        result._exact = false;
+        return result;
+    }
+
+    // P(a, b) / Q(a, b) = sum_{k=a+1}^{b} 1 / ((a+1)(a+2)...k)
+    static void eSeries(uint64_t a, uint64_t b, BigInt& p, BigInt& q, const StopCallback& stop) {
+        if (stop && b - a > 64 && stop()) return;
+        if (b - a == 1) {
+            p = BigInt(1);
+            q = BigInt((int64_t)b);
+            return;
+        }
+        uint64_t m = (a + b) / 2;
+        BigInt pl, ql, pr, qr;
+        eSeries(a, m, pl, ql, stop);
+        eSeries(m, b, pr, qr, stop);
+        p = pl * qr + pr;
+        q = ql * qr;
+    }
+
+    BigDecimal BigDecimal::e(size_t limbs, const StopCallback& stop) {
+        size_t work = limbs + BIGDECIMAL_GUARD_LIMBS;
+        double digits = (double)work * BIGINT_DIGITS + 2;
+        // 取 N 使 N! > 10^digits
+        uint64_t terms = 2;
+        while (std::lgamma((double)terms + 1.0) / std::log(10.0) < digits) terms *= 2;
+        uint64_t lo = terms / 2, hi = terms;
+        while (lo + 1 < hi) {
+            uint64_t mid = (lo + hi) / 2;
+            if (std::lgamma((double)mid + 1.0) / std::log(10.0) < digits) lo = mid;
+            else hi = mid;
+        }
+        BigInt p, q;
+        eSeries(0, hi, p, q, stop);
+        if (stop && stop()) return BigDecimal();
+        BigDecimal result = add(BigDecimal(BigInt(1)), div(BigDecimal(p), BigDecimal(q), work), work).rounded(limbs);
+        result._exact = false;
+        return result;
+    }
+
+    std::string BigDecimal::toString(size_t digits, size_t max_chars) const {
+        if (isZero()) return "0";
+        std::string sign = isNegative() ? "-" : "";
+        std::string s = _mantissa.abs().toString();
+        int64_t exponent10 = _exponent * BIGINT_DIGITS;
+
+        if (_exact && _exponent >= 0 && s.size() + (size_t)exponent10 + sign.size() <= max_chars) {
+            return sign + s + std::string((size_t)exponent10, '0');
+        }
+
+        digits = std::max<size_t>(1, std::min(digits, max_chars > 24 ? max_chars - 24 : 1));
+        if (s.size() > digits) {
+            bool round_up = s[digits] >= '5';
+            exponent10 += (int64_t)(s.size() - digits);
+            s.resize(digits);
+            if (round_up) {
+                size_t i = s.size();
+                while (i > 0 && s[i - 1] == '9') s[--i] = '0';
+                if (i == 0) {
+                    s.insert(s.begin(), '1');
+                    s.pop_back();
+                    exponent10++;
+                } else {
+                    s[i - 1]++;
+                }
+            }
+        }
+        size_t zeros = 0;
+        while (zeros + 1 < s.size() && s[s.size() - 1 - zeros] == '0') zeros++;
+        s.resize(s.size() - zeros);
+        exponent10 += (int64_t)zeros;
+
+        // point 为小数点前的位数
+        int64_t length = (int64_t)s.size();
+        int64_t point = length + exponent10;
+        std::string fixed;
+        if (point > -6 && point <= (int64_t)digits) {
+            if (exponent10 >= 0) {
+                fixed = s + std::string((size_t)exponent10, '0');
+            } else if (point > 0) {
+                fixed = s.substr(0, (size_t)point) + "." + s.substr((size_t)point);
+            } else {
+                fixed = "0." + std::string((size_t)(-point), '0') + s;
+            }
+            if (fixed.size() + sign.size() <= max_chars) return sign + fixed;
+        }
+        std::string scientific = s.substr(0, 1);
+        if (s.size() > 1) scientific += "." + s.substr(1);
+        return sign + scientific + "e" + std::to_string(point - 1);
+    }
+
+}
\ No newline at end of file
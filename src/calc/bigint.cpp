@@ -0,0 +1,378 @@
+#include "bigint.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ntt.hpp"
+
+namespace calc {
+
+    // ---- 无符号 limb 运算 ----
+
+    static void trimLimbs(Limbs& a) {
+        while (!a.empty() && a.back() == 0) a.pop_back();
+    }
+
+    static int compareLimbs(const Limbs& a, const Limbs& b) {
+        if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+        for (size_t i = a.size(); i-- > 0;) {
+            if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    static Limbs addLimbs(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+        if (na < nb) {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+        Limbs r(na + 1);
+        uint32_t carry = 0;
+        for (size_t i = 0; i < na; i++) {
+            uint32_t s = a[i] + (i < nb ? b[i] : 0) + carry;
+            carry = s >= BIGINT_BASE;
+            r[i] = carry ? s - BIGINT_BASE : s;
+        }
+        r[na] = carry;
+        trimLimbs(r);
+        return r;
+    }
+
+    // 要求 a >= b
+    static Limbs subLimbs(const Limbs& a, const Limbs& b) {
+        Limbs r(a.size());
+        int64_t borrow = 0;
+        for (size_t i = 0; i < a.size(); i++) {
+            int64_t d = (int64_t)a[i] - (i < b.size() ? b[i] : 0) - borrow;
+            borrow = d < 0;
+            r[i] = (uint32_t)(borrow ? d + BIGINT_BASE : d);
+        }
+        trimLimbs(r);
+        return r;
+    }
+
+    // r[offset...] += a, r 足够长
+    static void addInto(Limbs& r, const Limbs& a, size_t offset) {
+        uint32_t carry = 0;
+        size_t i = 0;
+        for (; i < a.size() || carry; i++) {
+            uint32_t s = r[offset + i] + (i < a.size() ? a[i] : 0) + carry;
+            carry = s >= BIGINT_BASE;
+            r[offset + i] = carry ? s - BIGINT_BASE : s;
+        }
+    }
+
+    static void schoolbook(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+        std::fill(out, out + na + nb, 0u);
+        for (size_t i = 0; i < na; i++) {
+            uint64_t carry = 0;
+            uint64_t ai = a[i];
+            if (ai == 0) continue;
+            for (size_t j = 0; j < nb; j++) {
+                uint64_t cur = out[i + j] + ai * b[j] + carry;
+                carry = cur / BIGINT_BASE;
+                out[i + j] = (uint32_t)(cur - carry * BIGINT_BASE);
+            }
+            size_t k = i + nb;
+            while (carry) {
+                uint64_t cur = out[k] + carry;
+                carry = cur / BIGINT_BASE;
+                out[k++] = (uint32_t)(cur - carry * BIGINT_BASE);
+            }
+        }
+    }
+
+    static Limbs multiplySlices(const uint32_t* a, size_t na, const uint32_t* b, size_t nb);
+
+    static Limbs slice(const uint32_t* a, size_t n, size_t begin, size_t end) {
+        begin = std::min(begin, n);
+        end = std::min(end, n);
+        Limbs r(a + begin, a + end);
+        trimLimbs(r);
+        return r;
+    }
+
+    // na >= nb > na / 2
+    static Limbs karatsuba(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+        size_t k = na / 2;
+        Limbs a0 = slice(a, na, 0, k), a1 = slice(a, na, k, na);
+        Limbs b0 = slice(b, nb, 0, k), b1 = slice(b, nb, k, nb);
+
+        Limbs z0 = multiplySlices(a0.data(), a0.size(), b0.data(), b0.size());
+        Limbs z2 = multiplySlices(a1.data(), a1.size(), b1.data(), b1.size());
+        Limbs sa = addLimbs(a0.data(), a0.size(), a1.data(), a1.size());
+        Limbs sb = addLimbs(b0.data(), b0.size(), b1.data(), b1.size());
+        Limbs z1 = multiplySlices(sa.data(), sa.size(), sb.data(), sb.size());
+        z1 = subLimbs(subLimbs(z1, z0), z2);
+
+        Limbs r(na + nb + 1, 0);
+        addInto(r, z0, 0);
+        addInto(r, z1, k);
+        addInto(r, z2, 2 * k);
+        return r;
+    }
+
+    // 五点求值 (0, 1, -1, -2, inf) 与 Bodrato 插值序列
+    static Limbs toom3(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+        size_t k = (std::max(na, nb) + 2) / 3;
+        BigInt a0(false, slice(a, na, 0, k)), a1(false, slice(a, na, k, 2 * k)), a2(false, slice(a, na, 2 * k, na));
+        BigInt b0(false, slice(b, nb, 0, k)), b1(false, slice(b, nb, k, 2 * k)), b2(false, slice(b, nb, 2 * k, nb));
+
+        BigInt pa = a0 + a2;
+        BigInt pa1 = pa + a1, pam1 = pa - a1;
+        BigInt pam2 = (pam1 + a2).mulSmall(2) - a0;
+        BigInt pb = b0 + b2;
+        BigInt pb1 = pb + b1, pbm1 = pb - b1;
+        BigInt pbm2 = (pbm1 + b2).mulSmall(2) - b0;
+
+        BigInt r0 = a0 * b0;
+        BigInt r1 = pa1 * pb1;
+        BigInt rm1 = pam1 * pbm1;
+        BigInt rm2 = pam2 * pbm2;
+        BigInt rinf = a2 * b2;
+
+        BigInt r3 = (rm2 - r1).divSmall(3);
+        r1 = (r1 - rm1).divSmall(2);
+        BigInt r2 = rm1 - r0;
+        r3 = (r2 - r3).divSmall(2) + rinf.mulSmall(2);
+        r2 = r2 + r1 - rinf;
+        r1 = r1 - r3;
+
+        // 插值后的系数都非负
+        Limbs r(na + nb + 2, 0);
+        addInto(r, r0.limbs(), 0);
+        addInto(r, r1.limbs(), k);
+        addInto(r, r2.limbs(), 2 * k);
+        addInto(r, r3.limbs(), 3 * k);
+        addInto(r, rinf.limbs(), 4 * k);
+        return r;
+    }
+
+    static Limbs multiplySlices(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+        if (na < nb) {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+        if (nb == 0) return Limbs();
+
+        Limbs r;
+        if (nb < BIGINT_KARATSUBA_THRESHOLD) {
+            r.resize(na + nb);
+            schoolbook(a, na, b, nb, r.data());
+        } else if (na >= 2 * nb) {
+            // 长短悬殊时把长的一方按短的长度分段, 每段都是平衡的乘法
+            r.assign(na + nb + 1, 0);
+            for (size_t offset = 0; offset < na; offset += nb) {
+                size_t n = std::min(nb, na - offset);
+                addInto(r, multiplySlices(a + offset, n, b, nb), offset);
+            }
+        } else if (nb < BIGINT_TOOM3_THRESHOLD) {
+            r = karatsuba(a, na, b, nb);
+        } else if (nb < BIGINT_NTT_THRESHOLD || na + nb > NTT_MAX_LENGTH) {
+            r = toom3(a, na, b, nb);
+        } else {
+            r.resize(na + nb);
+            nttMultiply(a, na, b, nb, r.data());
+        }
+        trimLimbs(r);
+        return r;
+    }
+
+    Limbs multiplyLimbs(const Limbs& a, const Limbs& b) {
+        return multiplySlices(a.data(), a.size(), b.data(), b.size());
+    }
+
+    // ---- BigInt ----
+
+    BigInt::BigInt()
+        : _negative(false)
+    {
+    }
+
+    BigInt::BigInt(int64_t value)
+        : _negative(value < 0)
+    {
+        uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+        while (magnitude) {
+            _limbs.push_back((uint32_t)(magnitude % BIGINT_BASE));
+            magnitude /= BIGINT_BASE;
+        }
+    }
+
+    BigInt::BigInt(bool negative, Limbs limbs)
+        : _negative(negative), _limbs(std::move(limbs))
+    {
+        trim();
+    }
+
+    void BigInt::trim() {
+        trimLimbs(_limbs);
+        if (_limbs.empty()) _negative = false;
+    }
+
+    bool BigInt::parse(const std::string& text, BigInt& out) {
+        size_t begin = 0;
+        bool negative = false;
+        if (begin < text.size() && (text[begin] == '-' || text[begin] == '+')) negative = text[begin++] == '-';
+        if (begin == text.size()) return false;
+        for (size_t i = begin; i < text.size(); i++) {
+            if (text[i] < '0' || text[i] > '9') return false;
+        }
+        Limbs limbs;
+        limbs.reserve((text.size() - begin) / BIGINT_DIGITS + 1);
+        for (size_t end = text.size(); end > begin;) {
+            size_t start = end >= begin + BIGINT_DIGITS ? end - BIGINT_DIGITS : begin;
+            uint32_t limb = 0;
+            for (size_t i = start; i < end; i++) limb = limb * 10 + (uint32_t)(text[i] - '0');
+            limbs.push_back(limb);
+            end = start;
+        }
+        out = BigInt(negative, std::move(limbs));
+        return true;
+    }
+
+    std::string BigInt::toString() const {
+        if (_limbs.empty()) return "0";
+        std::string s;
+        s.reserve(_limbs.size() * BIGINT_DIGITS + 1);
+        if (_negative) s += '-';
+        s += std::to_string(_limbs.back());
+        char buffer[16];
+        for (size_t i = _limbs.size() - 1; i-- > 0;) {
+            snprintf(buffer, sizeof(buffer), "%09u", _limbs[i]);
+            s.append(buffer, BIGINT_DIGITS);
+        }
+        return s;
+    }
+
+    size_t BigInt::digitCount() const {
+        if (_limbs.empty()) return 1;
+        size_t top = 0;
+        for (uint32_t v = _limbs.back(); v; v /= 10) top++;
+        return (_limbs.size() - 1) * BIGINT_DIGITS + top;
+    }
+
+    BigInt BigInt::operator-() const {
+        BigInt r = *this;
+        if (!r.isZero()) r._negative = !r._negative;
+        return r;
+    }
+
+    BigInt BigInt::abs() const {
+        return BigInt(false, _limbs);
+    }
+
+    int BigInt::compareMagnitude(const BigInt& a, const BigInt& b) {
+        return compareLimbs(a._limbs, b._limbs);
+    }
+
+    int BigInt::compare(const BigInt& a, const BigInt& b) {
+        if (a._negative != b._negative) return a._negative ? -1 : 1;
+        int c = compareLimbs(a._limbs, b._limbs);
+        return a._negative ? -c : c;
+    }
+
+    BigInt operator+(const BigInt& a, const BigInt& b) {
+        if (a._negative == b._negative) {
+            return BigInt(a._negative, addLimbs(a._limbs.data(), a._limbs.size(), b._limbs.data(), b._limbs.size()));
+        }
+        int c = compareLimbs(a._limbs, b._limbs);
+        if (c == 0) return BigInt();
+        if (c > 0) return BigInt(a._negative, subLimbs(a._limbs, b._limbs));
+        return BigInt(b._negative, subLimbs(b._limbs, a._limbs));
+    }
+
+    BigInt operator-(const BigInt& a, const BigInt& b) {
+        return a + (-b);
+    }
+
+    BigInt operator*(const BigInt& a, const BigInt& b) {
+        return BigInt(a._negative != b._negative, multiplyLimbs(a._limbs, b._limbs));
+    }
+
+    BigInt& BigInt::operator+=(const BigInt& b) { return *this = *this + b; }
+    BigInt& BigInt::operator-=(const BigInt& b) { return *this = *this - b; }
+    BigInt& BigInt::operator*=(const BigInt& b) { return *this = *this * b; }
+
+    BigInt BigInt::shiftLimbs(size_t n) const {
+        if (isZero() || n == 0) return *this;
+        Limbs limbs(n, 0);
+        limbs.insert(limbs.end(), _limbs.begin(), _limbs.end());
+        return BigInt(_negative, std::move(limbs));
+    }
+
+    BigInt BigInt::truncateLimbs(size_t n) const {
+        if (n >= _limbs.size()) return BigInt();
+        return BigInt(_negative, Limbs(_limbs.begin() + n, _limbs.end()));
+    }
+
+    BigInt BigInt::mulSmall(uint32_t m) const {
+        Limbs r(_limbs.size() + 2);
+        uint64_t carry = 0;
+        for (size_t i = 0; i < _limbs.size(); i++) {
+            uint64_t cur = (uint64_t)_limbs[i] * m + carry;
+            carry = cur / BIGINT_BASE;
+            r[i] = (uint32_t)(cur - carry * BIGINT_BASE);
+        }
+        for (size_t i = _limbs.size(); carry; i++) {
+            r[i] = (uint32_t)(carry % BIGINT_BASE);
+            carry /= BIGINT_BASE;
+        }
+        return BigInt(_negative, std::move(r));
+    }
+
+    BigInt BigInt::divSmall(uint32_t d, uint32_t* remainder) const {
+        Limbs r(_limbs.size());
+        uint64_t rem = 0;
+        for (size_t i = _limbs.size(); i-- > 0;) {
+            uint64_t cur = rem * BIGINT_BASE + _limbs[i];
+            r[i] = (uint32_t)(cur / d);
+            rem = cur % d;
+        }
+        if (remainder) *remainder = (uint32_t)rem;
+        return BigInt(_negative, std::move(r));
+    }
+
+    BigInt BigInt::pow(uint64_t exponent) const {
+        BigInt result(1), base = *this;
+        while (exponent) {
+            if (exponent & 1) result *= base;
+            exponent >>= 1;
+            if (exponent) base = base * base;
+        }
+        return result;
+    }
+
+    BigInt BigInt::product(uint64_t first, uint64_t last) {
+        if (first > last) return BigInt(1);
+        if (last - first < 16) {
+            BigInt r(1);
+            for (uint64_t k = first; k <= last; k++) {
+                r = k < 0xffffffffu ? r.mulSmall((uint32_t)k) : r * BigInt((int64_t)k);
+            }
+            return r;
+        }
+        uint64_t mid = first + (last - first) / 2;
+        return product(first, mid) * product(mid + 1, last);
+    }
+
+    BigInt BigInt::factorial(uint32_t n) {
+        return product(2, n);
+    }
+
+    double BigInt::toDouble(int64_t* exponent_limbs) const {
+        double value = 0.0;
+        size_t n = _limbs.size();
+        size_t take = std::min<size_t>(n, 3);
+        for (size_t i = 0; i < take; i++) value = value * BIGINT_BASE + _limbs[n - 1 - i];
+        int64_t exponent = (int64_t)(n - take);
+        if (exponent_limbs) {
+            *exponent_limbs = exponent;
+        } else {
+            value *= std::pow((double)BIGINT_BASE, (double)exponent);
+        }
+        return _negative ? -value : value;
+    }
+
+}
\ No newline at end of file
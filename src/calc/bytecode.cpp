@@ -0,0 +1,166 @@
+#include "bytecode.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+#include "optimizer.hpp"
+
+namespace calc {
+
+    int Program::slot(const std::string& name) const {
+        for (size_t i = 0; i < variables.size(); i++) {
+            if (variables[i] == name) return (int)i;
+        }
+        return -1;
+    }
+
+    bool Program::uses(const std::string& name) const {
+        int reg = slot(name);
+        if (reg < 0) return false;
+        if (result == reg) return true;
+        for (const Instr& in : code) {
+            if (in.a == reg || (isBinary(in.op) && in.b == reg)) return true;
+        }
+        return false;
+    }
+
+    void Program::clear() {
+        code.clear();
+        constants.clear();
+        variables.clear();
+        register_count = 0;
+        result = 0;
+    }
+
+    static bool lower(const ExprPool& pool, int root, Program& program) {
+        program.clear();
+        if (root < 0 || root >= (int)pool.size()) return false;
+
+        // 只保留 root 可达的节点
+        std::vector<char> live(root + 1, 0);
+        live[root] = 1;
+        for (int i = root; i >= 0; i--) {
+            if (!live[i]) continue;
+            const Node& node = pool[i];
+            if (node.a >= 0) live[node.a] = 1;
+            if (node.b >= 0) live[node.b] = 1;
+        }
+
+        // 每个节点最后被哪条父节点读取, 用于回收临时寄存器
+        std::vector<int> last_use(root + 1, -1);
+        std::unordered_map<uint64_t, uint16_t> constant_slots;
+        std::vector<double> constants;
+        for (int i = 0; i <= root; i++) {
+            if (!live[i]) continue;
+            const Node& node = pool[i];
+            if (node.a >= 0) last_use[node.a] = i;
+            if (node.b >= 0) last_use[node.b] = i;
+            if (node.op == Op::Const) {
+                uint64_t bits;
+                memcpy(&bits, &node.value, sizeof(bits));
+                if (!constant_slots.count(bits)) {
+                    constant_slots[bits] = (uint16_t)constants.size();
+                    constants.push_back(node.value);
+                }
+            }
+        }
+
+        program.variables = pool.variables();
+        program.constants = std::move(constants);
+        size_t temp_base = program.tempBase();
+
+        std::vector<int> reg(root + 1, -1);
+        std::vector<uint16_t> free_list;
+        size_t next_temp = temp_base;
+        for (int i = 0; i <= root; i++) {
+            if (!live[i]) continue;
+            const Node& node = pool[i];
+            if (node.op == Op::Const) {
+                uint64_t bits;
+                memcpy(&bits, &node.value, sizeof(bits));
+                reg[i] = program.constantBase() + constant_slots[bits];
+                continue;
+            }
+            if (node.op == Op::Var) {
+                reg[i] = node.slot;
+                continue;
+            }
+            uint16_t a = (uint16_t)reg[node.a];
+            uint16_t b = node.b >= 0 ? (uint16_t)reg[node.b] : 0;
+
+            // 先释放本指令读完即死的操作数, 目标寄存器可以与其重合
+            if (last_use[node.a] == i && a >= temp_base) free_list.push_back(a);
+            if (node.b >= 0 && node.b != node.a && last_use[node.b] == i && b >= temp_base) free_list.push_back(b);
+
+            uint16_t dst;
+            if (!free_list.empty()) {
+                dst = free_list.back();
+                free_list.pop_back();
+            } else {
+                // 寄存器编号用 16 位, 由调用方报告 "表达式过大"
+                if (next_temp >= UINT16_MAX) {
+                    program.clear();
+                    return false;
+                }
+                dst = (uint16_t)next_temp++;
+            }
+            reg[i] = dst;
+            program.code.push_back({node.op, dst, a, b});
+        }
+
+        program.result = (uint16_t)reg[root];
+        program.register_count = (uint16_t)next_temp;
+        return true;
+    }
+
+    bool compile(const ExprPool& pool, int root, Program& program, bool optimized, bool fast_math, OptimizeStats* stats) {
+        if (!optimized || root < 0) return lower(pool, root, program);
+        ExprPool simplified;
+        int simplified_root = optimize(pool, root, simplified, fast_math, stats);
+        return lower(simplified, simplified_root, program);
+    }
+
+    VM::VM()
+        : _program(nullptr)
+    {
+    }
+
+    void VM::load(const Program& program) {
+        _program = &program;
+        _registers.assign(program.register_count, 0.0);
+        std::copy(program.constants.begin(), program.constants.end(), _registers.begin() + program.constantBase());
+    }
+
+    double VM::run(const double* vars) {
+        const Program& program = *_program;
+        double* r = _registers.data();
+        size_t var_count = program.variables.size();
+        for (size_t i = 0; i < var_count; i++) r[i] = vars[i];
+
+        for (const Instr& in : program.code) {
+            double a = r[in.a];
+            double b = r[in.b];
+            double v;
+            switch (in.op) {
+                case Op::Add:   v = a + b; break;
+                case Op::Sub:   v = a - b; break;
+                case Op::Mul:   v = a * b; break;
+                case Op::Div:   v = a / b; break;
+                case Op::Neg:   v = -a; break;
+                case Op::Pow:   v = std::pow(a, b); break;
+                case Op::Sin:   v = std::sin(a); break;
+                case Op::Cos:   v = std::cos(a); break;
+                case Op::Sqrt:  v = std::sqrt(a); break;
+                case Op::Exp:   v = std::exp(a); break;
+                case Op::Log:   v = std::log(a); break;
+                default:
+                    v = isUnary(in.op) ? applyUnary(in.op, a) : applyBinary(in.op, a, b);
+                    break;
+            }
+            r[in.dst] = v;
+        }
+        return r[program.result];
+    }
+
+}
\ No newline at end of file
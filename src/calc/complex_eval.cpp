@@ -0,0 +1,240 @@
+#include "complex_eval.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstring>
+
+namespace calc {
+
+    using Complex = std::complex<double>;
+
+    // 整数次幂用平方求幂, z^2 之类的常见情形比 exp(b log a) 更精确
+    static Complex powComplex(Complex a, Complex b) {
+        double n = b.real();
+        if (b.imag() == 0.0 && n == std::floor(n) && std::fabs(n) <= 64.0) {
+            int e = (int)std::fabs(n);
+            Complex result(1.0, 0.0), base = a;
+            while (e) {
+                if (e & 1) result *= base;
+                e >>= 1;
+                if (e) base *= base;
+            }
+            return n < 0 ? 1.0 / result : result;
+        }
+        if (a == 0.0) return b.real() > 0.0 ? Complex(0.0, 0.0) : Complex(NAN, NAN);
+        return std::pow(a, b);
+    }
+
+    static Complex unaryComplex(Op op, Complex a) {
+        switch (op) {
+            case Op::Sin:   return std::sin(a);
+            case Op::Cos:   return std::cos(a);
+            case Op::Tan:   return std::tan(a);
+            case Op::Asin:  return std::asin(a);
+            case Op::Acos:  return std::acos(a);
+            case Op::Atan:  return std::atan(a);
+            case Op::Sinh:  return std::sinh(a);
+            case Op::Cosh:  return std::cosh(a);
+            case Op::Tanh:  return std::tanh(a);
+            case Op::Exp:   return std::exp(a);
+            case Op::Log:   return std::log(a);
+            case Op::Log10: return std::log10(a);
+            case Op::Sqrt:  return std::sqrt(a);
+            case Op::Floor: return Complex(std::floor(a.real()), std::floor(a.imag()));
+            case Op::Ceil:  return Complex(std::ceil(a.real()), std::ceil(a.imag()));
+            // 阶乘只对实轴定义
+            case Op::Fact:  return a.imag() == 0.0 ? Complex(applyUnary(Op::Fact, a.real()), 0.0) : Complex(NAN, NAN);
+            default:        return Complex(NAN, NAN);
+        }
+    }
+
+    // 指数是小整数常量时整块做平方求幂, 每一步都是可向量化的复数乘法
+    static bool integerExponent(const Program& program, uint16_t reg, int& exponent) {
+        if (reg < program.constantBase() || reg >= program.tempBase()) return false;
+        double value = program.constants[reg - program.constantBase()];
+        if (value != std::floor(value) || std::fabs(value) > 64.0) return false;
+        exponent = (int)value;
+        return true;
+    }
+
+    static void mulBlock(const double* ar, const double* ai, const double* br, const double* bi, double* dr, double* di, size_t n) {
+        for (size_t k = 0; k < n; k++) {
+            double r = ar[k] * br[k] - ai[k] * bi[k];
+            double i = ar[k] * bi[k] + ai[k] * br[k];
+            dr[k] = r;
+            di[k] = i;
+        }
+    }
+
+    void ComplexEvaluator::powBlock(const double* ar, const double* ai, int exponent, double* dr, double* di, size_t n) {
+        double* base_re = _pow.data();
+        double* base_im = base_re + COMPLEX_BLOCK;
+        double* acc_re = base_im + COMPLEX_BLOCK;
+        double* acc_im = acc_re + COMPLEX_BLOCK;
+        memcpy(base_re, ar, n * sizeof(double));
+        memcpy(base_im, ai, n * sizeof(double));
+        std::fill(acc_re, acc_re + n, 1.0);
+        std::fill(acc_im, acc_im + n, 0.0);
+        for (int e = std::abs(exponent); e; e >>= 1) {
+            if (e & 1) mulBlock(acc_re, acc_im, base_re, base_im, acc_re, acc_im, n);
+            if (e > 1) mulBlock(base_re, base_im, base_re, base_im, base_re, base_im, n);
+        }
+        for (size_t k = 0; k < n; k++) {
+            double r = acc_re[k], i = acc_im[k];
+            if (exponent < 0) {
+                double inv = 1.0 / (r * r + i * i);
+                r *= inv;
+                i *= -inv;
+            }
+            dr[k] = r;
+            di[k] = i;
+        }
+    }
+
+    ComplexEvaluator::ComplexEvaluator()
+        : _program(nullptr)
+    {
+    }
+
+    bool ComplexEvaluator::load(const Program& program) {
+        _program = nullptr;
+        _error.clear();
+        _bindings.assign(program.variables.size(), Binding::Unused);
+
+        for (size_t v = 0; v < program.variables.size(); v++) {
+            const std::string& name = program.variables[v];
+            if (!program.uses(name)) continue;
+            if (name == "z") _bindings[v] = Binding::Z;
+            else if (name == "x") _bindings[v] = Binding::Re;
+            else if (name == "y") _bindings[v] = Binding::Im;
+            else if (name == "i") _bindings[v] = Binding::Unit;
+            else {
+                _error = "unknown variable '" + name + "', use z, x, y or i";
+                return false;
+            }
+        }
+
+        _re.assign(std::max<size_t>(program.register_count, 1) * COMPLEX_BLOCK, 0.0);
+        _im.assign(_re.size(), 0.0);
+        _pow.assign(4 * COMPLEX_BLOCK, 0.0);
+        // 常量与虚数单位在每块中不变, 只写一次
+        for (size_t c = 0; c < program.constants.size(); c++) {
+            double* r = re((uint16_t)(program.constantBase() + c));
+            std::fill(r, r + COMPLEX_BLOCK, program.constants[c]);
+        }
+        for (size_t v = 0; v < _bindings.size(); v++) {
+            if (_bindings[v] != Binding::Unit) continue;
+            double* i = im((uint16_t)v);
+            std::fill(i, i + COMPLEX_BLOCK, 1.0);
+        }
+        _program = &program;
+        return true;
+    }
+
+    void ComplexEvaluator::evaluate(const double* in_re, const double* in_im, double* out_re, double* out_im, size_t count) {
+        const Program& program = *_program;
+        for (size_t base = 0; base < count; base += COMPLEX_BLOCK) {
+            size_t n = std::min<size_t>(COMPLEX_BLOCK, count - base);
+            for (size_t v = 0; v < _bindings.size(); v++) {
+                double* r = re((uint16_t)v);
+                double* i = im((uint16_t)v);
+                switch (_bindings[v]) {
+                    case Binding::Z:
+                        memcpy(r, in_re + base, n * sizeof(double));
+                        memcpy(i, in_im + base, n * sizeof(double));
+                        break;
+                    case Binding::Re:
+                        memcpy(r, in_re + base, n * sizeof(double));
+                        break;
+                    case Binding::Im:
+                        memcpy(r, in_im + base, n * sizeof(double));
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            int exponent = 0;
+            for (const Instr& in : program.code) {
+                const double* ar = re(in.a);
+                const double* ai = im(in.a);
+                const double* br = re(in.b);
+                const double* bi = im(in.b);
+                double* dr = re(in.dst);
+                double* di = im(in.dst);
+                switch (in.op) {
+                    // 虚部写成 0 - ai, 使 -1 的虚部为 +0, sqrt(-1) 落在分支切割的上侧得到 i
+                    case Op::Neg:
+                        for (size_t k = 0; k < n; k++) {
+                            dr[k] = -ar[k];
+                            di[k] = 0.0 - ai[k];
+                        }
+                        break;
+                    case Op::Add:
+                        for (size_t k = 0; k < n; k++) {
+                            dr[k] = ar[k] + br[k];
+                            di[k] = ai[k] + bi[k];
+                        }
+                        break;
+                    case Op::Sub:
+                        for (size_t k = 0; k < n; k++) {
+                            dr[k] = ar[k] - br[k];
+                            di[k] = ai[k] - bi[k];
+                        }
+                        break;
+                    case Op::Mul:
+                        mulBlock(ar, ai, br, bi, dr, di, n);
+                        break;
+                    case Op::Div:
+                        for (size_t k = 0; k < n; k++) {
+                            double inv = 1.0 / (br[k] * br[k] + bi[k] * bi[k]);
+                            double r = (ar[k] * br[k] + ai[k] * bi[k]) * inv;
+                            double i = (ai[k] * br[k] - ar[k] * bi[k]) * inv;
+                            dr[k] = r;
+                            di[k] = i;
+                        }
+                        break;
+                    case Op::Abs:
+                        for (size_t k = 0; k < n; k++) {
+                            dr[k] = std::hypot(ar[k], ai[k]);
+                            di[k] = 0.0;
+                        }
+                        break;
+                    // 按实部比较
+                    case Op::Min:
+                    case Op::Max:
+                        for (size_t k = 0; k < n; k++) {
+                            bool take_b = in.op == Op::Min ? br[k] < ar[k] : br[k] > ar[k];
+                            double r = take_b ? br[k] : ar[k];
+                            double i = take_b ? bi[k] : ai[k];
+                            dr[k] = r;
+                            di[k] = i;
+                        }
+                        break;
+                    case Op::Pow:
+                        if (integerExponent(program, in.b, exponent)) {
+                            powBlock(ar, ai, exponent, dr, di, n);
+                            break;
+                        }
+                        for (size_t k = 0; k < n; k++) {
+                            Complex v = powComplex(Complex(ar[k], ai[k]), Complex(br[k], bi[k]));
+                            dr[k] = v.real();
+                            di[k] = v.imag();
+                        }
+                        break;
+                    default:
+                        for (size_t k = 0; k < n; k++) {
+                            Complex v = unaryComplex(in.op, Complex(ar[k], ai[k]));
+                            dr[k] = v.real();
+                            di[k] = v.imag();
+                        }
+                        break;
+                }
+            }
+            memcpy(out_re + base, re(program.result), n * sizeof(double));
+            memcpy(out_im + base, im(program.result), n * sizeof(double));
+        }
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "dual.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace calc {
+
+    // ψ(x) = Γ'(x) / Γ(x), 用于阶乘的导数
+    static double digamma(double x) {
+        if (x <= 0.0 && x == std::floor(x)) return NAN;
+        if (x < 0.0) return digamma(1.0 - x) - M_PI / std::tan(M_PI * x);
+        double result = 0.0;
+        while (x < 6.0) {
+            result -= 1.0 / x;
+            x += 1.0;
+        }
+        double inv = 1.0 / x, inv2 = inv * inv;
+        return result + std::log(x) - 0.5 * inv - inv2 * (1.0 / 12.0 - inv2 * (1.0 / 120.0 - inv2 / 252.0));
+    }
+
+    DualEvaluator::DualEvaluator(BatchIsa isa)
+        : _program(nullptr), _kernels(batchKernels(isa))
+    {
+    }
+
+    void DualEvaluator::unary(Op op, const double* a, double* dst, size_t n) const {
+        UnaryKernel kernel = _kernels->unary[(int)op];
+        if (kernel) {
+            kernel(a, dst, n);
+        } else {
+            for (size_t k = 0; k < n; k++) dst[k] = applyUnary(op, a[k]);
+        }
+    }
+
+    void DualEvaluator::load(const Program& program) {
+        _program = &program;
+        _registers.assign(std::max<size_t>(program.register_count, 1) * (DUAL_WIDTH + 1) * BATCH_BLOCK, 0.0);
+        _scratch.assign(3 * BATCH_BLOCK, 0.0);
+        _points.assign(program.variables.size(), nullptr);
+        // 变量的偏导是单位向量, 常量的偏导为 0, 都只写一次
+        for (size_t v = 0; v < program.variables.size() && v < DUAL_WIDTH; v++) {
+            double* d = lane((uint16_t)v, (int)v + 1);
+            std::fill(d, d + BATCH_BLOCK, 1.0);
+        }
+        for (size_t c = 0; c < program.constants.size(); c++) {
+            double* value = lane((uint16_t)(program.constantBase() + c), 0);
+            std::fill(value, value + BATCH_BLOCK, program.constants[c]);
+        }
+    }
+
+    void DualEvaluator::evaluate(const double* const* vars, double* out, double* const* gradient, size_t count) {
+        const Program& program = *_program;
+        double* v = _scratch.data();
+        double* pa = v + BATCH_BLOCK;
+        double* pb = pa + BATCH_BLOCK;
+
+        for (size_t base = 0; base < count; base += BATCH_BLOCK) {
+            size_t n = std::min<size_t>(BATCH_BLOCK, count - base);
+            for (size_t i = 0; i < program.variables.size(); i++) {
+                double* value = lane((uint16_t)i, 0);
+                if (vars[i]) memcpy(value, vars[i] + base, n * sizeof(double));
+                else std::fill(value, value + n, 0.0);
+            }
+
+            for (const Instr& in : program.code) {
+                const double* a = lane(in.a, 0);
+                const double* b = lane(in.b, 0);
+                bool binary = isBinary(in.op);
+                // 先算出值与偏导因子 pa = ∂f/∂a, pb = ∂f/∂b, 目标寄存器可能与操作数重合
+                switch (in.op) {
+                    case Op::Neg:
+                        for (size_t k = 0; k < n; k++) { v[k] = -a[k]; pa[k] = -1.0; }
+                        break;
+                    case Op::Sin:
+                        unary(Op::Sin, a, v, n);
+                        unary(Op::Cos, a, pa, n);
+                        break;
+                    case Op::Cos:
+                        unary(Op::Cos, a, v, n);
+                        unary(Op::Sin, a, pa, n);
+                        for (size_t k = 0; k < n; k++) pa[k] = -pa[k];
+                        break;
+                    case Op::Tan:
+                        unary(Op::Tan, a, v, n);
+                        for (size_t k = 0; k < n; k++) pa[k] = 1.0 + v[k] * v[k];
+                        break;
+                    case Op::Asin:
+                        for (size_t k = 0; k < n; k++) { v[k] = std::asin(a[k]); pa[k] = 1.0 / std::sqrt(1.0 - a[k] * a[k]); }
+                        break;
+                    case Op::Acos:
+                        for (size_t k = 0; k < n; k++) { v[k] = std::acos(a[k]); pa[k] = -1.0 / std::sqrt(1.0 - a[k] * a[k]); }
+                        break;
+                    case Op::Atan:
+                        for (size_t k = 0; k < n; k++) { v[k] = std::atan(a[k]); pa[k] = 1.0 / (1.0 + a[k] * a[k]); }
+                        break;
+                    case Op::Sinh:
+                        for (size_t k = 0; k < n; k++) { v[k] = std::sinh(a[k]); pa[k] = std::cosh(a[k]); }
+                        break;
+                    case Op::Cosh:
+                        for (size_t k = 0; k < n; k++) { v[k] = std::cosh(a[k]); pa[k] = std::sinh(a[k]); }
+                        break;
+                    case Op::Tanh:
+                        for (size_t k = 0; k < n; k++) { v[k] = std::tanh(a[k]); pa[k] = 1.0 - v[k] * v[k]; }
+                        break;
+                    case Op::Exp:
+                        unary(Op::Exp, a, v, n);
+                        for (size_t k = 0; k < n; k++) pa[k] = v[k];
+                        break;
+                    case Op::Log:
+                        unary(Op::Log, a, v, n);
+                        for (size_t k = 0; k < n; k++) pa[k] = 1.0 / a[k];
+                        break;
+                    case Op::Log10:
+                        unary(Op::Log10, a, v, n);
+                        for (size_t k = 0; k < n; k++) pa[k] = 1.0 / (a[k] * M_LN10);
+                        break;
+                    case Op::Sqrt:
+                        unary(Op::Sqrt, a, v, n);
+                        for (size_t k = 0; k < n; k++) pa[k] = 0.5 / v[k];
+                        break;
+                    case Op::Abs:
+                        for (size_t k = 0; k < n; k++) { v[k] = std::fabs(a[k]); pa[k] = a[k] > 0.0 ? 1.0 : (a[k] < 0.0 ? -1.0 : 0.0); }
+                        break;
+                    case Op::Floor:
+                        for (size_t k = 0; k < n; k++) { v[k] = std::floor(a[k]); pa[k] = 0.0; }
+                        break;
+                    case Op::Ceil:
+                        for (size_t k = 0; k < n; k++) { v[k] = std::ceil(a[k]); pa[k] = 0.0; }
+                        break;
+                    case Op::Fact:
+                        for (size_t k = 0; k < n; k++) { v[k] = std::tgamma(a[k] + 1.0); pa[k] = v[k] * digamma(a[k] + 1.0); }
+                        break;
+                    case Op::Add:
+                        for (size_t k = 0; k < n; k++) { v[k] = a[k] + b[k]; pa[k] = 1.0; pb[k] = 1.0; }
+                        break;
+                    case Op::Sub:
+                        for (size_t k = 0; k < n; k++) { v[k] = a[k] - b[k]; pa[k] = 1.0; pb[k] = -1.0; }
+                        break;
+                    case Op::Mul:
+                        for (size_t k = 0; k < n; k++) { v[k] = a[k] * b[k]; pa[k] = b[k]; pb[k] = a[k]; }
+                        break;
+                    case Op::Div:
+                        for (size_t k = 0; k < n; k++) { v[k] = a[k] / b[k]; pa[k] = 1.0 / b[k]; pb[k] = -v[k] / b[k]; }
+                        break;
+                    case Op::Pow:
+                        for (size_t k = 0; k < n; k++) {
+                            v[k] = std::pow(a[k], b[k]);
+                            pa[k] = b[k] * std::pow(a[k], b[k] - 1.0);
+                            pb[k] = v[k] * std::log(a[k]);
+                        }
+                        break;
+                    // 与 applyBinary 一致: min 在 b < a 时取 b, max 在 b > a 时取 b
+                    case Op::Min:
+                        for (size_t k = 0; k < n; k++) { bool take_b = b[k] < a[k]; v[k] = take_b ? b[k] : a[k]; pa[k] = take_b ? 0.0 : 1.0; pb[k] = 1.0 - pa[k]; }
+                        break;
+                    case Op::Max:
+                        for (size_t k = 0; k < n; k++) { bool take_b = b[k] > a[k]; v[k] = take_b ? b[k] : a[k]; pa[k] = take_b ? 0.0 : 1.0; pb[k] = 1.0 - pa[k]; }
+                        break;
+                    default:
+                        for (size_t k = 0; k < n; k++) { v[k] = NAN; pa[k] = NAN; }
+                        break;
+                }
+
+                // 链式法则; 切向量分量为 0 时不乘偏导因子, 避免 sqrt(0), 0^b 处的 inf * 0
+                for (int c = 1; c <= DUAL_WIDTH; c++) {
+                    const double* da = lane(in.a, c);
+                    double* dd = lane(in.dst, c);
+                    if (binary) {
+                        const double* db = lane(in.b, c);
+                        for (size_t k = 0; k < n; k++) {
+                            double ta = da[k] != 0.0 ? pa[k] * da[k] : 0.0;
+                            double tb = db[k] != 0.0 ? pb[k] * db[k] : 0.0;
+                            dd[k] = ta + tb;
+                        }
+                    } else {
+                        for (size_t k = 0; k < n; k++) {
+                            dd[k] = da[k] != 0.0 ? pa[k] * da[k] : 0.0;
+                        }
+                    }
+                }
+                memcpy(lane(in.dst, 0), v, n * sizeof(double));
+            }
+
+            memcpy(out + base, lane(program.result, 0), n * sizeof(double));
+            for (int c = 0; c < DUAL_WIDTH; c++) {
+                if (gradient[c]) memcpy(gradient[c] + base, lane(program.result, c + 1), n * sizeof(double));
+            }
+        }
+    }
+
+    void DualEvaluator::evaluate(const double* x, const double* y, const double* z, double* out,
+                                 double* grad_x, double* grad_y, double* grad_z, size_t count) {
+        double* gradient[DUAL_WIDTH] = {grad_x, grad_y, grad_z};
+        const double* xyz[3] = {x, y, z};
+        size_t var_count = _program->variables.size();
+        if (var_count <= 3) {
+            evaluate(xyz, out, gradient, count);
+            return;
+        }
+        std::vector<const double*> vars(var_count, nullptr);
+        std::copy(xyz, xyz + 3, vars.begin());
+        evaluate(vars.data(), out, gradient, count);
+    }
+
+    double DualEvaluator::run(const double* vars, double* gradient) {
+        for (size_t i = 0; i < _points.size(); i++) _points[i] = vars + i;
+        double* lanes[DUAL_WIDTH];
+        for (int c = 0; c < DUAL_WIDTH; c++) lanes[c] = gradient + c;
+        double value;
+        evaluate(_points.data(), &value, lanes, 1);
+        return value;
+    }
+
+}
\ No newline at end of file
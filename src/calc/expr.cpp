@@ -0,0 +1,200 @@
+#include "expr.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace calc {
+
+    const char* opName(Op op) {
+        switch (op) {
+            case Op::Const: return "const";
+            case Op::Var:   return "var";
+            case Op::Neg:   return "neg";
+            case Op::Sin:   return "sin";
+            case Op::Cos:   return "cos";
+            case Op::Tan:   return "tan";
+            case Op::Asin:  return "asin";
+            case Op::Acos:  return "acos";
+            case Op::Atan:  return "atan";
+            case Op::Sinh:  return "sinh";
+            case Op::Cosh:  return "cosh";
+            case Op::Tanh:  return "tanh";
+            case Op::Exp:   return "exp";
+            case Op::Log:   return "log";
+            case Op::Log10: return "log10";
+            case Op::Sqrt:  return "sqrt";
+            case Op::Abs:   return "abs";
+            case Op::Floor: return "floor";
+            case Op::Ceil:  return "ceil";
+            case Op::Fact:  return "fact";
+            case Op::Add:   return "add";
+            case Op::Sub:   return "sub";
+            case Op::Mul:   return "mul";
+            case Op::Div:   return "div";
+            case Op::Pow:   return "pow";
+            case Op::Min:   return "min";
+            case Op::Max:   return "max";
+        }
+        return "?";
+    }
+
+    ExprPool::ExprPool() {
+        clear();
+    }
+
+    size_t ExprPool::hash(const Node& node) {
+        uint64_t bits;
+        memcpy(&bits, &node.value, sizeof(bits));
+        uint64_t h = 1469598103934665603ULL;
+        for (uint64_t part : {(uint64_t)node.op, (uint64_t)(uint32_t)node.a, (uint64_t)(uint32_t)node.b,
+                              (uint64_t)(uint32_t)node.slot, bits}) {
+            h = (h ^ part) * 1099511628211ULL;
+        }
+        return (size_t)(h ^ (h >> 29));
+    }
+
+    bool ExprPool::equal(const Node& lhs, const Node& rhs) {
+        // 常量按位比较, 区分 0.0 与 -0.0, 并让 nan 能与自身合并
+        return lhs.op == rhs.op && lhs.a == rhs.a && lhs.b == rhs.b && lhs.slot == rhs.slot &&
+               memcmp(&lhs.value, &rhs.value, sizeof(double)) == 0;
+    }
+
+    size_t ExprPool::find(const Node& node) const {
+        size_t mask = _index.size() - 1;
+        size_t pos = hash(node) & mask;
+        while (_index[pos] >= 0 && !equal(_nodes[_index[pos]], node)) pos = (pos + 1) & mask;
+        return pos;
+    }
+
+    void ExprPool::grow() {
+        _index.assign(_index.size() * 2, -1);
+        size_t mask = _index.size() - 1;
+        for (size_t i = 0; i < _nodes.size(); i++) {
+            size_t pos = hash(_nodes[i]) & mask;
+            while (_index[pos] >= 0) pos = (pos + 1) & mask;
+            _index[pos] = (int)i;
+        }
+    }
+
+    void ExprPool::clear() {
+        _nodes.clear();
+        _index.assign(EXPR_INDEX_INITIAL, -1);
+        _variables = {"x", "y", "z"};
+    }
+
+    void ExprPool::truncate(size_t size) {
+        size_t mask = _index.size() - 1;
+        while (_nodes.size() > size) {
+            // 节点互不相同, 末尾节点在表中的位置就是它自己的下标; 删除后把后面的探测链前移, 不留墓碑
+            size_t pos = find(_nodes.back());
+            _index[pos] = -1;
+            for (size_t next = (pos + 1) & mask; _index[next] >= 0; next = (next + 1) & mask) {
+                size_t home = hash(_nodes[_index[next]]) & mask;
+                if (((next - home) & mask) >= ((next - pos) & mask)) {
+                    _index[pos] = _index[next];
+                    _index[next] = -1;
+                    pos = next;
+                }
+            }
+            _nodes.pop_back();
+        }
+    }
+
+    int ExprPool::intern(const Node& node) {
+        size_t pos = find(node);
+        if (_index[pos] >= 0) return _index[pos];
+        int index = (int)_nodes.size();
+        _nodes.push_back(node);
+        if (_nodes.size() * 2 > _index.size()) {
+            grow();
+        } else {
+            _index[pos] = index;
+        }
+        return index;
+    }
+
+    int ExprPool::constant(double value, int source) {
+        return intern({Op::Const, -1, -1, source, value});
+    }
+
+    int ExprPool::declare(const std::string& name) {
+        int s = slot(name);
+        if (s < 0) {
+            _variables.push_back(name);
+            s = (int)_variables.size() - 1;
+        }
+        return s;
+    }
+
+    int ExprPool::variable(const std::string& name) {
+        return intern({Op::Var, -1, -1, declare(name), 0.0});
+    }
+
+    int ExprPool::unary(Op op, int a) {
+        return intern({op, a, -1, -1, 0.0});
+    }
+
+    int ExprPool::binary(Op op, int a, int b) {
+        if (isCommutative(op) && b < a) std::swap(a, b);
+        return intern({op, a, b, -1, 0.0});
+    }
+
+    int ExprPool::slot(const std::string& name) const {
+        for (size_t i = 0; i < _variables.size(); i++) {
+            if (_variables[i] == name) return (int)i;
+        }
+        return -1;
+    }
+
+    double applyUnary(Op op, double a) {
+        switch (op) {
+            case Op::Neg:   return -a;
+            case Op::Sin:   return std::sin(a);
+            case Op::Cos:   return std::cos(a);
+            case Op::Tan:   return std::tan(a);
+            case Op::Asin:  return std::asin(a);
+            case Op::Acos:  return std::acos(a);
+            case Op::Atan:  return std::atan(a);
+            case Op::Sinh:  return std::sinh(a);
+            case Op::Cosh:  return std::cosh(a);
+            case Op::Tanh:  return std::tanh(a);
+            case Op::Exp:   return std::exp(a);
+            case Op::Log:   return std::log(a);
+            case Op::Log10: return std::log10(a);
+            case Op::Sqrt:  return std::sqrt(a);
+            case Op::Abs:   return std::fabs(a);
+            case Op::Floor: return std::floor(a);
+            case Op::Ceil:  return std::ceil(a);
+            case Op::Fact:  return std::tgamma(a + 1.0);
+            default:        return NAN;
+        }
+    }
+
+    double applyBinary(Op op, double a, double b) {
+        switch (op) {
+            case Op::Add: return a + b;
+            case Op::Sub: return a - b;
+            case Op::Mul: return a * b;
+            case Op::Div: return a / b;
+            case Op::Pow: return std::pow(a, b);
+            case Op::Min: return std::min(a, b);
+            case Op::Max: return std::max(a, b);
+            default:      return NAN;
+        }
+    }
+
+    double evaluateTree(const ExprPool& pool, int root, const double* vars) {
+        const Node& node = pool[root];
+        switch (node.op) {
+            case Op::Const: return node.value;
+            case Op::Var:   return vars[node.slot];
+            default: break;
+        }
+        if (isUnary(node.op)) {
+            return applyUnary(node.op, evaluateTree(pool, node.a, vars));
+        }
+        return applyBinary(node.op, evaluateTree(pool, node.a, vars), evaluateTree(pool, node.b, vars));
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "expr_parser.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace calc {
+
+    struct FunctionInfo {
+        const char* name;
+        Op op;
+        int arity;
+    };
+
+    static const FunctionInfo functions[] = {
+        {"sin", Op::Sin, 1},     {"cos", Op::Cos, 1},     {"tan", Op::Tan, 1},
+        {"asin", Op::Asin, 1},   {"acos", Op::Acos, 1},   {"atan", Op::Atan, 1},
+        {"sinh", Op::Sinh, 1},   {"cosh", Op::Cosh, 1},   {"tanh", Op::Tanh, 1},
+        {"exp", Op::Exp, 1},     {"log", Op::Log, 1},     {"ln", Op::Log, 1},
+        {"log10", Op::Log10, 1}, {"lg", Op::Log10, 1},    {"sqrt", Op::Sqrt, 1},
+        {"abs", Op::Abs, 1},     {"floor", Op::Floor, 1}, {"ceil", Op::Ceil, 1},
+        {"fact", Op::Fact, 1},   {"pow", Op::Pow, 2},     {"min", Op::Min, 2},
+        {"max", Op::Max, 2},
+    };
+
+    int lookupFunction(const char* name, size_t length, Op& op) {
+        for (const auto& f : functions) {
+            if (strlen(f.name) == length && strncmp(f.name, name, length) == 0) {
+                op = f.op;
+                return f.arity;
+            }
+        }
+        return 0;
+    }
+
+    ExprParser::ExprParser()
+        : _src(nullptr), _pos(0), _depth(0), _pool(nullptr), _exact_literals(false)
+    {
+    }
+
+    bool ExprParser::fail(const char* message) {
+        if (_error.message.empty()) {
+            _error.message = message;
+            _error.position = peek().begin;
+        }
+        return false;
+    }
+
+    int ExprParser::parse(const std::string& src, ExprPool& pool) {
+        _src = &src;
+        _pool = &pool;
+        _pos = 0;
+        _depth = 0;
+        _error = ParseError();
+        tokenize(src, _tokens);
+
+        int root = parseAdditive();
+        if (root < 0) return -1;
+        if (peek().kind != TokenKind::End) {
+            fail(peek().kind == TokenKind::RParen ? "unbalanced ')'" : "unexpected token");
+            return -1;
+        }
+        return root;
+    }
+
+    int ExprParser::parseAdditive() {
+        int lhs = parseMultiplicative();
+        while (lhs >= 0 && (peek().kind == TokenKind::Plus || peek().kind == TokenKind::Minus)) {
+            Op op = peek().kind == TokenKind::Plus ? Op::Add : Op::Sub;
+            _pos++;
+            int rhs = parseMultiplicative();
+            if (rhs < 0) return -1;
+            lhs = _pool->binary(op, lhs, rhs);
+        }
+        return lhs;
+    }
+
+    int ExprParser::parseMultiplicative() {
+        int lhs = parseUnary();
+        while (lhs >= 0) {
+            TokenKind kind = peek().kind;
+            int rhs;
+            if (kind == TokenKind::Star || kind == TokenKind::Slash) {
+                _pos++;
+                rhs = parseUnary();
+                if (rhs < 0) return -1;
+                lhs = _pool->binary(kind == TokenKind::Star ? Op::Mul : Op::Div, lhs, rhs);
+            } else if (kind == TokenKind::Ident || kind == TokenKind::LParen || kind == TokenKind::Number) {
+                // 隐式乘法: 2x, 2(x+1), (x+1)(x-1); 两个相邻数字不合法
+                if (kind == TokenKind::Number && _tokens[_pos - 1].kind == TokenKind::Number) {
+                    fail("missing operator");
+                    return -1;
+                }
+                rhs = parsePower();
+                if (rhs < 0) return -1;
+                lhs = _pool->binary(Op::Mul, lhs, rhs);
+            } else {
+                break;
+            }
+        }
+        return lhs;
+    }
+
+    int ExprParser::parseUnary() {
+        if (peek().kind == TokenKind::Minus || peek().kind == TokenKind::Plus) {
+            bool negate = peek().kind == TokenKind::Minus;
+            _pos++;
+            if (++_depth > EXPR_MAX_DEPTH) return fail("expression too deep"), -1;
+            int operand = parseUnary();
+            _depth--;
+            if (operand < 0) return -1;
+            return negate ? _pool->unary(Op::Neg, operand) : operand;
+        }
+        return parsePower();
+    }
+
+    int ExprParser::parsePower() {
+        int base = parsePostfix();
+        if (base < 0) return -1;
+        if (peek().kind == TokenKind::Caret) {
+            _pos++;
+            // 右结合, 指数允许带符号: 2^-x
+            if (++_depth > EXPR_MAX_DEPTH) return fail("expression too deep"), -1;
+            int exponent = parseUnary();
+            _depth--;
+            if (exponent < 0) return -1;
+            return _pool->binary(Op::Pow, base, exponent);
+        }
+        return base;
+    }
+
+    int ExprParser::parsePostfix() {
+        int operand = parsePrimary();
+        while (operand >= 0 && peek().kind == TokenKind::Bang) {
+            _pos++;
+            operand = _pool->unary(Op::Fact, operand);
+        }
+        return operand;
+    }
+
+    int ExprParser::parsePrimary() {
+        const Token token = peek();
+        switch (token.kind) {
+            case TokenKind::Number:
+                _pos++;
+                return _pool->constant(token.value, _exact_literals ? (int)token.begin : EXPR_CONST_PLAIN);
+            case TokenKind::LParen: {
+                _pos++;
+                if (++_depth > EXPR_MAX_DEPTH) return fail("expression too deep"), -1;
+                int inner = parseAdditive();
+                _depth--;
+                if (inner < 0) return -1;
+                if (peek().kind != TokenKind::RParen) return fail("missing ')'"), -1;
+                _pos++;
+                return inner;
+            }
+            case TokenKind::Ident: {
+                _pos++;
+                const char* name = _src->data() + token.begin;
+                Op op;
+                int arity = lookupFunction(name, token.length, op);
+                if (arity > 0 && peek().kind == TokenKind::LParen) {
+                    _pos++;
+                    int args[2] = {-1, -1};
+                    for (int i = 0; i < arity; i++) {
+                        if (i > 0) {
+                            if (peek().kind != TokenKind::Comma) return fail("expected ','"), -1;
+                            _pos++;
+                        }
+                        if (++_depth > EXPR_MAX_DEPTH) return fail("expression too deep"), -1;
+                        args[i] = parseAdditive();
+                        _depth--;
+                        if (args[i] < 0) return -1;
+                    }
+                    if (peek().kind != TokenKind::RParen) return fail("missing ')'"), -1;
+                    _pos++;
+                    return arity == 1 ? _pool->unary(op, args[0]) : _pool->binary(op, args[0], args[1]);
+                }
+                std::string ident(name, token.length);
+                if (ident == "pi") return _pool->constant(M_PI, _exact_literals ? EXPR_CONST_PI : EXPR_CONST_PLAIN);
+                if (ident == "e") return _pool->constant(M_E, _exact_literals ? EXPR_CONST_E : EXPR_CONST_PLAIN);
+                return _pool->variable(ident);
+            }
+            case TokenKind::End:
+                return fail("unexpected end of expression"), -1;
+            case TokenKind::Invalid:
+                return fail("invalid character"), -1;
+            default:
+                return fail("unexpected token"), -1;
+        }
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "interval.hpp"
+
+#include <algorithm>
+
+namespace calc {
+
+    // gamma 在正半轴的最小值点, fact(x) = gamma(x + 1) 在 x = GAMMA_MIN_X - 1 处取最小
+    #define GAMMA_MIN_X 1.4616321449683623
+    #define GAMMA_MIN_Y 0.8856031944108887
+
+    static inline Interval widen(Interval a) {
+        if (a.isEmpty()) return a;
+        return {std::nextafter(a.lo, -INFINITY), std::nextafter(a.hi, INFINITY)};
+    }
+
+    static inline Interval make(double a, double b) {
+        if (std::isnan(a) || std::isnan(b)) return Interval::empty();
+        return widen({std::min(a, b), std::max(a, b)});
+    }
+
+    // 单调递增函数
+    template <typename F>
+    static inline Interval increasing(Interval a, F f) {
+        return make(f(a.lo), f(a.hi));
+    }
+
+    // 与定义域 [lo, hi] 求交
+    static inline Interval clip(Interval a, double lo, double hi) {
+        if (a.hi < lo || a.lo > hi) return Interval::empty();
+        return {std::max(a.lo, lo), std::min(a.hi, hi)};
+    }
+
+    // sin 在 [lo, hi] 上的值域: 检查区间是否跨过 pi/2 + 2k pi (最大) 与 -pi/2 + 2k pi (最小)
+    static Interval sinRange(Interval a) {
+        if (!std::isfinite(a.lo) || !std::isfinite(a.hi) || a.width() >= 2.0 * M_PI) return {-1.0, 1.0};
+        double lo = std::min(std::sin(a.lo), std::sin(a.hi));
+        double hi = std::max(std::sin(a.lo), std::sin(a.hi));
+        double k_max = std::ceil((a.lo - M_PI / 2.0) / (2.0 * M_PI));
+        if (M_PI / 2.0 + 2.0 * M_PI * k_max <= a.hi) hi = 1.0;
+        double k_min = std::ceil((a.lo + M_PI / 2.0) / (2.0 * M_PI));
+        if (-M_PI / 2.0 + 2.0 * M_PI * k_min <= a.hi) lo = -1.0;
+        return widen({std::max(lo, -1.0), std::min(hi, 1.0)});
+    }
+
+    static Interval mul(Interval a, Interval b) {
+        double p[4] = {a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi};
+        // 0 * inf 视为 0
+        for (double& v : p) if (std::isnan(v)) v = 0.0;
+        return make(*std::min_element(p, p + 4), *std::max_element(p, p + 4));
+    }
+
+    static Interval div(Interval a, Interval b) {
+        if (b.contains(0.0)) {
+            if (b.lo == 0.0 && b.hi == 0.0) return Interval::empty();
+            return Interval::entire();
+        }
+        return mul(a, make(1.0 / b.hi, 1.0 / b.lo));
+    }
+
+    static Interval powInteger(Interval a, int n) {
+        if (n == 0) return Interval::point(1.0);
+        if (n < 0) return div(Interval::point(1.0), powInteger(a, -n));
+        double lo = std::pow(a.lo, n), hi = std::pow(a.hi, n);
+        if (n % 2 == 1) return make(lo, hi);
+        // 偶次幂在跨过 0 时最小值为 0
+        if (a.contains(0.0)) return widen({0.0, std::max(lo, hi)});
+        return make(lo, hi);
+    }
+
+    Interval applyUnary(Op op, Interval a) {
+        if (a.isEmpty()) return a;
+        switch (op) {
+            case Op::Neg:   return {-a.hi, -a.lo};
+            case Op::Sin:   return sinRange(a);
+            case Op::Cos:   return sinRange({a.lo + M_PI / 2.0, a.hi + M_PI / 2.0});
+            case Op::Tan: {
+                // 跨过极点 pi/2 + k pi 时为整个实轴
+                double k = std::ceil((a.lo - M_PI / 2.0) / M_PI);
+                if (!std::isfinite(a.lo) || !std::isfinite(a.hi) || M_PI / 2.0 + M_PI * k <= a.hi) return Interval::entire();
+                return increasing(a, [](double v) { return std::tan(v); });
+            }
+            case Op::Asin:  return increasing(clip(a, -1.0, 1.0), [](double v) { return std::asin(v); });
+            case Op::Acos: {
+                Interval c = clip(a, -1.0, 1.0);
+                if (c.isEmpty()) return c;
+                return make(std::acos(c.hi), std::acos(c.lo));
+            }
+            case Op::Atan:  return increasing(a, [](double v) { return std::atan(v); });
+            case Op::Sinh:  return increasing(a, [](double v) { return std::sinh(v); });
+            case Op::Cosh: {
+                double lo = std::cosh(a.lo), hi = std::cosh(a.hi);
+                if (a.contains(0.0)) return widen({1.0, std::max(lo, hi)});
+                return make(lo, hi);
+            }
+            case Op::Tanh:  return increasing(a, [](double v) { return std::tanh(v); });
+            case Op::Exp:   return increasing(a, [](double v) { return std::exp(v); });
+            case Op::Log: {
+                Interval c = clip(a, 0.0, INFINITY);
+                if (c.isEmpty()) return c;
+                return increasing(c, [](double v) { return std::log(v); });
+            }
+            case Op::Log10: {
+                Interval c = clip(a, 0.0, INFINITY);
+                if (c.isEmpty()) return c;
+                return increasing(c, [](double v) { return std::log10(v); });
+            }
+            case Op::Sqrt: {
+                Interval c = clip(a, 0.0, INFINITY);
+                if (c.isEmpty()) return c;
+                return increasing(c, [](double v) { return std::sqrt(v); });
+            }
+            case Op::Abs:
+                if (a.contains(0.0)) return {0.0, std::max(-a.lo, a.hi)};
+                return a.lo > 0.0 ? a : Interval{-a.hi, -a.lo};
+            case Op::Floor: return {std::floor(a.lo), std::floor(a.hi)};
+            case Op::Ceil:  return {std::ceil(a.lo), std::ceil(a.hi)};
+            case Op::Fact: {
+                // 只处理 gamma 在 x + 1 > 0 上的单峰部分, 负半轴上的极点交替出现, 直接放弃
+                if (a.lo <= -1.0) return Interval::entire();
+                double lo = std::tgamma(a.lo + 1.0), hi = std::tgamma(a.hi + 1.0);
+                if (a.lo + 1.0 >= GAMMA_MIN_X) return make(lo, hi);
+                if (a.hi + 1.0 <= GAMMA_MIN_X) return make(hi, lo);
+                return widen({GAMMA_MIN_Y, std::max(lo, hi)});
+            }
+            default:        return Interval::entire();
+        }
+    }
+
+    Interval applyBinary(Op op, Interval a, Interval b) {
+        if (a.isEmpty() || b.isEmpty()) return Interval::empty();
+        switch (op) {
+            case Op::Add:   return make(a.lo + b.lo, a.hi + b.hi);
+            case Op::Sub:   return make(a.lo - b.hi, a.hi - b.lo);
+            case Op::Mul:   return mul(a, b);
+            case Op::Div:   return div(a, b);
+            case Op::Pow: {
+                // 整数指数按奇偶处理, 其它情况视为 exp(b ln a), 只取 a >= 0 的部分
+                if (b.lo == b.hi && b.lo == std::floor(b.lo) && std::fabs(b.lo) <= 1024.0) return powInteger(a, (int)b.lo);
+                Interval base = clip(a, 0.0, INFINITY);
+                if (base.isEmpty()) return base;
+                double p[4] = {std::pow(base.lo, b.lo), std::pow(base.lo, b.hi), std::pow(base.hi, b.lo), std::pow(base.hi, b.hi)};
+                double lo = *std::min_element(p, p + 4), hi = *std::max_element(p, p + 4);
+                // 底数跨过 1 时 1^b = 1 也在值域内
+                if (base.contains(1.0)) lo = std::min(lo, 1.0), hi = std::max(hi, 1.0);
+                return make(lo, hi);
+            }
+            case Op::Min:   return {std::min(a.lo, b.lo), std::min(a.hi, b.hi)};
+            case Op::Max:   return {std::max(a.lo, b.lo), std::max(a.hi, b.hi)};
+            default:        return Interval::entire();
+        }
+    }
+
+    IntervalEvaluator::IntervalEvaluator()
+        : _program(nullptr)
+    {
+    }
+
+    void IntervalEvaluator::load(const Program& program) {
+        _program = &program;
+        _registers.assign(program.register_count, Interval::point(0.0));
+        for (size_t i = 0; i < program.constants.size(); i++) {
+            _registers[program.constantBase() + i] = Interval::point(program.constants[i]);
+        }
+    }
+
+    Interval IntervalEvaluator::run(const Interval* vars) {
+        const Program& program = *_program;
+        Interval* r = _registers.data();
+        std::copy(vars, vars + program.variables.size(), r);
+        for (const Instr& in : program.code) {
+            r[in.dst] = isUnary(in.op) ? applyUnary(in.op, r[in.a]) : applyBinary(in.op, r[in.a], r[in.b]);
+        }
+        return r[program.result];
+    }
+
+}
\ No newline at end of file
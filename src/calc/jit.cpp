@@ -0,0 +1,294 @@
+#include "jit.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define CALC_JIT_X64
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace calc {
+
+#ifdef CALC_JIT_X64
+
+    // 与 VM 调用同一个库函数, 保证结果逐位一致
+    template <Op OP>
+    static double unaryThunk(double a) { return applyUnary(OP, a); }
+
+    template <Op OP>
+    static double binaryThunk(double a, double b) { return applyBinary(OP, a, b); }
+
+    static void* unaryFunction(Op op) {
+        switch (op) {
+            case Op::Sin:   return (void*)&unaryThunk<Op::Sin>;
+            case Op::Cos:   return (void*)&unaryThunk<Op::Cos>;
+            case Op::Tan:   return (void*)&unaryThunk<Op::Tan>;
+            case Op::Asin:  return (void*)&unaryThunk<Op::Asin>;
+            case Op::Acos:  return (void*)&unaryThunk<Op::Acos>;
+            case Op::Atan:  return (void*)&unaryThunk<Op::Atan>;
+            case Op::Sinh:  return (void*)&unaryThunk<Op::Sinh>;
+            case Op::Cosh:  return (void*)&unaryThunk<Op::Cosh>;
+            case Op::Tanh:  return (void*)&unaryThunk<Op::Tanh>;
+            case Op::Exp:   return (void*)&unaryThunk<Op::Exp>;
+            case Op::Log:   return (void*)&unaryThunk<Op::Log>;
+            case Op::Log10: return (void*)&unaryThunk<Op::Log10>;
+            case Op::Floor: return (void*)&unaryThunk<Op::Floor>;
+            case Op::Ceil:  return (void*)&unaryThunk<Op::Ceil>;
+            case Op::Fact:  return (void*)&unaryThunk<Op::Fact>;
+            default:        return nullptr;
+        }
+    }
+
+    // 寄存器 -> 内存操作数: 变量在 [r12], 常量在 [rbx], 临时值在 [rsp]
+    enum Base : uint8_t { RBX = 3, RSP = 4, R12 = 12 };
+
+    struct Operand {
+        Base base;
+        int32_t disp;
+    };
+
+    class Assembler {
+    private:
+        std::vector<uint8_t>& _out;
+    public:
+        explicit Assembler(std::vector<uint8_t>& out) : _out(out) {}
+
+        inline void byte(uint8_t b) { _out.push_back(b); }
+
+        void bytes(std::initializer_list<uint8_t> list) {
+            _out.insert(_out.end(), list.begin(), list.end());
+        }
+
+        void imm32(uint32_t v) {
+            for (int i = 0; i < 4; i++) byte((uint8_t)(v >> (8 * i)));
+        }
+
+        void imm64(uint64_t v) {
+            for (int i = 0; i < 8; i++) byte((uint8_t)(v >> (8 * i)));
+        }
+
+        // prefix [REX] 0F opcode ModRM(mod=10, reg=xmm, rm=base) [SIB] disp32
+        void sseMem(uint8_t prefix, uint8_t opcode, int xmm, Operand m) {
+            byte(prefix);
+            if (m.base == R12) byte(0x41);
+            bytes({0x0F, opcode});
+            byte((uint8_t)(0x80 | (xmm << 3) | (m.base & 7)));
+            if ((m.base & 7) == 4) byte(0x24);
+            imm32((uint32_t)m.disp);
+        }
+
+        void sseReg(uint8_t prefix, uint8_t opcode, int dst, int src) {
+            byte(prefix);
+            bytes({0x0F, opcode});
+            byte((uint8_t)(0xC0 | (dst << 3) | src));
+        }
+
+        void movsdLoad(int xmm, Operand m) { sseMem(0xF2, 0x10, xmm, m); }
+        void movsdStore(Operand m, int xmm) { sseMem(0xF2, 0x11, xmm, m); }
+
+        void call(const void* fn) {
+            bytes({0x48, 0xB8});    // mov rax, imm64
+            imm64((uint64_t)(uintptr_t)fn);
+            bytes({0xFF, 0xD0});    // call rax
+        }
+    };
+
+    bool JitFunction::supported() {
+        return true;
+    }
+
+    bool JitFunction::compile(const Program& program) {
+        release();
+
+        // 常量表之后追加符号位与绝对值掩码
+        std::vector<double> constants = program.constants;
+        size_t sign_index = constants.size();
+        size_t abs_index = sign_index + 1;
+        uint64_t sign_bits = 0x8000000000000000ULL, abs_bits = 0x7fffffffffffffffULL;
+        double mask;
+        memcpy(&mask, &sign_bits, sizeof(mask));
+        constants.push_back(mask);
+        memcpy(&mask, &abs_bits, sizeof(mask));
+        constants.push_back(mask);
+
+        size_t temp_count = program.register_count - program.tempBase();
+        if (temp_count * 8 > 0x7fff0000 || constants.size() * 8 > 0x7fff0000) return false;
+        // 入口 rsp = 8 mod 16, 压入两个寄存器后再减去 frame, 使调用时栈按 16 字节对齐
+        uint32_t frame = (uint32_t)(((temp_count * 8 + 15) & ~(size_t)15) + 8);
+
+        auto operand = [&](uint16_t reg) -> Operand {
+            if (reg < program.constantBase()) return {R12, (int32_t)(reg * 8)};
+            if (reg < program.tempBase()) return {RBX, (int32_t)((reg - program.constantBase()) * 8)};
+            return {RSP, (int32_t)((reg - program.tempBase()) * 8)};
+        };
+        Operand sign_mask = {RBX, (int32_t)(sign_index * 8)};
+        Operand abs_mask = {RBX, (int32_t)(abs_index * 8)};
+
+        std::vector<uint8_t> code;
+        Assembler as(code);
+        as.bytes({0x53});                       // push rbx
+        as.bytes({0x41, 0x54});                 // push r12
+        as.bytes({0x49, 0x89, 0xFC});           // mov r12, rdi
+        as.bytes({0x48, 0xBB});                 // mov rbx, imm64 (常量表地址, 映射后回填)
+        size_t constant_patch = code.size();
+        as.imm64(0);
+        as.bytes({0x48, 0x81, 0xEC});           // sub rsp, imm32
+        as.imm32(frame);
+
+        for (const Instr& in : program.code) {
+            Operand a = operand(in.a);
+            Operand b = operand(in.b);
+            Operand dst = operand(in.dst);
+            switch (in.op) {
+                case Op::Add: as.movsdLoad(0, a); as.sseMem(0xF2, 0x58, 0, b); break;
+                case Op::Mul: as.movsdLoad(0, a); as.sseMem(0xF2, 0x59, 0, b); break;
+                case Op::Sub: as.movsdLoad(0, a); as.sseMem(0xF2, 0x5C, 0, b); break;
+                case Op::Div: as.movsdLoad(0, a); as.sseMem(0xF2, 0x5E, 0, b); break;
+                // minsd / maxsd 返回第二个操作数当比较不成立时, 与 std::min(a, b) / std::max(a, b) 一致
+                case Op::Min: as.movsdLoad(0, b); as.sseMem(0xF2, 0x5D, 0, a); break;
+                case Op::Max: as.movsdLoad(0, b); as.sseMem(0xF2, 0x5F, 0, a); break;
+                case Op::Sqrt: as.sseMem(0xF2, 0x51, 0, a); break;
+                case Op::Neg:
+                    as.movsdLoad(0, a);
+                    as.movsdLoad(1, sign_mask);
+                    as.sseReg(0x66, 0x57, 0, 1);    // xorpd xmm0, xmm1
+                    break;
+                case Op::Abs:
+                    as.movsdLoad(0, a);
+                    as.movsdLoad(1, abs_mask);
+                    as.sseReg(0x66, 0x54, 0, 1);    // andpd xmm0, xmm1
+                    break;
+                case Op::Pow:
+                    as.movsdLoad(0, a);
+                    as.movsdLoad(1, b);
+                    as.call((void*)&binaryThunk<Op::Pow>);
+                    break;
+                default: {
+                    void* fn = unaryFunction(in.op);
+                    if (!fn) return false;
+                    as.movsdLoad(0, a);
+                    as.call(fn);
+                    break;
+                }
+            }
+            as.movsdStore(dst, 0);
+        }
+
+        Operand result = operand(program.result);
+        as.movsdLoad(0, result);
+        as.bytes({0x48, 0x81, 0xC4});           // add rsp, imm32
+        as.imm32(frame);
+        as.bytes({0x41, 0x5C});                 // pop r12
+        as.bytes({0x5B});                       // pop rbx
+        as.bytes({0xC3});                       // ret
+
+        size_t constant_offset = (code.size() + 15) & ~(size_t)15;
+        size_t total = constant_offset + constants.size() * sizeof(double);
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t size = (total + page - 1) / page * page;
+
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) return false;
+
+        uint8_t* base = (uint8_t*)memory;
+        uint64_t constant_address = (uint64_t)(uintptr_t)(base + constant_offset);
+        memcpy(&code[constant_patch], &constant_address, sizeof(constant_address));
+        memcpy(base, code.data(), code.size());
+        memcpy(base + constant_offset, constants.data(), constants.size() * sizeof(double));
+
+        // W^X: 写完后改为只读可执行, 被系统拒绝时放弃
+        if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+            munmap(memory, size);
+            return false;
+        }
+        _memory = memory;
+        _size = size;
+        _entry = (Entry)memory;
+        return true;
+    }
+
+    void JitFunction::release() {
+        if (_memory) munmap(_memory, _size);
+        _memory = nullptr;
+        _size = 0;
+        _entry = nullptr;
+    }
+
+#else
+
+    bool JitFunction::supported() {
+        return false;
+    }
+
+    bool JitFunction::compile(const Program&) {
+        return false;
+    }
+
+    void JitFunction::release() {
+        _memory = nullptr;
+        _size = 0;
+        _entry = nullptr;
+    }
+
+#endif
+
+    JitFunction::JitFunction()
+        : _memory(nullptr), _size(0), _entry(nullptr)
+    {
+    }
+
+    JitFunction::~JitFunction() {
+        release();
+    }
+
+    size_t crossCheck(const Program& program, const JitFunction& jit, VM& vm, size_t samples) {
+        static const double probes[] = {0.0, 1.0, -1.0, 0.5, -2.75, 3.14159, 10.0, -123.456, 1e-3, 1e6};
+        const size_t probe_count = sizeof(probes) / sizeof(probes[0]);
+        std::vector<double> vars(program.variables.size());
+        size_t mismatches = 0;
+        vm.load(program);
+        for (size_t s = 0; s < samples; s++) {
+            // 每个变量取不同的探测值组合, 避免所有变量相同
+            for (size_t v = 0; v < vars.size(); v++) {
+                vars[v] = probes[(s * (v + 1) + v * 3) % probe_count] * (1.0 + 0.01 * (double)(s / probe_count));
+            }
+            double expected = vm.run(vars.data());
+            double actual = jit(vars.data());
+            if (std::isnan(expected) && std::isnan(actual)) continue;
+            if (memcmp(&expected, &actual, sizeof(double)) != 0) mismatches++;
+        }
+        return mismatches;
+    }
+
+    bool JitFunction::compileVerified(const Program& program) {
+        if (!supported() || !compile(program)) return false;
+        VM vm;
+        if (crossCheck(program, *this, vm, 64) == 0) return true;
+        release();
+        return false;
+    }
+
+    Evaluator::Evaluator()
+        : _code(nullptr)
+    {
+    }
+
+    void Evaluator::load(const Program& program, bool allow_jit) {
+        _code = nullptr;
+        _jit.release();
+        if (allow_jit && _jit.compileVerified(program)) _code = &_jit;
+        _vm.load(program);
+    }
+
+    void Evaluator::load(const Program& program, const JitFunction& shared) {
+        _jit.release();
+        _code = shared.ready() ? &shared : nullptr;
+        _vm.load(program);
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "lexer.hpp"
+
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+namespace calc {
+
+    size_t lexToken(const char* src, size_t length, size_t pos, Token& token) {
+        while (pos < length && isspace((unsigned char)src[pos])) pos++;
+        token.begin = (uint32_t)pos;
+        token.length = 1;
+        token.value = 0.0;
+        if (pos >= length) {
+            token.kind = TokenKind::End;
+            token.length = 0;
+            return pos;
+        }
+
+        char c = src[pos];
+        if (isdigit((unsigned char)c) || (c == '.' && pos + 1 < length && isdigit((unsigned char)src[pos + 1]))) {
+            size_t end = pos;
+            while (end < length && isdigit((unsigned char)src[end])) end++;
+            if (end < length && src[end] == '.') {
+                end++;
+                while (end < length && isdigit((unsigned char)src[end])) end++;
+            }
+            // 指数部分只在后面确实跟着数字时才读取, 否则 e 作为标识符
+            if (end < length && (src[end] == 'e' || src[end] == 'E')) {
+                size_t exp = end + 1;
+                if (exp < length && (src[exp] == '+' || src[exp] == '-')) exp++;
+                if (exp < length && isdigit((unsigned char)src[exp])) {
+                    end = exp;
+                    while (end < length && isdigit((unsigned char)src[end])) end++;
+                }
+            }
+            // from_chars 不受 locale 影响, 也不需要复制出以 0 结尾的缓冲区
+            token.kind = TokenKind::Number;
+            token.length = (uint32_t)(end - pos);
+            auto result = std::from_chars(src + pos, src + end, token.value);
+            if (result.ec == std::errc::result_out_of_range) token.value = strtod(std::string(src + pos, end - pos).c_str(), nullptr);
+            return end;
+        }
+        if (isalpha((unsigned char)c) || c == '_') {
+            size_t end = pos;
+            while (end < length && (isalnum((unsigned char)src[end]) || src[end] == '_')) end++;
+            token.kind = TokenKind::Ident;
+            token.length = (uint32_t)(end - pos);
+            return end;
+        }
+
+        switch (c) {
+            case '+': token.kind = TokenKind::Plus; break;
+            case '-': token.kind = TokenKind::Minus; break;
+            case '*': token.kind = TokenKind::Star; break;
+            case '/': token.kind = TokenKind::Slash; break;
+            case '^': token.kind = TokenKind::Caret; break;
+            case '(': token.kind = TokenKind::LParen; break;
+            case ')': token.kind = TokenKind::RParen; break;
+            case ',': token.kind = TokenKind::Comma; break;
+            case '!': token.kind = TokenKind::Bang; break;
+            default:  token.kind = TokenKind::Invalid; break;
+        }
+        return pos + 1;
+    }
+
+    void tokenize(const std::string& src, std::vector<Token>& tokens) {
+        tokens.clear();
+        size_t pos = 0;
+        Token token;
+        do {
+            pos = lexToken(src.data(), src.size(), pos, token);
+            tokens.push_back(token);
+        } while (token.kind != TokenKind::End);
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,340 @@
+#include "live_parser.hpp"
+
+#include <cmath>
+
+#include "expr_parser.hpp"
+
+namespace calc {
+
+    static int precedence(Op op) {
+        switch (op) {
+            case Op::Add:
+            case Op::Sub: return 1;
+            case Op::Mul:
+            case Op::Div: return 2;
+            case Op::Neg: return 3;
+            case Op::Pow: return 4;
+            default:      return 0;
+        }
+    }
+
+    IncrementalParser::IncrementalParser()
+        : _preview_dirty(true)
+    {
+        clear();
+    }
+
+    void IncrementalParser::pushOperand(State& state, Operand operand) {
+        _operands.push_back({operand, state.operands});
+        state.operands = (int)_operands.size() - 1;
+    }
+
+    IncrementalParser::Operand IncrementalParser::popOperand(State& state) {
+        const Cell<Operand>& cell = _operands[state.operands];
+        state.operands = cell.next;
+        return cell.item;
+    }
+
+    void IncrementalParser::pushOperator(State& state, Operator op) {
+        _operators.push_back({op, state.operators});
+        state.operators = (int)_operators.size() - 1;
+    }
+
+    bool IncrementalParser::fail(State& state, const char* message, uint32_t position) {
+        if (!state.error) {
+            state.error = message;
+            state.error_position = position;
+        }
+        return false;
+    }
+
+    const char* IncrementalParser::unexpected(const State& state) const {
+        // 与 ExprParser 一致: 括号内出现多余的记号时报告缺少的闭合符号
+        for (int cell = state.operators; cell >= 0; cell = _operators[cell].next) {
+            const Operator& op = _operators[cell].item;
+            if (op.kind == Kind::LParen) return "missing ')'";
+            if (op.kind == Kind::Call) return op.args + 1 < op.arity ? "expected ','" : "missing ')'";
+        }
+        return "unexpected token";
+    }
+
+    void IncrementalParser::reduce(State& state) {
+        Operator op = *topOperator(state);
+        popOperator(state);
+        if (op.kind == Kind::Neg) {
+            Operand a = popOperand(state);
+            pushOperand(state, {_pool.unary(Op::Neg, a.node), -a.value, a.constant});
+            return;
+        }
+        Operand b = popOperand(state);
+        Operand a = popOperand(state);
+        pushOperand(state, {_pool.binary(op.op, a.node, b.node), applyBinary(op.op, a.value, b.value),
+                            a.constant && b.constant});
+    }
+
+    void IncrementalParser::pushBinary(State& state, Op op, uint32_t position) {
+        int p = precedence(op);
+        for (const Operator* top = topOperator(state); top; top = topOperator(state)) {
+            if (top->kind != Kind::Binary && top->kind != Kind::Neg) break;
+            int q = precedence(top->op);
+            // 乘方右结合, 其余左结合
+            if (q > p || (q == p && op != Op::Pow)) reduce(state);
+            else break;
+        }
+        pushOperator(state, {Kind::Binary, op, 2, 0, position, 1});
+        state.expect_operand = true;
+    }
+
+    void IncrementalParser::resolvePending(State& state) {
+        Operator pending = *topOperator(state);
+        popOperator(state);
+        int node = _pool.variable(_text.substr(pending.begin, pending.length));
+        pushOperand(state, {node, NAN, false});
+        state.expect_operand = false;
+    }
+
+    void IncrementalParser::operand(State& state, const Token& token) {
+        switch (token.kind) {
+            case TokenKind::Number:
+                pushOperand(state, {_pool.constant(token.value), token.value, true});
+                state.expect_operand = false;
+                break;
+            case TokenKind::Ident: {
+                Op op;
+                int arity = lookupFunction(_text.data() + token.begin, token.length, op);
+                if (arity > 0) {
+                    pushOperator(state, {Kind::Pending, op, (uint8_t)arity, 0, token.begin, token.length});
+                    state.expect_operand = false;
+                    break;
+                }
+                std::string name = _text.substr(token.begin, token.length);
+                if (name == "pi" || name == "e") {
+                    double value = name == "pi" ? M_PI : M_E;
+                    pushOperand(state, {_pool.constant(value), value, true});
+                } else {
+                    pushOperand(state, {_pool.variable(name), NAN, false});
+                }
+                state.expect_operand = false;
+                break;
+            }
+            case TokenKind::LParen:
+                pushOperator(state, {Kind::LParen, Op::Const, 0, 0, token.begin, 1});
+                break;
+            case TokenKind::Minus:
+                pushOperator(state, {Kind::Neg, Op::Neg, 1, 0, token.begin, 1});
+                break;
+            case TokenKind::Plus:
+                break;
+            case TokenKind::Invalid:
+                fail(state, "invalid character", token.begin);
+                break;
+            default:
+                fail(state, "unexpected token", token.begin);
+                break;
+        }
+    }
+
+    void IncrementalParser::step(State& state, const Token& token) {
+        if (state.error) return;
+
+        const Operator* top = topOperator(state);
+        if (top && top->kind == Kind::Pending) {
+            if (token.kind == TokenKind::LParen) {
+                Operator call = *top;
+                popOperator(state);
+                call.kind = Kind::Call;
+                pushOperator(state, call);
+                state.expect_operand = true;
+                state.after_number = false;
+                return;
+            }
+            resolvePending(state);
+        }
+
+        bool after_number = state.after_number;
+        state.after_number = token.kind == TokenKind::Number;
+        if (state.expect_operand) {
+            operand(state, token);
+            return;
+        }
+
+        switch (token.kind) {
+            case TokenKind::Plus:  pushBinary(state, Op::Add, token.begin); break;
+            case TokenKind::Minus: pushBinary(state, Op::Sub, token.begin); break;
+            case TokenKind::Star:  pushBinary(state, Op::Mul, token.begin); break;
+            case TokenKind::Slash: pushBinary(state, Op::Div, token.begin); break;
+            case TokenKind::Caret: pushBinary(state, Op::Pow, token.begin); break;
+            case TokenKind::Bang: {
+                Operand a = popOperand(state);
+                pushOperand(state, {_pool.unary(Op::Fact, a.node), applyUnary(Op::Fact, a.value), a.constant});
+                break;
+            }
+            case TokenKind::RParen: {
+                while (topOperator(state) && (topOperator(state)->kind == Kind::Binary || topOperator(state)->kind == Kind::Neg)) {
+                    reduce(state);
+                }
+                const Operator* open = topOperator(state);
+                if (!open) {
+                    fail(state, "unbalanced ')'", token.begin);
+                    break;
+                }
+                Operator bracket = *open;
+                if (bracket.kind == Kind::Call && bracket.args + 1 != bracket.arity) {
+                    fail(state, "expected ','", token.begin);
+                    break;
+                }
+                popOperator(state);
+                if (bracket.kind == Kind::Call) {
+                    if (bracket.arity == 1) {
+                        Operand a = popOperand(state);
+                        pushOperand(state, {_pool.unary(bracket.op, a.node), applyUnary(bracket.op, a.value), a.constant});
+                    } else {
+                        Operand b = popOperand(state);
+                        Operand a = popOperand(state);
+                        pushOperand(state, {_pool.binary(bracket.op, a.node, b.node), applyBinary(bracket.op, a.value, b.value),
+                                            a.constant && b.constant});
+                    }
+                }
+                break;
+            }
+            case TokenKind::Comma: {
+                while (topOperator(state) && (topOperator(state)->kind == Kind::Binary || topOperator(state)->kind == Kind::Neg)) {
+                    reduce(state);
+                }
+                const Operator* open = topOperator(state);
+                if (!open) {
+                    fail(state, "unexpected token", token.begin);
+                } else if (open->kind != Kind::Call || open->args + 1 >= open->arity) {
+                    fail(state, "missing ')'", token.begin);
+                } else {
+                    Operator call = *open;
+                    popOperator(state);
+                    call.args++;
+                    pushOperator(state, call);
+                    state.expect_operand = true;
+                }
+                break;
+            }
+            case TokenKind::Number:
+                if (after_number) {
+                    fail(state, "missing operator", token.begin);
+                    break;
+                }
+                // fallthrough
+            case TokenKind::Ident:
+            case TokenKind::LParen:
+                // 隐式乘法: 2x, 2(x+1), (x+1)(x-1)
+                pushBinary(state, Op::Mul, token.begin);
+                operand(state, token);
+                break;
+            default:
+                fail(state, unexpected(state), token.begin);
+                break;
+        }
+    }
+
+    void IncrementalParser::reparseFrom(size_t first) {
+        size_t pos = 0;
+        if (first < _tokens.size()) pos = _tokens[first].begin;
+        else if (first > 0) pos = _tokens[first - 1].begin + _tokens[first - 1].length;
+
+        _tokens.resize(first);
+        _states.resize(first + 1);
+        State state = _states[first];
+        _operands.resize(state.operand_cells);
+        _operators.resize(state.operator_cells);
+        _pool.truncate(state.pool_size);
+
+        Token token;
+        for (;;) {
+            pos = lexToken(_text.data(), _text.size(), pos, token);
+            if (token.kind == TokenKind::End) break;
+            step(state, token);
+            _tokens.push_back(token);
+            state.operand_cells = _operands.size();
+            state.operator_cells = _operators.size();
+            state.pool_size = _pool.size();
+            _states.push_back(state);
+        }
+        _preview_dirty = true;
+    }
+
+    void IncrementalParser::assign(const std::string& text) {
+        _text = text;
+        _tokens.clear();
+        _states.assign(1, State());
+        _operands.clear();
+        _operators.clear();
+        _pool.clear();
+        reparseFrom(0);
+    }
+
+    void IncrementalParser::clear() {
+        assign(std::string());
+    }
+
+    void IncrementalParser::append(const char* text) {
+        size_t edit = _text.size();
+        _text += text;
+
+        // 与末尾相接的记号可能被延长, 如 "12" + "3"
+        size_t first = _tokens.size();
+        while (first > 0 && _tokens[first - 1].begin + _tokens[first - 1].length >= edit) first--;
+        // "1e-" + "5" 会把数字, e, 符号三个记号合并为一个数字, 额外回退两个相邻的记号
+        for (int i = 0; i < 2 && first > 0 && first < _tokens.size(); i++) {
+            if (_tokens[first - 1].begin + _tokens[first - 1].length != _tokens[first].begin) break;
+            first--;
+        }
+        reparseFrom(first);
+    }
+
+    void IncrementalParser::pop(size_t count) {
+        size_t edit = count < _text.size() ? _text.size() - count : 0;
+        _text.resize(edit);
+
+        size_t first = _tokens.size();
+        while (first > 0 && _tokens[first - 1].begin + _tokens[first - 1].length >= edit) first--;
+        for (int i = 0; i < 2 && first > 0 && first < _tokens.size(); i++) {
+            if (_tokens[first - 1].begin + _tokens[first - 1].length != _tokens[first].begin) break;
+            first--;
+        }
+        reparseFrom(first);
+    }
+
+    const LivePreview& IncrementalParser::preview() {
+        if (!_preview_dirty) return _preview;
+        _preview_dirty = false;
+        _preview = LivePreview();
+
+        // 在最后状态的副本上补全, 新建的节点与链表单元在下次编辑时被截断
+        State state = _states.back();
+        if (!state.error) {
+            const Operator* top = topOperator(state);
+            if (top && top->kind == Kind::Pending) resolvePending(state);
+        }
+        if (!state.error && state.expect_operand) {
+            fail(state, "unexpected end of expression", (uint32_t)_text.size());
+        }
+        while (!state.error && topOperator(state)) {
+            Kind kind = topOperator(state)->kind;
+            if (kind == Kind::LParen || kind == Kind::Call) {
+                fail(state, unexpected(state), (uint32_t)_text.size());
+                break;
+            }
+            reduce(state);
+        }
+        if (state.error) {
+            _preview.error = state.error;
+            _preview.position = state.error_position;
+            return _preview;
+        }
+
+        Operand result = _operands[state.operands].item;
+        _preview.valid = true;
+        _preview.constant = result.constant;
+        _preview.value = result.value;
+        _preview.root = result.node;
+        return _preview;
+    }
+
+}
\ No newline at end of file
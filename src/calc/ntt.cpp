@@ -0,0 +1,148 @@
+#include "ntt.hpp"
+
+#include <vector>
+
+namespace calc {
+
+    // 32 位 Montgomery 模乘, R = 2^32
+    struct Modulus {
+        uint32_t p;
+        uint32_t p_inv;     // -p^-1 mod 2^32
+        uint32_t r2;        // R^2 mod p
+        uint32_t root;      // 原根
+
+        constexpr Modulus(uint32_t mod, uint32_t g)
+            : p(mod), p_inv(negInverse(mod)), r2((uint32_t)(((unsigned __int128)1 << 64) % mod)), root(g)
+        {
+        }
+
+        static constexpr uint32_t negInverse(uint32_t mod) {
+            uint32_t inv = mod;
+            for (int i = 0; i < 5; i++) inv *= 2 - mod * inv;
+            return (uint32_t)(0u - inv);
+        }
+
+        inline uint32_t reduce(uint64_t t) const {
+            uint32_t m = (uint32_t)t * p_inv;
+            uint32_t r = (uint32_t)((t + (uint64_t)m * p) >> 32);
+            return r >= p ? r - p : r;
+        }
+        inline uint32_t mul(uint32_t a, uint32_t b) const { return reduce((uint64_t)a * b); }
+        inline uint32_t to(uint32_t a) const { return mul(a % p, r2); }
+        inline uint32_t from(uint32_t a) const { return reduce(a); }
+        inline uint32_t add(uint32_t a, uint32_t b) const { uint32_t r = a + b; return r >= p ? r - p : r; }
+        inline uint32_t sub(uint32_t a, uint32_t b) const { return a >= b ? a - b : a + p - b; }
+
+        uint32_t pow(uint32_t base, uint64_t e) const {
+            uint32_t result = to(1), b = base;
+            while (e) {
+                if (e & 1) result = mul(result, b);
+                b = mul(b, b);
+                e >>= 1;
+            }
+            return result;
+        }
+    };
+
+    static constexpr Modulus MOD1(998244353u, 3);
+    static constexpr Modulus MOD2(167772161u, 3);
+    static constexpr Modulus MOD3(469762049u, 3);
+
+    // 原地变换, 值处于 Montgomery 域; 正变换为 DIF 输出位反转顺序, 逆变换为 DIT 接受位反转顺序, 省去重排
+    static void transform(const Modulus& m, uint32_t* a, size_t n, bool inverse) {
+        std::vector<uint32_t> roots(n / 2);
+        uint32_t g = m.pow(m.to(m.root), (m.p - 1) / n);
+        if (inverse) g = m.pow(g, m.p - 2);
+
+        if (!inverse) {
+            for (size_t len = n; len >= 2; len >>= 1) {
+                size_t half = len >> 1;
+                uint32_t w = m.pow(g, n / len);
+                roots[0] = m.to(1);
+                for (size_t j = 1; j < half; j++) roots[j] = m.mul(roots[j - 1], w);
+                for (size_t i = 0; i < n; i += len) {
+                    for (size_t j = 0; j < half; j++) {
+                        uint32_t u = a[i + j], v = a[i + j + half];
+                        a[i + j] = m.add(u, v);
+                        a[i + j + half] = m.mul(m.sub(u, v), roots[j]);
+                    }
+                }
+            }
+        } else {
+            for (size_t len = 2; len <= n; len <<= 1) {
+                size_t half = len >> 1;
+                uint32_t w = m.pow(g, n / len);
+                roots[0] = m.to(1);
+                for (size_t j = 1; j < half; j++) roots[j] = m.mul(roots[j - 1], w);
+                for (size_t i = 0; i < n; i += len) {
+                    for (size_t j = 0; j < half; j++) {
+                        uint32_t u = a[i + j], v = m.mul(a[i + j + half], roots[j]);
+                        a[i + j] = m.add(u, v);
+                        a[i + j + half] = m.sub(u, v);
+                    }
+                }
+            }
+            uint32_t n_inv = m.pow(m.to((uint32_t)n), m.p - 2);
+            for (size_t i = 0; i < n; i++) a[i] = m.mul(a[i], n_inv);
+        }
+    }
+
+    static void convolve(const Modulus& m, const uint32_t* a, size_t na, const uint32_t* b, size_t nb, size_t n,
+                         bool square, std::vector<uint32_t>& out) {
+        out.assign(n, 0);
+        for (size_t i = 0; i < na; i++) out[i] = m.to(a[i]);
+        transform(m, out.data(), n, false);
+        if (square) {
+            for (size_t i = 0; i < n; i++) out[i] = m.mul(out[i], out[i]);
+        } else {
+            std::vector<uint32_t> fb(n, 0);
+            for (size_t i = 0; i < nb; i++) fb[i] = m.to(b[i]);
+            transform(m, fb.data(), n, false);
+            for (size_t i = 0; i < n; i++) out[i] = m.mul(out[i], fb[i]);
+        }
+        transform(m, out.data(), n, true);
+        for (size_t i = 0; i < n; i++) out[i] = m.from(out[i]);
+    }
+
+    static uint32_t powMod(uint64_t base, uint64_t e, uint64_t mod) {
+        uint64_t result = 1;
+        base %= mod;
+        while (e) {
+            if (e & 1) result = result * base % mod;
+            base = base * base % mod;
+            e >>= 1;
+        }
+        return (uint32_t)result;
+    }
+
+    void nttMultiply(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+        size_t n = 1;
+        while (n < na + nb) n <<= 1;
+        bool square = a == b && na == nb;
+
+        std::vector<uint32_t> r1, r2, r3;
+        convolve(MOD1, a, na, b, nb, n, square, r1);
+        convolve(MOD2, a, na, b, nb, n, square, r2);
+        convolve(MOD3, a, na, b, nb, n, square, r3);
+
+        // Garner: x = r1 + p1 * k2 + p1 * p2 * k3, 每一项不超过 n * (1e9)^2 < p1 * p2 * p3
+        const uint64_t p1 = MOD1.p, p2 = MOD2.p, p3 = MOD3.p;
+        const uint64_t inv_p1_mod_p2 = powMod(p1, p2 - 2, p2);
+        const uint64_t p1p2_mod_p3 = p1 * p2 % p3;
+        const uint64_t inv_p1p2_mod_p3 = powMod(p1p2_mod_p3, p3 - 2, p3);
+        const unsigned __int128 p1p2 = (unsigned __int128)p1 * p2;
+
+        // 进位不超过 p1 * p2 * p3 / 1e9 < 2^63
+        uint64_t carry = 0;
+        for (size_t i = 0; i < na + nb; i++) {
+            uint64_t x1 = r1[i];
+            uint64_t k2 = (r2[i] + p2 - x1 % p2) % p2 * inv_p1_mod_p2 % p2;
+            uint64_t x12 = x1 + p1 * k2;
+            uint64_t k3 = (r3[i] + p3 - x12 % p3) % p3 * inv_p1p2_mod_p3 % p3;
+            unsigned __int128 value = (unsigned __int128)x12 + p1p2 * k3 + carry;
+            carry = (uint64_t)(value / 1000000000u);
+            out[i] = (uint32_t)(value - (unsigned __int128)carry * 1000000000u);
+        }
+    }
+
+}
\ No newline at end of file
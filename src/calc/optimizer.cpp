@@ -0,0 +1,195 @@
+#include "optimizer.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace calc {
+
+    static std::vector<char> reachable(const ExprPool& pool, int root) {
+        std::vector<char> live(root + 1, 0);
+        live[root] = 1;
+        for (int i = root; i >= 0; i--) {
+            if (!live[i]) continue;
+            const Node& node = pool[i];
+            if (node.a >= 0) live[node.a] = 1;
+            if (node.b >= 0) live[node.b] = 1;
+        }
+        return live;
+    }
+
+    static size_t countOperations(const ExprPool& pool, const std::vector<char>& live) {
+        size_t count = 0;
+        for (size_t i = 0; i < live.size(); i++) {
+            if (live[i] && pool[(int)i].op != Op::Const && pool[(int)i].op != Op::Var) count++;
+        }
+        return count;
+    }
+
+    int extract(const ExprPool& src, int root, ExprPool& dst) {
+        dst.clear();
+        for (const std::string& name : src.variables()) dst.declare(name);
+        if (root < 0) return -1;
+
+        std::vector<char> live = reachable(src, root);
+        std::vector<int> remap(root + 1, -1);
+        for (int i = 0; i <= root; i++) {
+            if (!live[i]) continue;
+            const Node& node = src[i];
+            switch (node.op) {
+                case Op::Const: remap[i] = dst.constant(node.value); break;
+                case Op::Var:   remap[i] = dst.variable(src.variables()[node.slot]); break;
+                default:
+                    remap[i] = isUnary(node.op) ? dst.unary(node.op, remap[node.a])
+                                                : dst.binary(node.op, remap[node.a], remap[node.b]);
+                    break;
+            }
+        }
+        return remap[root];
+    }
+
+    class Simplifier {
+    private:
+        ExprPool& _pool;
+        bool _fast_math;
+    private:
+        inline const Node& at(int index) const { return _pool[index]; }
+        inline bool isConst(int index) const { return at(index).op == Op::Const; }
+        inline bool isConst(int index, double value) const { return isConst(index) && at(index).value == value; }
+        // 区分 +0 与 -0: x + (-0) 与 x - (+0) 对任何 x 都等于 x, 换成另一个符号的零时 x = -0 的结果会变
+        inline bool isZero(int index, bool negative) const {
+            return isConst(index, 0.0) && std::signbit(at(index).value) == negative;
+        }
+
+        // 小整数次幂展开为乘法, 结果共享平方项
+        int power(int base, int n) {
+            if (n < 0) return binary(Op::Div, _pool.constant(1.0), power(base, -n));
+            if (n == 1) return base;
+            int half = power(base, n / 2);
+            int square = binary(Op::Mul, half, half);
+            return n % 2 ? binary(Op::Mul, square, base) : square;
+        }
+    public:
+        Simplifier(ExprPool& pool, bool fast_math) : _pool(pool), _fast_math(fast_math) {}
+
+        int unary(Op op, int a) {
+            const Node& na = at(a);
+            if (na.op == Op::Const) return _pool.constant(applyUnary(op, na.value));
+            switch (op) {
+                case Op::Neg:
+                    if (na.op == Op::Neg) return na.a;
+                    break;
+                case Op::Abs:
+                    if (na.op == Op::Abs) return a;
+                    if (na.op == Op::Neg) return unary(Op::Abs, na.a);
+                    break;
+                case Op::Floor:
+                case Op::Ceil:
+                    // 取整后的值再取整不变
+                    if (na.op == Op::Floor || na.op == Op::Ceil) return a;
+                    break;
+                default:
+                    break;
+            }
+            return _pool.unary(op, a);
+        }
+
+        int binary(Op op, int a, int b) {
+            if (isConst(a) && isConst(b)) return _pool.constant(applyBinary(op, at(a).value, at(b).value));
+            switch (op) {
+                // 默认的改写都必须与解释器逐值一致 (nan 只要求仍为 nan), _fast_math 下的改写只保证有限输入的结果相差几个 ulp
+                case Op::Add:
+                    if (isZero(a, true)) return b;
+                    if (isZero(b, true)) return a;
+                    if (at(b).op == Op::Neg) return binary(Op::Sub, a, at(b).a);
+                    if (at(a).op == Op::Neg) return binary(Op::Sub, b, at(a).a);
+                    break;
+                case Op::Sub:
+                    if (isZero(b, false)) return a;
+                    if (isZero(a, true)) return unary(Op::Neg, b);
+                    if (at(b).op == Op::Neg) return binary(Op::Add, a, at(b).a);
+                    break;
+                case Op::Mul:
+                    // x*0 对 inf / nan 应为 nan, 对负数应为 -0
+                    if (_fast_math && (isConst(a, 0.0) || isConst(b, 0.0))) return _pool.constant(0.0);
+                    if (isConst(a, 1.0)) return b;
+                    if (isConst(b, 1.0)) return a;
+                    if (isConst(a, -1.0)) return unary(Op::Neg, b);
+                    if (isConst(b, -1.0)) return unary(Op::Neg, a);
+                    if (at(a).op == Op::Neg && at(b).op == Op::Neg) return binary(Op::Mul, at(a).a, at(b).a);
+                    break;
+                case Op::Div:
+                    if (isConst(b, 1.0)) return a;
+                    if (isConst(b, -1.0)) return unary(Op::Neg, a);
+                    if (isConst(b)) {
+                        // 只有 2 的整数次幂的倒数是精确的, 此时 x*(1/c) 与 x/c 的舍入相同, 其它常数相差至多 1 ulp
+                        int exponent;
+                        double mantissa = std::frexp(at(b).value, &exponent);
+                        double inverse = 1.0 / at(b).value;
+                        if ((_fast_math || std::fabs(mantissa) == 0.5) && std::isnormal(inverse)) {
+                            return binary(Op::Mul, a, _pool.constant(inverse));
+                        }
+                    }
+                    break;
+                case Op::Pow:
+                    // pow(x, 0) 与 pow(1, y) 对任何输入 (包括 nan) 都为 1
+                    if (isConst(b, 0.0) || isConst(a, 1.0)) return _pool.constant(1.0);
+                    if (isConst(b, 1.0)) return a;
+                    // std::pow 并非总是正确舍入, x^2 -> x*x 之类的展开会改变末位, 只在 _fast_math 下进行
+                    if (_fast_math && isConst(b)) {
+                        double n = at(b).value;
+                        if (n == std::floor(n) && std::fabs(n) <= 4.0) return power(a, (int)n);
+                    }
+                    break;
+                case Op::Min:
+                case Op::Max:
+                    if (a == b) return a;
+                    break;
+                default:
+                    break;
+            }
+            return _pool.binary(op, a, b);
+        }
+    };
+
+    int optimize(const ExprPool& src, int root, ExprPool& dst, bool fast_math, OptimizeStats* stats) {
+        if (root < 0) {
+            dst.clear();
+            return -1;
+        }
+
+        ExprPool scratch;
+        for (const std::string& name : src.variables()) scratch.declare(name);
+        Simplifier simplifier(scratch, fast_math);
+
+        std::vector<char> live = reachable(src, root);
+        std::vector<int> remap(root + 1, -1);
+        std::vector<size_t> tree_size(root + 1, 0);
+        for (int i = 0; i <= root; i++) {
+            if (!live[i]) continue;
+            const Node& node = src[i];
+            switch (node.op) {
+                case Op::Const: remap[i] = scratch.constant(node.value); break;
+                case Op::Var:   remap[i] = scratch.variable(src.variables()[node.slot]); break;
+                default:
+                    if (isUnary(node.op)) {
+                        remap[i] = simplifier.unary(node.op, remap[node.a]);
+                        tree_size[i] = tree_size[node.a] + 1;
+                    } else {
+                        remap[i] = simplifier.binary(node.op, remap[node.a], remap[node.b]);
+                        tree_size[i] = tree_size[node.a] + tree_size[node.b] + 1;
+                    }
+                    break;
+            }
+        }
+
+        // 化简过程中被替换掉的节点仍留在 scratch 中, 重新抽取可达部分
+        int result = extract(scratch, remap[root], dst);
+        if (stats) {
+            stats->tree_nodes = tree_size[root];
+            stats->before = countOperations(src, live);
+            stats->after = countOperations(dst, reachable(dst, result));
+        }
+        return result;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,432 @@
+#include "solver.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+#include "dual.hpp"
+#include "expr_parser.hpp"
+#include "jit.hpp"
+#include "lexer.hpp"
+
+namespace calc {
+
+    // Gauss-Kronrod 15 点节点与权重 (QUADPACK qk15), 奇数下标的节点同时是 7 点 Gauss 节点
+    static const double KRONROD_NODES[8] = {
+        0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+        0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+        0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+        0.207784955007898467600689403773245, 0.000000000000000000000000000000000,
+    };
+    static const double KRONROD_WEIGHTS[8] = {
+        0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+        0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+        0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+        0.204432940075298892414161999234649, 0.209482141084727828012999174891714,
+    };
+    static const double GAUSS_WEIGHTS[4] = {
+        0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+        0.381830050505118944950369775488975, 0.417959183673469387755102040816327,
+    };
+
+    // 单变量视图: 其余变量固定为 0
+    class Univariate final {
+    private:
+        Evaluator _eval;
+        DualEvaluator _dual;
+        std::vector<double> _vars;
+        int _slot;
+    public:
+        Univariate(const Program& program, int slot, const JitFunction& jit)
+            : _vars(program.variables.size(), 0.0), _slot(slot)
+        {
+            _eval.load(program, jit);
+            if (slot < DUAL_WIDTH) _dual.load(program);
+        }
+
+        inline double value(double t) {
+            _vars[_slot] = t;
+            return _eval.run(_vars.data());
+        }
+        inline double value(double t, double& slope) {
+            double gradient[DUAL_WIDTH];
+            _vars[_slot] = t;
+            double f = _dual.run(_vars.data(), gradient);
+            slope = gradient[_slot];
+            return f;
+        }
+    };
+
+    static inline bool opposite(double a, double b) {
+        return (a < 0.0 && b > 0.0) || (a > 0.0 && b < 0.0);
+    }
+
+    // 变号区间内带保护的 Newton 迭代: 始终保持区间包含根, 步长越界或导数失效时改为二分
+    static double bracketNewton(Univariate& f, double lo, double hi, double flo, double fhi) {
+        double x = 0.5 * (lo + hi);
+        for (int i = 0; i < SOLVE_MAX_ITERATIONS; i++) {
+            double slope;
+            double fx = f.value(x, slope);
+            if (fx == 0.0 || !std::isfinite(fx)) return x;
+            if (opposite(fx, flo)) hi = x, fhi = fx;
+            else lo = x, flo = fx;
+
+            double next = x - fx / slope;
+            if (!std::isfinite(next) || next <= lo || next >= hi) next = 0.5 * (lo + hi);
+            if (std::fabs(next - x) <= 4e-16 * std::max(1.0, std::fabs(x)) || hi - lo <= 4e-16 * std::max(1.0, std::fabs(x))) {
+                return next;
+            }
+            x = next;
+        }
+        return x;
+    }
+
+    // f' 在区间内变号: 二分找出极值点, 用于发现 x^2 这类不变号的切点根
+    static double bisectSlope(Univariate& f, double lo, double hi, double slo) {
+        for (int i = 0; i < SOLVE_MAX_ITERATIONS && hi - lo > 4e-16 * std::max(1.0, std::fabs(lo)); i++) {
+            double mid = 0.5 * (lo + hi), slope;
+            f.value(mid, slope);
+            if (slope == 0.0) return mid;
+            if (opposite(slope, slo)) hi = mid;
+            else lo = mid, slo = slope;
+        }
+        return 0.5 * (lo + hi);
+    }
+
+    // 7 点 Gauss 与 15 点 Kronrod 之差作为误差估计, 按 QUADPACK 的方式放缩
+    static double kronrod(Evaluator& eval, std::vector<double>& vars, int slot, double a, double b, double& error) {
+        double center = 0.5 * (a + b), half = 0.5 * (b - a);
+        auto f = [&](double t) {
+            vars[slot] = t;
+            return eval.run(vars.data());
+        };
+
+        double fc = f(center);
+        double kronrod = fc * KRONROD_WEIGHTS[7];
+        double gauss = fc * GAUSS_WEIGHTS[3];
+        double values[7][2];
+        for (int i = 0; i < 7; i++) {
+            double dx = half * KRONROD_NODES[i];
+            double f1 = f(center - dx), f2 = f(center + dx);
+            values[i][0] = f1, values[i][1] = f2;
+            kronrod += KRONROD_WEIGHTS[i] * (f1 + f2);
+            if (i & 1) gauss += GAUSS_WEIGHTS[i / 2] * (f1 + f2);
+        }
+
+        double mean = 0.5 * kronrod;
+        double asc = KRONROD_WEIGHTS[7] * std::fabs(fc - mean);
+        for (int i = 0; i < 7; i++) {
+            asc += KRONROD_WEIGHTS[i] * (std::fabs(values[i][0] - mean) + std::fabs(values[i][1] - mean));
+        }
+        asc *= std::fabs(half);
+        error = std::fabs((kronrod - gauss) * half);
+        if (asc != 0.0 && error != 0.0) error = asc * std::min(1.0, std::pow(200.0 * error / asc, 1.5));
+        return kronrod * half;
+    }
+
+    // 误差超过按宽度分摊的容差时二分, 递归顺序固定, 结果与执行线程无关
+    static double adaptive(Evaluator& eval, std::vector<double>& vars, int slot, double a, double b,
+                           double tolerance, int depth, double& total_error) {
+        double error;
+        double estimate = kronrod(eval, vars, slot, a, b, error);
+        double allowed = tolerance * (b - a);
+        if (error <= allowed || depth >= INTEGRATE_MAX_DEPTH || !std::isfinite(estimate)) {
+            total_error += error;
+            return estimate;
+        }
+        double mid = 0.5 * (a + b);
+        return adaptive(eval, vars, slot, a, mid, tolerance, depth + 1, total_error) +
+               adaptive(eval, vars, slot, mid, b, tolerance, depth + 1, total_error);
+    }
+
+    NumericSolver::NumericSolver(ThreadPool& pool, StopCallback stop)
+        : _pool(pool), _stop(std::move(stop))
+    {
+    }
+
+    bool NumericSolver::fail(const std::string& message) {
+        _error = message;
+        return false;
+    }
+
+    bool NumericSolver::roots(const Program& program, int slot, double a, double b, std::vector<double>& out) {
+        out.clear();
+        if (slot < 0 || slot >= DUAL_WIDTH) return fail("solve needs x, y or z as the variable");
+        if (!(a < b)) std::swap(a, b);
+
+        // 均匀采样出值与导数, 每个采样点独立, 切块方式不影响结果
+        size_t count = SOLVE_SAMPLES + 1;
+        std::vector<double> t(count), f(count), slope(count);
+        for (size_t i = 0; i < count; i++) t[i] = a + (b - a) * i / SOLVE_SAMPLES;
+        _pool.parallelFor(count, BATCH_BLOCK, [&](size_t begin, size_t end) {
+            if (stopped()) return;
+            DualEvaluator dual;
+            dual.load(program);
+            std::vector<const double*> vars(program.variables.size(), nullptr);
+            double* gradient[DUAL_WIDTH] = {};
+            vars[slot] = t.data() + begin;
+            gradient[slot] = slope.data() + begin;
+            dual.evaluate(vars.data(), f.data() + begin, gradient, end - begin);
+        });
+        if (stopped()) return fail("cancelled");
+
+        // 每个采样段最多产生一个根, 写入自己的位置, 之后按顺序收集
+        std::vector<double> found(SOLVE_SAMPLES, NAN);
+        JitFunction jit;
+        jit.compileVerified(program);
+        _pool.parallelFor(SOLVE_SAMPLES, 64, [&](size_t begin, size_t end) {
+            if (stopped()) return;
+            Univariate u(program, slot, jit);
+            for (size_t i = begin; i < end; i++) {
+                double lo = t[i], hi = t[i + 1], flo = f[i], fhi = f[i + 1];
+                if (!std::isfinite(flo) || !std::isfinite(fhi)) continue;
+                double scale = std::max(std::fabs(flo), std::fabs(fhi));
+                if (flo == 0.0) {
+                    found[i] = lo;
+                } else if (opposite(flo, fhi)) {
+                    double x = bracketNewton(u, lo, hi, flo, fhi);
+                    if (std::fabs(u.value(x)) <= SOLVE_RESIDUAL * (1.0 + scale)) found[i] = x;
+                } else if (opposite(slope[i], slope[i + 1])) {
+                    double x = bisectSlope(u, lo, hi, slope[i]);
+                    if (std::fabs(u.value(x)) <= SOLVE_TOUCH_RESIDUAL * (1.0 + scale)) found[i] = x;
+                }
+            }
+        });
+        if (stopped()) return fail("cancelled");
+        if (f[SOLVE_SAMPLES] == 0.0) found.push_back(b);
+
+        for (double x : found) {
+            if (std::isnan(x)) continue;
+            if (!out.empty() && std::fabs(x - out.back()) <= 1e-9 * std::max(1.0, std::fabs(x))) continue;
+            out.push_back(x);
+        }
+        return true;
+    }
+
+    bool NumericSolver::integrate(const Program& program, int slot, double a, double b, double& value,
+                                  double* error_estimate) {
+        if (slot < 0 || slot >= (int)program.variables.size()) return fail("unknown integration variable");
+        if (!std::isfinite(a) || !std::isfinite(b)) return fail("integration bounds must be finite");
+        double sign = 1.0;
+        if (a > b) std::swap(a, b), sign = -1.0;
+        if (a == b) {
+            value = 0.0;
+            if (error_estimate) *error_estimate = 0.0;
+            return true;
+        }
+
+        // 第一遍在每块上各做一次 K15, 估计整体量级以确定容差
+        double width = (b - a) / INTEGRATE_CHUNKS;
+        // 机器码只编译一次, 各块共享; 不可用时各块回退到 VM
+        JitFunction jit;
+        jit.compileVerified(program);
+        std::vector<double> coarse(INTEGRATE_CHUNKS), coarse_error(INTEGRATE_CHUNKS);
+        _pool.parallelFor(INTEGRATE_CHUNKS, 1, [&](size_t begin, size_t end) {
+            Evaluator eval;
+            eval.load(program, jit);
+            std::vector<double> vars(program.variables.size(), 0.0);
+            for (size_t i = begin; i < end; i++) {
+                double lo = a + width * i, hi = i + 1 == INTEGRATE_CHUNKS ? b : lo + width;
+                coarse[i] = kronrod(eval, vars, slot, lo, hi, coarse_error[i]);
+            }
+        });
+        double magnitude = 0.0;
+        for (size_t i = 0; i < INTEGRATE_CHUNKS; i++) magnitude += std::fabs(coarse[i]);
+        if (!std::isfinite(magnitude)) return fail("integrand is not finite on the interval");
+        double tolerance = std::max(INTEGRATE_ABS_TOLERANCE, INTEGRATE_REL_TOLERANCE * magnitude) / (b - a);
+
+        // 第二遍各块独立细分, 块的划分与合并顺序固定
+        std::vector<double> fine(INTEGRATE_CHUNKS), fine_error(INTEGRATE_CHUNKS, 0.0);
+        _pool.parallelFor(INTEGRATE_CHUNKS, 1, [&](size_t begin, size_t end) {
+            Evaluator eval;
+            eval.load(program, jit);
+            std::vector<double> vars(program.variables.size(), 0.0);
+            for (size_t i = begin; i < end; i++) {
+                if (stopped()) return;
+                double lo = a + width * i, hi = i + 1 == INTEGRATE_CHUNKS ? b : lo + width;
+                if (coarse_error[i] <= tolerance * (hi - lo)) {
+                    fine[i] = coarse[i];
+                    fine_error[i] = coarse_error[i];
+                    continue;
+                }
+                double mid = 0.5 * (lo + hi);
+                fine[i] = adaptive(eval, vars, slot, lo, mid, tolerance, 1, fine_error[i]) +
+                          adaptive(eval, vars, slot, mid, hi, tolerance, 1, fine_error[i]);
+            }
+        });
+        if (stopped()) return fail("cancelled");
+
+        double sum = 0.0, error = 0.0;
+        for (size_t i = 0; i < INTEGRATE_CHUNKS; i++) {
+            sum += fine[i];
+            error += fine_error[i];
+        }
+        if (!std::isfinite(sum)) return fail("integral does not converge");
+        value = sign * sum;
+        if (error_estimate) *error_estimate = error;
+        return true;
+    }
+
+    bool NumericSolver::derivative(const Program& program, int slot, double at, double& value) {
+        if (slot < 0 || slot >= DUAL_WIDTH) return fail("derivative needs x, y or z as the variable");
+        JitFunction none;
+        Univariate u(program, slot, none);
+        u.value(at, value);
+        return true;
+    }
+
+    bool NumericSolver::constant(const std::string& src, double& value) {
+        ExprPool pool;
+        ExprParser parser;
+        int root = parser.parse(src, pool);
+        if (root < 0) return fail(parser.error().message);
+        Program program;
+        if (!compile(pool, root, program)) return fail("expression too large");
+        for (const std::string& name : program.variables) {
+            if (program.uses(name)) return fail("bound '" + src + "' cannot use '" + name + "'");
+        }
+        VM vm;
+        vm.load(program);
+        std::vector<double> vars(program.variables.size(), 0.0);
+        value = vm.run(vars.data());
+        return true;
+    }
+
+    bool NumericSolver::function(const std::string& src, const std::string& variable, bool differentiable,
+                                 Program& program, int& slot) {
+        ExprPool pool;
+        ExprParser parser;
+        slot = pool.declare(variable);
+        if (differentiable && slot >= DUAL_WIDTH) return fail("variable must be x, y or z");
+        int root = parser.parse(src, pool);
+        if (root < 0) return fail(parser.error().message);
+        if (!compile(pool, root, program)) return fail("expression too large");
+        for (const std::string& name : program.variables) {
+            if (name != variable && program.uses(name)) return fail("unknown variable '" + name + "'");
+        }
+        return true;
+    }
+
+    // 命令名, 参数的源文本; 识别失败时 name 为空
+    struct Command {
+        std::string name;
+        std::string variable;
+        std::vector<std::string> args;
+    };
+
+    static Command splitCommand(const std::string& src) {
+        Command command;
+        std::vector<Token> tokens;
+        tokenize(src, tokens);
+        size_t pos = 0;
+        auto text = [&](const Token& token) { return src.substr(token.begin, token.length); };
+
+        if (tokens.size() > 4 && tokens[0].kind == TokenKind::Ident && text(tokens[0]) == "d" &&
+            tokens[1].kind == TokenKind::Slash && tokens[2].kind == TokenKind::Ident &&
+            tokens[2].length > 1 && src[tokens[2].begin] == 'd' && tokens[3].kind == TokenKind::LParen) {
+            command.name = "d";
+            command.variable = src.substr(tokens[2].begin + 1, tokens[2].length - 1);
+            pos = 4;
+        } else if (tokens.size() > 2 && tokens[0].kind == TokenKind::Ident && tokens[1].kind == TokenKind::LParen &&
+                   (text(tokens[0]) == "solve" || text(tokens[0]) == "integrate")) {
+            command.name = text(tokens[0]);
+            pos = 2;
+        } else {
+            return command;
+        }
+
+        // 按顶层逗号切分参数, 右括号之后必须是结尾
+        int depth = 0;
+        size_t begin = tokens[pos].begin;
+        for (; pos < tokens.size(); pos++) {
+            const Token& token = tokens[pos];
+            if (token.kind == TokenKind::LParen) {
+                depth++;
+            } else if (token.kind == TokenKind::RParen && depth > 0) {
+                depth--;
+            } else if ((token.kind == TokenKind::Comma && depth == 0) || token.kind == TokenKind::RParen) {
+                command.args.push_back(src.substr(begin, token.begin - begin));
+                begin = token.begin + token.length;
+                if (token.kind == TokenKind::RParen) break;
+            } else if (token.kind == TokenKind::End) {
+                break;
+            }
+        }
+        if (pos >= tokens.size() || tokens[pos].kind != TokenKind::RParen || tokens[pos + 1].kind != TokenKind::End) {
+            command.name.clear();
+        }
+        return command;
+    }
+
+    // 参数是否为单个标识符
+    static bool isIdentifier(const std::string& src) {
+        std::vector<Token> tokens;
+        tokenize(src, tokens);
+        return tokens.size() == 2 && tokens[0].kind == TokenKind::Ident;
+    }
+
+    static std::string trim(const std::string& src) {
+        size_t begin = src.find_first_not_of(" \t"), end = src.find_last_not_of(" \t");
+        return begin == std::string::npos ? std::string() : src.substr(begin, end - begin + 1);
+    }
+
+    // 最短的可往返表示, 结果可以原样作为下一条表达式的输入
+    static std::string format(double value) {
+        char buffer[32];
+        return std::string(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+    }
+
+    bool NumericSolver::isCommand(const std::string& src) {
+        return !splitCommand(src).name.empty();
+    }
+
+    bool NumericSolver::run(const std::string& src, std::string& result) {
+        _error.clear();
+        Command command = splitCommand(src);
+        std::vector<std::string>& args = command.args;
+        Program program;
+        int slot = 0;
+
+        if (command.name == "solve") {
+            if (args.size() != 2 && args.size() != 4) return fail("usage: solve(f, x) or solve(f, x, a, b)");
+            if (!isIdentifier(args[1])) return fail("solve: second argument must be a variable");
+            double a = -SOLVE_DEFAULT_RANGE, b = SOLVE_DEFAULT_RANGE;
+            if (args.size() == 4 && (!constant(args[2], a) || !constant(args[3], b))) return false;
+            if (!function(args[0], trim(args[1]), true, program, slot)) return false;
+            std::vector<double> found;
+            if (!roots(program, slot, a, b, found)) return false;
+            if (found.empty()) return fail("no roots in [" + format(std::min(a, b)) + ", " + format(std::max(a, b)) + "]");
+            result.clear();
+            for (size_t i = 0; i < found.size(); i++) {
+                if (i) result += ", ";
+                result += format(found[i]);
+            }
+            return true;
+        }
+        if (command.name == "integrate") {
+            if (args.size() != 3 && args.size() != 4) return fail("usage: integrate(f, a, b) or integrate(f, x, a, b)");
+            std::string variable = "x";
+            if (args.size() == 4) {
+                if (!isIdentifier(args[1])) return fail("integrate: second argument must be a variable");
+                variable = trim(args[1]);
+            }
+            double a, b, value;
+            if (!constant(args[args.size() - 2], a) || !constant(args[args.size() - 1], b)) return false;
+            if (!function(args[0], variable, false, program, slot)) return false;
+            if (!integrate(program, slot, a, b, value)) return false;
+            result = format(value);
+            return true;
+        }
+        if (command.name == "d") {
+            if (args.size() != 2) return fail("usage: d/d" + command.variable + "(f, a)");
+            double at, value;
+            if (!constant(args[1], at)) return false;
+            if (!function(args[0], command.variable, true, program, slot)) return false;
+            if (!derivative(program, slot, at, value)) return false;
+            result = format(value);
+            return true;
+        }
+        return fail("not a solver command");
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "batch.hpp"
+#include "buffered_writer.hpp"
+#include "expr_parser.hpp"
+#include "mapped_file.hpp"
+#include "solver.hpp"
+#include "thread_pool.hpp"
+
+// 每次处理的输入块, 块内的行并行求值, 块之间按顺序输出
+#define EVAL_BLOCK_BYTES (16 << 20)
+// 每个并行任务处理的行数
+#define EVAL_GRAIN 2048
+
+// 逐行求值, 每个线程一个实例, 解析器与表达式池在行之间复用
+class LineEvaluator final {
+private:
+    calc::ExprPool _pool;
+    calc::ExprParser _parser;
+    std::vector<double> _values;
+    std::string _line;
+    calc::Program _program;
+    calc::BatchEvaluator _batch;
+    bool _fast_math = false;
+private:
+    static void fail(const std::string& message, std::string& out) {
+        out += "error: ";
+        out += message;
+        out += '\n';
+    }
+
+    static void append(double value, std::string& out) {
+        char text[32];
+        auto result = std::to_chars(text, text + sizeof(text), value);
+        out.append(text, result.ptr);
+    }
+
+    // 在所有采样点上一次批量求值, 同一行内以空格分隔
+    void tabulate(int root, const std::vector<double>& xs, std::string& out) {
+        if (!calc::compile(_pool, root, _program, true, _fast_math)) return fail("expression too large", out);
+        for (const std::string& name : _program.variables) {
+            if (name != "x" && _program.uses(name)) return fail("free variable '" + name + "'", out);
+        }
+        _values.resize(xs.size());
+        _batch.load(_program);
+        _batch.evaluate(xs.data(), nullptr, nullptr, _values.data(), xs.size());
+        for (size_t i = 0; i < _values.size(); i++) {
+            if (i > 0) out += ' ';
+            append(_values[i], out);
+        }
+        out += '\n';
+    }
+public:
+    inline void setFastMath(bool fast_math) { _fast_math = fast_math; }
+
+    // 结果或错误信息追加到 out, 每个输入行恰好对应一个输出行; xs 不为空时把表达式当作 f(x) 列表求值
+    void evaluate(ThreadPool& threads, const char* begin, size_t length, const std::vector<double>* xs, std::string& out) {
+        while (length > 0 && (begin[length - 1] == '\r' || begin[length - 1] == ' ' || begin[length - 1] == '\t')) length--;
+        while (length > 0 && (*begin == ' ' || *begin == '\t')) begin++, length--;
+        if (length == 0) {
+            out += '\n';
+            return;
+        }
+        _line.assign(begin, length);
+
+        // solve / integrate / d/dx 至少带一个逗号, 普通表达式不必再做一次识别
+        if (memchr(begin, ',', length) && calc::NumericSolver::isCommand(_line)) {
+            calc::NumericSolver solver(threads);
+            std::string result;
+            if (!solver.run(_line, result)) return fail(solver.error(), out);
+            out += result;
+            out += '\n';
+            return;
+        }
+
+        _pool.clear();
+        int root = _parser.parse(_line, _pool);
+        if (root < 0) return fail(_parser.error().message, out);
+        if (xs) return tabulate(root, *xs, out);
+
+        // 节点按拓扑序存放, 顺序扫描一遍即可求值
+        _values.resize(root + 1);
+        for (int i = 0; i <= root; i++) {
+            const calc::Node& node = _pool[i];
+            switch (node.op) {
+                case calc::Op::Const:
+                    _values[i] = node.value;
+                    break;
+                case calc::Op::Var:
+                    return fail("free variable '" + _pool.variables()[node.slot] + "'", out);
+                default:
+                    _values[i] = calc::isUnary(node.op) ? calc::applyUnary(node.op, _values[node.a])
+                                                        : calc::applyBinary(node.op, _values[node.a], _values[node.b]);
+                    break;
+            }
+        }
+
+        append(_values[root], out);
+        out += '\n';
+    }
+};
+
+class BlockEvaluator final {
+private:
+    ThreadPool& _threads;
+    size_t _grain;
+    BufferedWriter& _writer;
+    const std::vector<double>* _xs;
+    bool _fast_math;
+    std::vector<size_t> _starts;
+    std::vector<std::string> _outputs;
+    size_t _lines;
+public:
+    BlockEvaluator(ThreadPool& threads, size_t grain, BufferedWriter& writer, const std::vector<double>* xs, bool fast_math)
+        : _threads(threads), _grain(grain), _writer(writer), _xs(xs), _fast_math(fast_math), _lines(0)
+    {
+    }
+
+    // data 中只含完整的行, 最后一行可以没有换行符
+    void process(const char* data, size_t size) {
+        if (size == 0) return;
+        _starts.clear();
+        _starts.push_back(0);
+        for (const char* p = data; (p = (const char*)memchr(p, '\n', data + size - p)); p++) {
+            if (p + 1 < data + size) _starts.push_back(p + 1 - data);
+        }
+        _starts.push_back(size);
+        size_t count = _starts.size() - 1;
+        size_t chunks = (count + _grain - 1) / _grain;
+        if (_outputs.size() < chunks) _outputs.resize(chunks);
+
+        _threads.parallelFor(count, _grain, [&](size_t begin, size_t end) {
+            thread_local LineEvaluator evaluator;
+            evaluator.setFastMath(_fast_math);
+            std::string& out = _outputs[begin / _grain];
+            out.clear();
+            for (size_t i = begin; i < end; i++) {
+                size_t length = _starts[i + 1] - _starts[i];
+                if (length > 0 && data[_starts[i] + length - 1] == '\n') length--;
+                evaluator.evaluate(_threads, data + _starts[i], length, _xs, out);
+            }
+        });
+
+        // 按块的顺序写出, 输出行序与输入一致
+        for (size_t c = 0; c < chunks; c++) _writer.write(_outputs[c]);
+        _lines += count;
+    }
+
+    inline size_t lines() const { return _lines; }
+};
+
+static void usage() {
+    fprintf(stderr,
+            "usage: geocal-eval [-j threads] [-x a:b:n] [-f] [-s] [file]\n"
+            "  Evaluates one expression per line from file (memory-mapped) or stdin,\n"
+            "  writing one result per line to stdout in input order.\n"
+            "  -j N      worker threads (default: all cores)\n"
+            "  -x a:b:n  tabulate each line as f(x) at n evenly spaced x in [a, b],\n"
+            "            writing the n values space-separated on one line\n"
+            "  -f        with -x, also rewrite x*0, x/c and small integer powers;\n"
+            "            results may differ in the last few bits\n"
+            "  -s        print throughput to stderr\n");
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    unsigned int jobs = 0;
+    bool stats = false;
+    bool fast_math = false;
+    std::vector<double> xs;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+            jobs = (unsigned int)std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "-x") && i + 1 < argc) {
+            double a, b;
+            long n;
+            if (sscanf(argv[++i], "%lf:%lf:%ld", &a, &b, &n) != 3 || n < 1) {
+                usage();
+                return EXIT_FAILURE;
+            }
+            xs.resize(n);
+            for (long k = 0; k < n; k++) xs[k] = n == 1 ? a : a + (b - a) * k / (n - 1);
+        } else if (!strcmp(argv[i], "-f")) {
+            fast_math = true;
+        } else if (!strcmp(argv[i], "-s")) {
+            stats = true;
+        } else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            usage();
+            return EXIT_SUCCESS;
+        } else if (!strcmp(argv[i], "-") || argv[i][0] != '-') {
+            path = strcmp(argv[i], "-") ? argv[i] : nullptr;
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    // 调用线程也参与求值, 所以 -j N 只需 N - 1 个工作线程; -j 1 时不创建工作线程, 整块在调用线程上执行
+    ThreadPool threads(jobs > 0 ? (int)jobs - 1 : -1);
+    size_t grain = threads.size() == 0 ? (size_t)-1 / 2 : EVAL_GRAIN;
+    BufferedWriter writer(stdout);
+    BlockEvaluator evaluator(threads, grain, writer, xs.empty() ? nullptr : &xs, fast_math);
+    auto start = std::chrono::steady_clock::now();
+
+    if (path) {
+        MappedFile file;
+        if (!file.open(path)) {
+            fprintf(stderr, "geocal-eval: cannot open '%s'\n", path);
+            return EXIT_FAILURE;
+        }
+        const char* data = file.data();
+        size_t size = file.size(), pos = 0;
+        while (pos < size) {
+            // 在块尾之前的最后一个换行处切开, 单行超过块大小时延伸到该行结尾
+            size_t end = std::min(pos + EVAL_BLOCK_BYTES, size);
+            if (end < size) {
+                size_t cut = end;
+                while (cut > pos && data[cut - 1] != '\n') cut--;
+                if (cut == pos) {
+                    const char* newline = (const char*)memchr(data + end, '\n', size - end);
+                    cut = newline ? newline + 1 - data : size;
+                }
+                end = cut;
+            }
+            evaluator.process(data + pos, end - pos);
+            pos = end;
+        }
+    } else {
+        // 逐块读取标准输入, 不完整的末行留到下一块
+        std::vector<char> buffer(EVAL_BLOCK_BYTES);
+        size_t carry = 0;
+        while (true) {
+            if (carry == buffer.size()) buffer.resize(buffer.size() * 2);
+            size_t got = fread(buffer.data() + carry, 1, buffer.size() - carry, stdin);
+            size_t size = carry + got;
+            if (got == 0) {
+                evaluator.process(buffer.data(), size);
+                break;
+            }
+            size_t cut = size;
+            while (cut > 0 && buffer[cut - 1] != '\n') cut--;
+            evaluator.process(buffer.data(), cut);
+            carry = size - cut;
+            memmove(buffer.data(), buffer.data() + cut, carry);
+        }
+    }
+
+    bool ok = writer.flush();
+    if (stats) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        fprintf(stderr, "geocal-eval: %zu expressions in %.3f s (%.2f M/s, %zu threads)\n", evaluator.lines(), seconds,
+                evaluator.lines() / seconds / 1e6, threads.size() + 1);
+    }
+    if (!ok) {
+        fprintf(stderr, "geocal-eval: write error\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
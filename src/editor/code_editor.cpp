@@ -0,0 +1,425 @@
+#include "code_editor.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define EDITOR_TAB_WIDTH 4
+
+static std::string expandTabs(const char* text, size_t len) {
+    std::string out;
+    out.reserve(len);
+    for (size_t i = 0; i < len; i++) {
+        if (text[i] == '\t') out.append(EDITOR_TAB_WIDTH, ' ');
+        else if (text[i] != '\r') out.push_back(text[i]);
+    }
+    return out;
+}
+
+static int encodeUtf8(unsigned int c, char* out) {
+    if (c < 0x80) { out[0] = (char)c; return 1; }
+    if (c < 0x800) {
+        out[0] = (char)(0xC0 | (c >> 6));
+        out[1] = (char)(0x80 | (c & 0x3F));
+        return 2;
+    }
+    if (c >= 0xD800 && c < 0xE000) return 0;
+    if (c < 0x10000) {
+        out[0] = (char)(0xE0 | (c >> 12));
+        out[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (c & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (c >> 18));
+    out[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (c & 0x3F));
+    return 4;
+}
+
+static ImU32 tokenColor(GlslTokenKind kind) {
+    switch (kind) {
+        case GlslTokenKind::Keyword:      return IM_COL32(198, 120, 221, 255);
+        case GlslTokenKind::Type:         return IM_COL32(229, 192, 123, 255);
+        case GlslTokenKind::Builtin:      return IM_COL32( 97, 175, 239, 255);
+        case GlslTokenKind::Number:       return IM_COL32(209, 154, 102, 255);
+        case GlslTokenKind::Comment:      return IM_COL32(110, 130, 110, 255);
+        case GlslTokenKind::Preprocessor: return IM_COL32(224, 108, 117, 255);
+        case GlslTokenKind::Punctuation:  return IM_COL32(171, 178, 191, 255);
+        default:                          return ImGui::GetColorU32(ImGuiCol_Text);
+    }
+}
+
+// 读取 "0(12) : error ...", "ERROR: 0:12: ...", "0:12(5): error: ..." 等格式
+static bool parseLogLine(const char* p, ShaderMarker& marker) {
+    while (*p == ' ') p++;
+    for (const char* prefix : {"ERROR:", "WARNING:", "error:", "warning:"}) {
+        size_t n = strlen(prefix);
+        if (strncmp(p, prefix, n) == 0) {
+            p += n;
+            break;
+        }
+    }
+    while (*p == ' ') p++;
+    if (!isdigit((unsigned char)*p)) return false;
+
+    char* end = nullptr;
+    strtol(p, &end, 10);
+    long line = 0;
+    if (*end == '(') {
+        line = strtol(end + 1, &end, 10);
+        if (*end != ')') return false;
+        end++;
+    } else if (*end == ':') {
+        line = strtol(end + 1, &end, 10);
+        // Mesa 会追加列号 "(5)"
+        if (*end == '(') {
+            while (*end && *end != ')') end++;
+            if (*end) end++;
+        }
+    } else {
+        return false;
+    }
+    if (line <= 0) return false;
+
+    while (*end == ' ' || *end == ':') end++;
+    marker.line = (int)line;
+    marker.message = end;
+    return true;
+}
+
+std::vector<ShaderMarker> parseShaderLog(const std::string& log) {
+    std::vector<ShaderMarker> markers;
+    size_t begin = 0;
+    while (begin < log.size()) {
+        size_t end = log.find('\n', begin);
+        if (end == std::string::npos) end = log.size();
+        std::string line = log.substr(begin, end - begin);
+        ShaderMarker marker;
+        if (parseLogLine(line.c_str(), marker)) {
+            markers.push_back(std::move(marker));
+        }
+        begin = end + 1;
+    }
+    return markers;
+}
+
+CodeEditor::CodeEditor()
+    : _cursor_line(0), _cursor_col(0), _focused(false), _modified(false),
+      _scroll_to_cursor(false), _revision(0), _dirty_from(SIZE_MAX), _dirty_to(0)
+{
+    rebuildLines();
+}
+
+void CodeEditor::setText(const std::string& text) {
+    _buffer.assign(expandTabs(text.data(), text.size()));
+    rebuildLines();
+    _markers.clear();
+    _cursor_line = 0;
+    _cursor_col = 0;
+    _modified = false;
+    _scroll_to_cursor = true;
+}
+
+std::string CodeEditor::getText() const {
+    return _buffer.text();
+}
+
+void CodeEditor::setMarkers(std::vector<ShaderMarker> markers) {
+    _markers = std::move(markers);
+}
+
+size_t CodeEditor::lineLength(size_t line) const {
+    size_t end = line + 1 < _lines.size() ? _lines[line + 1].start - 1 : _buffer.size();
+    return end - _lines[line].start;
+}
+
+size_t CodeEditor::cursorOffset() const {
+    return _lines[_cursor_line].start + _cursor_col;
+}
+
+void CodeEditor::markDirty(size_t from, size_t to) {
+    _dirty_from = std::min(_dirty_from, from);
+    _dirty_to = std::max(_dirty_to, to);
+    for (size_t i = from; i <= to && i < _lines.size(); i++) {
+        _lines[i].dirty = true;
+    }
+}
+
+void CodeEditor::shiftStarts(size_t first_line, long delta) {
+    for (size_t i = first_line; i < _lines.size(); i++) {
+        _lines[i].start += delta;
+    }
+}
+
+void CodeEditor::rebuildLines() {
+    _lines.clear();
+    _lines.push_back(Line{0});
+    for (size_t i = 0; i < _buffer.size(); i++) {
+        if (_buffer.at(i) == '\n') {
+            _lines.push_back(Line{i + 1});
+        }
+    }
+    _dirty_from = 0;
+    _dirty_to = _lines.size() - 1;
+}
+
+void CodeEditor::insertText(const char* text, size_t len) {
+    if (len == 0) return;
+    size_t offset = cursorOffset();
+    size_t line = _cursor_line;
+    _buffer.insert(offset, text, len);
+    shiftStarts(line + 1, (long)len);
+
+    size_t inserted = 0;
+    size_t last_newline = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (text[i] == '\n') {
+            inserted++;
+            last_newline = i;
+            _lines.insert(_lines.begin() + line + inserted, Line{offset + i + 1});
+        }
+    }
+
+    if (_dirty_from != SIZE_MAX && _dirty_to > line) {
+        _dirty_to += inserted;
+    }
+    if (inserted > 0) {
+        _cursor_line = line + inserted;
+        _cursor_col = len - last_newline - 1;
+    } else {
+        _cursor_col += len;
+    }
+    markDirty(line, line + inserted);
+    _modified = true;
+    _scroll_to_cursor = true;
+    _revision++;
+}
+
+void CodeEditor::eraseBackward() {
+    size_t offset = cursorOffset();
+    if (offset == 0) return;
+    _buffer.erase(offset - 1, 1);
+    if (_cursor_col > 0) {
+        _cursor_col--;
+    } else {
+        _cursor_col = lineLength(_cursor_line - 1);
+        _lines.erase(_lines.begin() + _cursor_line);
+        _cursor_line--;
+    }
+    shiftStarts(_cursor_line + 1, -1);
+    markDirty(_cursor_line, _cursor_line);
+    _modified = true;
+    _scroll_to_cursor = true;
+    _revision++;
+}
+
+void CodeEditor::eraseForward() {
+    size_t offset = cursorOffset();
+    if (offset >= _buffer.size()) return;
+    bool joins = _cursor_col >= lineLength(_cursor_line);
+    _buffer.erase(offset, 1);
+    if (joins) {
+        _lines.erase(_lines.begin() + _cursor_line + 1);
+    }
+    shiftStarts(_cursor_line + 1, -1);
+    markDirty(_cursor_line, _cursor_line);
+    _modified = true;
+    _revision++;
+}
+
+// 仅重新分析被修改的行, 以及块注释状态因此发生变化的后续行
+void CodeEditor::relex() {
+    if (_dirty_from == SIZE_MAX) return;
+    for (size_t i = _dirty_from; i < _lines.size(); i++) {
+        Line& line = _lines[i];
+        bool comment_in = i == 0 ? false : _lines[i - 1].comment_out;
+        if (i > _dirty_to && !line.dirty && line.comment_in == comment_in) {
+            break;
+        }
+        _buffer.copy(line.start, lineLength(i), _scratch);
+        line.comment_in = comment_in;
+        line.comment_out = lexGlslLine(_scratch.data(), _scratch.size(), comment_in, line.tokens);
+        line.dirty = false;
+    }
+    _dirty_from = SIZE_MAX;
+    _dirty_to = 0;
+}
+
+const ShaderMarker* CodeEditor::markerAt(size_t line) const {
+    for (const auto& marker : _markers) {
+        if (marker.line == (int)line) return &marker;
+    }
+    return nullptr;
+}
+
+void CodeEditor::handleKeyboard() {
+    ImGuiIO& io = ImGui::GetIO();
+
+    for (int i = 0; i < io.InputQueueCharacters.Size; i++) {
+        unsigned int c = io.InputQueueCharacters[i];
+        if (c == '\t' || c == '\n' || c == '\r' || c < 32 || c == 127) continue;
+        char utf8[4];
+        int n = encodeUtf8(c, utf8);
+        insertText(utf8, n);
+    }
+    io.InputQueueCharacters.resize(0);
+
+    bool shortcut = io.KeyCtrl || io.KeySuper;
+    size_t page = 30;
+
+    if (ImGui::IsKeyPressed(ImGuiKey_Enter) || ImGui::IsKeyPressed(ImGuiKey_KeypadEnter)) {
+        // 保持当前行的缩进
+        _buffer.copy(_lines[_cursor_line].start, _cursor_col, _scratch);
+        size_t indent = 0;
+        while (indent < _scratch.size() && _scratch[indent] == ' ') indent++;
+        std::string text = "\n" + std::string(indent, ' ');
+        insertText(text.data(), text.size());
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_Tab)) {
+        insertText("    ", EDITOR_TAB_WIDTH);
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_Backspace)) eraseBackward();
+    if (ImGui::IsKeyPressed(ImGuiKey_Delete)) eraseForward();
+
+    if (shortcut && ImGui::IsKeyPressed(ImGuiKey_V)) {
+        const char* clip = ImGui::GetClipboardText();
+        if (clip) {
+            std::string text = expandTabs(clip, strlen(clip));
+            insertText(text.data(), text.size());
+        }
+    }
+
+    if (ImGui::IsKeyPressed(ImGuiKey_LeftArrow)) {
+        if (_cursor_col > 0) _cursor_col--;
+        else if (_cursor_line > 0) _cursor_col = lineLength(--_cursor_line);
+        _scroll_to_cursor = true;
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_RightArrow)) {
+        if (_cursor_col < lineLength(_cursor_line)) _cursor_col++;
+        else if (_cursor_line + 1 < _lines.size()) { _cursor_line++; _cursor_col = 0; }
+        _scroll_to_cursor = true;
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_UpArrow) && _cursor_line > 0) {
+        _cursor_line--;
+        _scroll_to_cursor = true;
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_DownArrow) && _cursor_line + 1 < _lines.size()) {
+        _cursor_line++;
+        _scroll_to_cursor = true;
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_PageUp)) {
+        _cursor_line = _cursor_line > page ? _cursor_line - page : 0;
+        _scroll_to_cursor = true;
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_PageDown)) {
+        _cursor_line = std::min(_cursor_line + page, _lines.size() - 1);
+        _scroll_to_cursor = true;
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_Home)) {
+        if (shortcut) _cursor_line = 0;
+        _cursor_col = 0;
+        _scroll_to_cursor = true;
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_End)) {
+        if (shortcut) _cursor_line = _lines.size() - 1;
+        _cursor_col = lineLength(_cursor_line);
+        _scroll_to_cursor = true;
+    }
+    _cursor_col = std::min(_cursor_col, lineLength(_cursor_line));
+}
+
+bool CodeEditor::render(const char* id, const ImVec2& size) {
+    ImGui::BeginChild(id, size, true, ImGuiWindowFlags_HorizontalScrollbar | ImGuiWindowFlags_NoNav);
+    _focused = ImGui::IsWindowFocused();
+
+    unsigned long revision = _revision;
+    if (_focused) handleKeyboard();
+    relex();
+
+    const float line_height = ImGui::GetTextLineHeightWithSpacing();
+    const float text_height = ImGui::GetTextLineHeight();
+    const float char_width = ImGui::CalcTextSize("#").x;
+    int digits = 1;
+    for (size_t n = _lines.size(); n >= 10; n /= 10) digits++;
+    const float gutter = char_width * (digits + 2);
+
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    ImFont* font = ImGui::GetFont();
+    float font_size = ImGui::GetFontSize();
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+
+    if (ImGui::IsWindowHovered() && ImGui::IsMouseClicked(0)) {
+        ImVec2 mouse = ImGui::GetMousePos();
+        float row = (mouse.y - origin.y) / line_height;
+        _cursor_line = std::min((size_t)std::max(row, 0.0f), _lines.size() - 1);
+        float col = (mouse.x - origin.x - gutter) / char_width + 0.5f;
+        _cursor_col = std::min((size_t)std::max(col, 0.0f), lineLength(_cursor_line));
+    }
+
+    if (_scroll_to_cursor) {
+        float y = _cursor_line * line_height;
+        float x = gutter + _cursor_col * char_width;
+        float view_h = ImGui::GetWindowHeight();
+        float view_w = ImGui::GetWindowWidth();
+        if (y < ImGui::GetScrollY()) ImGui::SetScrollY(y);
+        else if (y + 2 * line_height > ImGui::GetScrollY() + view_h) ImGui::SetScrollY(y + 2 * line_height - view_h);
+        if (x < ImGui::GetScrollX() + gutter) ImGui::SetScrollX(std::max(x - gutter, 0.0f));
+        else if (x + 2 * char_width > ImGui::GetScrollX() + view_w) ImGui::SetScrollX(x + 2 * char_width - view_w);
+        _scroll_to_cursor = false;
+    }
+
+    const ImU32 gutter_color = ImGui::GetColorU32(ImGuiCol_TextDisabled);
+    const ImU32 text_color = ImGui::GetColorU32(ImGuiCol_Text);
+    const bool cursor_visible = _focused && std::fmod(ImGui::GetTime(), 1.0) < 0.6;
+
+    ImGuiListClipper clipper;
+    clipper.Begin((int)_lines.size(), line_height);
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+            ImVec2 pos = ImGui::GetCursorScreenPos();
+            const Line& line = _lines[i];
+            const ShaderMarker* marker = markerAt(i + 1);
+
+            if (marker) {
+                draw_list->AddRectFilled(
+                    pos,
+                    ImVec2(pos.x + ImGui::GetScrollX() + ImGui::GetWindowWidth(), pos.y + text_height),
+                    IM_COL32(200, 50, 50, 70));
+            }
+
+            char number[16];
+            snprintf(number, sizeof(number), "%*d", digits, i + 1);
+            draw_list->AddText(pos, gutter_color, number);
+
+            _buffer.copy(line.start, lineLength(i), _scratch);
+            float x = pos.x + gutter;
+            for (const auto& token : line.tokens) {
+                const char* begin = _scratch.data() + token.begin;
+                draw_list->AddText(font, font_size, ImVec2(x + token.begin * char_width, pos.y),
+                    tokenColor(token.kind), begin, begin + token.length);
+            }
+
+            float width = gutter + _scratch.size() * char_width;
+            if (marker) {
+                float mx = x + (_scratch.size() + EDITOR_TAB_WIDTH) * char_width;
+                draw_list->AddText(ImVec2(mx, pos.y), IM_COL32(255, 110, 110, 255), marker->message.c_str());
+                width += (EDITOR_TAB_WIDTH + marker->message.size()) * char_width;
+            }
+
+            if (cursor_visible && (size_t)i == _cursor_line) {
+                float cx = x + _cursor_col * char_width;
+                draw_list->AddLine(ImVec2(cx, pos.y), ImVec2(cx, pos.y + text_height), text_color, 2.0f);
+            }
+
+            ImGui::Dummy(ImVec2(width + char_width, text_height));
+        }
+    }
+    clipper.End();
+
+    ImGui::EndChild();
+    return _revision != revision;
+}
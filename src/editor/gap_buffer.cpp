@@ -0,0 +1,86 @@
+#include "gap_buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+GapBuffer::GapBuffer(size_t capacity)
+    : _data(capacity), _gap_begin(0), _gap_end(capacity)
+{
+}
+
+void GapBuffer::moveGap(size_t pos) {
+    if (pos == _gap_begin) return;
+    size_t gap = _gap_end - _gap_begin;
+    if (pos < _gap_begin) {
+        size_t n = _gap_begin - pos;
+        std::memmove(&_data[_gap_end - n], &_data[pos], n);
+    } else {
+        size_t n = pos - _gap_begin;
+        std::memmove(&_data[_gap_begin], &_data[_gap_end], n);
+    }
+    _gap_begin = pos;
+    _gap_end = pos + gap;
+}
+
+void GapBuffer::grow(size_t required) {
+    size_t gap = _gap_end - _gap_begin;
+    if (gap >= required) return;
+    size_t old_size = _data.size();
+    size_t new_size = std::max(old_size * 2, old_size + required - gap);
+    size_t tail = old_size - _gap_end;
+    _data.resize(new_size);
+    std::memmove(&_data[new_size - tail], &_data[_gap_end], tail);
+    _gap_end = new_size - tail;
+}
+
+void GapBuffer::assign(const std::string& text) {
+    size_t capacity = std::max<size_t>(text.size() * 2, 4096);
+    _data.assign(capacity, 0);
+    std::memcpy(_data.data(), text.data(), text.size());
+    _gap_begin = text.size();
+    _gap_end = capacity;
+}
+
+void GapBuffer::insert(size_t pos, const char* text, size_t len) {
+    if (len == 0) return;
+    pos = std::min(pos, size());
+    grow(len);
+    moveGap(pos);
+    std::memcpy(&_data[_gap_begin], text, len);
+    _gap_begin += len;
+}
+
+void GapBuffer::erase(size_t pos, size_t len) {
+    if (pos >= size()) return;
+    len = std::min(len, size() - pos);
+    moveGap(pos);
+    _gap_end += len;
+}
+
+void GapBuffer::clear() {
+    _gap_begin = 0;
+    _gap_end = _data.size();
+}
+
+std::string GapBuffer::text() const {
+    std::string out;
+    copy(0, size(), out);
+    return out;
+}
+
+void GapBuffer::copy(size_t pos, size_t len, std::string& dst) const {
+    dst.clear();
+    if (pos >= size()) return;
+    len = std::min(len, size() - pos);
+    dst.reserve(len);
+    size_t end = pos + len;
+    if (pos < _gap_begin) {
+        size_t front_end = std::min(end, _gap_begin);
+        dst.append(&_data[pos], front_end - pos);
+        pos = front_end;
+    }
+    if (pos < end) {
+        size_t gap = _gap_end - _gap_begin;
+        dst.append(&_data[pos + gap], end - pos);
+    }
+}
@@ -0,0 +1,131 @@
+#include "glsl_lexer.hpp"
+
+#include <cctype>
+#include <string_view>
+#include <unordered_set>
+
+static const std::unordered_set<std::string_view>& keywords() {
+    static const std::unordered_set<std::string_view> set = {
+        "attribute", "const", "uniform", "varying", "buffer", "shared", "coherent",
+        "volatile", "restrict", "readonly", "writeonly", "layout", "centroid", "flat",
+        "smooth", "noperspective", "patch", "sample", "break", "continue", "do", "for",
+        "while", "switch", "case", "default", "if", "else", "subroutine", "in", "out",
+        "inout", "true", "false", "invariant", "precise", "discard", "return", "struct",
+        "precision", "highp", "mediump", "lowp",
+    };
+    return set;
+}
+
+static const std::unordered_set<std::string_view>& types() {
+    static const std::unordered_set<std::string_view> set = {
+        "void", "bool", "int", "uint", "float", "double",
+        "vec2", "vec3", "vec4", "dvec2", "dvec3", "dvec4",
+        "bvec2", "bvec3", "bvec4", "ivec2", "ivec3", "ivec4", "uvec2", "uvec3", "uvec4",
+        "mat2", "mat3", "mat4", "mat2x2", "mat2x3", "mat2x4", "mat3x2", "mat3x3",
+        "mat3x4", "mat4x2", "mat4x3", "mat4x4", "dmat2", "dmat3", "dmat4",
+        "sampler1D", "sampler2D", "sampler3D", "samplerCube", "sampler2DArray",
+        "sampler2DShadow", "samplerCubeShadow", "sampler2DArrayShadow", "samplerBuffer",
+        "isampler2D", "usampler2D", "image2D", "uimage2D", "iimage2D",
+    };
+    return set;
+}
+
+static const std::unordered_set<std::string_view>& builtins() {
+    static const std::unordered_set<std::string_view> set = {
+        "gl_Position", "gl_FragCoord", "gl_FragDepth", "gl_VertexID", "gl_InstanceID",
+        "gl_PointSize", "gl_FrontFacing", "gl_PointCoord", "gl_PrimitiveID",
+        "radians", "degrees", "sin", "cos", "tan", "asin", "acos", "atan", "pow", "exp",
+        "log", "exp2", "log2", "sqrt", "inversesqrt", "abs", "sign", "floor", "ceil",
+        "fract", "mod", "min", "max", "clamp", "mix", "step", "smoothstep", "length",
+        "distance", "dot", "cross", "normalize", "reflect", "refract", "transpose",
+        "inverse", "determinant", "texture", "texelFetch", "textureLod", "dFdx", "dFdy",
+        "fwidth",
+    };
+    return set;
+}
+
+static bool isIdentStart(char c) {
+    return std::isalpha((unsigned char)c) || c == '_';
+}
+
+static bool isIdentChar(char c) {
+    return std::isalnum((unsigned char)c) || c == '_';
+}
+
+bool lexGlslLine(const char* line, size_t length, bool in_comment, std::vector<GlslToken>& tokens) {
+    tokens.clear();
+    size_t i = 0;
+
+    auto push = [&](size_t begin, size_t end, GlslTokenKind kind) {
+        if (end > begin) tokens.push_back({(unsigned int)begin, (unsigned int)(end - begin), kind});
+    };
+
+    if (in_comment) {
+        size_t begin = 0;
+        while (i < length && !(line[i] == '*' && i + 1 < length && line[i + 1] == '/')) i++;
+        if (i >= length) {
+            push(begin, length, GlslTokenKind::Comment);
+            return true;
+        }
+        i += 2;
+        push(begin, i, GlslTokenKind::Comment);
+    }
+
+    // 跳过行首空白后以 # 开头的行视为预处理指令
+    size_t first = i;
+    while (first < length && (line[first] == ' ' || line[first] == '\t')) first++;
+    if (!in_comment && first < length && line[first] == '#') {
+        size_t end = first;
+        while (end < length && !(line[end] == '/' && end + 1 < length && (line[end + 1] == '/' || line[end + 1] == '*'))) end++;
+        push(first, end, GlslTokenKind::Preprocessor);
+        i = end;
+    }
+
+    while (i < length) {
+        char c = line[i];
+        if (c == ' ' || c == '\t') {
+            i++;
+            continue;
+        }
+        if (c == '/' && i + 1 < length && line[i + 1] == '/') {
+            push(i, length, GlslTokenKind::Comment);
+            return false;
+        }
+        if (c == '/' && i + 1 < length && line[i + 1] == '*') {
+            size_t begin = i;
+            i += 2;
+            while (i < length && !(line[i] == '*' && i + 1 < length && line[i + 1] == '/')) i++;
+            if (i >= length) {
+                push(begin, length, GlslTokenKind::Comment);
+                return true;
+            }
+            i += 2;
+            push(begin, i, GlslTokenKind::Comment);
+            continue;
+        }
+        if (std::isdigit((unsigned char)c) || (c == '.' && i + 1 < length && std::isdigit((unsigned char)line[i + 1]))) {
+            size_t begin = i;
+            while (i < length && (std::isalnum((unsigned char)line[i]) || line[i] == '.')) {
+                // 指数部分的符号
+                if ((line[i] == 'e' || line[i] == 'E') && i + 1 < length && (line[i + 1] == '+' || line[i + 1] == '-')) i++;
+                i++;
+            }
+            push(begin, i, GlslTokenKind::Number);
+            continue;
+        }
+        if (isIdentStart(c)) {
+            size_t begin = i;
+            while (i < length && isIdentChar(line[i])) i++;
+            std::string_view word(line + begin, i - begin);
+            GlslTokenKind kind = GlslTokenKind::Text;
+            if (keywords().count(word)) kind = GlslTokenKind::Keyword;
+            else if (types().count(word)) kind = GlslTokenKind::Type;
+            else if (builtins().count(word)) kind = GlslTokenKind::Builtin;
+            push(begin, i, kind);
+            continue;
+        }
+        push(i, i + 1, GlslTokenKind::Punctuation);
+        i++;
+    }
+    return false;
+}
@@ -0,0 +1,38 @@
+#include "axis_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+AxisGrid::AxisGrid()
+    : _major(1.0f)
+{
+}
+
+void AxisGrid::update(const glm::vec3& camera_pos) {
+    float distance = std::max(glm::length(camera_pos), GRID_MIN_SPACING);
+    _major = std::pow(10.0f, std::floor(std::log10(distance)));
+}
+
+void AxisGrid::drawLabels(ImDrawList* list, const glm::mat4& view_proj, const glm::vec3& camera_pos,
+                          const ImVec2& origin, const ImVec2& size) const {
+    // 数学坐标 (x, y, z) 对应 OpenGL 的 (x, z, -y)
+    const glm::vec3 axes[3] = {glm::vec3(1, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0)};
+    const ImU32 colors[3] = {IM_COL32(230, 90, 90, 255), IM_COL32(90, 200, 90, 255), IM_COL32(90, 140, 240, 255)};
+    char text[32];
+    for (int a = 0; a < 3; a++) {
+        long center = std::lround(glm::dot(camera_pos, axes[a]) / _major);
+        for (long k = center - GRID_LABEL_COUNT; k <= center + GRID_LABEL_COUNT; k++) {
+            if (k == 0) continue;
+            double value = k * (double)_major;
+            glm::vec4 clip = view_proj * glm::vec4(axes[a] * (float)value, 1.0f);
+            if (clip.w <= 0.0f) continue;
+            float nx = clip.x / clip.w, ny = clip.y / clip.w;
+            if (nx < -1.0f || nx > 1.0f || ny < -1.0f || ny > 1.0f) continue;
+
+            ImVec2 pos(origin.x + (nx * 0.5f + 0.5f) * size.x + 3.0f, origin.y + (0.5f - ny * 0.5f) * size.y + 2.0f);
+            snprintf(text, sizeof(text), "%g", value);
+            list->AddText(pos, colors[a], text);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,401 @@
+#include "curve_plot.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "batch.hpp"
+
+// 按黄金角分布色相, 相邻曲线颜色差别明显
+static uint32_t curveColor(size_t index) {
+    double hue = std::fmod(index * 0.618033988749895, 1.0) * 6.0;
+    double s = 0.75, v = 0.95;
+    double rgb[3];
+    const double offsets[3] = {5.0, 3.0, 1.0};
+    for (int c = 0; c < 3; c++) {
+        double t = std::fmod(offsets[c] + hue, 6.0);
+        double weight = std::max(0.0, std::min(std::min(t, 4.0 - t), 1.0));
+        rgb[c] = v * (1.0 - s * weight);
+    }
+    uint32_t color = 0xff000000u;
+    for (int c = 0; c < 3; c++) color |= (uint32_t)(rgb[c] * 255.0 + 0.5) << (8 * c);
+    return color;
+}
+
+// 一条曲线上一个初始段的采样任务, 只读曲线的缓存, 新求出的点另存, 之后统一写回
+struct SegmentTask {
+    const calc::Program* program;
+    const calc::JitFunction* jit;
+    const std::unordered_map<double, double>* cache;
+    uint32_t color;
+    double a, b;
+    bool last;                      // 曲线的最后一段, 需要补上终点与断点
+    std::vector<LinePoint> points;
+    std::vector<std::pair<double, double>> fresh;
+};
+
+namespace {
+
+    // 细分中的区间; 同一层的所有区间按任务与 x 递增排列, 中点整层一起求值
+    struct Span {
+        SegmentTask* task;
+        double a, fa, b, fb, m, fm;
+        int depth;
+        bool leaf;
+    };
+
+    // 按层 (广度优先) 细分: 每一层先收集所有未完成区间的中点, 缓存未命中的点交给 BatchEvaluator 一次算完,
+    // 再逐个判断是否继续细分; 结果与逐点递归相同, 只是求值顺序不同
+    class SegmentSampler final {
+    private:
+        calc::BatchEvaluator _batch;
+        calc::Evaluator _scalar;
+        std::vector<double> _vars;
+        const calc::Program* _program;
+        std::vector<Span> _spans, _next;
+        std::vector<double> _xs, _ys;       // 本层缓存未命中的点
+        std::vector<double*> _targets;      // 求出的值写回的位置
+        std::vector<SegmentTask*> _owners;
+        double _scale;
+        double _origin_x, _origin_y;
+        double _y_limit;
+        int _max_depth;
+    public:
+        SegmentSampler(double scale, double origin_x, double origin_y, double y_limit, int max_depth)
+            : _program(nullptr), _scale(scale), _origin_x(origin_x), _origin_y(origin_y),
+              _y_limit(y_limit), _max_depth(max_depth)
+        {
+        }
+
+        // 连续的同一条曲线的任务合并细分
+        void run(SegmentTask* tasks, size_t count) {
+            for (size_t first = 0; first < count;) {
+                size_t last = first + 1;
+                while (last < count && tasks[last].program == tasks[first].program) last++;
+                sampleGroup(tasks + first, last - first);
+                first = last;
+            }
+        }
+    private:
+        void load(const SegmentTask& task) {
+            if (_program == task.program) return;
+            _program = task.program;
+            _batch.load(*_program);
+            _scalar.load(*_program, *task.jit);
+            _vars.assign(_program->variables.size(), 0.0);
+        }
+
+        inline double evaluate(double x) {
+            _vars[0] = x;
+            return _scalar.run(_vars.data());
+        }
+
+        // 命中缓存时直接写入, 否则留到 flush 一起求值
+        void request(SegmentTask* task, double x, double* target) {
+            auto it = task->cache->find(x);
+            if (it != task->cache->end()) {
+                *target = it->second;
+                return;
+            }
+            _xs.push_back(x);
+            _targets.push_back(target);
+            _owners.push_back(task);
+        }
+
+        void flush() {
+            if (_xs.empty()) return;
+            _ys.resize(_xs.size());
+            _batch.evaluate(_xs.data(), nullptr, nullptr, _ys.data(), _xs.size());
+            for (size_t i = 0; i < _xs.size(); i++) {
+                *_targets[i] = _ys[i];
+                _owners[i]->fresh.push_back({_xs[i], _ys[i]});
+            }
+            _xs.clear();
+            _targets.clear();
+            _owners.clear();
+        }
+
+        void sampleGroup(SegmentTask* tasks, size_t count) {
+            load(tasks[0]);
+            _spans.clear();
+            for (size_t t = 0; t < count; t++) {
+                _spans.push_back({&tasks[t], tasks[t].a, 0.0, tasks[t].b, 0.0, 0.0, 0.0, 0, false});
+            }
+            // 相邻任务共享端点, 缓存未命中时会重复求值, 与逐段递归时一致
+            for (Span& span : _spans) {
+                request(span.task, span.a, &span.fa);
+                request(span.task, span.b, &span.fb);
+            }
+            flush();
+
+            while (true) {
+                bool open = false;
+                for (Span& span : _spans) {
+                    if (span.leaf) continue;
+                    span.m = 0.5 * (span.a + span.b);
+                    request(span.task, span.m, &span.fm);
+                    open = true;
+                }
+                if (!open) break;
+                flush();
+
+                _next.clear();
+                for (const Span& span : _spans) {
+                    if (!span.leaf && refine(span)) {
+                        _next.push_back({span.task, span.a, span.fa, span.m, span.fm, 0.0, 0.0, span.depth + 1, false});
+                        _next.push_back({span.task, span.m, span.fm, span.b, span.fb, 0.0, 0.0, span.depth + 1, false});
+                    } else {
+                        _next.push_back(span);
+                        _next.back().leaf = true;
+                    }
+                }
+                _spans.swap(_next);
+            }
+
+            for (const Span& span : _spans) output(span);
+            for (size_t t = 0; t < count; t++) {
+                SegmentTask& task = tasks[t];
+                if (!task.last) continue;
+                // 终点的值在最后一个区间中
+                double fb = 0.0;
+                for (const Span& span : _spans) {
+                    if (span.task == &task) fb = span.fb;
+                }
+                emit(task, task.b, fb);
+                emitBreak(task);
+            }
+        }
+
+        bool refine(const Span& span) const {
+            if (span.depth < CURVE_MIN_DEPTH) return true;
+            if (span.depth >= _max_depth) return false;
+            bool ok_a = std::isfinite(span.fa), ok_m = std::isfinite(span.fm), ok_b = std::isfinite(span.fb);
+            // 定义域的边界
+            if (ok_a != ok_m || ok_m != ok_b) return true;
+            // 中点偏离弦
+            return ok_a && std::fabs(span.fm - 0.5 * (span.fa + span.fb)) > CURVE_FLATNESS_PX * _scale;
+        }
+
+        void emit(SegmentTask& task, double x, double y) {
+            if (!std::isfinite(y)) {
+                emitBreak(task);
+                return;
+            }
+            double dy = std::max(-_y_limit, std::min(y - _origin_y, _y_limit));
+            task.points.push_back({(float)(x - _origin_x), (float)dy, task.color, CURVE_LINE_WIDTH});
+        }
+
+        inline void emitBreak(SegmentTask& task) {
+            task.points.push_back({0.0f, NAN, task.color, CURVE_LINE_WIDTH});
+        }
+
+        // 输出 [a, b) 上的点, 终点由下一个区间给出
+        void output(const Span& span) {
+            SegmentTask& task = *span.task;
+            double a = span.a, fa = span.fa, m = span.m, fm = span.fm, b = span.b, fb = span.fb;
+            emit(task, a, fa);
+            bool finite = std::isfinite(fa) && std::isfinite(fm) && std::isfinite(fb);
+            if (finite && std::fabs(fb - fa) > CURVE_JUMP_PX * _scale && discontinuous(a, fa, b, fb)) {
+                // 断点放在变化较大的一侧
+                if (std::fabs(fm - fa) < std::fabs(fb - fm)) {
+                    emit(task, m, fm);
+                    emitBreak(task);
+                } else {
+                    emitBreak(task);
+                    emit(task, m, fm);
+                }
+            } else {
+                emit(task, m, fm);
+            }
+        }
+
+        // 沿变化较大的一半继续二分: 连续函数的跳变随区间缩小而变小, 间断点处保持不变
+        // 每一步依赖上一步的结果, 只能逐点求值; 这些点不会被其它视图复用, 不写入缓存
+        bool discontinuous(double a, double fa, double b, double fb) {
+            double jump = std::fabs(fb - fa);
+            for (int i = 0; i < CURVE_JUMP_DEPTH; i++) {
+                double m = 0.5 * (a + b);
+                double fm = evaluate(m);
+                if (!std::isfinite(fm)) return true;
+                if (std::fabs(fm - fa) > std::fabs(fb - fm)) b = m, fb = fm;
+                else a = m, fa = fm;
+                if (std::fabs(fb - fa) <= 0.5 * jump) return false;
+            }
+            return true;
+        }
+    };
+
+}
+
+CurvePlot::CurvePlot(ThreadPool& pool, int width, int height)
+    : _pool(pool), _width(0), _height(0), _dirty(true),
+      _sampled_x0(0.0), _sampled_x1(0.0), _sampled_scale(0.0), _origin_x(0.0), _origin_y(0.0)
+{
+    resize(width, height);
+    resetView();
+}
+
+bool CurvePlot::validate(const calc::Program& program, std::string& error) {
+    for (const std::string& name : program.variables) {
+        if (name != "x" && program.uses(name)) {
+            error = "y = f(x) cannot use '" + name + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CurvePlot::add(const std::string& source, const calc::Program& program, std::string& error) {
+    if (!validate(program, error)) return false;
+    for (Curve& curve : _curves) {
+        if (curve.source == source) {
+            curve.program = program;
+            curve.jit->compileVerified(program);
+            curve.cache.clear();
+            _dirty = true;
+            return true;
+        }
+    }
+    if (_curves.size() >= CURVE_MAX_COUNT) {
+        error = "too many curves";
+        return false;
+    }
+    auto jit = std::make_unique<calc::JitFunction>();
+    jit->compileVerified(program);
+    _curves.push_back({source, program, std::move(jit), curveColor(_curves.size()), {}});
+    _dirty = true;
+    return true;
+}
+
+void CurvePlot::clear() {
+    _curves.clear();
+    _points.clear();
+    _batch.upload(_points);
+    _dirty = true;
+}
+
+void CurvePlot::resize(int width, int height) {
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (width == _width && height == _height) return;
+    _width = width;
+    _height = height;
+    _dirty = true;
+}
+
+void CurvePlot::pan(float dx, float dy) {
+    _center_x -= dx * _scale;
+    _center_y -= dy * _scale;
+}
+
+void CurvePlot::zoom(float factor, float x, float y) {
+    // 保持光标下的点不动
+    double ox = x - _width * 0.5;
+    double oy = y - _height * 0.5;
+    _center_x += ox * _scale * (1.0 - factor);
+    _center_y += oy * _scale * (1.0 - factor);
+    _scale *= factor;
+}
+
+void CurvePlot::resetView() {
+    _center_x = 0.0;
+    _center_y = 0.0;
+    _scale = 8.0 / _height;
+    _dirty = true;
+}
+
+bool CurvePlot::needsResample() const {
+    if (_dirty) return true;
+    double half = 0.5 * _width * _scale;
+    if (_center_x - half < _sampled_x0 || _center_x + half > _sampled_x1) return true;
+    double ratio = _scale / _sampled_scale;
+    if (ratio < 0.5 || ratio > 2.0) return true;
+    // 纵向移出限制范围时更新原点
+    return std::fabs(_center_y - _origin_y) > 0.5 * CURVE_Y_LIMIT * _height * _scale;
+}
+
+void CurvePlot::update() {
+    if (!isLoaded() || !needsResample()) return;
+    resample();
+    _batch.upload(_points);
+    _dirty = false;
+}
+
+void CurvePlot::resample() {
+    double view = _width * _scale;
+    double x0 = _center_x - view * (0.5 + CURVE_MARGIN);
+    double x1 = _center_x + view * (0.5 + CURVE_MARGIN);
+
+    // 初始段宽与最细段宽都是 2 的幂, 采样点因此对齐到同一组二进分点
+    double base = std::exp2(std::floor(std::log2(view / CURVE_BASE_SEGMENTS)));
+    double finest = std::exp2(std::floor(std::log2(0.5 * _scale)));
+    int max_depth = std::max(CURVE_MIN_DEPTH, (int)std::lround(std::log2(base / finest)));
+    double start = std::floor(x0 / base) * base;
+    size_t segments = (size_t)std::ceil((x1 - start) / base);
+
+    _sampled_x0 = start;
+    _sampled_x1 = start + segments * base;
+    _sampled_scale = _scale;
+    _origin_x = _center_x;
+    _origin_y = _center_y;
+
+    std::vector<SegmentTask> tasks(_curves.size() * segments);
+    for (size_t c = 0; c < _curves.size(); c++) {
+        Curve& curve = _curves[c];
+        if (curve.cache.size() > CURVE_CACHE_LIMIT) curve.cache.clear();
+        for (size_t s = 0; s < segments; s++) {
+            SegmentTask& task = tasks[c * segments + s];
+            task.program = &curve.program;
+            task.jit = curve.jit.get();
+            task.cache = &curve.cache;
+            task.color = curve.color;
+            task.a = start + s * base;
+            task.b = start + (s + 1) * base;
+            task.last = s + 1 == segments;
+        }
+    }
+
+    double y_limit = CURVE_Y_LIMIT * _height * _scale;
+    _pool.parallelFor(tasks.size(), CURVE_TASK_GRAIN, [&](size_t begin, size_t end) {
+        SegmentSampler sampler(_scale, _origin_x, _origin_y, y_limit, max_depth);
+        sampler.run(tasks.data() + begin, end - begin);
+    });
+
+    // 按任务顺序拼接, 再写回新求出的点
+    size_t total = 0;
+    for (const SegmentTask& task : tasks) total += task.points.size();
+    _points.clear();
+    _points.reserve(total + 6);
+
+    // 坐标轴与曲线在同一批中绘制, 放在最前面, 曲线覆盖在上方
+    const uint32_t axis = 0xff808080u;
+    float left = (float)(_sampled_x0 - _origin_x), right = (float)(_sampled_x1 - _origin_x);
+    float top = (float)y_limit, bottom = -(float)y_limit;
+    float axis_x = (float)(-_origin_x), axis_y = (float)(-_origin_y);
+    _points.push_back({left, axis_y, axis, CURVE_AXIS_WIDTH});
+    _points.push_back({right, axis_y, axis, CURVE_AXIS_WIDTH});
+    _points.push_back({0.0f, NAN, axis, CURVE_AXIS_WIDTH});
+    _points.push_back({axis_x, bottom, axis, CURVE_AXIS_WIDTH});
+    _points.push_back({axis_x, top, axis, CURVE_AXIS_WIDTH});
+    _points.push_back({0.0f, NAN, axis, CURVE_AXIS_WIDTH});
+
+    for (const SegmentTask& task : tasks) {
+        _points.insert(_points.end(), task.points.begin(), task.points.end());
+    }
+    // 每条曲线的缓存由一个线程写回
+    _pool.parallelFor(_curves.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            Curve& curve = _curves[c];
+            for (size_t s = 0; s < segments; s++) {
+                for (const auto& entry : tasks[c * segments + s].fresh) curve.cache.emplace(entry.first, entry.second);
+            }
+        }
+    });
+}
+
+glm::mat4 CurvePlot::viewProjection() const {
+    double half_w = 0.5 * _width * _scale, half_h = 0.5 * _height * _scale;
+    double cx = _center_x - _origin_x, cy = _center_y - _origin_y;
+    return glm::ortho((float)(cx - half_w), (float)(cx + half_w), (float)(cy - half_h), (float)(cy + half_h));
+}
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "domain_coloring.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// 色相取 arg f, 亮度取 log2|f| 的小数部分, 相邻等模线之间由暗到亮
+static void shadeSamples(const double* re, const double* im, size_t count, uint32_t* out) {
+    const double inv_two_pi = 0.15915494309189535;
+    for (size_t k = 0; k < count; k++) {
+        double r = re[k], i = im[k];
+        if (!std::isfinite(r) || !std::isfinite(i)) {
+            // 极点附近为白色, 无定义处为灰色
+            out[k] = (std::isnan(r) || std::isnan(i)) ? 0xff808080u : 0xffffffffu;
+            continue;
+        }
+        double hue = std::atan2(i, r) * inv_two_pi + 0.5;
+        double magnitude = std::log2(std::hypot(r, i));
+        double value = std::isfinite(magnitude) ? 0.6 + 0.4 * (magnitude - std::floor(magnitude)) : 0.0;
+
+        uint32_t color = 0xff000000u;
+        const double offsets[3] = {5.0, 3.0, 1.0};
+        for (int c = 0; c < 3; c++) {
+            double t = std::fmod(offsets[c] + hue * 6.0, 6.0);
+            double weight = std::max(0.0, std::min(std::min(t, 4.0 - t), 1.0));
+            uint32_t channel = (uint32_t)(255.0 * value * (1.0 - weight) + 0.5);
+            color |= channel << (8 * c);
+        }
+        out[k] = color;
+    }
+}
+
+DomainColoring::DomainColoring(ThreadPool& pool, int width, int height)
+    : _pool(pool), _loaded(false), _texture_id(0), _width(0), _height(0), _step(0), _next_tile(0)
+{
+    resize(width, height);
+    resetView();
+}
+
+DomainColoring::~DomainColoring() {
+    if (_texture_id) {
+        glDeleteTextures(1, &_texture_id);
+    }
+}
+
+bool DomainColoring::load(const calc::Program& program, std::string& error) {
+    calc::ComplexEvaluator evaluator;
+    if (!evaluator.load(program)) {
+        error = evaluator.error();
+        return false;
+    }
+    _program = program;
+    _loaded = true;
+    restart();
+    return true;
+}
+
+void DomainColoring::resize(int width, int height) {
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (width == _width && height == _height) return;
+    _width = width;
+    _height = height;
+    _pixels.assign((size_t)width * height, 0xff333333u);
+
+    if (_texture_id) {
+        glDeleteTextures(1, &_texture_id);
+    }
+    glGenTextures(1, &_texture_id);
+    glBindTexture(GL_TEXTURE_2D, _texture_id);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, _pixels.data());
+    restart();
+}
+
+void DomainColoring::restart() {
+    _step = DOMAIN_COARSE_STEP;
+    _next_tile = 0;
+}
+
+void DomainColoring::pan(float dx, float dy) {
+    _center_re -= dx * _scale;
+    _center_im -= dy * _scale;
+    restart();
+}
+
+void DomainColoring::zoom(float factor, float x, float y) {
+    // 保持光标下的点不动
+    double ox = x - _width * 0.5;
+    double oy = y - _height * 0.5;
+    _center_re += ox * _scale * (1.0 - factor);
+    _center_im += oy * _scale * (1.0 - factor);
+    _scale *= factor;
+    restart();
+}
+
+void DomainColoring::resetView() {
+    _center_re = 0.0;
+    _center_im = 0.0;
+    _scale = 8.0 / _height;
+    restart();
+}
+
+void DomainColoring::shadeTile(calc::ComplexEvaluator& evaluator, size_t tile, int step) {
+    thread_local std::vector<double> re, im, out_re, out_im;
+    thread_local std::vector<uint32_t> colors;
+    thread_local std::vector<uint32_t> offsets;
+
+    int ox = (int)(tile % tilesX()) * DOMAIN_TILE_SIZE;
+    int oy = (int)(tile / tilesX()) * DOMAIN_TILE_SIZE;
+    int tw = std::min(DOMAIN_TILE_SIZE, _width - ox);
+    int th = std::min(DOMAIN_TILE_SIZE, _height - oy);
+
+    // 上一遍 (步长 2 * step) 已经求过的点不再重复
+    re.clear();
+    im.clear();
+    offsets.clear();
+    bool refine = step < DOMAIN_COARSE_STEP;
+    for (int j = 0; j < th; j += step) {
+        for (int i = 0; i < tw; i += step) {
+            if (refine && i % (2 * step) == 0 && j % (2 * step) == 0) continue;
+            int px = ox + i, py = oy + j;
+            re.push_back(_center_re + (px + 0.5 - _width * 0.5) * _scale);
+            im.push_back(_center_im + (py + 0.5 - _height * 0.5) * _scale);
+            offsets.push_back((uint32_t)(j << 16 | i));
+        }
+    }
+
+    size_t count = re.size();
+    out_re.resize(count);
+    out_im.resize(count);
+    colors.resize(count);
+    evaluator.evaluate(re.data(), im.data(), out_re.data(), out_im.data(), count);
+    shadeSamples(out_re.data(), out_im.data(), count, colors.data());
+
+    // 每个样本填满它所代表的 step x step 区域
+    for (size_t k = 0; k < count; k++) {
+        int i = offsets[k] & 0xffff, j = offsets[k] >> 16;
+        int w = std::min(step, tw - i), h = std::min(step, th - j);
+        for (int y = 0; y < h; y++) {
+            uint32_t* row = _pixels.data() + (size_t)(oy + j + y) * _width + ox + i;
+            std::fill(row, row + w, colors[k]);
+        }
+    }
+}
+
+void DomainColoring::uploadTile(size_t tile) {
+    int ox = (int)(tile % tilesX()) * DOMAIN_TILE_SIZE;
+    int oy = (int)(tile / tilesX()) * DOMAIN_TILE_SIZE;
+    int tw = std::min(DOMAIN_TILE_SIZE, _width - ox);
+    int th = std::min(DOMAIN_TILE_SIZE, _height - oy);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, ox, oy, tw, th, GL_RGBA, GL_UNSIGNED_BYTE, _pixels.data() + (size_t)oy * _width + ox);
+}
+
+void DomainColoring::update() {
+    if (!_loaded || _step == 0) return;
+    auto start = std::chrono::steady_clock::now();
+    size_t tiles = (size_t)tilesX() * tilesY();
+    size_t batch = (_pool.size() + 1) * 2;
+
+    glBindTexture(GL_TEXTURE_2D, _texture_id);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, _width);
+    while (_step > 0) {
+        size_t first = _next_tile;
+        size_t count = std::min(batch, tiles - first);
+        int step = _step;
+        _pool.parallelFor(count, 1, [&](size_t begin, size_t end) {
+            calc::ComplexEvaluator evaluator;
+            evaluator.load(_program);
+            for (size_t t = begin; t < end; t++) shadeTile(evaluator, first + t, step);
+        });
+        for (size_t t = first; t < first + count; t++) uploadTile(t);
+
+        _next_tile += count;
+        if (_next_tile >= tiles) {
+            _next_tile = 0;
+            _step /= 2;
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed > DOMAIN_FRAME_BUDGET_MS) break;
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void DomainColoring::bind(unsigned int slot) const {
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_2D, _texture_id);
+}
\ No newline at end of file
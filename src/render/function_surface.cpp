@@ -0,0 +1,64 @@
+#include "function_surface.hpp"
+
+#include <cmath>
+
+#include "dual.hpp"
+
+FunctionSurface::FunctionSurface(const calc::Program& program, int precision, float extent) {
+    int side = precision + 1;
+    size_t count = (size_t)side * side;
+    std::vector<double> x(count), y(count), f(count), fx(count), fy(count);
+    for (int i = 0; i <= precision; i++) {
+        for (int j = 0; j <= precision; j++) {
+            size_t index = (size_t)i * side + j;
+            x[index] = extent * (2.0 * j / precision - 1.0);
+            y[index] = extent * (2.0 * i / precision - 1.0);
+        }
+    }
+
+    // 一遍求出 f 与两个偏导, 不需要有限差分
+    calc::DualEvaluator evaluator;
+    evaluator.load(program);
+    evaluator.evaluate(x.data(), y.data(), nullptr, f.data(), fx.data(), fy.data(), nullptr, count);
+
+    _vertices.resize(count * 8);
+    std::vector<char> valid(count);
+    for (size_t k = 0; k < count; k++) {
+        float* v = &_vertices[k * 8];
+        valid[k] = std::isfinite(f[k]) && std::fabs(f[k]) <= FUNCTION_SURFACE_HEIGHT_LIMIT;
+        v[0] = (float)x[k];
+        v[1] = valid[k] ? (float)f[k] : 0.0f;
+        v[2] = -(float)y[k];
+        v[3] = (float)(k % side) / precision;
+        v[4] = (float)(k / side) / precision;
+
+        // 曲面 z - f(x, y) = 0 的法线 (-fx, -fy, 1) 换到 OpenGL 坐标系
+        double nx = -fx[k], ny = 1.0, nz = fy[k];
+        double length = std::sqrt(nx * nx + ny * ny + nz * nz);
+        if (!std::isfinite(length)) {
+            nx = 0.0, nz = 0.0, length = 1.0;
+        }
+        v[5] = (float)(nx / length);
+        v[6] = (float)(ny / length);
+        v[7] = (float)(nz / length);
+    }
+
+    _indices.reserve((size_t)precision * precision * 6);
+    for (int i = 0; i < precision; i++) {
+        for (int j = 0; j < precision; j++) {
+            unsigned int a = i * side + j, b = a + 1, c = a + side, d = c + 1;
+            if (!valid[a] || !valid[b] || !valid[c] || !valid[d]) continue;
+            _indices.insert(_indices.end(), {a, b, c, b, d, c});
+        }
+    }
+}
+
+bool FunctionSurface::validate(const calc::Program& program, std::string& error) {
+    for (const std::string& name : program.variables) {
+        if (name != "x" && name != "y" && program.uses(name)) {
+            error = "z = f(x, y) cannot use '" + name + "'";
+            return false;
+        }
+    }
+    return true;
+}
\ No newline at end of file
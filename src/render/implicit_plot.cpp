@@ -0,0 +1,161 @@
+#include "implicit_plot.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "interval.hpp"
+#include "dual.hpp"
+
+// 细分中的单元: 左下角的整数坐标与边长 (以像素 / 体素为单位)
+template <int D>
+struct TreeCell {
+    int origin[D];
+    int size;
+};
+
+template <int D>
+static void subdivide(ThreadPool& pool, const calc::Program& program, const double* min, const double* max,
+                      int resolution, std::vector<TreeCell<D>>& leaves, ImplicitStats* stats) {
+    leaves.clear();
+    int root = 1;
+    while (root < resolution) root <<= 1;
+
+    double step[D];
+    for (int d = 0; d < D; d++) step[d] = (max[d] - min[d]) / resolution;
+
+    std::vector<TreeCell<D>> level(1);
+    for (int d = 0; d < D; d++) level[0].origin[d] = 0;
+    level[0].size = root;
+
+    size_t evals = 0;
+    std::vector<std::vector<TreeCell<D>>> outputs;
+    while (!level.empty()) {
+        evals += level.size();
+        size_t chunks = (level.size() + IMPLICIT_GRAIN - 1) / IMPLICIT_GRAIN;
+        outputs.assign(chunks, {});
+
+        // 每块写入自己的输出, 之后按块的顺序拼接, 结果与线程数无关
+        pool.parallelFor(level.size(), IMPLICIT_GRAIN, [&](size_t begin, size_t end) {
+            calc::IntervalEvaluator evaluator;
+            evaluator.load(program);
+            std::vector<calc::Interval> vars(program.variables.size(), calc::Interval::point(0.0));
+            std::vector<TreeCell<D>>& out = outputs[begin / IMPLICIT_GRAIN];
+            for (size_t i = begin; i < end; i++) {
+                const TreeCell<D>& cell = level[i];
+                for (int d = 0; d < D && d < (int)vars.size(); d++) {
+                    int hi = std::min(cell.origin[d] + cell.size, resolution);
+                    vars[d] = {min[d] + cell.origin[d] * step[d], min[d] + hi * step[d]};
+                }
+                calc::Interval value = evaluator.run(vars.data());
+                if (value.isEmpty() || !value.contains(0.0)) continue;
+
+                if (cell.size == 1) {
+                    out.push_back(cell);
+                    continue;
+                }
+                int half = cell.size / 2;
+                for (int child = 0; child < (1 << D); child++) {
+                    TreeCell<D> c;
+                    c.size = half;
+                    bool inside = true;
+                    for (int d = 0; d < D; d++) {
+                        c.origin[d] = cell.origin[d] + ((child >> d) & 1) * half;
+                        inside = inside && c.origin[d] < resolution;
+                    }
+                    if (inside) out.push_back(c);
+                }
+            }
+        });
+
+        // size 为 1 的存活单元即为结果, 其余进入下一层
+        std::vector<TreeCell<D>> next;
+        for (auto& out : outputs) {
+            for (const TreeCell<D>& cell : out) {
+                if (cell.size == 1 && level.front().size == 1) leaves.push_back(cell);
+                else next.push_back(cell);
+            }
+        }
+        level.swap(next);
+    }
+
+    if (stats) {
+        size_t uniform = 1;
+        for (int d = 0; d < D; d++) uniform *= (size_t)resolution;
+        stats->interval_evals = evals;
+        stats->uniform_evals = uniform;
+        stats->leaves = leaves.size();
+    }
+}
+
+ImplicitPlotter::ImplicitPlotter(ThreadPool& pool)
+    : _pool(pool)
+{
+}
+
+void ImplicitPlotter::plot2D(const calc::Program& program, const double* min, const double* max, int resolution,
+                             std::vector<Cell2>& cells, ImplicitStats* stats) {
+    std::vector<TreeCell<2>> leaves;
+    subdivide<2>(_pool, program, min, max, resolution, leaves, stats);
+    cells.resize(leaves.size());
+    for (size_t i = 0; i < leaves.size(); i++) cells[i] = {leaves[i].origin[0], leaves[i].origin[1]};
+}
+
+void ImplicitPlotter::plot3D(const calc::Program& program, const double* min, const double* max, int resolution,
+                             std::vector<Cell3>& cells, ImplicitStats* stats) {
+    std::vector<TreeCell<3>> leaves;
+    subdivide<3>(_pool, program, min, max, resolution, leaves, stats);
+    cells.resize(leaves.size());
+    for (size_t i = 0; i < leaves.size(); i++) cells[i] = {leaves[i].origin[0], leaves[i].origin[1], leaves[i].origin[2]};
+}
+
+ImplicitSurface::ImplicitSurface(ThreadPool& pool, const calc::Program& program, int resolution, float extent) {
+    double min[3] = {-extent, -extent, -extent};
+    double max[3] = {extent, extent, extent};
+    std::vector<ImplicitPlotter::Cell3> cells;
+    ImplicitPlotter(pool).plot3D(program, min, max, resolution, cells, &_stats);
+
+    size_t count = cells.size();
+    double step = 2.0 * extent / resolution;
+    std::vector<double> x(count), y(count), z(count), f(count), fx(count), fy(count), fz(count);
+    for (size_t k = 0; k < count; k++) {
+        x[k] = min[0] + (cells[k].x + 0.5) * step;
+        y[k] = min[1] + (cells[k].y + 0.5) * step;
+        z[k] = min[2] + (cells[k].z + 0.5) * step;
+    }
+
+    calc::DualEvaluator evaluator;
+    evaluator.load(program);
+    evaluator.evaluate(x.data(), y.data(), z.data(), f.data(), fx.data(), fy.data(), fz.data(), count);
+
+    _vertices.resize(count * 8);
+    _indices.resize(count);
+    for (size_t k = 0; k < count; k++) {
+        float* v = &_vertices[k * 8];
+        v[0] = (float)x[k];
+        v[1] = (float)z[k];
+        v[2] = -(float)y[k];
+        v[3] = (float)(cells[k].x + 0.5) / resolution;
+        v[4] = (float)(cells[k].y + 0.5) / resolution;
+
+        // ∇f 换到 OpenGL 坐标系 (x, z, -y)
+        double nx = fx[k], ny = fz[k], nz = -fy[k];
+        double length = std::sqrt(nx * nx + ny * ny + nz * nz);
+        if (!std::isfinite(length) || length == 0.0) {
+            nx = 0.0, ny = 1.0, nz = 0.0, length = 1.0;
+        }
+        v[5] = (float)(nx / length);
+        v[6] = (float)(ny / length);
+        v[7] = (float)(nz / length);
+        _indices[k] = (unsigned int)k;
+    }
+}
+
+bool ImplicitSurface::validate(const calc::Program& program, std::string& error) {
+    for (const std::string& name : program.variables) {
+        if (name != "x" && name != "y" && name != "z" && program.uses(name)) {
+            error = "f(x, y, z) = 0 cannot use '" + name + "'";
+            return false;
+        }
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "line_batch.hpp"
+
+#include <algorithm>
+
+LineBatch::LineBatch()
+    : _buffer_id(0), _capacity(0), _count(0)
+{
+    glGenBuffers(1, &_buffer_id);
+}
+
+LineBatch::~LineBatch() {
+    if (_buffer_id) {
+        glDeleteBuffers(1, &_buffer_id);
+    }
+}
+
+void LineBatch::upload(const std::vector<LinePoint>& points) {
+    size_t size = points.size() * sizeof(LinePoint);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _buffer_id);
+    if (size > _capacity) {
+        _capacity = std::max(size, _capacity * 2);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, _capacity, nullptr, GL_DYNAMIC_DRAW);
+    }
+    if (size) {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, points.data());
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    _count = points.size();
+}
+
+void LineBatch::bind(unsigned int binding) const {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, _buffer_id);
+}
\ No newline at end of file
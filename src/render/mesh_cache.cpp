@@ -0,0 +1,204 @@
+#include "mesh_cache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+#include "buffered_writer.hpp"
+#include "mesh_export.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    inline uint64_t alignUp(uint64_t value) {
+        return (value + MESH_CACHE_ALIGNMENT - 1) / MESH_CACHE_ALIGNMENT * MESH_CACHE_ALIGNMENT;
+    }
+
+}
+
+MeshKey::MeshKey(const char* generator)
+    : _hash(1469598103934665603ull)
+{
+    uint32_t version = MESH_CACHE_VERSION;
+    mix(&version, sizeof(version));
+    add(std::string(generator));
+}
+
+void MeshKey::mix(const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        _hash ^= bytes[i];
+        _hash *= 1099511628211ull;
+    }
+}
+
+MeshKey& MeshKey::add(int value) {
+    mix(&value, sizeof(value));
+    return *this;
+}
+
+MeshKey& MeshKey::add(float value) {
+    mix(&value, sizeof(value));
+    return *this;
+}
+
+MeshKey& MeshKey::add(const std::string& text) {
+    // 带上长度, 相邻的两个字符串不会因为切分位置不同而得到相同的哈希
+    uint64_t length = text.size();
+    mix(&length, sizeof(length));
+    mix(text.data(), text.size());
+    return *this;
+}
+
+MeshKey& MeshKey::add(const calc::Program& program) {
+    // Instr 可能含有填充字节, 逐个字段加入
+    add((int)program.code.size());
+    for (const calc::Instr& instr : program.code) {
+        uint16_t fields[4] = {(uint16_t)instr.op, instr.dst, instr.a, instr.b};
+        mix(fields, sizeof(fields));
+    }
+    add((int)program.constants.size());
+    mix(program.constants.data(), program.constants.size() * sizeof(double));
+    add((int)program.variables.size());
+    for (const std::string& name : program.variables) add(name);
+    uint16_t registers[2] = {program.register_count, program.result};
+    mix(registers, sizeof(registers));
+    return *this;
+}
+
+CachedMesh::CachedMesh()
+    : _header(nullptr)
+{
+}
+
+bool CachedMesh::open(const std::string& path, uint64_t key) {
+    if (!_file.open(path)) return false;
+    if (_file.size() < sizeof(MeshCacheHeader)) return false;
+    const MeshCacheHeader* header = (const MeshCacheHeader*)_file.data();
+    if (memcmp(header->magic, MESH_CACHE_MAGIC, sizeof(header->magic)) != 0) return false;
+    if (header->version != MESH_CACHE_VERSION || header->byte_order != MESH_CACHE_BYTE_ORDER) return false;
+    if (header->key != key || header->file_size != _file.size()) return false;
+
+    // 顶点格式必须与渲染器一致; 各块必须对齐且落在文件内, 大小不能超出 Geo 接口的 32 位范围
+    if (header->vertex_floats != MESH_VERTEX_FLOATS || header->vertex_count == 0) return false;
+    if (header->vertex_count > UINT32_MAX / (MESH_VERTEX_FLOATS * sizeof(float))) return false;
+    if (header->index_count > UINT32_MAX) return false;
+    uint64_t vertex_bytes = header->vertex_count * MESH_VERTEX_FLOATS * sizeof(float);
+    uint64_t index_bytes = header->index_count * sizeof(uint32_t);
+    if (header->vertex_offset % MESH_CACHE_ALIGNMENT || header->index_offset % MESH_CACHE_ALIGNMENT) return false;
+    if (header->vertex_offset < sizeof(MeshCacheHeader) || header->index_offset > header->file_size) return false;
+    if (header->vertex_offset > header->index_offset) return false;
+    if (vertex_bytes > header->index_offset - header->vertex_offset) return false;
+    if (index_bytes > header->file_size - header->index_offset) return false;
+
+    // 越界的索引会让绘制读到顶点缓冲区之外; 文件只由 store 整体写入后改名得到, 信任头中的最大索引
+    if (header->index_count > 0 && header->max_index >= header->vertex_count) return false;
+    _header = header;
+    return true;
+}
+
+MeshCache::MeshCache(const std::string& dir, size_t budget)
+    : _dir(dir), _budget(budget), _hits(0), _misses(0)
+{
+}
+
+std::string MeshCache::path(uint64_t key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+    return _dir + "/" + name + MESH_CACHE_EXTENSION;
+}
+
+CachedMesh* MeshCache::load(uint64_t key) {
+    std::string file = path(key);
+    CachedMesh* mesh = new CachedMesh;
+    if (!mesh->open(file, key)) {
+        delete mesh;
+        _misses++;
+        return nullptr;
+    }
+    // 以写入时间作为最近使用时间, 常用的缓存不会被 prune 删掉
+    std::error_code ec;
+    fs::last_write_time(file, fs::file_time_type::clock::now(), ec);
+    _hits++;
+    return mesh;
+}
+
+bool MeshCache::store(uint64_t key, Geo& geo) {
+    uint64_t vertex_bytes = geo.getSize();
+    uint64_t index_bytes = (uint64_t)geo.getCount() * sizeof(uint32_t);
+    if (vertex_bytes == 0) return false;
+
+    MeshCacheHeader header = {};
+    memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+    header.version = MESH_CACHE_VERSION;
+    header.byte_order = MESH_CACHE_BYTE_ORDER;
+    header.key = key;
+    const uint32_t* indices = (const uint32_t*)geo.getIndices();
+    for (uint64_t i = 0; i < geo.getCount(); i++) header.max_index = std::max(header.max_index, indices[i]);
+    header.vertex_floats = MESH_VERTEX_FLOATS;
+    header.vertex_count = vertex_bytes / (header.vertex_floats * sizeof(float));
+    header.index_count = geo.getCount();
+    header.vertex_offset = alignUp(sizeof(MeshCacheHeader));
+    header.index_offset = alignUp(header.vertex_offset + vertex_bytes);
+    header.file_size = header.index_offset + index_bytes;
+
+    std::error_code ec;
+    fs::create_directories(_dir, ec);
+    std::string file = path(key);
+    std::string temp = file + ".tmp";
+    FILE* out = fopen(temp.c_str(), "wb");
+    if (!out) return false;
+    setvbuf(out, nullptr, _IONBF, 0);
+
+    static const char zeros[MESH_CACHE_ALIGNMENT] = {};
+    bool ok;
+    {
+        BufferedWriter writer(out);
+        writer.write((const char*)&header, sizeof(header));
+        writer.write(zeros, header.vertex_offset - sizeof(header));
+        writer.write((const char*)geo.getVertices(), vertex_bytes);
+        writer.write(zeros, header.index_offset - header.vertex_offset - vertex_bytes);
+        writer.write((const char*)geo.getIndices(), index_bytes);
+        ok = writer.flush();
+    }
+    ok = fclose(out) == 0 && ok;
+    if (ok) {
+        fs::rename(temp, file, ec);
+        ok = !ec;
+    }
+    if (!ok) {
+        fs::remove(temp, ec);
+        return false;
+    }
+    prune();
+    return true;
+}
+
+void MeshCache::prune() {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type time;
+        uintmax_t size;
+    };
+    std::vector<Entry> entries;
+    uintmax_t total = 0;
+    std::error_code ec;
+    for (fs::directory_iterator it(_dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != MESH_CACHE_EXTENSION) continue;
+        Entry entry = {it->path(), it->last_write_time(ec), it->file_size(ec)};
+        if (ec) return;
+        total += entry.size;
+        entries.push_back(entry);
+    }
+    if (total <= _budget) return;
+
+    // 最新的一个 (刚写入的) 始终保留
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+    for (size_t i = 0; i + 1 < entries.size() && total > _budget; i++) {
+        if (fs::remove(entries[i].path, ec)) total -= entries[i].size;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "mesh_export.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "buffered_writer.hpp"
+
+// 顶点与索引数组按此大小分段写出, 段之间检查取消
+#define MESH_EXPORT_BLOCK (16 << 20)
+
+namespace {
+
+    inline bool littleEndian() {
+        const uint16_t one = 1;
+        uint8_t byte;
+        memcpy(&byte, &one, 1);
+        return byte == 1;
+    }
+
+    inline char* formatFloat(char* p, float value) {
+        return std::to_chars(p, p + 32, value).ptr;
+    }
+
+    inline char* formatIndex(char* p, unsigned int value) {
+        return std::to_chars(p, p + 16, value).ptr;
+    }
+
+    inline void appendFloat(std::string& out, float value) {
+        char text[32];
+        out.append(text, formatFloat(text, value));
+    }
+
+    inline void appendSize(std::string& out, size_t value) {
+        char text[32];
+        out.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+    }
+
+}
+
+std::shared_ptr<MeshData> MeshData::snapshot(Geo& geo, bool points) {
+    std::shared_ptr<MeshData> mesh = std::make_shared<MeshData>();
+    const float* vertices = (const float*)geo.getVertices();
+    mesh->vertices.assign(vertices, vertices + geo.getSize() / sizeof(float));
+    const unsigned int* indices = (const unsigned int*)geo.getIndices();
+    mesh->indices.assign(indices, indices + geo.getCount());
+    mesh->points = points;
+    return mesh;
+}
+
+MeshExporter::MeshExporter(TaskContext* context)
+    : _context(context)
+{
+}
+
+bool MeshExporter::fail(const std::string& message) {
+    if (_error.empty()) _error = message;
+    return false;
+}
+
+bool MeshExporter::stopped() const {
+    return _context && _context->shouldStop();
+}
+
+void MeshExporter::progress(size_t done, size_t total) const {
+    if (_context && total > 0) _context->setProgress((float)done / total);
+}
+
+bool MeshExporter::formatFromPath(const std::string& path, MeshFormat& format) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return false;
+    std::string extension;
+    for (size_t i = dot; i < path.size(); i++) extension += (char)tolower((unsigned char)path[i]);
+    if (extension == ".ply") format = MeshFormat::PLY;
+    else if (extension == ".obj") format = MeshFormat::OBJ;
+    else if (extension == ".glb") format = MeshFormat::GLB;
+    else return false;
+    return true;
+}
+
+bool MeshExporter::write(const std::string& path, const MeshData& mesh) {
+    MeshFormat format;
+    if (!formatFromPath(path, format)) return fail("unknown format, use .ply, .obj or .glb");
+    return write(path, mesh, format);
+}
+
+bool MeshExporter::write(const std::string& path, const MeshData& mesh, MeshFormat format) {
+    if (mesh.vertexCount() == 0) return fail("nothing to export");
+    for (unsigned int index : mesh.indices) {
+        if (index >= mesh.vertexCount()) return fail("index out of range");
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) return fail("cannot open '" + path + "' for writing");
+    // BufferedWriter 自己攒块, 关掉 stdio 的缓冲, 大块数据直接交给 write
+    setvbuf(file, nullptr, _IONBF, 0);
+
+    bool ok = false;
+    switch (format) {
+        case MeshFormat::PLY: ok = writePLY(file, mesh); break;
+        case MeshFormat::OBJ: ok = writeOBJ(file, mesh); break;
+        case MeshFormat::GLB: ok = writeGLB(file, mesh); break;
+    }
+    if (fclose(file) != 0 && ok) ok = fail("write error");
+    if (!ok) std::remove(path.c_str());
+    return ok;
+}
+
+bool MeshExporter::writePLY(FILE* file, const MeshData& mesh) {
+    size_t vertex_count = mesh.vertexCount();
+    size_t face_count = mesh.points ? 0 : mesh.indices.size() / 3;
+    BufferedWriter writer(file);
+
+    // 按内存中的顺序声明属性并写明本机字节序, 顶点数组可以原样写出
+    std::string header = "ply\nformat ";
+    header += littleEndian() ? "binary_little_endian" : "binary_big_endian";
+    header += " 1.0\ncomment GeoForce\nelement vertex ";
+    appendSize(header, vertex_count);
+    header += "\nproperty float x\nproperty float y\nproperty float z\n"
+              "property float s\nproperty float t\n"
+              "property float nx\nproperty float ny\nproperty float nz\n";
+    if (face_count > 0) {
+        header += "element face ";
+        appendSize(header, face_count);
+        header += "\nproperty list uchar uint vertex_indices\n";
+    }
+    header += "end_header\n";
+    writer.write(header);
+
+    size_t vertex_bytes = mesh.vertices.size() * sizeof(float);
+    size_t total = vertex_bytes + face_count * 13;
+    const char* vertices = (const char*)mesh.vertices.data();
+    for (size_t offset = 0; offset < vertex_bytes; offset += MESH_EXPORT_BLOCK) {
+        if (stopped()) return fail("cancelled");
+        writer.write(vertices + offset, std::min<size_t>(MESH_EXPORT_BLOCK, vertex_bytes - offset));
+        progress(offset, total);
+    }
+
+    // 每个面 1 字节的顶点数加 3 个索引, 直接拼在写缓冲区中
+    const unsigned int* indices = mesh.indices.data();
+    for (size_t begin = 0; begin < face_count; begin += MESH_EXPORT_BATCH) {
+        if (stopped()) return fail("cancelled");
+        size_t end = std::min<size_t>(begin + MESH_EXPORT_BATCH, face_count);
+        char* out = writer.reserve((end - begin) * 13);
+        for (size_t f = begin; f < end; f++, out += 13) {
+            out[0] = 3;
+            memcpy(out + 1, indices + f * 3, 12);
+        }
+        writer.commit((end - begin) * 13);
+        progress(vertex_bytes + end * 13, total);
+    }
+    return writer.flush() || fail("write error");
+}
+
+bool MeshExporter::writeOBJ(FILE* file, const MeshData& mesh) {
+    size_t vertex_count = mesh.vertexCount();
+    BufferedWriter writer(file);
+    writer.write(std::string("# GeoForce\n"));
+
+    const float* v = mesh.vertices.data();
+    size_t total = vertex_count + mesh.indices.size();
+    for (size_t begin = 0; begin < vertex_count; begin += MESH_EXPORT_BATCH) {
+        if (stopped()) return fail("cancelled");
+        size_t end = std::min<size_t>(begin + MESH_EXPORT_BATCH, vertex_count);
+        for (size_t i = begin; i < end; i++) {
+            const float* p = v + i * MESH_VERTEX_FLOATS;
+            char* out = writer.reserve(256);
+            char* s = out;
+            *s++ = 'v';
+            for (int k = 0; k < 3; k++) *s++ = ' ', s = formatFloat(s, p[k]);
+            memcpy(s, "\nvt", 3), s += 3;
+            for (int k = 3; k < 5; k++) *s++ = ' ', s = formatFloat(s, p[k]);
+            memcpy(s, "\nvn", 3), s += 3;
+            for (int k = 5; k < 8; k++) *s++ = ' ', s = formatFloat(s, p[k]);
+            *s++ = '\n';
+            writer.commit(s - out);
+        }
+        progress(end, total);
+    }
+
+    // 索引从 1 开始; 位置, 纹理坐标与法线共用同一个下标
+    const unsigned int* indices = mesh.indices.data();
+    size_t corners = mesh.points ? 1 : 3;
+    size_t elements = mesh.indices.size() / corners;
+    for (size_t begin = 0; begin < elements; begin += MESH_EXPORT_BATCH) {
+        if (stopped()) return fail("cancelled");
+        size_t end = std::min<size_t>(begin + MESH_EXPORT_BATCH, elements);
+        for (size_t e = begin; e < end; e++) {
+            char* out = writer.reserve(128);
+            char* s = out;
+            *s++ = mesh.points ? 'p' : 'f';
+            for (size_t k = 0; k < corners; k++) {
+                unsigned int index = indices[e * corners + k] + 1;
+                *s++ = ' ';
+                s = formatIndex(s, index);
+                if (!mesh.points) {
+                    *s++ = '/', s = formatIndex(s, index);
+                    *s++ = '/', s = formatIndex(s, index);
+                }
+            }
+            *s++ = '\n';
+            writer.commit(s - out);
+        }
+        progress(vertex_count + end * corners, total);
+    }
+    return writer.flush() || fail("write error");
+}
+
+bool MeshExporter::writeGLB(FILE* file, const MeshData& mesh) {
+    if (!littleEndian()) return fail("GLB export requires a little-endian host");
+    size_t vertex_count = mesh.vertexCount();
+    size_t vertex_bytes = mesh.vertices.size() * sizeof(float);
+    size_t index_bytes = mesh.indices.size() * sizeof(unsigned int);
+
+    // 位置的包围盒是 glTF 的必填项
+    float lower[3] = {INFINITY, INFINITY, INFINITY}, upper[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (size_t i = 0; i < vertex_count; i++) {
+        const float* p = mesh.vertices.data() + i * MESH_VERTEX_FLOATS;
+        for (int k = 0; k < 3; k++) {
+            lower[k] = std::min(lower[k], p[k]);
+            upper[k] = std::max(upper[k], p[k]);
+        }
+    }
+
+    // 一个交错的顶点缓冲视图 (步长 32 字节) 上的三个访问器, 加一个索引访问器
+    std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"GeoForce\"},\"scene\":0,"
+                       "\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+                       "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"TEXCOORD_0\":1,\"NORMAL\":2},"
+                       "\"indices\":3,\"mode\":";
+    json += mesh.points ? "0" : "4";
+    json += "}]}],\"buffers\":[{\"byteLength\":";
+    appendSize(json, vertex_bytes + index_bytes);
+    json += "}],\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":";
+    appendSize(json, vertex_bytes);
+    json += ",\"byteStride\":32,\"target\":34962},{\"buffer\":0,\"byteOffset\":";
+    appendSize(json, vertex_bytes);
+    json += ",\"byteLength\":";
+    appendSize(json, index_bytes);
+    json += ",\"target\":34963}],\"accessors\":[";
+    const char* types[3] = {"VEC3", "VEC2", "VEC3"};
+    const int offsets[3] = {0, 12, 20};
+    for (int a = 0; a < 3; a++) {
+        json += "{\"bufferView\":0,\"byteOffset\":";
+        appendSize(json, offsets[a]);
+        json += ",\"componentType\":5126,\"count\":";
+        appendSize(json, vertex_count);
+        json += ",\"type\":\"";
+        json += types[a];
+        json += "\"";
+        if (a == 0) {
+            json += ",\"min\":[";
+            for (int k = 0; k < 3; k++) {
+                if (k) json += ',';
+                appendFloat(json, lower[k]);
+            }
+            json += "],\"max\":[";
+            for (int k = 0; k < 3; k++) {
+                if (k) json += ',';
+                appendFloat(json, upper[k]);
+            }
+            json += "]";
+        }
+        json += "},";
+    }
+    json += "{\"bufferView\":1,\"componentType\":5125,\"count\":";
+    appendSize(json, mesh.indices.size());
+    json += ",\"type\":\"SCALAR\"}]}";
+    // 块长度须为 4 的倍数, JSON 以空格补齐
+    json.append((4 - json.size() % 4) % 4, ' ');
+
+    uint64_t length = 12 + 8 + json.size() + 8 + vertex_bytes + index_bytes;
+    if (length > UINT32_MAX) return fail("mesh is too large for GLB");
+
+    BufferedWriter writer(file);
+    const uint32_t header[3] = {0x46546C67u, 2u, (uint32_t)length};
+    const uint32_t json_chunk[2] = {(uint32_t)json.size(), 0x4E4F534Au};
+    const uint32_t bin_chunk[2] = {(uint32_t)(vertex_bytes + index_bytes), 0x004E4942u};
+    writer.write((const char*)header, sizeof(header));
+    writer.write((const char*)json_chunk, sizeof(json_chunk));
+    writer.write(json);
+    writer.write((const char*)bin_chunk, sizeof(bin_chunk));
+
+    // BIN 块直接引用顶点与索引数组
+    const char* blocks[2] = {(const char*)mesh.vertices.data(), (const char*)mesh.indices.data()};
+    size_t sizes[2] = {vertex_bytes, index_bytes};
+    size_t written = 0;
+    for (int b = 0; b < 2; b++) {
+        for (size_t offset = 0; offset < sizes[b]; offset += MESH_EXPORT_BLOCK) {
+            if (stopped()) return fail("cancelled");
+            size_t size = std::min<size_t>(MESH_EXPORT_BLOCK, sizes[b] - offset);
+            writer.write(blocks[b] + offset, size);
+            written += size;
+            progress(written, vertex_bytes + index_bytes);
+        }
+    }
+    return writer.flush() || fail("write error");
+}
\ No newline at end of file
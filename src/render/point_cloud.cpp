@@ -0,0 +1,824 @@
+#include "point_cloud.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+
+#include "glad/glad.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace fs = std::filesystem;
+
+// 连续 8 位数字的 SWAR 转换依赖小端字节序
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define POINT_SWAR_DIGITS 0
+#else
+#define POINT_SWAR_DIGITS 1
+#endif
+
+// 网格每个方向上的单元数
+#define POINT_GRID_CELLS (1 << POINT_GRID_DEPTH)
+
+namespace {
+
+    const double powers_of_ten[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+
+    inline bool isDigit(char c) {
+        return (unsigned char)(c - '0') < 10;
+    }
+
+    inline bool isSeparator(char c) {
+        return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
+    }
+
+    // 8 个字节是否全为 ASCII 数字: 高半字节为 3, 且加 6 后不进位到高半字节
+    inline bool isEightDigits(uint64_t v) {
+        return ((v & 0xF0F0F0F0F0F0F0F0ULL) | (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+               0x3333333333333333ULL;
+    }
+
+    // 8 个数字字符一次转换为整数, 三次乘法依次把相邻的 1, 2, 4 位合并
+    inline uint32_t parseEightDigits(uint64_t v) {
+        v -= 0x3030303030303030ULL;
+        v = (v * 10) + (v >> 8);
+        v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+             (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+        return (uint32_t)v;
+    }
+
+    // 整段读入 8 位数字, 有效数字不超过 19 位, 保证 mantissa 不溢出
+    inline bool eightDigits(const char*& s, const char* end, uint64_t& mantissa, int& digits) {
+#if POINT_SWAR_DIGITS
+        if (end - s < 8 || digits > 11) return false;
+        uint64_t chunk;
+        memcpy(&chunk, s, sizeof(chunk));
+        if (!isEightDigits(chunk)) return false;
+        mantissa = mantissa * 100000000ULL + parseEightDigits(chunk);
+        digits += 8;
+        s += 8;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // 十进制数, 超出 19 位的有效数字只计入指数; 结果最终存为 float, 不需要严格的正确舍入
+    bool parseNumber(const char*& p, const char* end, double& out) {
+        const char* s = p;
+        bool negative = false;
+        if (s < end && (*s == '-' || *s == '+')) negative = *s++ == '-';
+
+        uint64_t mantissa = 0;
+        int digits = 0, exponent = 0;
+        bool any = false;
+        while (s < end && *s == '0') s++, any = true;
+        while (eightDigits(s, end, mantissa, digits)) any = true;
+        for (; s < end && isDigit(*s); s++, any = true) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*s - '0');
+                digits++;
+            } else {
+                exponent++;
+            }
+        }
+        if (s < end && *s == '.') {
+            s++;
+            if (mantissa == 0) {
+                for (; s < end && *s == '0'; s++, any = true) exponent--;
+            }
+            for (int before = digits; eightDigits(s, end, mantissa, digits); before = digits) {
+                exponent -= digits - before;
+                any = true;
+            }
+            for (; s < end && isDigit(*s); s++, any = true) {
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + (*s - '0');
+                    digits++;
+                    exponent--;
+                }
+            }
+        }
+        if (!any) return false;
+
+        if (s < end && (*s == 'e' || *s == 'E')) {
+            const char* e = s + 1;
+            bool negative_exponent = false;
+            if (e < end && (*e == '-' || *e == '+')) negative_exponent = *e++ == '-';
+            if (e < end && isDigit(*e)) {
+                int value = 0;
+                for (; e < end && isDigit(*e); e++) value = std::min(value * 10 + (*e - '0'), 100000);
+                exponent += negative_exponent ? -value : value;
+                s = e;
+            }
+        }
+
+        double value = (double)mantissa;
+        if (mantissa != 0 && exponent != 0) {
+            if (mantissa < (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+                value = exponent > 0 ? value * powers_of_ten[exponent] : value / powers_of_ten[-exponent];
+            } else {
+                value *= std::pow(10.0, exponent);
+            }
+        }
+        out = negative ? -value : value;
+        p = s;
+        return true;
+    }
+
+    // 一行的前三列, 其余列忽略; p 移到下一行开头
+    bool parseLine(const char*& p, const char* end, double* xyz) {
+        const char* eol = (const char*)memchr(p, '\n', end - p);
+        if (!eol) eol = end;
+        const char* s = p;
+        bool ok = true;
+        for (int i = 0; i < 3 && ok; i++) {
+            while (s < eol && isSeparator(*s)) s++;
+            ok = parseNumber(s, eol, xyz[i]) && (s == eol || isSeparator(*s));
+        }
+        p = eol < end ? eol + 1 : end;
+        return ok;
+    }
+
+    // 数据坐标 (x, y, z) 换到 OpenGL 坐标系 (x, z, -y), 相对于 origin
+    inline glm::vec3 toLocal(double x, double y, double z, const glm::dvec3& origin) {
+        return glm::vec3((float)(x - origin.x), (float)(z - origin.z), (float)(origin.y - y));
+    }
+
+    inline int octant(const glm::vec3& p, const glm::vec3& center) {
+        return (p.x >= center.x ? 1 : 0) | (p.y >= center.y ? 2 : 0) | (p.z >= center.z ? 4 : 0);
+    }
+
+    // 溢出文件放在 POINT_SPILL_DIR 下, 映射后目录项即被删除, 名字只需在同一时刻唯一
+    std::string spillPath(const char* kind) {
+        static std::atomic<uint64_t> serial(0);
+        std::error_code ec;
+        fs::create_directories(POINT_SPILL_DIR, ec);
+        return std::string(POINT_SPILL_DIR) + "/points-" + kind + "-" +
+               std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "-" +
+               std::to_string(serial.fetch_add(1)) + ".tmp";
+    }
+
+    // 把 10 位以内的整数的各位隔两位展开, 用于拼出 Morton 序
+    inline uint32_t spreadBits(uint32_t v) {
+        v = (v | (v << 16)) & 0x030000FF;
+        v = (v | (v << 8)) & 0x0300F00F;
+        v = (v | (v << 4)) & 0x030C30C3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    }
+
+    // 顶层 POINT_GRID_DEPTH 层节点对应的网格, 分界按逐层取 0.5f * (min + max) 得到, 与节点的中点逐位一致
+    struct PointGrid {
+        float bounds[3][POINT_GRID_CELLS + 1];
+        glm::vec3 lower;
+        float scale;
+
+        // 根节点是立方体, 各方向的单元大小相同
+        PointGrid(const glm::vec3& min, const glm::vec3& max)
+            : lower(min), scale((float)POINT_GRID_CELLS / (max.x - min.x))
+        {
+            for (int axis = 0; axis < 3; axis++) {
+                float* b = bounds[axis];
+                b[0] = min[axis];
+                b[POINT_GRID_CELLS] = max[axis];
+                for (int step = POINT_GRID_CELLS; step > 1; step /= 2) {
+                    for (int a = 0; a < POINT_GRID_CELLS; a += step) b[a + step / 2] = 0.5f * (b[a] + b[a + step]);
+                }
+            }
+        }
+
+        // 先按比例估计所在单元, 再用分界修正舍入误差, 结果与逐层比较中点相同
+        inline uint32_t index(const glm::vec3& p, int axis) const {
+            const float* b = bounds[axis];
+            int i = std::min(std::max((int)((p[axis] - lower[axis]) * scale), 0), POINT_GRID_CELLS - 1);
+            while (i > 0 && p[axis] < b[i]) i--;
+            while (i < POINT_GRID_CELLS - 1 && p[axis] >= b[i + 1]) i++;
+            return (uint32_t)i;
+        }
+
+        // 单元按 Morton 序编号, 最高的三位是根的八分体, 同一节点子树的单元连续
+        inline uint32_t cell(const glm::vec3& p) const {
+            return spreadBits(index(p, 0)) | (spreadBits(index(p, 1)) << 1) | (spreadBits(index(p, 2)) << 2);
+        }
+    };
+
+    // 按 sizes 在 nodes[parent] 的范围内依次建立非空的子节点, 子节点下标加入 next
+    void splitNode(std::vector<PointNode>& nodes, int parent, const uint64_t* sizes, std::vector<int>& next) {
+        PointNode node = nodes[parent];
+        glm::vec3 mid = 0.5f * (node.min + node.max);
+        uint32_t cursor = node.first;
+        nodes[parent].first_child = (int)nodes.size();
+        for (int o = 0; o < 8; o++) {
+            if (sizes[o] == 0) continue;
+            PointNode child;
+            child.min = glm::vec3(o & 1 ? mid.x : node.min.x, o & 2 ? mid.y : node.min.y, o & 4 ? mid.z : node.min.z);
+            child.max = glm::vec3(o & 1 ? node.max.x : mid.x, o & 2 ? node.max.y : mid.y, o & 4 ? node.max.z : mid.z);
+            child.first = cursor;
+            child.count = (uint32_t)sizes[o];
+            child.total = sizes[o];
+            child.first_child = -1;
+            child.child_count = 0;
+            cursor += child.count;
+            next.push_back((int)nodes.size());
+            nodes.push_back(child);
+            nodes[parent].child_count++;
+        }
+    }
+
+    // 就地按八分体分组 (American flag sort), 不需要额外的缓冲区
+    void partition(glm::vec3* points, size_t count, const glm::vec3& center, uint64_t* sizes) {
+        for (int o = 0; o < 8; o++) sizes[o] = 0;
+        for (size_t i = 0; i < count; i++) sizes[octant(points[i], center)]++;
+        uint64_t heads[8], tails[8];
+        for (int o = 0; o < 8; o++) {
+            heads[o] = o == 0 ? 0 : tails[o - 1];
+            tails[o] = heads[o] + sizes[o];
+        }
+        for (int o = 0; o < 8; o++) {
+            while (heads[o] < tails[o]) {
+                glm::vec3 p = points[heads[o]];
+                // 沿置换环把点依次换到各自分组的下一个空位, 直到换回属于 o 的点
+                for (int t = octant(p, center); t != o; t = octant(p, center)) std::swap(p, points[heads[t]++]);
+                points[heads[o]++] = p;
+            }
+        }
+    }
+
+}
+
+const glm::vec3* PointSource::read(size_t first, size_t n, glm::vec3* buffer) const {
+    if (!convert) return (const glm::vec3*)data + first;
+    const size_t stride = 3 * sizeof(float);
+    for (size_t i = 0; i < n; i++) {
+        float v[3];
+        memcpy(v, data + (first + i) * stride, stride);
+        buffer[i] = toLocal(v[0], v[1], v[2], origin);
+    }
+    return buffer;
+}
+
+PointCloudBuilder::PointCloudBuilder(ThreadPool& pool)
+    : _pool(pool)
+{
+}
+
+bool PointCloudBuilder::fail(const std::string& message) {
+    _error = message;
+    return false;
+}
+
+bool PointCloudBuilder::load(const std::string& path, PointOctree& tree, TaskContext& context) {
+    MappedFile file;
+    if (!file.open(path)) return fail("cannot open '" + path + "'");
+
+    std::string extension;
+    size_t dot = path.find_last_of('.');
+    if (dot != std::string::npos && path.find_first_of("/\\", dot) == std::string::npos) {
+        for (size_t i = dot; i < path.size(); i++) extension += (char)tolower((unsigned char)path[i]);
+    }
+    // 二进制直接从源文件的映射读取, 文本先解析到临时文件, 点都不在堆上
+    MappedFile parsed;
+    PointSource source;
+    bool ok = extension == ".bin" || extension == ".xyzb" ? parseBinary(file.data(), file.size(), source)
+                                                          : parseText(file.data(), file.size(), parsed, source, context);
+    std::vector<int> chunks;
+    ok = ok && distribute(source, tree, chunks, context);
+    file.close();
+    parsed.close();
+    if (!ok) return false;
+
+    // 各网格单元的点互不重叠, 并行细分, 再按顺序把子树接到节点表末尾, 结果与线程数无关
+    std::vector<std::vector<PointNode>> subtrees(chunks.size());
+    std::vector<int> depths(chunks.size(), 0);
+    _pool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end && !context.shouldStop(); i++) refine(tree, chunks[i], subtrees[i], depths[i]);
+    });
+    if (context.shouldStop()) return fail("cancelled");
+    for (size_t i = 0; i < chunks.size(); i++) {
+        std::vector<PointNode>& subtree = subtrees[i];
+        int base = (int)tree.nodes.size() - 1;
+        for (size_t k = 1; k < subtree.size(); k++) {
+            if (subtree[k].first_child >= 0) subtree[k].first_child += base;
+            tree.nodes.push_back(subtree[k]);
+        }
+        if (subtree[0].first_child >= 0) {
+            tree.nodes[chunks[i]].first_child = subtree[0].first_child + base;
+            tree.nodes[chunks[i]].child_count = subtree[0].child_count;
+        }
+        tree.depth = std::max(tree.depth, depths[i]);
+    }
+    context.setProgress(0.9f);
+    return sample(tree, context);
+}
+
+bool PointCloudBuilder::parseText(const char* data, size_t size, MappedFile& spill, PointSource& source,
+                                  TaskContext& context) {
+    // 第一个有效的点作为原点, 同时跳过表头
+    const char* end = data + size;
+    const char* p = data;
+    double xyz[3];
+    bool found = false;
+    while (p < end && !found) found = parseLine(p, end, xyz);
+    if (!found) return fail("no points found");
+    glm::dvec3 origin(xyz[0], xyz[1], xyz[2]);
+
+    // 块边界移到名义位置之后的第一个换行之后, 每一行完整地落在一个块中
+    size_t chunks = (size + POINT_PARSE_CHUNK - 1) / POINT_PARSE_CHUNK;
+    std::vector<size_t> bounds(chunks + 1, size);
+    bounds[0] = 0;
+    for (size_t c = 1; c < chunks; c++) {
+        size_t pos = std::max((size_t)c * POINT_PARSE_CHUNK, bounds[c - 1]);
+        const char* newline = (const char*)memchr(data + pos, '\n', size - pos);
+        bounds[c] = newline ? newline + 1 - data : size;
+    }
+
+    // 先数行数确定每块的写入位置, 再并行解析到临时文件, 最后把无效行留下的空位压实
+    std::vector<size_t> offsets(chunks + 1, 0), valid(chunks, 0);
+    _pool.parallelFor(chunks, 1, [&](size_t begin, size_t end_chunk) {
+        for (size_t c = begin; c < end_chunk; c++) {
+            const char* s = data + bounds[c];
+            const char* e = data + bounds[c + 1];
+            size_t lines = 0;
+            for (const char* q = s; (q = (const char*)memchr(q, '\n', e - q)); q++) lines++;
+            if (e > s && e[-1] != '\n') lines++;
+            offsets[c + 1] = lines;
+        }
+    });
+    for (size_t c = 0; c < chunks; c++) offsets[c + 1] += offsets[c];
+    if (offsets[chunks] > UINT32_MAX) return fail("too many points");
+    if (!spill.createTemporary(spillPath("parsed"), offsets[chunks] * sizeof(glm::vec3))) {
+        return fail("cannot create spill file in '" POINT_SPILL_DIR "'");
+    }
+    glm::vec3* points = (glm::vec3*)spill.writableData();
+
+    std::atomic<size_t> parsed(0);
+    _pool.parallelFor(chunks, 1, [&](size_t begin, size_t end_chunk) {
+        for (size_t c = begin; c < end_chunk && !context.shouldStop(); c++) {
+            const char* s = data + bounds[c];
+            const char* e = data + bounds[c + 1];
+            glm::vec3* out = points + offsets[c];
+            size_t count = 0;
+            double v[3];
+            while (s < e) {
+                if (parseLine(s, e, v)) out[count++] = toLocal(v[0], v[1], v[2], origin);
+            }
+            valid[c] = count;
+            context.setProgress(0.4f * (float)(parsed.fetch_add(1) + 1) / chunks);
+        }
+    });
+    if (context.shouldStop()) return fail("cancelled");
+
+    size_t count = 0;
+    for (size_t c = 0; c < chunks; c++) {
+        if (offsets[c] != count && valid[c]) {
+            memmove(points + count, points + offsets[c], valid[c] * sizeof(glm::vec3));
+        }
+        count += valid[c];
+    }
+    source.data = spill.data();
+    source.count = count;
+    source.convert = false;
+    source.origin = origin;
+    return true;
+}
+
+bool PointCloudBuilder::parseBinary(const char* data, size_t size, PointSource& source) {
+    const size_t stride = 3 * sizeof(float);
+    if (size % stride != 0) return fail("binary XYZ size is not a multiple of 12 bytes");
+    size_t count = size / stride;
+    if (count == 0) return fail("no points found");
+    if (count > UINT32_MAX) return fail("too many points");
+
+    float first[3];
+    memcpy(first, data, stride);
+    source.data = data;
+    source.count = count;
+    source.convert = true;
+    source.origin = glm::dvec3(first[0], first[1], first[2]);
+    return true;
+}
+
+bool PointCloudBuilder::distribute(const PointSource& source, PointOctree& tree, std::vector<int>& chunks,
+                                   TaskContext& context) {
+    size_t count = source.count;
+    if (count == 0) return fail("no points found");
+    if (count > UINT32_MAX) return fail("too many points");
+    tree.origin = source.origin;
+
+    size_t blocks = (count + POINT_PARTITION_GRAIN - 1) / POINT_PARTITION_GRAIN;
+    std::vector<glm::vec3> lowers(blocks), uppers(blocks);
+    _pool.parallelFor(blocks, 1, [&](size_t begin, size_t end) {
+        std::vector<glm::vec3> buffer(POINT_PARTITION_GRAIN);
+        for (size_t c = begin; c < end && !context.shouldStop(); c++) {
+            size_t a = c * POINT_PARTITION_GRAIN, n = std::min<size_t>(POINT_PARTITION_GRAIN, count - a);
+            const glm::vec3* points = source.read(a, n, buffer.data());
+            glm::vec3 lo = points[0], hi = points[0];
+            for (size_t i = 1; i < n; i++) {
+                lo = glm::min(lo, points[i]);
+                hi = glm::max(hi, points[i]);
+            }
+            lowers[c] = lo;
+            uppers[c] = hi;
+        }
+    });
+    if (context.shouldStop()) return fail("cancelled");
+    tree.lower = lowers[0];
+    tree.upper = uppers[0];
+    for (size_t c = 1; c < blocks; c++) {
+        tree.lower = glm::min(tree.lower, lowers[c]);
+        tree.upper = glm::max(tree.upper, uppers[c]);
+    }
+    context.setProgress(0.5f);
+
+    // 根节点取包住全部点的立方体, 子节点都是立方体, 屏幕大小的估计在各方向上一致
+    glm::vec3 center = 0.5f * (tree.lower + tree.upper);
+    glm::vec3 extent = tree.upper - tree.lower;
+    float half = std::max(0.5f * std::max(std::max(extent.x, extent.y), extent.z) * 1.0001f, 1e-6f);
+    tree.nodes.clear();
+    tree.nodes.push_back({center - glm::vec3(half), center + glm::vec3(half), 0, (uint32_t)count, count, -1, 0});
+    tree.depth = 0;
+
+    // 源数据分成固定的条带, 每个条带分别按网格单元计数, 再换算成各条带在每个单元中的写入位置
+    // 分发后点在文件中按单元的 Morton 序排列, 每个单元内保持源数据的顺序
+    const PointGrid grid(tree.nodes[0].min, tree.nodes[0].max);
+    const size_t cells = (size_t)1 << (3 * POINT_GRID_DEPTH);
+    const size_t stripe = (count + POINT_SCATTER_STRIPES - 1) / POINT_SCATTER_STRIPES;
+    std::vector<uint32_t> cursors(POINT_SCATTER_STRIPES * cells, 0);
+    auto stripes = [&](const std::function<void(uint32_t* cursor, const glm::vec3* points, size_t n)>& visit) {
+        _pool.parallelFor(POINT_SCATTER_STRIPES, 1, [&](size_t begin, size_t end) {
+            std::vector<glm::vec3> buffer(POINT_PARTITION_GRAIN);
+            for (size_t s = begin; s < end; s++) {
+                size_t a = std::min(s * stripe, count), b = std::min(a + stripe, count);
+                for (size_t i = a; i < b && !context.shouldStop(); i += POINT_PARTITION_GRAIN) {
+                    size_t n = std::min<size_t>(POINT_PARTITION_GRAIN, b - i);
+                    visit(cursors.data() + s * cells, source.read(i, n, buffer.data()), n);
+                }
+            }
+        });
+    };
+    stripes([&](uint32_t* cursor, const glm::vec3* points, size_t n) {
+        for (size_t i = 0; i < n; i++) cursor[grid.cell(points[i])]++;
+    });
+    if (context.shouldStop()) return fail("cancelled");
+
+    std::vector<uint64_t> starts(cells + 1, 0);
+    for (size_t cell = 0; cell < cells; cell++) {
+        uint64_t next = starts[cell];
+        for (size_t s = 0; s < POINT_SCATTER_STRIPES; s++) {
+            uint32_t n = cursors[s * cells + cell];
+            cursors[s * cells + cell] = (uint32_t)next;
+            next += n;
+        }
+        starts[cell + 1] = next;
+    }
+
+    if (!tree.points.createTemporary(spillPath("nodes"), count * sizeof(glm::vec3))) {
+        return fail("cannot create spill file in '" POINT_SPILL_DIR "'");
+    }
+    glm::vec3* out = (glm::vec3*)tree.points.writableData();
+    stripes([&](uint32_t* cursor, const glm::vec3* points, size_t n) {
+        for (size_t i = 0; i < n; i++) out[cursor[grid.cell(points[i])]++] = points[i];
+    });
+    if (context.shouldStop()) return fail("cancelled");
+    cursors.clear();
+    cursors.shrink_to_fit();
+    context.setProgress(0.7f);
+
+    // 顶层节点直接由单元的前缀和建立: 深度 d 的节点对应连续的 8^(POINT_GRID_DEPTH - d) 个单元
+    std::vector<size_t> cell_first = {0};
+    std::vector<int> level = {0}, next;
+    for (int depth = 0; depth < POINT_GRID_DEPTH && !level.empty(); depth++) {
+        size_t span = cells >> (3 * (depth + 1));
+        next.clear();
+        for (int parent : level) {
+            if (tree.nodes[parent].total <= POINT_NODE_CAPACITY) continue;
+            uint64_t sizes[8];
+            for (int o = 0; o < 8; o++) {
+                size_t first = cell_first[parent] + o * span;
+                sizes[o] = starts[first + span] - starts[first];
+                if (sizes[o] > 0) cell_first.push_back(first);
+            }
+            splitNode(tree.nodes, parent, sizes, next);
+        }
+        if (!next.empty()) tree.depth = depth + 1;
+        level.swap(next);
+    }
+
+    // 到达网格深度仍超出容量的节点在文件中就地继续细分
+    chunks.clear();
+    for (int n : level) {
+        if (tree.nodes[n].total > POINT_NODE_CAPACITY) chunks.push_back(n);
+    }
+    return true;
+}
+
+void PointCloudBuilder::refine(PointOctree& tree, int chunk, std::vector<PointNode>& subtree, int& depth) {
+    glm::vec3* points = (glm::vec3*)tree.points.writableData();
+    subtree.assign(1, tree.nodes[chunk]);
+    subtree[0].first_child = -1;
+    subtree[0].child_count = 0;
+    depth = POINT_GRID_DEPTH;
+    std::vector<int> level = {0}, next;
+    for (int d = POINT_GRID_DEPTH; d < POINT_MAX_DEPTH && !level.empty(); d++) {
+        next.clear();
+        for (int parent : level) {
+            const PointNode& node = subtree[parent];
+            if (node.total <= POINT_NODE_CAPACITY) continue;
+            uint64_t sizes[8];
+            partition(points + node.first, node.total, 0.5f * (node.min + node.max), sizes);
+            splitNode(subtree, parent, sizes, next);
+        }
+        if (!next.empty()) depth = d + 1;
+        level.swap(next);
+    }
+}
+
+bool PointCloudBuilder::sample(PointOctree& tree, TaskContext& context) {
+    // 内部节点从子树范围中等距抽取 1 / POINT_SAMPLE_RATIO 的点 (至多 POINT_NODE_CAPACITY 个)
+    // 子树按八分体递归排列, 等距抽样在空间上也是均匀的
+    // 到达最大深度仍超出容量的叶节点 (大量重合的点) 只绘制前 POINT_NODE_CAPACITY 个
+    std::vector<int> internal;
+    std::vector<size_t> offsets = {0};
+    for (size_t n = 0; n < tree.nodes.size(); n++) {
+        PointNode& node = tree.nodes[n];
+        if (node.isLeaf()) {
+            node.count = std::min<uint32_t>(node.count, POINT_NODE_CAPACITY);
+            continue;
+        }
+        internal.push_back((int)n);
+        uint64_t samples = std::min<uint64_t>((node.total + POINT_SAMPLE_RATIO - 1) / POINT_SAMPLE_RATIO, POINT_NODE_CAPACITY);
+        offsets.push_back(offsets.back() + samples);
+    }
+    if (offsets.back() > 0 && !tree.samples.createTemporary(spillPath("samples"), offsets.back() * sizeof(glm::vec3))) {
+        return fail("cannot create spill file in '" POINT_SPILL_DIR "'");
+    }
+    const glm::vec3* points = (const glm::vec3*)tree.points.data();
+    glm::vec3* samples = (glm::vec3*)tree.samples.writableData();
+    _pool.parallelFor(internal.size(), 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end && !context.shouldStop(); i++) {
+            PointNode& node = tree.nodes[internal[i]];
+            uint64_t count = offsets[i + 1] - offsets[i];
+            glm::vec3* out = samples + offsets[i];
+            for (uint64_t k = 0; k < count; k++) out[k] = points[node.first + k * node.total / count];
+            node.first = (uint32_t)offsets[i];
+            node.count = (uint32_t)count;
+        }
+    });
+    if (context.shouldStop()) return fail("cancelled");
+    context.setProgress(1.0f);
+    return true;
+}
+
+PointCloud::PointCloud(ThreadPool& pool, size_t budget)
+    : _pool(pool), _vao(0), _buffer(0), _budget(budget), _slot_count(0), _frame(0),
+      _drawn_points(0), _resident(0), _model(1.0f)
+{
+    glGenVertexArrays(1, &_vao);
+    glGenBuffers(1, &_buffer);
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (const void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+PointCloud::~PointCloud() {
+    cancel();
+    if (_buffer) {
+        glDeleteBuffers(1, &_buffer);
+    }
+    if (_vao) {
+        glDeleteVertexArrays(1, &_vao);
+    }
+}
+
+void PointCloud::load(const std::string& path) {
+    cancel();
+    _path = path;
+    _loading = std::make_shared<PointOctree>();
+    _status = "Loading " + path;
+
+    std::shared_ptr<PointOctree> tree = _loading;
+    ThreadPool* pool = &_pool;
+    _task.start([tree, pool, path](TaskContext& context, std::string& error) -> std::string {
+        auto start = std::chrono::steady_clock::now();
+        PointCloudBuilder builder(*pool);
+        if (!builder.load(path, *tree, context)) {
+            error = builder.error();
+            return std::string();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        char summary[128];
+        snprintf(summary, sizeof(summary), "%zu points, %zu nodes, depth %d (%.2f s)", (size_t)tree->nodes[0].total,
+                 tree->nodes.size(), tree->depth, seconds);
+        return summary;
+    }, POINT_LOAD_TIMEOUT_SECONDS);
+}
+
+void PointCloud::cancel() {
+    if (!_task.running()) return;
+    _task.cancel();
+    _loading.reset();
+    _status = "Cancelled";
+}
+
+void PointCloud::clear() {
+    cancel();
+    _tree.reset();
+    _status.clear();
+    release();
+}
+
+void PointCloud::poll() {
+    if (!_task.poll()) return;
+    switch (_task.state()) {
+        case TaskState::Done: {
+            _tree = _loading;
+            _status = _task.result();
+            // 根立方体缩放到 [-1, 1]
+            const PointNode& root = _tree->nodes[0];
+            float half = 0.5f * (root.max.x - root.min.x);
+            _model = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / half));
+            _model = glm::translate(_model, -0.5f * (root.min + root.max));
+            allocate();
+            break;
+        }
+        case TaskState::TimedOut:
+            _status = "Loading timed out";
+            break;
+        default:
+            _status = _task.error();
+            break;
+    }
+    _loading.reset();
+}
+
+void PointCloud::allocate() {
+    size_t slot_bytes = POINT_NODE_CAPACITY * sizeof(glm::vec3);
+    _slot_count = (int)std::max<size_t>(_budget / slot_bytes, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(_slot_count * slot_bytes), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    _node_slot.assign(_tree ? _tree->nodes.size() : 0, -1);
+    _slot_node.assign(_slot_count, -1);
+    _slot_frame.assign(_slot_count, 0);
+    _resident = 0;
+    _firsts.clear();
+    _counts.clear();
+}
+
+void PointCloud::release() {
+    glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+    glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    _slot_count = 0;
+    _node_slot.clear();
+    _slot_node.clear();
+    _slot_frame.clear();
+    _resident = 0;
+    _firsts.clear();
+    _counts.clear();
+    _drawn_points = 0;
+}
+
+void PointCloud::setBudget(size_t bytes) {
+    _budget = bytes;
+    if (_tree) allocate();
+}
+
+bool PointCloud::upload(int node) {
+    // 空闲槽位的帧号为 0, 总是最先被选中; 本帧用到的槽位不回收
+    int slot = -1;
+    for (int s = 0; s < _slot_count; s++) {
+        if (_slot_frame[s] < _frame && (slot < 0 || _slot_frame[s] < _slot_frame[slot])) slot = s;
+    }
+    if (slot < 0) return false;
+
+    if (_slot_node[slot] >= 0) {
+        _node_slot[_slot_node[slot]] = -1;
+    } else {
+        _resident++;
+    }
+    const PointNode& info = _tree->nodes[node];
+    glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)((size_t)slot * POINT_NODE_CAPACITY * sizeof(glm::vec3)),
+                    (GLsizeiptr)(info.count * sizeof(glm::vec3)), _tree->drawPoints(info));
+    _slot_node[slot] = node;
+    _node_slot[node] = slot;
+    _slot_frame[slot] = _frame;
+    return true;
+}
+
+void PointCloud::update(const glm::mat4& view_proj, const glm::vec3& camera_pos, float fov_y, float viewport_height) {
+    _firsts.clear();
+    _counts.clear();
+    _drawn_points = 0;
+    if (!_tree) return;
+    _frame++;
+
+    const PointOctree& tree = *_tree;
+    // 视锥的六个平面 (Gribb-Hartmann), 在模型空间中与节点的包围盒比较
+    glm::mat4 mvp = view_proj * _model;
+    glm::vec4 planes[6];
+    for (int i = 0; i < 3; i++) {
+        glm::vec4 row(mvp[0][i], mvp[1][i], mvp[2][i], mvp[3][i]);
+        glm::vec4 w(mvp[0][3], mvp[1][3], mvp[2][3], mvp[3][3]);
+        planes[2 * i] = w + row;
+        planes[2 * i + 1] = w - row;
+    }
+    auto visible = [&](const PointNode& node) {
+        for (const glm::vec4& plane : planes) {
+            glm::vec3 corner(plane.x >= 0.0f ? node.max.x : node.min.x, plane.y >= 0.0f ? node.max.y : node.min.y,
+                             plane.z >= 0.0f ? node.max.z : node.min.z);
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) return false;
+        }
+        return true;
+    };
+
+    // 模型变换是均匀缩放加平移, 在模型空间中算出的像素大小与世界空间一致
+    glm::vec3 eye = glm::vec3(glm::inverse(_model) * glm::vec4(camera_pos, 1.0f));
+    float pixels = viewport_height / (2.0f * std::tan(0.5f * fov_y));
+    auto projected = [&](const PointNode& node) {
+        glm::vec3 center = 0.5f * (node.min + node.max);
+        float radius = 0.5f * glm::length(node.max - node.min);
+        float distance = std::max(glm::length(center - eye) - radius, 1e-3f * radius);
+        return 2.0f * radius * pixels / distance;
+    };
+
+    // 按屏幕上的大小从大到小展开, 预算先给离得近的大节点
+    std::vector<std::pair<float, int>> queue, requests;
+    if (!visible(tree.nodes[0])) return;
+    if (_node_slot[0] < 0) {
+        requests.push_back({0.0f, 0});
+    } else {
+        queue.push_back({projected(tree.nodes[0]), 0});
+    }
+    int used = (int)queue.size();
+    while (!queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end());
+        auto [size, n] = queue.back();
+        queue.pop_back();
+        const PointNode& node = tree.nodes[n];
+        int slot = _node_slot[n];
+        _slot_frame[slot] = _frame;
+
+        if (!node.isLeaf() && size / std::sqrt((float)node.count) > POINT_SPACING_PX) {
+            // 可见的子节点全部在显存中时才以子节点代替, 否则先请求上传, 本帧仍画自己
+            int needed = 0;
+            bool ready = true;
+            for (int c = node.first_child; c < node.first_child + node.child_count; c++) {
+                if (!visible(tree.nodes[c])) continue;
+                needed++;
+                if (_node_slot[c] < 0) ready = false;
+            }
+            if (used + needed <= _slot_count) {
+                if (ready) {
+                    for (int c = node.first_child; c < node.first_child + node.child_count; c++) {
+                        if (!visible(tree.nodes[c])) continue;
+                        queue.push_back({projected(tree.nodes[c]), c});
+                        std::push_heap(queue.begin(), queue.end());
+                    }
+                    used += needed;
+                    continue;
+                }
+                for (int c = node.first_child; c < node.first_child + node.child_count; c++) {
+                    if (_node_slot[c] < 0 && visible(tree.nodes[c])) requests.push_back({size, c});
+                }
+            }
+        }
+
+        _firsts.push_back(slot * POINT_NODE_CAPACITY);
+        _counts.push_back((int)node.count);
+        _drawn_points += node.count;
+    }
+
+    // 优先上传父节点在屏幕上较大的
+    std::stable_sort(requests.begin(), requests.end(),
+                     [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first > b.first; });
+    glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+    for (size_t i = 0; i < requests.size() && i < POINT_UPLOADS_PER_FRAME; i++) {
+        if (!upload(requests[i].second)) break;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PointCloud::draw() const {
+    if (_counts.empty()) return;
+    glBindVertexArray(_vao);
+    glMultiDrawArrays(GL_POINTS, _firsts.data(), _counts.data(), (GLsizei)_counts.size());
+    glBindVertexArray(0);
+}
+
+glm::vec2 PointCloud::heightRange() const {
+    return _tree ? glm::vec2(_tree->lower.y, _tree->upper.y) : glm::vec2(0.0f, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,382 @@
+#include "procedural.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "arena.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#define PROCEDURAL_ROW_GRAIN 16
+// 噪声按列分块的宽度 (像素)
+#define PROCEDURAL_NOISE_STRIP 256
+// 缓存像素的总字节数上限, 约两张 4K RGBA8 纹理
+#define PROCEDURAL_CACHE_BYTES (128u * 1024 * 1024)
+
+static const float grad_x[8] = {1.0f, -1.0f, 0.0f, 0.0f, 0.70710678f, -0.70710678f, 0.70710678f, -0.70710678f};
+static const float grad_y[8] = {0.0f, 0.0f, 1.0f, -1.0f, 0.70710678f, 0.70710678f, -0.70710678f, -0.70710678f};
+
+// 晶格坐标先对周期取模再哈希, 周期不受置换表大小限制, 任意周期都能无缝平铺
+static inline uint32_t latticeHash(int x, int y, uint32_t seed) {
+    uint32_t h = seed * 0x9e3779b9u ^ (uint32_t)x * 0x85ebca6bu ^ (uint32_t)y * 0xc2b2ae35u;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+static inline float fade(float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+// 像素 x 属于晶格 floor((x + 0.5) * period / width), 返回晶格 c 覆盖的第一个像素
+static inline int cellStart(int c, int period, int width) {
+    int64_t num = 2 * (int64_t)width * c - period;
+    int64_t den = 2 * (int64_t)period;
+    int64_t start = num <= 0 ? 0 : (num + den - 1) / den;
+    return (int)std::min<int64_t>(start, width);
+}
+
+// 一条晶格行沿 x 插值后的结果为 a[x] + yf * b[x], 只与 x 和晶格行有关, 同一晶格带内的像素行共用
+// 只计算像素 [x_begin, x_end), 结果从 a[0] 开始存放
+static void latticeRow(const ProceduralParams& p, int period, int row, int x_begin, int x_end, float* a, float* b) {
+    int width = p.width;
+    float scale_x = (float)period / width;
+    int first = (int)(((2 * (int64_t)x_begin + 1) * period) / (2 * (int64_t)width));
+    for (int c = first; c < period; c++) {
+        int begin = std::max(cellStart(c, period, width), x_begin);
+        int end = std::min(cellStart(c + 1, period, width), x_end);
+        if (begin >= x_end) break;
+        if (begin >= end) continue;
+        uint32_t h0 = latticeHash(c, row, p.seed);
+        uint32_t h1 = latticeHash((c + 1) % period, row, p.seed);
+        float offset = (float)c;
+
+        if (p.noise == NoiseType::Perlin) {
+            float g0x = grad_x[h0 & 7], g1x = grad_x[h1 & 7];
+            float g0y = grad_y[h0 & 7], g1y = grad_y[h1 & 7];
+            for (int x = begin; x < end; x++) {
+                float xf = (x + 0.5f) * scale_x - offset;
+                float fx = fade(xf);
+                float n0 = g0x * xf;
+                float n1 = g1x * (xf - 1.0f);
+                a[x - x_begin] = n0 + fx * (n1 - n0);
+                b[x - x_begin] = g0y + fx * (g1y - g0y);
+            }
+        } else {
+            float v0 = (h0 & 255) * (2.0f / 255.0f) - 1.0f;
+            float v1 = (h1 & 255) * (2.0f / 255.0f) - 1.0f;
+            for (int x = begin; x < end; x++) {
+                float fx = fade((x + 0.5f) * scale_x - offset);
+                a[x - x_begin] = v0 + fx * (v1 - v0);
+            }
+        }
+    }
+}
+
+// acc += k0 * a0 + k1 * b0 + k2 * a1 + k3 * b1, Value 噪声没有 b 项
+static void accumulateRow(float* acc, int width, const float* a0, const float* b0, const float* a1, const float* b1,
+                          float k0, float k1, float k2, float k3) {
+    int x = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128 v0 = _mm_set1_ps(k0), v2 = _mm_set1_ps(k2);
+    if (b0) {
+        const __m128 v1 = _mm_set1_ps(k1), v3 = _mm_set1_ps(k3);
+        for (; x + 4 <= width; x += 4) {
+            __m128 s = _mm_add_ps(_mm_mul_ps(v0, _mm_loadu_ps(a0 + x)), _mm_mul_ps(v1, _mm_loadu_ps(b0 + x)));
+            __m128 t = _mm_add_ps(_mm_mul_ps(v2, _mm_loadu_ps(a1 + x)), _mm_mul_ps(v3, _mm_loadu_ps(b1 + x)));
+            _mm_storeu_ps(acc + x, _mm_add_ps(_mm_loadu_ps(acc + x), _mm_add_ps(s, t)));
+        }
+    } else {
+        for (; x + 4 <= width; x += 4) {
+            __m128 s = _mm_add_ps(_mm_mul_ps(v0, _mm_loadu_ps(a0 + x)), _mm_mul_ps(v2, _mm_loadu_ps(a1 + x)));
+            _mm_storeu_ps(acc + x, _mm_add_ps(_mm_loadu_ps(acc + x), s));
+        }
+    }
+#endif
+    for (; x < width; x++) {
+        float s = k0 * a0[x] + k2 * a1[x];
+        if (b0) s += k1 * b0[x] + k3 * b1[x];
+        acc[x] += s;
+    }
+}
+
+static void shadeRow(const float* t, int width, const unsigned char* a, const unsigned char* b, unsigned char* dst) {
+    float base[4], delta[4];
+    for (int c = 0; c < 4; c++) {
+        base[c] = a[c] + 0.5f;
+        delta[c] = (float)b[c] - (float)a[c];
+    }
+    int x = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+    // 一次处理 4 个像素, 各通道结果打包为 32 位后整体写出
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 vb[4], vd[4];
+    for (int c = 0; c < 4; c++) {
+        vb[c] = _mm_set1_ps(base[c]);
+        vd[c] = _mm_set1_ps(delta[c]);
+    }
+    for (; x + 4 <= width; x += 4) {
+        __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(t + x), zero), one);
+        __m128i packed = _mm_cvttps_epi32(_mm_add_ps(vb[0], _mm_mul_ps(vd[0], v)));
+        for (int c = 1; c < 4; c++) {
+            __m128i channel = _mm_cvttps_epi32(_mm_add_ps(vb[c], _mm_mul_ps(vd[c], v)));
+            packed = _mm_or_si128(packed, _mm_slli_epi32(channel, 8 * c));
+        }
+        _mm_storeu_si128((__m128i*)(dst + 4 * x), packed);
+    }
+#endif
+    for (; x < width; x++) {
+        float v = std::min(std::max(t[x], 0.0f), 1.0f);
+        for (int c = 0; c < 4; c++) {
+            dst[4 * x + c] = (unsigned char)(base[c] + delta[c] * v);
+        }
+    }
+}
+
+ProceduralParams ProceduralParams::checkerboard(int width, int height, int tileSize) {
+    ProceduralParams p;
+    p.kind = ProceduralKind::Checkerboard;
+    p.width = width;
+    p.height = height;
+    p.tile_size = tileSize;
+    return p;
+}
+
+ProceduralParams ProceduralParams::gradient(int width, int height, GradientShape shape) {
+    ProceduralParams p;
+    p.kind = ProceduralKind::Gradient;
+    p.width = width;
+    p.height = height;
+    p.shape = shape;
+    return p;
+}
+
+ProceduralParams ProceduralParams::fbm(int width, int height, NoiseType type, int frequency, int octaves, uint32_t seed) {
+    ProceduralParams p;
+    p.kind = ProceduralKind::Noise;
+    p.width = width;
+    p.height = height;
+    p.noise = type;
+    p.frequency = frequency;
+    p.octaves = octaves;
+    p.seed = seed;
+    return p;
+}
+
+bool ProceduralParams::operator==(const ProceduralParams& o) const {
+    return kind == o.kind && width == o.width && height == o.height
+        && memcmp(color_a, o.color_a, 4) == 0 && memcmp(color_b, o.color_b, 4) == 0
+        && tile_size == o.tile_size && shape == o.shape && noise == o.noise
+        && frequency == o.frequency && octaves == o.octaves && lacunarity == o.lacunarity
+        && gain == o.gain && seed == o.seed;
+}
+
+uint64_t ProceduralParams::hash() const {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void* data, size_t size) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++) {
+            h ^= bytes[i];
+            h *= 1099511628211ull;
+        }
+    };
+    int fields[] = {(int)kind, width, height, tile_size, (int)shape, (int)noise, frequency, octaves, lacunarity};
+    mix(fields, sizeof(fields));
+    mix(color_a, 4);
+    mix(color_b, 4);
+    mix(&gain, sizeof(gain));
+    mix(&seed, sizeof(seed));
+    return h;
+}
+
+ProceduralGenerator::ProceduralGenerator(ThreadPool& pool)
+    : _pool(pool)
+{
+}
+
+// 棋盘格只有两种不同的行, 先各生成一行再整行拷贝
+void ProceduralGenerator::fillCheckerboard(const ProceduralParams& p, unsigned char* dst) {
+    size_t stride = (size_t)p.width * 4;
+    int tile = std::max(p.tile_size, 1);
+    std::vector<unsigned char> rows(stride * 2);
+    for (int x = 0; x < p.width; x++) {
+        bool odd = (x / tile) & 1;
+        memcpy(&rows[x * 4], odd ? p.color_a : p.color_b, 4);
+        memcpy(&rows[stride + x * 4], odd ? p.color_b : p.color_a, 4);
+    }
+    _pool.parallelFor(p.height, PROCEDURAL_ROW_GRAIN * 4, [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; y++) {
+            memcpy(dst + y * stride, &rows[((y / tile) & 1) * stride], stride);
+        }
+    });
+}
+
+void ProceduralGenerator::fillGradient(const ProceduralParams& p, unsigned char* dst) {
+    size_t stride = (size_t)p.width * 4;
+    float inv_w = 1.0f / std::max(p.width - 1, 1);
+    float inv_h = 1.0f / std::max(p.height - 1, 1);
+    float cx = 0.5f * (p.width - 1);
+    float cy = 0.5f * (p.height - 1);
+    float inv_r = 1.0f / std::sqrt(cx * cx + cy * cy);
+
+    _pool.parallelFor(p.height, PROCEDURAL_ROW_GRAIN, [&](size_t begin, size_t end) {
+        // 行缓冲取自当前线程的临时内存, 任务结束时回滚
+        ScratchScope scratch;
+        float* t = scratch.allocateArray<float>(p.width);
+        for (size_t y = begin; y < end; y++) {
+            switch (p.shape) {
+                case GradientShape::Horizontal:
+                    for (int x = 0; x < p.width; x++) t[x] = x * inv_w;
+                    break;
+                case GradientShape::Vertical:
+                    std::fill(t, t + p.width, y * inv_h);
+                    break;
+                case GradientShape::Radial: {
+                    float dy = y - cy;
+                    for (int x = 0; x < p.width; x++) {
+                        float dx = x - cx;
+                        t[x] = std::sqrt(dx * dx + dy * dy) * inv_r;
+                    }
+                    break;
+                }
+            }
+            shadeRow(t, p.width, p.color_a, p.color_b, dst + y * stride);
+        }
+    });
+}
+
+// 可平铺的分形噪声: 双线性插值按 y 拆开, 每个倍频只在晶格带变化时计算一次晶格行, 带内每个像素只剩 4 次乘加;
+// 任务内再按 PROCEDURAL_NOISE_STRIP 列分块, 累加缓冲与晶格行都留在 L1 中, 相邻晶格带共用一条晶格行
+void ProceduralGenerator::fillNoise(const ProceduralParams& p, unsigned char* dst) {
+    size_t stride = (size_t)p.width * 4;
+    int width = p.width;
+    int height = p.height;
+    bool perlin = p.noise == NoiseType::Perlin;
+
+    float amp_sum = 0.0f;
+    float amp = 1.0f;
+    for (int o = 0; o < p.octaves; o++) {
+        amp_sum += amp;
+        amp *= p.gain;
+    }
+    // 单位梯度的二维 Perlin 噪声取值范围约为 [-sqrt(2)/2, sqrt(2)/2]
+    float norm = perlin ? 0.5f / (amp_sum * 0.70710678f) : 0.5f / amp_sum;
+
+    _pool.parallelFor(height, PROCEDURAL_ROW_GRAIN, [&](size_t begin, size_t end) {
+        ScratchScope scratch;
+        size_t rows = end - begin;
+        float* acc = scratch.allocateArray<float>(rows * PROCEDURAL_NOISE_STRIP);
+        float* a0 = scratch.allocateArray<float>(PROCEDURAL_NOISE_STRIP);
+        float* a1 = scratch.allocateArray<float>(PROCEDURAL_NOISE_STRIP);
+        float* b0 = perlin ? scratch.allocateArray<float>(PROCEDURAL_NOISE_STRIP) : nullptr;
+        float* b1 = perlin ? scratch.allocateArray<float>(PROCEDURAL_NOISE_STRIP) : nullptr;
+
+        for (int x_begin = 0; x_begin < width; x_begin += PROCEDURAL_NOISE_STRIP) {
+            int x_end = std::min(x_begin + PROCEDURAL_NOISE_STRIP, width);
+            int strip = x_end - x_begin;
+            std::fill(acc, acc + rows * strip, 0.0f);
+
+            int period = std::max(p.frequency, 1);
+            float amplitude = 1.0f;
+            for (int o = 0; o < p.octaves; o++) {
+                int band = -1;
+                for (size_t y = begin; y < end; y++) {
+                    float v = (y + 0.5f) * period / height;
+                    int cell_y = (int)v;
+                    float yf = v - cell_y;
+                    float fy = fade(yf);
+                    if (cell_y != band) {
+                        if (band >= 0 && cell_y == band + 1) {
+                            std::swap(a0, a1);
+                            std::swap(b0, b1);
+                        } else {
+                            latticeRow(p, period, cell_y % period, x_begin, x_end, a0, b0);
+                        }
+                        latticeRow(p, period, (cell_y + 1) % period, x_begin, x_end, a1, b1);
+                        band = cell_y;
+                    }
+                    // top = a0 + yf * b0, bottom = a1 + (yf - 1) * b1, 结果为 top + fy * (bottom - top)
+                    float k0 = amplitude * (1.0f - fy);
+                    float k2 = amplitude * fy;
+                    accumulateRow(acc + (y - begin) * strip, strip, a0, b0, a1, b1, k0, k0 * yf, k2, k2 * (yf - 1.0f));
+                }
+                amplitude *= p.gain;
+                period *= std::max(p.lacunarity, 1);
+            }
+
+            for (size_t y = begin; y < end; y++) {
+                float* row = acc + (y - begin) * strip;
+                for (int x = 0; x < strip; x++) {
+                    row[x] = 0.5f + row[x] * norm;
+                }
+                shadeRow(row, strip, p.color_a, p.color_b, dst + y * stride + (size_t)x_begin * 4);
+            }
+        }
+    });
+}
+
+std::shared_ptr<const unsigned char[]> ProceduralGenerator::generate(const ProceduralParams& params) {
+    uint64_t key = params.hash();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& entry : _cache) {
+            if (entry.hash != key || !(entry.params == params)) continue;
+            entry.last_used = ++_clock;
+            return entry.pixels;
+        }
+    }
+
+    // 不做零初始化, 首次写入发生在各工作线程上
+    size_t bytes = (size_t)params.width * params.height * 4;
+    std::shared_ptr<unsigned char[]> pixels(new unsigned char[bytes]);
+    switch (params.kind) {
+        case ProceduralKind::Checkerboard: fillCheckerboard(params, pixels.get()); break;
+        case ProceduralKind::Gradient:     fillGradient(params, pixels.get()); break;
+        case ProceduralKind::Noise:        fillNoise(params, pixels.get()); break;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    // 另一个线程可能同时生成了相同的参数, 沿用先插入的那份
+    for (auto& entry : _cache) {
+        if (entry.hash != key || !(entry.params == params)) continue;
+        entry.last_used = ++_clock;
+        return entry.pixels;
+    }
+    // 单张超过预算的纹理不进缓存
+    if (bytes <= PROCEDURAL_CACHE_BYTES) {
+        evict(bytes);
+        _cache.push_back({params, key, pixels, bytes, ++_clock});
+        _cache_bytes += bytes;
+    }
+    return pixels;
+}
+
+// 调用方持有 _mutex; 腾出 incoming 字节的空间
+void ProceduralGenerator::evict(size_t incoming) {
+    while (!_cache.empty() && _cache_bytes + incoming > PROCEDURAL_CACHE_BYTES) {
+        auto oldest = std::min_element(_cache.begin(), _cache.end(), [](const Entry& a, const Entry& b) {
+            return a.last_used < b.last_used;
+        });
+        _cache_bytes -= oldest->bytes;
+        *oldest = std::move(_cache.back());
+        _cache.pop_back();
+    }
+}
+
+Texture* ProceduralGenerator::createTexture(const ProceduralParams& params) {
+    auto pixels = generate(params);
+    return new Texture(params.width, params.height, pixels.get(), 4);
+}
+
+void ProceduralGenerator::clearCache() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cache.clear();
+    _cache_bytes = 0;
+}
\ No newline at end of file
@@ -22,6 +22,21 @@ std::string Shader::parseShader(const std::string& filePath) {
     return ss.str();
 }
 
+std::string Shader::checkSource(unsigned int type, const std::string& source) {
+    unsigned int id = glCreateShader(type);
+    const char* src = source.c_str();
+    glShaderSource(id, 1, &src, NULL);
+    glCompileShader(id);
+    int status;
+    glGetShaderiv(id, GL_COMPILE_STATUS, &status);
+    std::string log;
+    if (status != GL_TRUE) {
+        log = getShaderLog(id);
+    }
+    glDeleteShader(id);
+    return log;
+}
+
 unsigned int Shader::compileShader(unsigned int type, const char* source, ShaderType s_type) {
     unsigned int id;
     id = glCreateShader(type);
@@ -81,34 +96,45 @@ Shader::~Shader() {
     glDeleteProgram(renderer_id);
 }
 
-int Shader::getUniformLocation(const std::string& name) {
-    if (uniform_cache.find(name) != uniform_cache.end()) {
-        return uniform_cache[name];
+int Shader::getUniformLocation(const char* name) {
+    uint64_t hash = 1469598103934665603ull;
+    for (const char* c = name; *c; c++) {
+        hash ^= (unsigned char)*c;
+        hash *= 1099511628211ull;
+    }
+    for (const auto& slot : uniform_cache) {
+        if (slot.hash == hash && slot.name == name) {
+            return slot.location;
+        }
     }
     int location;
-    location = glGetUniformLocation(renderer_id, name.c_str());
+    location = glGetUniformLocation(renderer_id, name);
     if (location == -1) {
         std::cout << "Warning: no uniform named: `" << name << "`\n";
     }
-    uniform_cache[name] = location;
+    uniform_cache.push_back({hash, name, location});
     return location;
 }
 
-void Shader::setUniform1i(const std::string& name, int value) {
+void Shader::setUniform1i(const char* name, int value) {
     glUniform1i(getUniformLocation(name), value);
 }
 
-void Shader::setUniform1f(const std::string& name, float value) {
+void Shader::setUniform1f(const char* name, float value) {
     glUniform1f(getUniformLocation(name), value);
 }
 
-void Shader::setUniform2f(const std::string& name, float v0, float v1) {
+void Shader::setUniform2f(const char* name, float v0, float v1) {
     glUniform2f(getUniformLocation(name), v0, v1);
 }
 
-void Shader::setUniform3f(const std::string& name, float v0, float v1, float v2) {
+void Shader::setUniform3f(const char* name, float v0, float v1, float v2) {
     glUniform3f(getUniformLocation(name), v0, v1, v2);
 }
-void Shader::setUniformMat4f(const std::string& name, glm::mat4& mat) {
+void Shader::setUniformMat3f(const char* name, const glm::mat3& mat) {
+    glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(mat));
+}
+
+void Shader::setUniformMat4f(const char* name, const glm::mat4& mat) {
     glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(mat));
 }
\ No newline at end of file
@@ -1,45 +1,109 @@
 #include "texture.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 
-Texture::Texture(const std::string& filePath) 
-    : file_path(filePath), data(nullptr), width(0), height(0), BPP(0)
+#include "texture_loader.hpp"
+
+static const unsigned char placeholder_pixels[] = {
+    200, 0, 200,   40, 40, 40,
+    40, 40, 40,    200, 0, 200,
+};
+
+unsigned int Texture::internalFormat(int channels) {
+    switch (channels) {
+        case 1: return GL_R8;
+        case 2: return GL_RG8;
+        case 3: return GL_RGB8;
+        default: return GL_RGBA8;
+    }
+}
+
+unsigned int Texture::pixelFormat(int channels) {
+    switch (channels) {
+        case 1: return GL_RED;
+        case 2: return GL_RG;
+        case 3: return GL_RGB;
+        default: return GL_RGBA;
+    }
+}
+
+Texture::Texture()
+    : texture_id(0), width(0), height(0), BPP(0), ready(false), loader(nullptr), load_id(0)
 {
-    glGenTextures(1, &texture_id);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    upload(2, 2, 3, placeholder_pixels);
+    ready = false;
+}
 
+Texture::Texture(const std::string& filePath) 
+    : texture_id(0), file_path(filePath), width(0), height(0), BPP(0), ready(false), loader(nullptr), load_id(0)
+{
     stbi_set_flip_vertically_on_load(true);
-    data = stbi_load(filePath.c_str(), &width, &height, &BPP, 0);
+    unsigned char* data = stbi_load(filePath.c_str(), &width, &height, &BPP, 0);
     if (data) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        upload(width, height, BPP, data);
+        stbi_image_free(data);
+    } else {
+        printf("\x1b[31;1m[Texture Error] Failed to load image: %s\n\x1b[0m", filePath.c_str());
+        upload(2, 2, 3, placeholder_pixels);
+        ready = false;
     }
 }
 
-Texture::Texture(int width, int height, const unsigned char* data) {
-    glGenTextures(1, &texture_id);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
+Texture::Texture(int width, int height, const unsigned char* data, int channels)
+    : texture_id(0), width(0), height(0), BPP(0), ready(false), loader(nullptr), load_id(0)
+{
     if (data) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        upload(width, height, channels, data);
+    } else {
+        allocate(width, height, channels);
     }
 }
 
 Texture::~Texture() {
-    if (data) stbi_image_free(data);
+    if (loader) {
+        loader->cancel(load_id);
+    }
     glDeleteTextures(1, &texture_id);
 }
 
+// glTexStorage2D 分配的存储不可变, 尺寸或格式改变时需要重新生成纹理对象
+void Texture::allocate(int w, int h, int channels) {
+    if (texture_id) {
+        glDeleteTextures(1, &texture_id);
+    }
+    width = w;
+    height = h;
+    BPP = channels;
+
+    int levels = 1 + (int)std::floor(std::log2((float)std::max(w, h)));
+    glGenTextures(1, &texture_id);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat(channels), w, h);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (channels == 1) {
+        GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    } else if (channels == 2) {
+        GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_GREEN};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+}
+
+void Texture::upload(int w, int h, int channels, const void* pixels) {
+    allocate(w, h, channels);
+    // RGB 等行宽不是 4 字节倍数的图像需要按 1 字节对齐读取
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, pixelFormat(channels), GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    ready = true;
+}
+
 void Texture::Bind(unsigned int slot) const {
     glActiveTexture(GL_TEXTURE0 + slot);
     glBindTexture(GL_TEXTURE_2D, texture_id);
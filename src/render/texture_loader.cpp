@@ -0,0 +1,134 @@
+#include "texture_loader.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "arena.hpp"
+
+TextureLoader::TextureLoader(ThreadPool& pool)
+    : _pool(pool), _shared(std::make_shared<Shared>()), _next_id(0), _pending(0), _pbo_index(0)
+{
+    // stb_image 的翻转标志是全局状态, 在工作线程开始解码前设置一次
+    stbi_set_flip_vertically_on_load(true);
+    glGenBuffers(TEXTURE_PBO_COUNT, _pbos);
+    for (int i = 0; i < TEXTURE_PBO_COUNT; i++) {
+        _pbo_sizes[i] = 0;
+    }
+}
+
+TextureLoader::~TextureLoader() {
+    for (auto& target : _targets) {
+        if (target.second.texture) target.second.texture->loader = nullptr;
+    }
+    _targets.clear();
+    std::lock_guard<std::mutex> lock(_shared->mutex);
+    _shared->closed = true;
+    for (auto& image : _shared->done) {
+        stbi_image_free(image.pixels);
+    }
+    _shared->done.clear();
+    glDeleteBuffers(TEXTURE_PBO_COUNT, _pbos);
+}
+
+TextureLoader::Producer TextureLoader::file(const std::string& path) {
+    return [path]() {
+        Image image{nullptr, 0, 0, 0};
+        image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+        return image;
+    };
+}
+
+uint32_t TextureLoader::submit(Target target, Producer produce) {
+    uint32_t id = ++_next_id;
+    _targets[id] = std::move(target);
+    _pending++;
+    std::shared_ptr<Shared> shared = _shared;
+    _pool.submit([shared, id, produce = std::move(produce)]() {
+        Image produced = produce();
+        Decoded image{id, produced.pixels, produced.width, produced.height, produced.channels};
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        if (shared->closed) {
+            stbi_image_free(image.pixels);
+            return;
+        }
+        shared->done.push_back(image);
+    });
+    return id;
+}
+
+Texture* TextureLoader::load(const std::string& path) {
+    Texture* tex = new Texture();
+    tex->loader = this;
+    tex->load_id = submit({tex, nullptr, path}, file(path));
+    return tex;
+}
+
+uint32_t TextureLoader::request(Producer produce, Receiver receive, const std::string& name) {
+    return submit({nullptr, std::move(receive), name}, std::move(produce));
+}
+
+void TextureLoader::cancel(uint32_t id) {
+    _targets.erase(id);
+}
+
+void TextureLoader::upload(Texture* target, Decoded& image) {
+    size_t bytes = (size_t)image.width * image.height * image.channels;
+    unsigned int pbo = _pbos[_pbo_index];
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    if (_pbo_sizes[_pbo_index] < bytes) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        _pbo_sizes[_pbo_index] = bytes;
+    }
+
+    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dst) {
+        memcpy(dst, image.pixels, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        // 像素已进入驱动管理的缓冲区, 立即释放 CPU 副本
+        stbi_image_free(image.pixels);
+        image.pixels = nullptr;
+        target->upload(image.width, image.height, image.channels, (const void*)0);
+    } else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        target->upload(image.width, image.height, image.channels, image.pixels);
+        stbi_image_free(image.pixels);
+        image.pixels = nullptr;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    _pbo_index = (_pbo_index + 1) % TEXTURE_PBO_COUNT;
+}
+
+void TextureLoader::poll(int max_uploads) {
+    std::pmr::vector<Decoded> ready(frameResource());
+    {
+        std::lock_guard<std::mutex> lock(_shared->mutex);
+        if (_shared->done.empty()) return;
+        size_t n = std::min(_shared->done.size(), (size_t)max_uploads);
+        ready.assign(_shared->done.begin(), _shared->done.begin() + n);
+        _shared->done.erase(_shared->done.begin(), _shared->done.begin() + n);
+    }
+
+    for (auto& image : ready) {
+        _pending--;
+        auto target = _targets.find(image.id);
+        if (target == _targets.end()) {
+            // 纹理在解码期间已被删除
+            stbi_image_free(image.pixels);
+            continue;
+        }
+        Target done = std::move(target->second);
+        _targets.erase(target);
+        if (!image.pixels) {
+            printf("\x1b[31;1m[Texture Error] Failed to load image: %s\n\x1b[0m", done.path.c_str());
+        }
+        if (done.texture) {
+            done.texture->loader = nullptr;
+            if (image.pixels) upload(done.texture, image);
+        } else {
+            // 失败时 pixels 为空, 同样通知接收方; 接收方可能再次调用 request, 目标已先移出表
+            done.receive({image.pixels, image.width, image.height, image.channels});
+            stbi_image_free(image.pixels);
+        }
+    }
+}
\ No newline at end of file
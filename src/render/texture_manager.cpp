@@ -0,0 +1,300 @@
+#include "texture_manager.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "texture.hpp"
+
+static int mipLevels(int width, int height) {
+    return 1 + (int)std::floor(std::log2((float)std::max(width, height)));
+}
+
+TextureManager::TextureManager(TextureLoader& loader, size_t budget)
+    : _loader(loader), _fallback(0), _budget(budget), _allocated(0), _frame(0)
+{
+}
+
+TextureManager::~TextureManager() {
+    for (auto& entry : _textures) {
+        if (entry.reload) _loader.cancel(entry.reload);
+    }
+    for (auto& bucket : _buckets) {
+        if (bucket.texture_id) glDeleteTextures(1, &bucket.texture_id);
+    }
+    if (_fallback) glDeleteTextures(1, &_fallback);
+}
+
+size_t TextureManager::layerBytes(const Bucket& bucket) const {
+    size_t bytes = 0;
+    for (int l = 0; l < bucket.levels; l++) {
+        size_t w = std::max(bucket.width >> l, 1);
+        size_t h = std::max(bucket.height >> l, 1);
+        bytes += w * h * bucket.channels;
+    }
+    return bytes;
+}
+
+int TextureManager::findBucket(int width, int height, int channels) {
+    for (size_t i = 0; i < _buckets.size(); i++) {
+        const Bucket& b = _buckets[i];
+        if (b.width == width && b.height == height && b.channels == channels) return (int)i;
+    }
+    Bucket bucket;
+    bucket.texture_id = 0;
+    bucket.width = width;
+    bucket.height = height;
+    bucket.channels = channels;
+    bucket.levels = mipLevels(width, height);
+    bucket.capacity = 0;
+    bucket.mips_dirty = false;
+    _buckets.push_back(bucket);
+    return (int)_buckets.size() - 1;
+}
+
+// 重新分配数组存储并将已用层紧凑地拷贝到前部, 同时更新各纹理的层号
+void TextureManager::resize(int index, int capacity) {
+    Bucket& bucket = _buckets[index];
+    unsigned int old_id = bucket.texture_id;
+    unsigned int new_id = 0;
+
+    if (capacity > 0) {
+        glGenTextures(1, &new_id);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, new_id);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, bucket.levels, Texture::internalFormat(bucket.channels),
+            bucket.width, bucket.height, capacity);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        if (bucket.channels == 1) {
+            GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+            glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        } else if (bucket.channels == 2) {
+            GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_GREEN};
+            glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        }
+    }
+
+    std::vector<int> owners(capacity, -1);
+    int next = 0;
+    for (int layer = 0; layer < (int)bucket.owners.size(); layer++) {
+        int owner = bucket.owners[layer];
+        if (owner < 0) continue;
+        for (int l = 0; l < bucket.levels; l++) {
+            glCopyImageSubData(old_id, GL_TEXTURE_2D_ARRAY, l, 0, 0, layer,
+                new_id, GL_TEXTURE_2D_ARRAY, l, 0, 0, next,
+                std::max(bucket.width >> l, 1), std::max(bucket.height >> l, 1), 1);
+        }
+        owners[next] = owner;
+        _textures[owner].layer = next;
+        next++;
+    }
+
+    if (old_id) glDeleteTextures(1, &old_id);
+    _allocated -= layerBytes(bucket) * bucket.capacity;
+    _allocated += layerBytes(bucket) * capacity;
+    bucket.texture_id = new_id;
+    bucket.capacity = capacity;
+    bucket.owners.swap(owners);
+}
+
+int TextureManager::allocateLayer(int index, int owner, bool exact) {
+    Bucket& bucket = _buckets[index];
+    for (int layer = 0; layer < bucket.capacity; layer++) {
+        if (bucket.owners[layer] < 0) {
+            bucket.owners[layer] = owner;
+            return layer;
+        }
+    }
+    int capacity = exact ? bucket.capacity + 1 : std::max(bucket.capacity * 2, TEXTURE_ARRAY_MIN_LAYERS);
+    int layer = bucket.capacity;
+    resize(index, capacity);
+    _buckets[index].owners[layer] = owner;
+    return layer;
+}
+
+void TextureManager::freeLayer(int index, int layer, bool shrink) {
+    Bucket& bucket = _buckets[index];
+    bucket.owners[layer] = -1;
+    int used = (int)std::count_if(bucket.owners.begin(), bucket.owners.end(), [](int o) { return o >= 0; });
+    if (used == 0 || (shrink && used < bucket.capacity)) {
+        resize(index, used);
+    }
+}
+
+// 为纹理分配所在尺寸的一层并写入第 0 级
+void TextureManager::upload(int id, const void* pixels) {
+    Entry& entry = _textures[id];
+    entry.bucket = findBucket(entry.width, entry.height, entry.channels);
+    entry.layer = allocateLayer(entry.bucket, id);
+    entry.last_used = _frame;
+    entry.resident = true;
+
+    Bucket& bucket = _buckets[entry.bucket];
+    entry.bytes = layerBytes(bucket);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, bucket.texture_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, entry.layer, entry.width, entry.height, 1,
+        Texture::pixelFormat(entry.channels), GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    bucket.mips_dirty = true;
+}
+
+int TextureManager::add(const void* pixels, int width, int height, int channels, TextureLoader::Producer source) {
+    int id = (int)_textures.size();
+    _textures.push_back(Entry{});
+    Entry& entry = _textures[id];
+    entry.width = width;
+    entry.height = height;
+    entry.channels = channels;
+    entry.alive = true;
+    entry.source = std::move(source);
+    entry.reload = 0;
+    upload(id, pixels);
+    return id;
+}
+
+void TextureManager::remove(int id) {
+    Entry& entry = _textures[id];
+    if (!entry.alive) return;
+    if (entry.resident) freeLayer(entry.bucket, entry.layer);
+    if (entry.reload) _loader.cancel(entry.reload);
+    entry.reload = 0;
+    entry.source = nullptr;
+    entry.alive = false;
+    entry.resident = false;
+}
+
+// 重新加载完成, 按原始尺寸放回; 失败时保持逐出状态, 下次 bind 再试
+void TextureManager::restore(int id, const TextureLoader::Image& image) {
+    Entry& entry = _textures[id];
+    entry.reload = 0;
+    if (!image.pixels || entry.resident) return;
+    entry.width = image.width;
+    entry.height = image.height;
+    entry.channels = image.channels;
+    upload(id, image.pixels);
+}
+
+void TextureManager::generateMips(Bucket& bucket) {
+    if (!bucket.mips_dirty || !bucket.texture_id) return;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, bucket.texture_id);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    bucket.mips_dirty = false;
+}
+
+bool TextureManager::bind(int id, unsigned int slot) {
+    Entry& entry = _textures[id];
+    if (!entry.resident) {
+        if (entry.alive && entry.source && !entry.reload) {
+            entry.reload = _loader.request(entry.source, [this, id](const TextureLoader::Image& image) {
+                restore(id, image);
+            });
+        }
+        return false;
+    }
+    entry.last_used = _frame;
+    Bucket& bucket = _buckets[entry.bucket];
+    glActiveTexture(GL_TEXTURE0 + slot);
+    generateMips(bucket);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, bucket.texture_id);
+    return true;
+}
+
+void TextureManager::bindFallback(unsigned int slot) {
+    if (!_fallback) {
+        const unsigned char white[4] = {255, 255, 255, 255};
+        glGenTextures(1, &_fallback);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _fallback);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, Texture::internalFormat(4), 1, 1, 1);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, 1, 1, 1, Texture::pixelFormat(4), GL_UNSIGNED_BYTE, white);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _fallback);
+}
+
+void TextureManager::beginFrame() {
+    _frame++;
+}
+
+size_t TextureManager::residentBytes() const {
+    size_t bytes = 0;
+    for (const auto& entry : _textures) {
+        if (entry.resident) bytes += entry.bytes;
+    }
+    return bytes;
+}
+
+bool TextureManager::canDownsample(int id) const {
+    const Bucket& bucket = _buckets[_textures[id].bucket];
+    return bucket.width / 2 >= TEXTURE_MIN_DOWNSAMPLE && bucket.height / 2 >= TEXTURE_MIN_DOWNSAMPLE;
+}
+
+// 利用 GPU 上已有的 mip 链, 将第 1 级及以下拷贝到半尺寸数组的第 0 级起, 不经过 CPU
+bool TextureManager::downsample(int id) {
+    Entry& entry = _textures[id];
+    int src_index = entry.bucket;
+    if (!canDownsample(id)) return false;
+    generateMips(_buckets[src_index]);
+
+    int w = _buckets[src_index].width / 2;
+    int h = _buckets[src_index].height / 2;
+    int dst_index = findBucket(w, h, entry.channels);
+    int dst_layer = allocateLayer(dst_index, id, true);
+    const Bucket& src = _buckets[src_index];
+    const Bucket& dst = _buckets[dst_index];
+    int levels = std::min(dst.levels, src.levels - 1);
+    for (int l = 0; l < levels; l++) {
+        glCopyImageSubData(src.texture_id, GL_TEXTURE_2D_ARRAY, l + 1, 0, 0, entry.layer,
+            dst.texture_id, GL_TEXTURE_2D_ARRAY, l, 0, 0, dst_layer,
+            std::max(w >> l, 1), std::max(h >> l, 1), 1);
+    }
+
+    freeLayer(src_index, entry.layer, true);
+    entry.bucket = dst_index;
+    entry.layer = dst_layer;
+    entry.width = w;
+    entry.height = h;
+    entry.bytes = layerBytes(dst);
+    // 刚降采样的纹理排到最近使用, 下一次先处理其它纹理
+    entry.last_used = _frame;
+    return true;
+}
+
+void TextureManager::enforceBudget() {
+    // 先回收使用率不足一半的数组
+    for (size_t i = 0; i < _buckets.size(); i++) {
+        Bucket& bucket = _buckets[i];
+        int used = (int)std::count_if(bucket.owners.begin(), bucket.owners.end(), [](int o) { return o >= 0; });
+        if (bucket.capacity > TEXTURE_ARRAY_MIN_LAYERS && used * 2 < bucket.capacity) {
+            resize((int)i, std::max(used, TEXTURE_ARRAY_MIN_LAYERS));
+        }
+    }
+
+    while (_allocated > _budget) {
+        int victim = -1;
+        for (size_t i = 0; i < _textures.size(); i++) {
+            const Entry& entry = _textures[i];
+            if (!entry.resident || entry.last_used == _frame) continue;
+            // 无法重新加载的纹理降到最小后留在显存中
+            if (!entry.source && !canDownsample((int)i)) continue;
+            if (victim < 0 || entry.last_used < _textures[victim].last_used
+                || (entry.last_used == _textures[victim].last_used && entry.bytes > _textures[victim].bytes)) {
+                victim = (int)i;
+            }
+        }
+        if (victim < 0) break;
+
+        size_t before = _allocated;
+        if (!downsample(victim)) {
+            // 逐出后由下一次 bind 经 TextureLoader 按原始尺寸重新加载
+            Entry& entry = _textures[victim];
+            freeLayer(entry.bucket, entry.layer, true);
+            entry.resident = false;
+        }
+        // 源数组收缩到已用层数, 目标数组只增一层, 每一步都应当减少总量
+        if (_allocated >= before) break;
+    }
+}
\ No newline at end of file
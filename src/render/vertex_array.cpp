@@ -1,5 +1,7 @@
 #include "vertex_array.hpp"
 
+#include <cstdint>
+
 VertexArray::VertexArray() {
     glGenVertexArrays(1, &buffer_id);
 }
@@ -14,9 +16,9 @@ void VertexArray::addBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 
     unsigned int offset = 0;
     const auto& elements = layout.getElement();
-    for (unsigned int i = 0; i < elements.size(); i++) {
+    for (unsigned int i = 0; i < layout.getCount(); i++) {
         const auto& element = elements[i];
-        glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.getStride(), (const void*)offset);
+        glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.getStride(), (const void*)(uintptr_t)offset);
         glEnableVertexAttribArray(i);
         offset += element.count * VertexBufferElement::getSize(element.type);
     }
@@ -1,4 +1,10 @@
 #include "renderer.hpp"
+#include "interface.hpp"
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 
 Renderer::Renderer(int w, int h, const char* name)
@@ -17,11 +23,34 @@ Renderer::Renderer(int w, int h, const char* name)
     _last_y = _height / 2.0f;
 
     _camera = new Camera(glm::vec3(0.0, 0.0, 3.0f));
+    _editor = nullptr;
+    _tex_loader = nullptr;
+    _procedural = nullptr;
+    _tex_manager = nullptr;
+    _domain = nullptr;
+    _algebra_geo = nullptr;
+    _plot = nullptr;
+    _plot_view = false;
+    _cloud = nullptr;
+    _dataset_path[0] = '\0';
+    _mesh_cache = new MeshCache;
+    _export_task = new AsyncTask;
+    strcpy(_export_path, "mesh.glb");
+    _scene = nullptr;
+    _first_frame = true;
+    _show_stats = false;
+    _frame_allocs = 0;
+    _frame_arena_peak = 0;
+    _live_parser = new calc::IncrementalParser;
+    _eval_task = nullptr;
     setDisplayZero();
     attachParser();
 }
 
 Renderer::~Renderer() {
+    if (_scene) {
+        delete _scene;
+    }
     _geos.clear();
     _vaos.clear();
     _vbos.clear();
@@ -37,6 +66,40 @@ Renderer::~Renderer() {
     if (_camera) {
         delete  _camera;
     }
+    if (_editor) {
+        delete _editor;
+    }
+    // 纹理管理器会取消它在加载器中的请求, 先于加载器析构
+    if (_tex_manager) {
+        delete _tex_manager;
+    }
+    if (_tex_loader) {
+        delete _tex_loader;
+    }
+    if (_procedural) {
+        delete _procedural;
+    }
+    if (_domain) {
+        delete _domain;
+    }
+    if (_plot) {
+        delete _plot;
+    }
+    if (_cloud) {
+        delete _cloud;
+    }
+    if (_live_parser) {
+        delete _live_parser;
+    }
+    if (_eval_task) {
+        delete _eval_task;
+    }
+    if (_export_task) {
+        delete _export_task;
+    }
+    if (_mesh_cache) {
+        delete _mesh_cache;
+    }
     glfwTerminate();
 }
 
@@ -67,29 +130,46 @@ bool Renderer::init() {
     }
     
     _ui = new UI(this);
+    _tex_loader = new TextureLoader(ThreadPool::global());
+    _procedural = new ProceduralGenerator(ThreadPool::global());
+    _tex_manager = new TextureManager(*_tex_loader);
+    _domain = new DomainColoring(ThreadPool::global(), _width / 2, _height / 2);
+    _plot = new CurvePlot(ThreadPool::global(), _width / 2, _height / 2);
+    _cloud = new PointCloud(ThreadPool::global(), (size_t)_cloud_budget_mb << 20);
 
     {
-        _vaos["axis"] = new VertexArray();
-        float axis_vertex[] = {
-            -100.0, 0.0, 0.0, 
-            100.0, 0.0, 0.0, 
-            0.0, -100.0, 0.0, 
-            0.0, 100.0, 0.0, 
-            0.0, 0.0, -100.0,
-            0.0, 0.0, 100.0
-        };
-        _vbos["axis"] = new VertexBuffer(axis_vertex, sizeof(float) * std::size(axis_vertex));
-        VertexBufferLayout axis_layout;
-        axis_layout.push_float(3);
-        _vaos["axis"]->addBuffer(*_vbos["axis"], axis_layout);
-        std::string axis[] = {axisVertexPath, axisFragPath};
-        _shaders["axis"] = new Shader(axis);
-        _vbos["axis"]->Unbind();
-        _vaos["axis"]->Unbind();
+        // 网格由全屏三角形在片元着色器中求出, 不需要顶点缓冲
+        _vaos["grid"] = new VertexArray();
+        std::string grid[] = {gridVertexPath, gridFragPath};
+        _shaders["grid"] = new Shader(grid);
+        _vaos["grid"]->Unbind();
+    }
+
+    {
+        // 定义域着色只画一个覆盖视口的三角形, 绑定空的顶点数组即可
+        _vaos["domain"] = new VertexArray();
+        std::string domain[] = {domainVertexPath, domainFragPath};
+        _shaders["domain"] = new Shader(domain);
+        _vaos["domain"]->Unbind();
     }
 
     {
-        Geo* cube = new Sphere();
+        // 粗线的顶点全部由 gl_VertexID 从 SSBO 中取出, 同样绑定空的顶点数组
+        _vaos["line"] = new VertexArray();
+        std::string line[] = {lineVertexPath, lineFragPath};
+        _shaders["line"] = new Shader(line);
+        _vaos["line"]->Unbind();
+    }
+
+    {
+        // 点云自带顶点数组与显存池
+        std::string points[] = {pointVertexPath, pointFragPath};
+        _shaders["points"] = new Shader(points);
+    }
+
+    {
+        Geo* cube = new Sphere(_precision);
+        _sphere_precision = _precision;
 
         _geos["Sphere"] = cube;
         _vaos["Sphere"] = new VertexArray();
@@ -102,12 +182,19 @@ bool Renderer::init() {
         layout.push_float(3);
         _vaos["Sphere"]->addBuffer(*_vbos["Sphere"], layout);
         
-        unsigned char tex_data[640 * 640 * 3];
-        createCheckboardTexture(tex_data, 640, 640, 32);
-        Texture* tex = new Texture(640, 640, tex_data);
-        
-        _texs["Sphere"] = tex;
-        _texs["img"] = new Texture(texPath);
+        ProceduralParams checker_params = ProceduralParams::checkerboard(640, 640, 32);
+        auto checker = _procedural->generate(checker_params);
+        // 被逐出后在工作线程上重新生成, 不依赖渲染器的生成器是否还在
+        auto regenerate = [checker_params]() {
+            ProceduralGenerator generator(ThreadPool::global());
+            auto pixels = generator.generate(checker_params);
+            size_t bytes = (size_t)checker_params.width * checker_params.height * 4;
+            TextureLoader::Image image{(unsigned char*)malloc(bytes), checker_params.width, checker_params.height, 4};
+            if (image.pixels) memcpy(image.pixels, pixels.get(), bytes);
+            return image;
+        };
+        _tex_ids["Sphere"] = _tex_manager->add(checker.get(), 640, 640, 4, regenerate);
+        _texs["img"] = _tex_loader->load(texPath);
         
         std::string paths[] = {vertexPath, fragPath};
         _shaders["geo"] = new Shader(paths);
@@ -122,6 +209,8 @@ bool Renderer::init() {
         _lightPos[2] = 4.0f;   
     }
 
+    _scene = new Interface(this);
+
     _ui->initEditor();
     _ui->imguiInit();
     return true;
@@ -130,6 +219,8 @@ bool Renderer::init() {
 void Renderer::run() {
     glViewport(0, _height / 2.0, _width / 2.0, _height / 2.0);
     while (!glfwWindowShouldClose(_window)) {
+        uint64_t allocs_before = AllocStats::allocationCount();
+
         // Delta time calcualtion
         float currentFrame = static_cast<float>(glfwGetTime());
         _delta_time = currentFrame - _last_time;
@@ -144,65 +235,36 @@ void Renderer::run() {
         glDepthFunc(GL_LESS);
 
         processInput(_window);
+        _tex_loader->poll();
+        _tex_manager->beginFrame();
+        pollEvaluation();
+        pollExport();
+        _cloud->poll();
 
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        _ui->imguiLayout();
-
-
-        _vMat = glm::perspective(glm::radians(_camera->Zoom), _aspect, 0.1f, 1000.0f);
-        auto view = _camera->GetViewMatrix();
-
-        {
-            _geos["Sphere"] = new Sphere(_precision);
-            Geo* sp = _geos["Sphere"];
-            _vbos["Sphere"]->update(sp->getVertices(), sp->getSize());
-            _ibos["Sphere"]->update(sp->getIndices(), sp->getCount());
-            VertexBufferLayout layout;
-            layout.push_float(3);
-            layout.push_float(2);
-            layout.push_float(3);
-            _vaos["Sphere"]->addBuffer(*_vbos["Sphere"], layout);
-
-            _shaders["geo"]->Bind();
-            _ibos["Sphere"]->Bind();
-            _texs["Sphere"]->Bind(0);
-            _vaos["Sphere"]->Bind();
-
-            _shaders["geo"]->setUniform1i("samp", 0);
-            
-            _shaders["geo"]->setUniformMat4f("proj_matrix", _vMat);
-            _shaders["geo"]->setUniformMat4f("view_matrix", view);
-
-            _shaders["geo"]->setUniform3f("lightColor", _lightColor[0], _lightColor[1], _lightColor[2]);
-            _shaders["geo"]->setUniform3f("lightPos", _lightPos[0], _lightPos[1], _lightPos[2]);
-            _shaders["geo"]->setUniform3f("viewPos", _camera->Position.x, _camera->Position.y, _camera->Position.z);
-
-            glm::mat4 mMat = glm::scale(glm::mat4(1.0f), glm::vec3(1, 1, 1));
-            mMat *= glm::rotate(glm::mat4(1.0f), 0.5f * (float)glfwGetTime(), glm::vec3(0.0, 1.0, 0.0));
-            _shaders["geo"]->setUniformMat4f("model_matrix", mMat);
-
-            glDrawElements(GL_TRIANGLES, _geos["Sphere"]->getCount(), GL_UNSIGNED_INT, 0);
-        }
-
-        if (_axis_mode) {
-            _shaders["axis"]->Bind();
-            _vaos["axis"]->Bind();
-            _shaders["axis"]->setUniformMat4f("proj_matrix", _vMat);
-            _shaders["axis"]->setUniformMat4f("view_matrix", view);
-
-            glDrawArrays(GL_LINES, 0, 6);
-            _shaders["axis"]->Unbind();
-        }
-
+        _scene->onImGuiRender();
+        _scene->onUpdate(_delta_time);
+        _scene->onRender();
 
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        _tex_manager->enforceBudget();
 
         glfwSwapBuffers(_window);
         glfwPollEvents();   
+
+        // 帧内存在帧内只增不回滚, reset 前的占用即本帧峰值; peak() 是自创建以来的最高值
+        _frame_arena_peak = frameArena().used();
+        frameArena().reset();
+        _frame_allocs = AllocStats::allocationCount() - allocs_before;
+
+        if (_first_frame) {
+            _first_frame = false;
+            printf("\x1b[32;1m[Startup] First frame presented after %.1f ms\n\x1b[0m", glfwGetTime() * 1000.0);
+        }
     }
 }
 
@@ -229,6 +291,127 @@ void Renderer::processInput(GLFWwindow *window)
 }
 
 
+void Renderer::processDomainInput() {
+    ImGuiIO& io = ImGui::GetIO();
+    if (io.WantCaptureMouse) return;
+    // 视口位于窗口左上角, 纹理的第 0 行在底部
+    float x = io.MousePos.x;
+    float y = _height / 2.0f - io.MousePos.y;
+    if (x < 0.0f || x >= _width / 2.0f || y < 0.0f || y >= _height / 2.0f) return;
+
+    if (ImGui::IsMouseDragging(ImGuiMouseButton_Left, 0.0f) && (io.MouseDelta.x != 0.0f || io.MouseDelta.y != 0.0f)) {
+        _domain->pan(io.MouseDelta.x, -io.MouseDelta.y);
+    }
+    if (io.MouseWheel != 0.0f) {
+        _domain->zoom(std::pow(0.85f, io.MouseWheel), x, y);
+    }
+}
+
+void Renderer::processPlotInput() {
+    ImGuiIO& io = ImGui::GetIO();
+    if (io.WantCaptureMouse) return;
+    float x = io.MousePos.x;
+    float y = _height / 2.0f - io.MousePos.y;
+    if (x < 0.0f || x >= _width / 2.0f || y < 0.0f || y >= _height / 2.0f) return;
+
+    if (ImGui::IsMouseDragging(ImGuiMouseButton_Left, 0.0f) && (io.MouseDelta.x != 0.0f || io.MouseDelta.y != 0.0f)) {
+        _plot->pan(io.MouseDelta.x, -io.MouseDelta.y);
+    }
+    if (io.MouseWheel != 0.0f) {
+        _plot->zoom(std::pow(0.85f, io.MouseWheel), x, y);
+    }
+}
+
+void Renderer::compileComplex() {
+    _eval_status.clear();
+    calc::ExprPool pool;
+    calc::ExprParser parser;
+    int root = parser.parse(_display_buffer, pool);
+    calc::Program program;
+    std::string error;
+    if (root < 0) {
+        error = parser.error().message;
+    } else if (!calc::compile(pool, root, program, false)) {
+        error = "expression too large";
+    } else if (_domain->load(program, error)) {
+        return;
+    }
+    _eval_status = error;
+    printf("\x1b[31;1m[Complex Error] %s\n\x1b[0m", error.c_str());
+}
+
+void Renderer::compileSurface() {
+    _eval_status.clear();
+    calc::ExprPool pool;
+    calc::ExprParser parser;
+    int root = parser.parse(_display_buffer, pool);
+    calc::Program program;
+    std::string error;
+    if (root < 0) {
+        error = parser.error().message;
+    } else if (!calc::compile(pool, root, program)) {
+        error = "expression too large";
+    } else {
+        const char* name = nullptr;
+        Geo* surface = nullptr;
+        bool implicit_form = program.uses("z");
+        if (!implicit_form && !program.uses("y")) {
+            if (_plot->add(_display_buffer, program, error)) {
+                _plot_view = true;
+                return;
+            }
+        } else if (implicit_form && ImplicitSurface::validate(program, error)) {
+            // 修改生成算法时递增名称中的修订号
+            uint64_t key = MeshKey("ImplicitSurface/1").add(program).add(IMPLICIT_SURFACE_RESOLUTION).add(2.0f).value();
+            surface = _mesh_cache->load(key);
+            if (!surface) {
+                ImplicitSurface* implicit = new ImplicitSurface(ThreadPool::global(), program);
+                const ImplicitStats& stats = implicit->stats();
+                printf("[Implicit] %zu voxels, %zu interval evaluations (uniform grid: %zu)\n",
+                       stats.leaves, stats.interval_evals, stats.uniform_evals);
+                _mesh_cache->store(key, *implicit);
+                surface = implicit;
+            }
+            name = "Implicit";
+        } else if (!implicit_form && FunctionSurface::validate(program, error)) {
+            uint64_t key = MeshKey("FunctionSurface/1").add(program).add(FUNCTION_SURFACE_PRECISION).add(2.0f).value();
+            surface = _mesh_cache->load(key);
+            if (!surface) {
+                surface = new FunctionSurface(program);
+                _mesh_cache->store(key, *surface);
+            }
+            name = "Surface";
+        }
+        if (surface) {
+            if (_geos.count(name)) {
+                delete _geos[name];
+                _geos[name] = surface;
+                _vaos[name]->Bind();
+                _vbos[name]->Bind();
+                _vbos[name]->update(surface->getVertices(), surface->getSize());
+                _ibos[name]->Bind();
+                _ibos[name]->update(surface->getIndices(), surface->getCount());
+            } else {
+                _geos[name] = surface;
+                _vaos[name] = new VertexArray();
+                _vbos[name] = new VertexBuffer(surface->getVertices(), surface->getSize());
+                _ibos[name] = new IndexBuffer(surface->getIndices(), surface->getCount());
+                VertexBufferLayout layout;
+                layout.push_float(3);
+                layout.push_float(2);
+                layout.push_float(3);
+                _vaos[name]->addBuffer(*_vbos[name], layout);
+            }
+            _vaos[name]->Unbind();
+            _algebra_geo = name;
+            _plot_view = false;
+            return;
+        }
+    }
+    _eval_status = error;
+    printf("\x1b[31;1m[Surface Error] %s\n\x1b[0m", error.c_str());
+}
+
 void Renderer::toggle_frame_mode() {
     _frame_mode = !_frame_mode;
     if (_frame_mode) {
@@ -244,37 +427,173 @@ void Renderer::toggle(bool* value) {
 
 
 void Renderer::attachParser() {
-    _parser = new core::NumericParser;
-    _analyzer = new core::NumericAnalyzer;
-
-    _analyzer->attach(_parser);
+    _eval_task = new AsyncTask;
 }
 
 void Renderer::executeParser() {
-    _parser->parse(_display_buffer);
-    _parser->printInfo();
-    double result = _analyzer->output();
-    _display_buffer = std::to_string(result);
+    if (_eval_task->running()) return;
+    if (_mode == Mode::Complex) {
+        // f(z) 直接在视口中逐块绘制, 不经过后台求值任务
+        compileComplex();
+        return;
+    }
+    if (_mode == Mode::Algebra) {
+        compileSurface();
+        return;
+    }
+    _eval_status.clear();
+
+    // 后台线程使用自己的解析器实例, 渲染线程继续出帧
+    std::string expression = _display_buffer;
+    if (calc::NumericSolver::isCommand(expression)) {
+        _eval_task->start([expression](TaskContext& context, std::string& error) -> std::string {
+            calc::NumericSolver solver(ThreadPool::global(), [&context]() { return context.shouldStop(); });
+            std::string result;
+            if (!solver.run(expression, result)) error = solver.error();
+            return result;
+        }, EVAL_TIMEOUT_SECONDS);
+        return;
+    }
+    if (_mode == Mode::Numeric && _big_numbers) {
+        size_t digits = (size_t)_big_digits;
+        _eval_task->start([expression, digits](TaskContext& context, std::string& error) -> std::string {
+            calc::ExprPool pool;
+            calc::ExprParser parser;
+            parser.setExactLiterals(true);
+            int root = parser.parse(expression, pool);
+            if (root < 0) {
+                error = parser.error().message;
+                return std::string();
+            }
+            calc::BigEvaluator evaluator(digits, [&context]() { return context.shouldStop(); });
+            calc::BigDecimal value;
+            if (!evaluator.evaluate(expression, pool, root, value)) {
+                error = evaluator.error();
+                return std::string();
+            }
+            return value.toString(digits, std::string::npos);
+        }, BIG_EVAL_TIMEOUT_SECONDS);
+        return;
+    }
+    _eval_task->start([expression](TaskContext& context, std::string& error) -> std::string {
+        core::NumericParser parser;
+        core::NumericAnalyzer analyzer;
+        analyzer.attach(&parser);
+        parser.parse(expression);
+        if (context.shouldStop()) return std::string();
+        double result = analyzer.output();
+        if (context.shouldStop()) return std::string();
+        if (std::isnan(result)) error = "invalid expression";
+        // 最短的可往返表示, 结果写回显示区后可以继续参与运算而不丢精度
+        char text[32];
+        return std::string(text, std::to_chars(text, text + sizeof(text), result).ptr);
+    }, EVAL_TIMEOUT_SECONDS);
+}
 
-    _parser->clear();
-    _analyzer->reset();
+void Renderer::cancelEvaluation() {
+    if (!_eval_task->running()) return;
+    _eval_task->cancel();
+    _eval_status = "cancelled";
+}
+
+void Renderer::pollEvaluation() {
+    if (!_eval_task->poll()) return;
+    switch (_eval_task->state()) {
+        case TaskState::Done:
+            _display_buffer = _eval_task->result();
+            if (_display_buffer.size() > DISPLAY_BUFFER_SIZE) {
+                // 完整结果放入剪贴板, 显示区保留可以继续运算的近似值
+                ImGui::SetClipboardText(_display_buffer.c_str());
+                _eval_status = "full result (" + std::to_string(_display_buffer.size()) + " chars) copied to clipboard";
+                calc::BigDecimal value;
+                calc::BigDecimal::parse(_display_buffer, value);
+                _display_buffer = value.toString(DISPLAY_BUFFER_SIZE / 2, DISPLAY_BUFFER_SIZE);
+            }
+            _live_parser->assign(_display_buffer);
+            break;
+        case TaskState::Failed:
+            _eval_status = _eval_task->error();
+            break;
+        case TaskState::TimedOut:
+            _eval_status = "timed out";
+            printf("\x1b[31;1m[Evaluation Error] timed out after %.0f s\n\x1b[0m", _big_numbers ? BIG_EVAL_TIMEOUT_SECONDS : EVAL_TIMEOUT_SECONDS);
+            break;
+        default:
+            break;
+    }
+}
+
+void Renderer::exportMesh() {
+    if (_export_task->running()) return;
+    std::string path = _export_path;
+    MeshFormat format;
+    if (!MeshExporter::formatFromPath(path, format)) {
+        _export_status = "unknown format, use .ply, .obj or .glb";
+        return;
+    }
+    // 与 3D 视图中绘制的一致: Algebra 模式下的曲面, 否则为球体
+    bool surface = _mode == Mode::Algebra && _algebra_geo;
+    std::string name = surface ? _algebra_geo : "Sphere";
+    std::shared_ptr<MeshData> mesh = MeshData::snapshot(*_geos[name], name == "Implicit");
+    _export_status = "exporting " + name + " to " + path;
+    _export_task->start([mesh, path, format](TaskContext& context, std::string& error) -> std::string {
+        auto start = std::chrono::steady_clock::now();
+        MeshExporter exporter(&context);
+        if (!exporter.write(path, *mesh, format)) {
+            error = exporter.error();
+            return std::string();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        char text[DISPLAY_BUFFER_SIZE];
+        snprintf(text, sizeof(text), "exported %zu vertices to %s in %.2f s", mesh->vertexCount(), path.c_str(), seconds);
+        return text;
+    }, MESH_EXPORT_TIMEOUT_SECONDS);
+}
+
+void Renderer::pollExport() {
+    if (!_export_task->poll()) return;
+    switch (_export_task->state()) {
+        case TaskState::Done:
+            _export_status = _export_task->result();
+            break;
+        case TaskState::Failed:
+            _export_status = _export_task->error();
+            printf("\x1b[31;1m[Export Error] %s\n\x1b[0m", _export_status.c_str());
+            break;
+        case TaskState::TimedOut:
+            _export_status = "export timed out";
+            break;
+        case TaskState::Cancelled:
+            _export_status = "export cancelled";
+            break;
+        default:
+            break;
+    }
 }
 
 void Renderer::addDisplayChar(const char* str) {
+    cancelEvaluation();
     if (_display_buffer == "0" && str != std::string(".")) {
         _display_buffer = str;
+        _live_parser->assign(_display_buffer);
     } else {
         _display_buffer += str;
+        _live_parser->append(str);
     }
 }
 
 void Renderer::setDisplayZero() {
+    if (_eval_task) cancelEvaluation();
     _display_buffer = std::string("0");
+    _live_parser->assign(_display_buffer);
 }
 
 void Renderer::popDisplay() {
+    cancelEvaluation();
     _display_buffer.pop_back();
     if (_display_buffer.empty()) {
         setDisplayZero();
+    } else {
+        _live_parser->pop();
     }
 }
\ No newline at end of file
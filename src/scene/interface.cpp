@@ -0,0 +1,218 @@
+#include "interface.hpp"
+
+#include <cmath>
+
+#include "renderer.hpp"
+
+Interface::Interface(Renderer* rd)
+    : _rd(rd)
+{
+    // 每四分之一圈一个关键帧, 相邻两帧之间的球面插值是匀速的
+    float times[5];
+    glm::quat turns[5];
+    for (int k = 0; k < 5; k++) {
+        times[k] = k * glm::radians(90.0f) / SPIN_SPEED;
+        turns[k] = glm::angleAxis(k * glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+    Clip spin;
+    spin.animation = new Animation(true);
+    int spin_channel = spin.animation->addQuat(times, turns, 5);
+    _clips.push_back(spin);
+
+    Material material;
+    material.texture = rd->_tex_ids["Sphere"];
+
+    _sphere = _registry.create();
+    MeshRef sphere_mesh;
+    sphere_mesh.mesh = addMesh("Sphere", GL_TRIANGLES);
+    Animator animator;
+    animator.clip = 0;
+    animator.channel = spin_channel;
+    _registry.transforms().add(_sphere, Transform());
+    _registry.meshes().add(_sphere, sphere_mesh);
+    _registry.materials().add(_sphere, material);
+    _registry.animators().add(_sphere, animator);
+
+    // 曲面的网格在第一次编译后才存在, 之前不绘制
+    _surface = _registry.create();
+    MeshRef surface_mesh;
+    surface_mesh.visible = false;
+    _registry.transforms().add(_surface, Transform());
+    _registry.meshes().add(_surface, surface_mesh);
+    _registry.materials().add(_surface, material);
+}
+
+Interface::~Interface() {
+    for (Clip& clip : _clips) {
+        delete clip.animation;
+    }
+}
+
+int Interface::addMesh(const std::string& name, unsigned int primitive) {
+    _meshes.push_back({name, primitive});
+    return (int)_meshes.size() - 1;
+}
+
+int Interface::findMesh(const std::string& name) const {
+    for (size_t i = 0; i < _meshes.size(); i++) {
+        if (_meshes[i].name == name) return (int)i;
+    }
+    return -1;
+}
+
+void Interface::onImGuiRender() {
+    _rd->_ui->imguiLayout();
+}
+
+void Interface::onUpdate(float delta_time) {
+    Renderer* rd = _rd;
+
+    // 仅在精度改变时重新生成球体, 原缓冲区对象不变, 顶点属性指针无需重新设置
+    if (rd->_sphere_precision != rd->_precision) {
+        rd->_sphere_precision = rd->_precision;
+        delete rd->_geos["Sphere"];
+        rd->_geos["Sphere"] = new Sphere(rd->_precision);
+        Geo* sp = rd->_geos["Sphere"];
+        rd->_vaos["Sphere"]->Bind();
+        rd->_vbos["Sphere"]->Bind();
+        rd->_vbos["Sphere"]->update(sp->getVertices(), sp->getSize());
+        rd->_ibos["Sphere"]->Bind();
+        rd->_ibos["Sphere"]->update(sp->getIndices(), sp->getCount());
+    }
+
+    // Algebra 模式下有曲面时画 z = f(x, y) 或 f(x, y, z) = 0, 否则画旋转的球体
+    bool surface = rd->_mode == Mode::Algebra && rd->_algebra_geo;
+    MeshRef& surface_mesh = _registry.meshes().get(_surface);
+    if (surface) {
+        int mesh = findMesh(rd->_algebra_geo);
+        if (mesh < 0) {
+            bool points = std::string(rd->_algebra_geo) == "Implicit";
+            mesh = addMesh(rd->_algebra_geo, points ? GL_POINTS : GL_TRIANGLES);
+        }
+        surface_mesh.mesh = mesh;
+    }
+    surface_mesh.visible = surface;
+    _registry.meshes().get(_sphere).visible = !surface;
+
+    updateAnimation(_registry, _clips, delta_time);
+    _transforms.update(_registry, ThreadPool::global());
+}
+
+void Interface::onRender() {
+    Renderer* rd = _rd;
+    rd->_vMat = glm::perspective(glm::radians(rd->_camera->Zoom), rd->_aspect, 0.1f, 1000.0f);
+    glm::mat4 view = rd->_camera->GetViewMatrix();
+    bool plot = rd->_mode == Mode::Algebra && rd->_plot_view && rd->_plot->isLoaded();
+    bool domain = rd->_mode == Mode::Complex && rd->_domain->isLoaded();
+
+    if (domain) {
+        rd->processDomainInput();
+        rd->_domain->update();
+
+        glDisable(GL_DEPTH_TEST);
+        rd->_shaders["domain"]->Bind();
+        rd->_vaos["domain"]->Bind();
+        rd->_domain->bind(0);
+        rd->_shaders["domain"]->setUniform1i("samp", 0);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glEnable(GL_DEPTH_TEST);
+    } else if (plot) {
+        rd->processPlotInput();
+        rd->_plot->update();
+
+        glDisable(GL_DEPTH_TEST);
+        rd->_shaders["line"]->Bind();
+        rd->_vaos["line"]->Bind();
+        rd->_plot->bind(0);
+        rd->_shaders["line"]->setUniformMat4f("view_proj", rd->_plot->viewProjection());
+        rd->_shaders["line"]->setUniform2f("viewport", (float)rd->_plot->width(), (float)rd->_plot->height());
+        // 所有曲线与坐标轴一次绘制
+        glDrawArrays(GL_TRIANGLES, 0, rd->_plot->vertexCount());
+        glEnable(GL_DEPTH_TEST);
+    } else if (rd->_cloud->isLoaded()) {
+        // 只有当前视图可见的节点留在显存中, 每帧按需补充上传
+        glm::mat4 view_proj = rd->_vMat * view;
+        rd->_cloud->update(view_proj, rd->_camera->Position, glm::radians(rd->_camera->Zoom), rd->_height / 2.0f);
+        glm::vec2 range = rd->_cloud->heightRange();
+        rd->_shaders["points"]->Bind();
+        rd->_shaders["points"]->setUniformMat4f("mvp", view_proj * rd->_cloud->model());
+        rd->_shaders["points"]->setUniform2f("height_range", range.x, range.y);
+        glPointSize(POINT_SIZE);
+        rd->_cloud->draw();
+    } else {
+        renderEntities(view);
+    }
+
+    if (rd->_axis_mode && !plot && !domain) {
+        renderGrid(view);
+    }
+}
+
+void Interface::renderEntities(const glm::mat4& view) {
+    Renderer* rd = _rd;
+    Shader* shader = rd->_shaders["geo"];
+    shader->Bind();
+    shader->setUniform1i("samp", 0);
+    shader->setUniformMat4f("proj_matrix", rd->_vMat);
+    shader->setUniformMat4f("view_matrix", view);
+    shader->setUniform3f("lightColor", rd->_lightColor[0], rd->_lightColor[1], rd->_lightColor[2]);
+    shader->setUniform3f("lightPos", rd->_lightPos[0], rd->_lightPos[1], rd->_lightPos[2]);
+    shader->setUniform3f("viewPos", rd->_camera->Position.x, rd->_camera->Position.y, rd->_camera->Position.z);
+
+    ComponentPool<MeshRef>& meshes = _registry.meshes();
+    const Entity* entities = meshes.entities();
+    const MeshRef* refs = meshes.data();
+    for (size_t i = 0; i < meshes.size(); i++) {
+        if (!refs[i].visible || refs[i].mesh < 0) continue;
+        const Mesh& mesh = _meshes[refs[i].mesh];
+        auto geo = rd->_geos.find(mesh.name);
+        if (geo == rd->_geos.end()) continue;
+
+        Material* material = _registry.materials().find(entities[i]);
+        if (material && material->texture >= 0) {
+            // 纹理被逐出时已排队重新加载, 加载完成前用白色代替
+            if (rd->_tex_manager->bind(material->texture, 0)) {
+                glVertexAttrib1f(3, (float)rd->_tex_manager->layer(material->texture));
+            } else {
+                rd->_tex_manager->bindFallback(0);
+                glVertexAttrib1f(3, 0.0f);
+            }
+        }
+        // onUpdate 已在本帧更新过变换, 稠密下标仍然有效
+        uint32_t transform = _registry.transforms().indexOf(entities[i]);
+        shader->setUniformMat4f("model_matrix", transform != POOL_NONE ? _transforms.world(transform) : glm::mat4(1.0f));
+        shader->setUniformMat3f("normal_matrix", transform != POOL_NONE ? _transforms.normal(transform) : glm::mat3(1.0f));
+
+        rd->_vaos[mesh.name]->Bind();
+        rd->_ibos[mesh.name]->Bind();
+        if (mesh.primitive == GL_POINTS) glPointSize(IMPLICIT_POINT_SIZE);
+        glDrawElements(mesh.primitive, geo->second->getCount(), GL_UNSIGNED_INT, 0);
+    }
+}
+
+void Interface::renderGrid(const glm::mat4& view) {
+    Renderer* rd = _rd;
+    glm::mat4 view_proj = rd->_vMat * view;
+    rd->_grid.update(rd->_camera->Position);
+
+    // 网格半透明叠加, 参与深度测试但不写入深度
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    rd->_shaders["grid"]->Bind();
+    rd->_vaos["grid"]->Bind();
+    rd->_shaders["grid"]->setUniformMat4f("view_proj", view_proj);
+    rd->_shaders["grid"]->setUniformMat4f("inv_view_proj", glm::inverse(view_proj));
+    rd->_shaders["grid"]->setUniform3f("camera_pos", rd->_camera->Position.x, rd->_camera->Position.y, rd->_camera->Position.z);
+    rd->_shaders["grid"]->setUniform1f("major", rd->_grid.major());
+    rd->_shaders["grid"]->setUniform1f("minor", rd->_grid.minor());
+    rd->_shaders["grid"]->setUniform1f("pixel_angle",
+                                       2.0f * std::tan(glm::radians(rd->_camera->Zoom) * 0.5f) / (rd->_height / 2.0f));
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    rd->_shaders["grid"]->Unbind();
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+
+    rd->_grid.drawLabels(ImGui::GetBackgroundDrawList(), view_proj, rd->_camera->Position,
+                         ImVec2(0.0f, 0.0f), ImVec2(rd->_width / 2.0f, rd->_height / 2.0f));
+}
\ No newline at end of file
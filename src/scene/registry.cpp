@@ -0,0 +1,65 @@
+#include "registry.hpp"
+
+Registry::Registry()
+    : _alive(0)
+{
+}
+
+Entity Registry::create() {
+    _alive++;
+    if (!_free.empty()) {
+        uint32_t index = _free.back();
+        _free.pop_back();
+        return _slots[index];
+    }
+    Entity entity = (Entity)_slots.size();
+    _slots.push_back(entity);
+    return entity;
+}
+
+void Registry::destroy(Entity entity) {
+    if (!alive(entity)) return;
+    _transforms.remove(entity);
+    _meshes.remove(entity);
+    _materials.remove(entity);
+    _animators.remove(entity);
+
+    // 版本加一, 旧句柄失效; 版本回绕到 ENTITY_NULL 时跳过
+    uint32_t index = entityIndex(entity);
+    Entity next = ((entity >> ENTITY_INDEX_BITS) + 1) << ENTITY_INDEX_BITS | index;
+    if (next == ENTITY_NULL) next = index;
+    _slots[index] = next;
+    _free.push_back(index);
+    _alive--;
+}
+
+bool Registry::alive(Entity entity) const {
+    uint32_t index = entityIndex(entity);
+    // 销毁后 _slots 中已是下一个版本, 旧句柄不再相等
+    return entity != ENTITY_NULL && index < _slots.size() && _slots[index] == entity;
+}
+
+void Registry::setParent(Entity child, Entity parent) {
+    Transform* transform = _transforms.find(child);
+    if (!transform || transform->parent == parent) return;
+    // 不允许把节点挂到自己的子树下
+    for (Entity node = parent; node != ENTITY_NULL;) {
+        if (node == child) return;
+        Transform* ancestor = _transforms.find(node);
+        node = ancestor ? ancestor->parent : ENTITY_NULL;
+    }
+    transform->parent = parent;
+    _transforms.markDirty(child);
+    // 层级改变, TransformSystem 据此重新排序
+    _transforms.touch();
+}
+
+void Registry::clear() {
+    _slots.clear();
+    _free.clear();
+    _alive = 0;
+    _transforms.clear();
+    _meshes.clear();
+    _materials.clear();
+    _animators.clear();
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#include "scene.hpp"
+
+Scene::Scene() {
+}
+
+Scene::~Scene() {
+}
+
+void Scene::onImGuiRender() {
+}
\ No newline at end of file
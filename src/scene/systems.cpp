@@ -0,0 +1,270 @@
+#include "systems.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SCENE_SSE2
+#endif
+
+void updateAnimation(Registry& registry, std::vector<Clip>& clips, float delta_time) {
+    for (Clip& clip : clips) {
+        Animation* animation = clip.animation;
+        clip.time += delta_time * clip.speed;
+        // 时间按片段时长回绕, 长时间运行也不损失 float 精度
+        if (animation->loop() && animation->duration() > 0.0f) {
+            clip.time = std::fmod(clip.time, animation->duration());
+            if (clip.time < 0.0f) clip.time += animation->duration();
+        }
+        animation->sample(clip.time);
+    }
+
+    ComponentPool<Animator>& animators = registry.animators();
+    ComponentPool<Transform>& transforms = registry.transforms();
+    const Entity* entities = animators.entities();
+    const Animator* data = animators.data();
+    Transform* targets = transforms.data();
+    uint8_t* dirty = transforms.dirty();
+    for (size_t i = 0; i < animators.size(); i++) {
+        uint32_t slot = transforms.indexOf(entities[i]);
+        if (slot == POOL_NONE) continue;
+        // 直接读取采样结果的分量数组
+        const TrackSet& quats = clips[data[i].clip].animation->quats();
+        int channel = data[i].channel;
+        targets[slot].rotation = glm::quat(quats.output(3)[channel], quats.output(0)[channel],
+                                           quats.output(1)[channel], quats.output(2)[channel]);
+        dirty[slot] = 1;
+    }
+}
+
+TransformSystem::TransformSystem()
+    : _revision(UINT64_MAX), _stride(0), _updated(0)
+{
+}
+
+void TransformSystem::sort(Registry& registry) {
+    ComponentPool<Transform>& transforms = registry.transforms();
+    size_t count = transforms.size();
+    Transform* data = transforms.data();
+
+    // 父节点已销毁 (句柄失效) 的节点视为根; setParent 保证不会成环
+    std::vector<int> parents(count), depths(count, -1);
+    for (size_t i = 0; i < count; i++) {
+        Transform* parent = transforms.find(data[i].parent);
+        parents[i] = parent ? (int)(parent - data) : -1;
+    }
+    std::vector<int> chain;
+    int max_depth = -1;
+    for (size_t i = 0; i < count; i++) {
+        chain.clear();
+        int node = (int)i;
+        while (node >= 0 && depths[node] < 0) {
+            chain.push_back(node);
+            node = parents[node];
+        }
+        int depth = node < 0 ? -1 : depths[node];
+        for (size_t j = chain.size(); j-- > 0;) depths[chain[j]] = ++depth;
+        max_depth = std::max(max_depth, depth);
+    }
+
+    // 按深度计数排序, 同一层内保持原来的相对顺序
+    _levels.assign(max_depth + 2, 0);
+    for (size_t i = 0; i < count; i++) _levels[depths[i] + 1]++;
+    for (size_t d = 1; d < _levels.size(); d++) _levels[d] += _levels[d - 1];
+    std::vector<uint32_t> order(count), position(count);
+    std::vector<uint32_t> next(_levels.begin(), _levels.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        position[i] = next[depths[i]]++;
+        order[position[i]] = (uint32_t)i;
+    }
+    transforms.reorder(order);
+
+    _parents.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        int parent = parents[order[i]];
+        _parents[i] = parent < 0 ? (uint32_t)count : position[parent];
+    }
+    if (count > 0) memset(transforms.dirty(), 1, count);
+
+    // 末尾一格是根节点的父矩阵 (单位矩阵)
+    _stride = count + 1;
+    _world.assign(12 * _stride, 0.0f);
+    _normal.assign(9 * _stride, 0.0f);
+    for (int c = 0; c < 3; c++) {
+        _world[(c * 3 + c) * _stride + count] = 1.0f;
+        _normal[(c * 3 + c) * _stride + count] = 1.0f;
+    }
+    _revision = transforms.revision();
+}
+
+namespace {
+
+    // 4 个节点的同一分量
+#ifdef SCENE_SSE2
+    typedef __m128 Lanes;
+    inline Lanes lanes(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+    inline Lanes splat(float v) { return _mm_set1_ps(v); }
+    inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+    inline Lanes sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+    inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+    // 1 / x, |x| 不超过 1e-20 时为 1
+    inline Lanes safeInverse(Lanes x) {
+        Lanes usable = _mm_cmpgt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), x), _mm_set1_ps(1e-20f));
+        return _mm_or_ps(_mm_and_ps(usable, _mm_div_ps(_mm_set1_ps(1.0f), x)), _mm_andnot_ps(usable, _mm_set1_ps(1.0f)));
+    }
+    inline void store(float* p, Lanes v) { _mm_storeu_ps(p, v); }
+#else
+    struct Lanes {
+        float v[4];
+    };
+    inline Lanes lanes(float a, float b, float c, float d) { return {{a, b, c, d}}; }
+    inline Lanes splat(float v) { return {{v, v, v, v}}; }
+    inline Lanes add(Lanes a, Lanes b) { for (int l = 0; l < 4; l++) a.v[l] += b.v[l]; return a; }
+    inline Lanes sub(Lanes a, Lanes b) { for (int l = 0; l < 4; l++) a.v[l] -= b.v[l]; return a; }
+    inline Lanes mul(Lanes a, Lanes b) { for (int l = 0; l < 4; l++) a.v[l] *= b.v[l]; return a; }
+    inline Lanes safeInverse(Lanes x) {
+        for (int l = 0; l < 4; l++) x.v[l] = std::fabs(x.v[l]) > 1e-20f ? 1.0f / x.v[l] : 1.0f;
+        return x;
+    }
+    inline void store(float* p, Lanes v) { memcpy(p, v.v, sizeof(v.v)); }
+#endif
+
+    // 全为 0 的 16 个脏标记
+    inline bool clean16(const uint8_t* flags) {
+        uint64_t a, b;
+        memcpy(&a, flags, 8);
+        memcpy(&b, flags + 8, 8);
+        return (a | b) == 0;
+    }
+
+}
+
+// world = parent * T * R * S, normal = world 左上 3x3 的逆转置
+void TransformSystem::compose(const Transform* data, size_t first, size_t count, uint32_t mask, bool root) {
+    // 不足 4 个时重复最后一个, 多出的通道不写回
+    const Transform* t[4];
+    const float* p[12];
+    uint32_t parents[4];
+    for (int l = 0; l < 4; l++) {
+        size_t i = first + std::min<size_t>(l, count - 1);
+        t[l] = data + i;
+        parents[l] = _parents[i];
+    }
+    for (int e = 0; e < 12; e++) p[e] = _world.data() + e * _stride;
+#define SCENE_GATHER(expr) lanes(t[0]->expr, t[1]->expr, t[2]->expr, t[3]->expr)
+#define SCENE_PARENT(e) lanes(p[e][parents[0]], p[e][parents[1]], p[e][parents[2]], p[e][parents[3]])
+    Lanes qx = SCENE_GATHER(rotation.x), qy = SCENE_GATHER(rotation.y);
+    Lanes qz = SCENE_GATHER(rotation.z), qw = SCENE_GATHER(rotation.w);
+    Lanes sx = SCENE_GATHER(scale.x), sy = SCENE_GATHER(scale.y), sz = SCENE_GATHER(scale.z);
+    Lanes tx = SCENE_GATHER(position.x), ty = SCENE_GATHER(position.y), tz = SCENE_GATHER(position.z);
+
+    // 与 glm::translate * glm::mat4_cast * glm::scale 相同, 展开后省去两次 4x4 乘法
+    // 先把一个因子加倍 (乘 2 是精确的), 结果与 2 * (a + b) 逐位相同
+    Lanes one = splat(1.0f);
+    Lanes x2 = add(qx, qx), y2 = add(qy, qy), z2 = add(qz, qz);
+    Lanes xx = mul(qx, x2), yy = mul(qy, y2), zz = mul(qz, z2);
+    Lanes xy = mul(qx, y2), xz = mul(qx, z2), yz = mul(qy, z2);
+    Lanes wx = mul(qw, x2), wy = mul(qw, y2), wz = mul(qw, z2);
+    Lanes local[9] = {
+        mul(sub(one, add(yy, zz)), sx), mul(add(xy, wz), sx), mul(sub(xz, wy), sx),
+        mul(sub(xy, wz), sy), mul(sub(one, add(xx, zz)), sy), mul(add(yz, wx), sy),
+        mul(add(xz, wy), sz), mul(sub(yz, wx), sz), mul(sub(one, add(xx, yy)), sz),
+    };
+
+    // 根节点 (第 0 层) 直接取局部矩阵; 否则每一列是父矩阵前三列的线性组合, 平移列再加上父矩阵的平移
+    Lanes m[12] = {local[0], local[1], local[2], local[3], local[4], local[5], local[6], local[7], local[8], tx, ty, tz};
+    for (int r = 0; r < 3 && !root; r++) {
+        Lanes p0 = SCENE_PARENT(r), p1 = SCENE_PARENT(3 + r), p2 = SCENE_PARENT(6 + r), p3 = SCENE_PARENT(9 + r);
+        for (int c = 0; c < 3; c++) {
+            m[c * 3 + r] = add(add(mul(p0, local[c * 3]), mul(p1, local[c * 3 + 1])), mul(p2, local[c * 3 + 2]));
+        }
+        m[9 + r] = add(add(mul(p0, tx), mul(p1, ty)), add(mul(p2, tz), p3));
+    }
+#undef SCENE_GATHER
+#undef SCENE_PARENT
+
+    // 逆转置的三列分别是另外两列的叉积除以行列式, 不需要完整的求逆
+    Lanes n[9] = {
+        sub(mul(m[4], m[8]), mul(m[5], m[7])), sub(mul(m[5], m[6]), mul(m[3], m[8])), sub(mul(m[3], m[7]), mul(m[4], m[6])),
+        sub(mul(m[7], m[2]), mul(m[8], m[1])), sub(mul(m[8], m[0]), mul(m[6], m[2])), sub(mul(m[6], m[1]), mul(m[7], m[0])),
+        sub(mul(m[1], m[5]), mul(m[2], m[4])), sub(mul(m[2], m[3]), mul(m[0], m[5])), sub(mul(m[0], m[4]), mul(m[1], m[3])),
+    };
+    // 退化 (某个方向缩放为 0) 时只保留方向
+    Lanes inv = safeInverse(add(add(mul(m[0], n[0]), mul(m[1], n[1])), mul(m[2], n[2])));
+    for (int k = 0; k < 9; k++) n[k] = mul(n[k], inv);
+
+    if (count == 4 && mask == 0xF) {
+        for (int e = 0; e < 12; e++) store(_world.data() + e * _stride + first, m[e]);
+        for (int e = 0; e < 9; e++) store(_normal.data() + e * _stride + first, n[e]);
+        return;
+    }
+    // 只写回需要重算的节点, 相邻的节点可能属于别的任务或者下一层
+    alignas(16) float values[4];
+    for (int e = 0; e < 21; e++) {
+        store(values, e < 12 ? m[e] : n[e - 12]);
+        float* out = e < 12 ? _world.data() + e * _stride : _normal.data() + (e - 12) * _stride;
+        for (size_t l = 0; l < count; l++) {
+            if (mask >> l & 1) out[first + l] = values[l];
+        }
+    }
+}
+
+void TransformSystem::update(Registry& registry, ThreadPool& pool) {
+    ComponentPool<Transform>& transforms = registry.transforms();
+    if (transforms.revision() != _revision) sort(registry);
+    const Transform* data = transforms.data();
+    uint8_t* dirty = transforms.dirty();
+
+    _updated = 0;
+    size_t previous = 0;
+    for (size_t level = 0; level + 1 < _levels.size(); level++) {
+        size_t first = _levels[level], last = _levels[level + 1];
+        // 上一层有重算时父节点的脏标记 (已传播) 也要检查, 否则只看自身的标记
+        bool follow = previous > 0;
+        std::atomic<size_t> updated(0);
+        pool.parallelFor(last - first, SCENE_TRANSFORM_GRAIN, [&](size_t begin, size_t end) {
+            size_t count = 0;
+            size_t stop = first + end;
+            for (size_t i = first + begin; i < stop; i += 4) {
+                if (!follow) {
+                    while (i + 16 <= stop && clean16(dirty + i)) i += 16;
+                    if (i >= stop) break;
+                }
+                size_t n = std::min<size_t>(4, stop - i);
+                uint32_t mask = 0;
+                for (size_t l = 0; l < n; l++) {
+                    uint8_t flag = dirty[i + l] | (follow ? dirty[_parents[i + l]] : 0);
+                    dirty[i + l] = flag;
+                    mask |= (uint32_t)(flag != 0) << l;
+                }
+                if (!mask) continue;
+                compose(data, i, n, mask, level == 0);
+                for (uint32_t bits = mask; bits; bits &= bits - 1) count++;
+            }
+            updated += count;
+        });
+        previous = updated;
+        _updated += previous;
+    }
+    // 脏标记在传播完所有层后才能清除
+    if (_updated > 0) memset(dirty, 0, transforms.size());
+}
+
+glm::mat4 TransformSystem::world(size_t index) const {
+    glm::mat4 m(1.0f);
+    for (int c = 0; c < 4; c++) {
+        for (int r = 0; r < 3; r++) m[c][r] = _world[(c * 3 + r) * _stride + index];
+    }
+    return m;
+}
+
+glm::mat3 TransformSystem::normal(size_t index) const {
+    glm::mat3 m;
+    for (int c = 0; c < 3; c++) {
+        for (int r = 0; r < 3; r++) m[c][r] = _normal[(c * 3 + r) * _stride + index];
+    }
+    return m;
+}
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include "renderer.hpp"
 #include "shader.hpp"
 
+#include <cstring>
+
 UI::UI(Renderer* rd) {
     _rd = rd;
 }
@@ -48,6 +50,7 @@ void UI::imguiLayout() {
     imguiMainTabBar();
     imguiOperationPanel();
     imguiGLSLEditor();
+    if ( _rd->_show_stats) imguiStats();
     if ( _rd->_show_demo) ImGui::ShowDemoWindow();
 }
 
@@ -60,8 +63,10 @@ void UI::imguiOperationPanel() {
         ImGui::SliderInt("Precsion", &_rd->_precision, 2, 48);
     }
     ImGui::PushFont(_rd->_fonts["display"]);
-    ImGui::Text("%s", _rd->_display_buffer.c_str());
+    ImGui::TextWrapped("%s", _rd->_display_buffer.c_str());
     ImGui::PopFont();
+    imguiLivePreview();
+    imguiEvaluationStatus();
 
     UIDIVIDER
 
@@ -87,10 +92,14 @@ void UI::imguiOperationPanel() {
         handleButton(ImGui::Button("+", bt_size), Enum::Key::Key_Add, "+", _rd); UINEXT
         handleButton(ImGui::Button("-", bt_size), Enum::Key::Key_Sub, "-", _rd);
     }
-    if (_rd->_mode == Mode::Algebra) {
+    if (_rd->_mode == Mode::Algebra || _rd->_mode == Mode::Numeric) {
         UINEXT
         handleButton(ImGui::Button("x", bt_size), Enum::Key::Key_X, "x", _rd);
     }
+    if (_rd->_mode == Mode::Complex) {
+        UINEXT
+        handleButton(ImGui::Button("z", bt_size), Enum::Key::Key_Z, "z", _rd);
+    }
 
     UIDIVIDER
 
@@ -106,6 +115,14 @@ void UI::imguiOperationPanel() {
         UINEXT
         handleButton(ImGui::Button("y", bt_size), Enum::Key::Key_Y, "y", _rd); 
     }
+    if (_rd->_mode == Mode::Complex) {
+        UINEXT
+        handleButton(ImGui::Button("i", bt_size), Enum::Key::Key_I, "i", _rd);
+    }
+    if (_rd->_mode == Mode::Numeric) {
+        UINEXT
+        handleButton(ImGui::Button(",", bt_size), Enum::Key::Key_Comma, ",", _rd);
+    }
 
     UIDIVIDER
 
@@ -121,14 +138,80 @@ void UI::imguiOperationPanel() {
         UINEXT
         handleButton(ImGui::Button("z", bt_size), Enum::Key::Key_Z, "z", _rd); 
     }
+    // 求根 / 积分 / 求导命令, 参数以 "," 分隔
+    if (_rd->_mode == Mode::Numeric) {
+        UIDIVIDER
+        handleButton(ImGui::Button("solve", bt_size), Enum::Key::Key_Solve, "solve(", _rd); UINEXT
+        handleButton(ImGui::Button("integrate", bt_size), Enum::Key::Key_Integrate, "integrate(", _rd); UINEXT
+        handleButton(ImGui::Button("d/dx", bt_size), Enum::Key::Key_Derivative, "d/dx(", _rd);
+    }
+    ImGui::End();
+}
+
+void UI::imguiLivePreview() {
+    // 只有一个数字时结果与显示相同, 不再重复
+    const calc::LivePreview& preview = _rd->_live_parser->preview();
+    if (preview.valid && _rd->_live_parser->tokenCount() <= 1) {
+        ImGui::TextDisabled(" ");
+    } else if (preview.valid && preview.constant) {
+        ImGui::TextDisabled("= %.12g", preview.value);
+    } else if (preview.valid) {
+        ImGui::TextDisabled("= f(x, y, z)");
+    } else {
+        ImGui::TextColored(ImVec4(0.9f, 0.35f, 0.3f, 1.0f), "%s at %zu", preview.error.c_str(), preview.position + 1);
+    }
+}
+
+void UI::imguiEvaluationStatus() {
+    AsyncTask* task = _rd->_eval_task;
+    if (!task->running()) {
+        if (!_rd->_eval_status.empty()) {
+            ImGui::TextColored(ImVec4(0.9f, 0.35f, 0.3f, 1.0f), "%s", _rd->_eval_status.c_str());
+        }
+        return;
+    }
+
+    // 旋转的圆弧作为忙碌指示
+    float radius = ImGui::GetTextLineHeight() * 0.4f;
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    ImVec2 center(pos.x + radius + 2.0f, pos.y + ImGui::GetTextLineHeight() * 0.5f);
+    float start = (float)ImGui::GetTime() * 6.0f;
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    draw_list->PathArcTo(center, radius, start, start + 4.5f, 16);
+    draw_list->PathStroke(ImGui::GetColorU32(ImGuiCol_Text), 0, radius * 0.4f);
+    ImGui::Dummy(ImVec2(radius * 2.0f + 4.0f, ImGui::GetTextLineHeight())); UINEXT
+
+    float progress = task->progress();
+    if (progress >= 0.0f) {
+        ImGui::ProgressBar(progress, ImVec2(200, 0)); UINEXT
+    }
+    ImGui::Text("Evaluating %.1f s", task->elapsed()); UINEXT
+    if (ImGui::SmallButton("Cancel")) {
+        _rd->cancelEvaluation();
+    }
+}
+
+void UI::imguiStats() {
+    ImGui::SetNextWindowPos(ImVec2(10, ImGui::GetTextLineHeightWithSpacing() * 2), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Stats", &_rd->_show_stats, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoCollapse);
+    ImGui::Text("Frame: %.2f ms (%.0f FPS)", _rd->_delta_time * 1000.0f, ImGui::GetIO().Framerate);
+    ImGui::Text("Heap allocations: %llu / frame", (unsigned long long)_rd->_frame_allocs);
+    ImGui::Text("Frame arena peak: %.1f KB", _rd->_frame_arena_peak / 1024.0);
+    ImGui::Text("Texture memory: %.1f MB", _rd->_tex_manager->allocatedBytes() / (1024.0 * 1024.0));
+    ImGui::Text("Mesh cache: %zu hits, %zu misses", _rd->_mesh_cache->hits(), _rd->_mesh_cache->misses());
+    if (_rd->_cloud->isLoaded()) {
+        ImGui::Text("Point cloud: %zu / %zu nodes drawn, %zu resident, %.1f M points",
+                    _rd->_cloud->drawnNodes(), _rd->_cloud->nodeCount(), _rd->_cloud->residentNodes(),
+                    _rd->_cloud->drawnPoints() / 1e6);
+    }
     ImGui::End();
 }
 
 void UI::initEditor() {
     _rd->_is_editing = false;
     _rd->_current_shader_src = ShaderType::None;
-    memset(_rd->_editor_buffer, 0, sizeof(char) *  EDITOR_BUFFER_SIZE);
-    _rd->_editor_buffer[0] = '\0';
+    _rd->_editor = new CodeEditor();
+    _rd->_editor_file = 0;
 }
 
 void UI::imguiGLSLEditor() {
@@ -139,29 +222,37 @@ void UI::imguiGLSLEditor() {
 
     static int item_current = 0;
     ImGui::Combo("File", &item_current, _rd->_shader_sources.data(), _rd->_shader_sources.size()); UINEXT
+    if (item_current != _rd->_editor_file) {
+        _rd->_editor_file = item_current;
+        if (item_current != 0) {
+            _rd->_editor->setText(loadShaderSource(_rd->_shader_sources[item_current]));
+        }
+    }
+
+    bool focused = false;
     if (item_current != 0) {
-        _rd->_is_editing = true;
-        unsigned int size = sizeof(char) * EDITOR_BUFFER_SIZE;
-        loadShaderSource(_rd->_shader_sources[item_current], _rd->_editor_buffer, size);
-        if (ImGui::Button("Save")) {
-            printf("%s\n", _rd->_editor_buffer);
-            writeShaderSource(_rd->_shader_sources[item_current], _rd->_editor_buffer);
+        const char* path = _rd->_shader_sources[item_current];
+        _rd->_current_shader_src = strstr(path, "frag") ? ShaderType::Fragment : ShaderType::Vertex;
+        unsigned int type = _rd->_current_shader_src == ShaderType::Fragment ? GL_FRAGMENT_SHADER : GL_VERTEX_SHADER;
+
+        bool save = ImGui::Button("Save"); UINEXT
+        bool check = ImGui::Button("Check"); UINEXT
+        ImGui::Text("%zu lines%s", _rd->_editor->lineCount(), _rd->_editor->isModified() ? " *" : "");
+        if (save || check) {
+            std::string src = _rd->_editor->getText();
+            _rd->_editor->setMarkers(parseShaderLog(Shader::checkSource(type, src)));
+            if (save) {
+                writeShaderSource(path, src);
+                _rd->_editor->markSaved();
+            }
         }
 
-        ImGui::InputTextMultiline(
-            "##source",
-            _rd->_editor_buffer,
-            sizeof(char) * EDITOR_BUFFER_SIZE,
-            ImVec2(-FLT_MIN, ImGui::GetTextLineHeight() * 30)
-        );
-    }
-    
-    if (ImGui::IsItemActive()) {
-       _rd-> _is_editing = true;
-    } else {
-        _rd->_is_editing = false;
+        _rd->_editor->render("##source", ImVec2(-FLT_MIN, -FLT_MIN));
+        focused = _rd->_editor->isFocused();
     }
 
+    _rd->_is_editing = focused;
+
     ImGui::End();
 }
 
@@ -199,6 +290,9 @@ void UI::imguiMainTabBar() {
             if (ImGui::MenuItem("Axis mode", _rd->_axis_mode ? "ON" : "OFF")) {
                 _rd->toggle(&_rd->_axis_mode);
             }
+            if (ImGui::MenuItem("Stats", _rd->_show_stats ? "ON" : "OFF")) {
+                _rd->toggle(&_rd->_show_stats);
+            }
             if (ImGui::MenuItem("Demo")) {
                 _rd->toggle(&_rd->_show_demo);
             }
@@ -223,6 +317,67 @@ void UI::imguiMainTabBar() {
             if (ImGui::MenuItem("Presision")) {
                 _rd->toggle(&_rd->_modify_presicion);
             }
+            if (ImGui::MenuItem("Arbitrary precision", _rd->_big_numbers ? "ON" : "OFF")) {
+                _rd->toggle(&_rd->_big_numbers);
+            }
+            if (_rd->_big_numbers) {
+                ImGui::SliderInt("Digits", &_rd->_big_digits, 16, 1000000, "%d", ImGuiSliderFlags_Logarithmic);
+            }
+            if (ImGui::SliderInt("Texture MB", &_rd->_texture_budget_mb, 16, 2048)) {
+                _rd->_tex_manager->setBudget((size_t)_rd->_texture_budget_mb * 1024 * 1024);
+            }
+            ImGui::Text("Texture memory: %.1f MB", _rd->_tex_manager->allocatedBytes() / (1024.0 * 1024.0));
+            if (ImGui::MenuItem("Reset complex view")) {
+                _rd->_domain->resetView();
+            }
+            if (ImGui::MenuItem("Reset plot view")) {
+                _rd->_plot->resetView();
+            }
+            if (ImGui::MenuItem("Clear curves")) {
+                _rd->_plot->clear();
+                _rd->_plot_view = false;
+            }
+            ImGui::EndMenu();
+        }
+
+        if(ImGui::BeginMenu("Data")) {
+            PointCloud* cloud = _rd->_cloud;
+            ImGui::InputText("Path", _rd->_dataset_path, sizeof(_rd->_dataset_path));
+            if (ImGui::MenuItem("Load point cloud", nullptr, false, _rd->_dataset_path[0] != '\0')) {
+                cloud->load(_rd->_dataset_path);
+            }
+            if (cloud->loading()) {
+                float progress = cloud->progress();
+                ImGui::ProgressBar(progress < 0.0f ? 0.0f : progress, ImVec2(-FLT_MIN, 0.0f));
+                if (ImGui::MenuItem("Cancel loading")) {
+                    cloud->cancel();
+                }
+            }
+            if (ImGui::MenuItem("Clear point cloud", nullptr, false, cloud->isLoaded())) {
+                cloud->clear();
+            }
+            if (ImGui::SliderInt("Point cloud MB", &_rd->_cloud_budget_mb, 16, 4096)) {
+                cloud->setBudget((size_t)_rd->_cloud_budget_mb << 20);
+            }
+            if (!cloud->status().empty()) {
+                ImGui::TextUnformatted(cloud->status().c_str());
+            }
+            UIDIVIDER
+            ImGui::InputText("Export path", _rd->_export_path, sizeof(_rd->_export_path));
+            bool exporting = _rd->_export_task->running();
+            if (ImGui::MenuItem("Export mesh", nullptr, false, !exporting && _rd->_export_path[0] != '\0')) {
+                _rd->exportMesh();
+            }
+            if (exporting) {
+                float progress = _rd->_export_task->progress();
+                ImGui::ProgressBar(progress < 0.0f ? 0.0f : progress, ImVec2(-FLT_MIN, 0.0f));
+                if (ImGui::MenuItem("Cancel export")) {
+                    _rd->_export_task->cancel();
+                }
+            }
+            if (!_rd->_export_status.empty()) {
+                ImGui::TextUnformatted(_rd->_export_status.c_str());
+            }
             ImGui::EndMenu();
         }
 
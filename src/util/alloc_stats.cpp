@@ -0,0 +1,77 @@
+#include "alloc_stats.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> allocation_count{0};
+static std::atomic<uint64_t> allocated_bytes{0};
+
+uint64_t AllocStats::allocationCount() {
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocStats::allocatedBytes() {
+    return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+static void* countedAlloc(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+static void* countedAlignedAlloc(size_t size, size_t align) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    size = (size + align - 1) / align * align;
+#if defined(_WIN32)
+    return _aligned_malloc(size == 0 ? align : size, align);
+#else
+    return std::aligned_alloc(align, size == 0 ? align : size);
+#endif
+}
+
+static void alignedFree(void* ptr) {
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void* operator new(size_t size) {
+    void* ptr = countedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    void* ptr = countedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+
+void* operator new(size_t size, std::align_val_t align) {
+    void* ptr = countedAlignedAlloc(size, (size_t)align);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+    void* ptr = countedAlignedAlloc(size, (size_t)align);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { alignedFree(ptr); }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "arena.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+LinearArena::LinearArena(size_t block_size)
+    : _block_size(block_size), _offset(0), _used(0), _peak(0)
+{
+}
+
+LinearArena::~LinearArena() {
+    for (auto& block : _blocks) {
+        std::free(block.data);
+    }
+}
+
+void LinearArena::addBlock(size_t min_size) {
+    size_t size = std::max(_block_size, min_size);
+    unsigned char* data = static_cast<unsigned char*>(std::malloc(size));
+    if (!data) throw std::bad_alloc();
+    _blocks.push_back({data, size});
+    _offset = 0;
+}
+
+void* LinearArena::allocate(size_t size, size_t align) {
+    if (_blocks.empty()) addBlock(size + align);
+    Block* block = &_blocks.back();
+    uintptr_t base = reinterpret_cast<uintptr_t>(block->data);
+    size_t aligned = ((base + _offset + align - 1) & ~(uintptr_t)(align - 1)) - base;
+    if (aligned + size > block->size) {
+        addBlock(size + align);
+        block = &_blocks.back();
+        base = reinterpret_cast<uintptr_t>(block->data);
+        aligned = ((base + align - 1) & ~(uintptr_t)(align - 1)) - base;
+    }
+    _used += aligned + size - _offset;
+    _offset = aligned + size;
+    _peak = std::max(_peak, _used);
+    return block->data + aligned;
+}
+
+void LinearArena::rewind(Marker marker) {
+    if (_blocks.empty()) return;
+    while (_blocks.size() > marker.block + 1) {
+        std::free(_blocks.back().data);
+        _blocks.pop_back();
+    }
+    _offset = marker.offset;
+    _used = marker.used;
+}
+
+// 本帧用到多个块时, 合并成一个足够大的块, 下一帧起只需一次 bump 即可满足
+void LinearArena::reset() {
+    if (_blocks.size() > 1) {
+        size_t total = capacity();
+        for (auto& block : _blocks) {
+            std::free(block.data);
+        }
+        _blocks.clear();
+        addBlock(total);
+    }
+    _offset = 0;
+    _used = 0;
+}
+
+size_t LinearArena::capacity() const {
+    size_t total = 0;
+    for (const auto& block : _blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+LinearArena& frameArena() {
+    static LinearArena arena(1024 * 1024);
+    return arena;
+}
+
+std::pmr::memory_resource* frameResource() {
+    static ArenaResource resource(frameArena());
+    return &resource;
+}
+
+LinearArena& scratchArena() {
+    thread_local LinearArena arena;
+    return arena;
+}
+
+std::pmr::memory_resource* scratchResource() {
+    thread_local ArenaResource resource(scratchArena());
+    return &resource;
+}
\ No newline at end of file
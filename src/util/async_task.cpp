@@ -0,0 +1,106 @@
+#include "async_task.hpp"
+
+TaskContext::TaskContext()
+    : _cancel(false), _progress(-1.0f), _deadline(std::chrono::steady_clock::time_point::max())
+{
+}
+
+AsyncTask::AsyncTask()
+    : _state(TaskState::Idle)
+{
+}
+
+AsyncTask::~AsyncTask() {
+    if (!_thread.joinable()) return;
+    _shared->context._cancel.store(true, std::memory_order_relaxed);
+    bool finished;
+    {
+        std::unique_lock<std::mutex> lock(_shared->mutex);
+        finished = _shared->done.wait_for(lock, std::chrono::milliseconds(ASYNC_TASK_SHUTDOWN_MS),
+                                          [this] { return _shared->finished; });
+    }
+    if (finished) {
+        _thread.join();
+    } else {
+        _thread.detach();
+    }
+}
+
+void AsyncTask::abandon() {
+    _shared->context._cancel.store(true, std::memory_order_relaxed);
+    if (_thread.joinable()) _thread.detach();
+}
+
+bool AsyncTask::start(Function fn, double timeout_seconds) {
+    if (running()) return false;
+    // 上一个任务已在 poll 中 join 或被 detach; 结束后未经 poll 的也已写完结果
+    if (_thread.joinable()) _thread.join();
+
+    // 每个任务一份独立的共享状态, 被放弃的旧线程只会写入自己的那份
+    std::shared_ptr<Shared> shared = std::make_shared<Shared>();
+    _start = std::chrono::steady_clock::now();
+    shared->context._deadline = _start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(timeout_seconds));
+    _shared = shared;
+    _state = TaskState::Running;
+
+    _thread = std::thread([shared, fn = std::move(fn)]() {
+        std::string error;
+        std::string result = fn(shared->context, error);
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->result = std::move(result);
+        shared->error = std::move(error);
+        shared->finished = true;
+        shared->done.notify_all();
+    });
+    return true;
+}
+
+void AsyncTask::cancel() {
+    if (!running()) return;
+    abandon();
+    _state = TaskState::Cancelled;
+}
+
+bool AsyncTask::poll() {
+    if (!running()) return false;
+    bool finished;
+    {
+        std::lock_guard<std::mutex> lock(_shared->mutex);
+        finished = _shared->finished;
+        if (finished) _state = _shared->error.empty() ? TaskState::Done : TaskState::Failed;
+    }
+    if (finished) {
+        // 结果已写完, 线程随即退出
+        _thread.join();
+        // 任务自行检测到超时而提前返回
+        if (_shared->context.expired() && _state == TaskState::Failed) _state = TaskState::TimedOut;
+        return true;
+    }
+    if (_shared->context.expired()) {
+        abandon();
+        _state = TaskState::TimedOut;
+        return true;
+    }
+    return false;
+}
+
+float AsyncTask::progress() const {
+    return _shared ? _shared->context.progress() : -1.0f;
+}
+
+double AsyncTask::elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+}
+
+std::string AsyncTask::result() const {
+    if (!_shared) return std::string();
+    std::lock_guard<std::mutex> lock(_shared->mutex);
+    return _shared->result;
+}
+
+std::string AsyncTask::error() const {
+    if (!_shared) return std::string();
+    std::lock_guard<std::mutex> lock(_shared->mutex);
+    return _shared->error;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "buffered_writer.hpp"
+
+#include <cstring>
+
+BufferedWriter::BufferedWriter(FILE* file, size_t capacity)
+    : _file(file), _buffer(capacity > 0 ? capacity : 1), _used(0), _failed(false)
+{
+}
+
+BufferedWriter::~BufferedWriter() {
+    flush();
+}
+
+void BufferedWriter::write(const char* data, size_t size) {
+    if (_used + size > _buffer.size()) {
+        flush();
+        if (size >= _buffer.size()) {
+            if (fwrite(data, 1, size, _file) != size) _failed = true;
+            return;
+        }
+    }
+    memcpy(_buffer.data() + _used, data, size);
+    _used += size;
+}
+
+bool BufferedWriter::flush() {
+    if (_used > 0) {
+        if (fwrite(_buffer.data(), 1, _used, _file) != _used) _failed = true;
+        _used = 0;
+    }
+    if (fflush(_file) != 0) _failed = true;
+    return !_failed;
+}
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "mapped_file.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : _data(nullptr), _size(0), _open(false), _writable(false)
+#if defined(_WIN32)
+    , _file(nullptr), _mapping(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    _file = file;
+    _size = (size_t)size.QuadPart;
+    _open = true;
+    if (_size == 0) return true;
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        return false;
+    }
+    _mapping = mapping;
+    _data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!_data) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::createTemporary(const std::string& path, size_t size) {
+    close();
+    // 最后一个句柄 (包括映射) 关闭时系统删除文件
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    _file = file;
+    _size = size;
+    _open = true;
+    _writable = true;
+    if (_size == 0) return true;
+
+    LARGE_INTEGER end;
+    end.QuadPart = (LONGLONG)size;
+    if (!SetFilePointerEx(file, end, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+        close();
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        return false;
+    }
+    _mapping = mapping;
+    _data = (const char*)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0);
+    if (!_data) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (_data) UnmapViewOfFile(_data);
+    if (_mapping) CloseHandle((HANDLE)_mapping);
+    if (_file) CloseHandle((HANDLE)_file);
+    _data = nullptr;
+    _mapping = nullptr;
+    _file = nullptr;
+    _size = 0;
+    _open = false;
+    _writable = false;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    _size = (size_t)info.st_size;
+    if (_size > 0) {
+        void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            _size = 0;
+            return false;
+        }
+        // 顺序读取, 让内核提前预读
+        madvise(data, _size, MADV_SEQUENTIAL);
+        _data = (const char*)data;
+    }
+    // 映射建立后文件描述符不再需要
+    ::close(fd);
+    _open = true;
+    return true;
+}
+
+bool MappedFile::createTemporary(const std::string& path, size_t size) {
+    close();
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) return false;
+    // 目录项立即删除, 映射保持文件存在, 进程异常退出也不会留下文件
+    unlink(path.c_str());
+    if (size > 0) {
+        void* data = MAP_FAILED;
+        if (ftruncate(fd, (off_t)size) == 0) {
+            data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        _data = (const char*)data;
+    }
+    ::close(fd);
+    _size = size;
+    _open = true;
+    _writable = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (_data) munmap((void*)_data, _size);
+    _data = nullptr;
+    _size = 0;
+    _open = false;
+    _writable = false;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(int count)
+    : _stop(false)
+{
+    if (count < 0) {
+        unsigned int hw = std::thread::hardware_concurrency();
+        count = hw > 1 ? (int)hw - 1 : 1;
+    }
+    _workers.reserve(count);
+    for (int i = 0; i < count; i++) {
+        _workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cv.notify_all();
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this] { return _stop || !_jobs.empty(); });
+            if (_stop && _jobs.empty()) return;
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        job();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+    if (_workers.empty()) {
+        job();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.push_back(std::move(job));
+    }
+    _cv.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& fn) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || _workers.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto state = std::make_shared<State>();
+    const auto* body = &fn;
+
+    // 共享状态由 shared_ptr 持有, 晚启动的辅助任务取不到块时直接返回, 不会再访问 fn
+    auto run = [state, body, count, grain, chunks]() {
+        size_t chunk;
+        while ((chunk = state->next.fetch_add(1)) < chunks) {
+            size_t begin = chunk * grain;
+            (*body)(begin, std::min(begin + grain, count));
+            if (state->done.fetch_add(1) + 1 == chunks) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->cv.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(_workers.size(), chunks - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        submit(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done.load() == chunks; });
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
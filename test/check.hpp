@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// 失败时打印位置并计数, 测试程序以失败数作为返回值
+extern int check_failures;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            check_failures++; \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while (0)
+
+#define CHECK_MAIN_RESULT() (check_failures == 0 ? 0 : (fprintf(stderr, "%d check(s) failed\n", check_failures), 1))
+
+// 两个 double 之间相隔的可表示数个数; 同为 nan 时为 0, 只有一个为 nan 时为最大值
+inline uint64_t ulpDistance(double a, double b) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b) ? 0 : UINT64_MAX;
+    if (a == b) return 0;
+    int64_t ia, ib;
+    memcpy(&ia, &a, sizeof(a));
+    memcpy(&ib, &b, sizeof(b));
+    // 把符号位表示映射成单调的整数序
+    if (ia < 0) ia = INT64_MIN - ia;
+    if (ib < 0) ib = INT64_MIN - ib;
+    return ia > ib ? (uint64_t)ia - (uint64_t)ib : (uint64_t)ib - (uint64_t)ia;
+}
@@ -0,0 +1,78 @@
+#include "check.hpp"
+
+#include <random>
+#include <vector>
+
+#include "batch.hpp"
+#include "expr_parser.hpp"
+
+// SIMD 多项式近似与标量 libm 之间允许的最大误差
+#define BATCH_MAX_ULP 4
+#define BATCH_RANDOM_SAMPLES 200000
+
+int check_failures = 0;
+
+static std::vector<double> inputs(double lo, double hi) {
+    std::vector<double> values;
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> uniform(lo, hi);
+    for (int i = 0; i < BATCH_RANDOM_SAMPLES; i++) values.push_back(uniform(rng));
+    // 特殊值与约化范围的边界, 超出范围的点由内核回退到标量函数
+    const double specials[] = {0.0, -0.0, 1.0, -1.0, 1e-300, -1e-300, 4.9e-324, 1e300, -1e300,
+                               INFINITY, -INFINITY, NAN, 3.141592653589793, 1.5707963267948966, 709.78, -745.1,
+                               1e8, -1e8, 2.2250738585072014e-308};
+    values.insert(values.end(), std::begin(specials), std::end(specials));
+    return values;
+}
+
+// 对每个可用的指令集, 比较批量结果与 VM 的标量结果
+static void checkFunction(const char* source, double lo, double hi) {
+    calc::ExprPool pool;
+    calc::ExprParser parser;
+    int root = parser.parse(source, pool);
+    calc::Program program;
+    CHECK(root >= 0 && calc::compile(pool, root, program));
+    if (root < 0) return;
+
+    std::vector<double> x = inputs(lo, hi);
+    std::vector<double> expected(x.size()), actual(x.size());
+    calc::VM vm;
+    vm.load(program);
+    std::vector<double> vars(program.variables.size(), 0.0);
+    for (size_t i = 0; i < x.size(); i++) {
+        vars[0] = x[i];
+        expected[i] = vm.run(vars.data());
+    }
+
+    const calc::BatchIsa isas[] = {calc::BatchIsa::Scalar, calc::BatchIsa::SSE2, calc::BatchIsa::AVX2, calc::BatchIsa::AVX512};
+    for (calc::BatchIsa isa : isas) {
+        calc::BatchEvaluator evaluator(isa);
+        // CPU 不支持时会降级, 只测实际得到的那一档
+        if (evaluator.isa() != isa) continue;
+        evaluator.load(program);
+        evaluator.evaluate(x.data(), nullptr, nullptr, actual.data(), x.size());
+        uint64_t worst = 0;
+        size_t worst_index = 0;
+        for (size_t i = 0; i < x.size(); i++) {
+            uint64_t ulp = ulpDistance(expected[i], actual[i]);
+            if (ulp > worst) worst = ulp, worst_index = i;
+        }
+        printf("%-8s %-10s max %llu ulp\n", calc::batchIsaName(isa), source, (unsigned long long)worst);
+        if (worst > BATCH_MAX_ULP) {
+            fprintf(stderr, "  x = %.17g: expected %.17g, got %.17g\n", x[worst_index], expected[worst_index], actual[worst_index]);
+        }
+        CHECK(worst <= BATCH_MAX_ULP);
+    }
+}
+
+int main() {
+    checkFunction("sin(x)", -100.0, 100.0);
+    checkFunction("cos(x)", -100.0, 100.0);
+    checkFunction("tan(x)", -10.0, 10.0);
+    checkFunction("exp(x)", -700.0, 700.0);
+    checkFunction("log(x)", 1e-300, 1e300);
+    checkFunction("log(x)", 0.0, 4.0);
+    // 只含加减乘的表达式不经过近似
+    checkFunction("x*x - 3*x + 2", -1e3, 1e3);
+    return CHECK_MAIN_RESULT();
+}
@@ -0,0 +1,104 @@
+#include "check.hpp"
+
+#include <random>
+#include <vector>
+
+#include "expr_parser.hpp"
+#include "jit.hpp"
+
+#define JIT_RANDOM_SAMPLES 100000
+
+int check_failures = 0;
+
+// 覆盖每一种指令, 以及常量、多变量与寄存器较多的程序
+static const char* const PROGRAMS[] = {
+    "x + y",
+    "x - y * z",
+    "x / y",
+    "-x",
+    "abs(x) - abs(y)",
+    "min(x, y) + max(y, z)",
+    "sqrt(x) + x^0.5",
+    "pow(x, y)",
+    "sin(x) * cos(y) + tan(z)",
+    "asin(x) + acos(y) + atan(z)",
+    "sinh(x) - cosh(y) + tanh(z)",
+    "exp(x) * log(y)",
+    "log10(x) + ln(abs(y))",
+    "floor(x) + ceil(y)",
+    "fact(x)",
+    "x*0 + y*1 - z/1",
+    "2*pi*x + e^y",
+    "(x + 1)*(x - 2)*(x + 3)*(y - 4)*(y + 5)*(z - 6)",
+    "sin(x*x + y*y) / (1 + x*x + y*y) - sqrt(abs(z))*exp(-z*z)",
+};
+
+// 随机值按指数分布覆盖很宽的量级, 再混入 nan / inf / 非规格化数等特殊值
+static double input(std::mt19937_64& rng) {
+    static const double specials[] = {0.0, -0.0, 1.0, -1.0, 0.5, INFINITY, -INFINITY, NAN, -NAN,
+                                      4.9e-324, -4.9e-324, 2.2250738585072009e-308, 1e-310, 1.7976931348623157e308,
+                                      -1.7976931348623157e308, 170.0, 171.0, 3.141592653589793};
+    const size_t special_count = sizeof(specials) / sizeof(specials[0]);
+    uint64_t r = rng();
+    switch (r % 4) {
+        case 0: return specials[(r >> 8) % special_count];
+        case 1: return std::uniform_real_distribution<double>(-4.0, 4.0)(rng);
+        case 2: {
+            double magnitude = std::ldexp(1.0, (int)((r >> 8) % 2098) - 1074);
+            return (r >> 20) & 1 ? -magnitude : magnitude;
+        }
+        default: {
+            // 任意位模式, 包括各种 nan 载荷
+            uint64_t bits = rng();
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+    }
+}
+
+static bool sameBits(double a, double b) {
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// JIT 与 VM 对同一输入必须逐位相同
+static void checkProgram(const char* source, std::mt19937_64& rng) {
+    calc::ExprPool pool;
+    calc::ExprParser parser;
+    int root = parser.parse(source, pool);
+    calc::Program program;
+    CHECK(root >= 0 && calc::compile(pool, root, program));
+    if (root < 0) return;
+
+    calc::JitFunction jit;
+    CHECK(jit.compile(program));
+    if (!jit.ready()) return;
+    calc::VM vm;
+    vm.load(program);
+
+    std::vector<double> vars(program.variables.size());
+    size_t mismatches = 0;
+    for (int s = 0; s < JIT_RANDOM_SAMPLES; s++) {
+        for (double& v : vars) v = input(rng);
+        double expected = vm.run(vars.data());
+        double actual = jit(vars.data());
+        if (sameBits(expected, actual)) continue;
+        if (mismatches++ == 0) {
+            fprintf(stderr, "  %s: expected %.17g, got %.17g at", source, expected, actual);
+            for (double v : vars) fprintf(stderr, " %.17g", v);
+            fprintf(stderr, "\n");
+        }
+    }
+    printf("%-60s %zu mismatches\n", source, mismatches);
+    CHECK(mismatches == 0);
+}
+
+int main() {
+    if (!calc::JitFunction::supported()) {
+        printf("JIT not supported on this platform, skipped\n");
+        return 0;
+    }
+    std::mt19937_64 rng(2024);
+    for (const char* source : PROGRAMS) checkProgram(source, rng);
+    return CHECK_MAIN_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "check.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "expr_parser.hpp"
+#include "bytecode.hpp"
+
+#define OPTIMIZER_RANDOM_SAMPLES 100000
+// fast_math 下有限输入且有限结果允许的最大误差
+#define OPTIMIZER_FAST_MATH_ULPS 4
+
+int check_failures = 0;
+
+// 每条都命中至少一条化简规则
+static const char* const PROGRAMS[] = {
+    "x*0",
+    "0*x + y",
+    "x + 0",
+    "0 + x",
+    "x - 0",
+    "0 - x",
+    "x*1 + y*(-1)",
+    "x/1 - y/(-1)",
+    "x/3",
+    "x/4 + y/0.1",
+    "x^2",
+    "x^3 - y^-1",
+    "x^-2 + y^4",
+    "x^0 + y^1 + 1^z",
+    "-(-x) + abs(-y) + floor(ceil(z))",
+    "x + -y - -z",
+    "min(x, x) + max(y, y)",
+    "sin(x)*sin(x) + sin(x)*0 + 2*3",
+};
+
+static double input(std::mt19937_64& rng) {
+    static const double specials[] = {0.0, -0.0, 1.0, -1.0, 2.0, 3.0, INFINITY, -INFINITY, NAN,
+                                      4.9e-324, -4.9e-324, 1e-310, 1.7976931348623157e308, -1e200};
+    const size_t special_count = sizeof(specials) / sizeof(specials[0]);
+    uint64_t r = rng();
+    if (r % 2) return specials[(r >> 8) % special_count];
+    return std::uniform_real_distribution<double>(-1e3, 1e3)(rng);
+}
+
+// 优化后的程序对任何输入都必须与未优化的逐位相同, nan 只要求仍为 nan
+static void checkProgram(const char* source, std::mt19937_64& rng) {
+    calc::ExprPool pool;
+    calc::ExprParser parser;
+    int root = parser.parse(source, pool);
+    calc::Program plain, optimized;
+    CHECK(root >= 0 && calc::compile(pool, root, plain, false) && calc::compile(pool, root, optimized));
+    if (root < 0) return;
+
+    calc::VM reference, vm;
+    reference.load(plain);
+    vm.load(optimized);
+    std::vector<double> vars(plain.variables.size());
+    size_t mismatches = 0;
+    for (int s = 0; s < OPTIMIZER_RANDOM_SAMPLES; s++) {
+        for (double& v : vars) v = input(rng);
+        double expected = reference.run(vars.data());
+        double actual = vm.run(vars.data());
+        if (std::isnan(expected) && std::isnan(actual)) continue;
+        if (memcmp(&expected, &actual, sizeof(double)) == 0) continue;
+        if (mismatches++ == 0) {
+            fprintf(stderr, "  %s: expected %.17g, got %.17g at", source, expected, actual);
+            for (double v : vars) fprintf(stderr, " %.17g", v);
+            fprintf(stderr, "\n");
+        }
+    }
+    printf("%-40s %2zu -> %2zu instructions, %zu mismatches\n", source, plain.code.size(), optimized.code.size(), mismatches);
+    CHECK(mismatches == 0);
+}
+
+// fast_math 的改写只要求有限输入得到有限结果时相差不超过 OPTIMIZER_FAST_MATH_ULPS
+static void checkFastMath(const char* source, std::mt19937_64& rng) {
+    calc::ExprPool pool;
+    calc::ExprParser parser;
+    int root = parser.parse(source, pool);
+    calc::Program plain, fast;
+    calc::OptimizeStats stats;
+    CHECK(root >= 0 && calc::compile(pool, root, plain, false) && calc::compile(pool, root, fast, true, true, &stats));
+    if (root < 0) return;
+
+    calc::VM reference, vm;
+    reference.load(plain);
+    vm.load(fast);
+    std::vector<double> vars(plain.variables.size());
+    uint64_t worst = 0;
+    for (int s = 0; s < OPTIMIZER_RANDOM_SAMPLES; s++) {
+        bool finite = true;
+        for (double& v : vars) {
+            v = input(rng);
+            finite = finite && std::isfinite(v);
+        }
+        double expected = reference.run(vars.data());
+        if (!finite || !std::isfinite(expected)) continue;
+        uint64_t distance = ulpDistance(expected, vm.run(vars.data()));
+        if (distance > worst && distance > OPTIMIZER_FAST_MATH_ULPS && worst <= OPTIMIZER_FAST_MATH_ULPS) {
+            fprintf(stderr, "  fast %s: expected %.17g, got %.17g at", source, expected, vm.run(vars.data()));
+            for (double v : vars) fprintf(stderr, " %.17g", v);
+            fprintf(stderr, "\n");
+        }
+        worst = std::max(worst, distance);
+    }
+    printf("%-40s %2zu -> %2zu operations with fast math, max %llu ulp\n", source, stats.before, stats.after,
+           (unsigned long long)worst);
+    CHECK(worst <= OPTIMIZER_FAST_MATH_ULPS);
+}
+
+int main() {
+    std::mt19937_64 rng(7);
+    for (const char* source : PROGRAMS) checkProgram(source, rng);
+    for (const char* source : PROGRAMS) checkFastMath(source, rng);
+    return CHECK_MAIN_RESULT();
+}
\ No newline at end of file
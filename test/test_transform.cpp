@@ -0,0 +1,134 @@
+#include "check.hpp"
+
+#include <random>
+#include <vector>
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include "registry.hpp"
+#include "systems.hpp"
+
+#define TRANSFORM_NODES 4000
+#define TRANSFORM_MAX_DEPTH 5
+// 与逐节点用 glm 递归计算的结果相比, 按矩阵元素的量级放缩后的最大误差
+#define TRANSFORM_TOLERANCE 6e-7f
+
+int check_failures = 0;
+
+// 参考实现: 沿父链递归, world = parent * translate * mat4_cast * scale, normal = transpose(inverse(mat3(world)))
+static glm::mat4 referenceWorld(Registry& registry, Entity entity) {
+    const Transform& t = registry.transforms().get(entity);
+    glm::mat4 local = glm::translate(glm::mat4(1.0f), t.position) * glm::mat4_cast(t.rotation) *
+                      glm::scale(glm::mat4(1.0f), t.scale);
+    if (t.parent == ENTITY_NULL) return local;
+    return referenceWorld(registry, t.parent) * local;
+}
+
+static float maxAbs(const float* values, int count) {
+    float m = 0.0f;
+    for (int i = 0; i < count; i++) m = std::max(m, std::fabs(values[i]));
+    return m;
+}
+
+// 返回所有节点中 world 与 normal 的最大相对误差
+static float compare(Registry& registry, const TransformSystem& system, const std::vector<Entity>& entities) {
+    float worst = 0.0f;
+    for (Entity entity : entities) {
+        uint32_t index = registry.transforms().indexOf(entity);
+        glm::mat4 actual_world = system.world(index);
+        glm::mat3 actual_normal = system.normal(index);
+        glm::mat4 world = referenceWorld(registry, entity);
+        glm::mat3 normal = glm::transpose(glm::inverse(glm::mat3(world)));
+        float world_scale = std::max(1.0f, maxAbs(&world[0][0], 16));
+        float normal_scale = std::max(1.0f, maxAbs(&normal[0][0], 9));
+        for (int k = 0; k < 16; k++) {
+            worst = std::max(worst, std::fabs((&actual_world[0][0])[k] - (&world[0][0])[k]) / world_scale);
+        }
+        for (int k = 0; k < 9; k++) {
+            worst = std::max(worst, std::fabs((&actual_normal[0][0])[k] - (&normal[0][0])[k]) / normal_scale);
+        }
+    }
+    return worst;
+}
+
+static size_t subtreeSize(Registry& registry, const std::vector<Entity>& entities, Entity root) {
+    size_t count = 0;
+    for (Entity entity : entities) {
+        for (Entity node = entity; node != ENTITY_NULL; node = registry.transforms().get(node).parent) {
+            if (node == root) {
+                count++;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+int main() {
+    std::mt19937 rng(50);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    Registry registry;
+    std::vector<Entity> entities;
+    for (int i = 0; i < TRANSFORM_NODES; i++) {
+        Entity entity = registry.create();
+        Transform t;
+        t.position = glm::vec3(uniform(rng), uniform(rng), uniform(rng)) * 3.0f;
+        t.rotation = glm::normalize(glm::quat(uniform(rng), uniform(rng), uniform(rng), uniform(rng)));
+        t.scale = glm::vec3(1.0f + 0.4f * uniform(rng), 1.0f + 0.4f * uniform(rng), 1.0f + 0.4f * uniform(rng));
+        registry.transforms().add(entity, t);
+        entities.push_back(entity);
+    }
+    // 父节点总是先创建的节点, 层级深度不超过 TRANSFORM_MAX_DEPTH
+    std::vector<int> depth(TRANSFORM_NODES, 0);
+    for (int i = 1; i < TRANSFORM_NODES; i++) {
+        int parent = (int)(rng() % i);
+        if (rng() % 8 == 0 || depth[parent] >= TRANSFORM_MAX_DEPTH) continue;
+        registry.setParent(entities[i], entities[parent]);
+        depth[i] = depth[parent] + 1;
+    }
+
+    TransformSystem system;
+    ThreadPool pool(2);
+    system.update(registry, pool);
+    CHECK(system.updated() == TRANSFORM_NODES);
+    float error = compare(registry, system, entities);
+    printf("%d nodes, depth %zu, max error %.3g\n", TRANSFORM_NODES, system.depth(), error);
+    CHECK(error <= TRANSFORM_TOLERANCE);
+
+    // 不修改时不重算
+    system.update(registry, pool);
+    CHECK(system.updated() == 0);
+
+    // 只重算被修改节点的子树
+    Entity changed = entities[TRANSFORM_NODES / 4];
+    registry.transforms().get(changed).position += glm::vec3(0.5f, -0.25f, 1.0f);
+    registry.transforms().markDirty(changed);
+    system.update(registry, pool);
+    CHECK(system.updated() == subtreeSize(registry, entities, changed));
+    CHECK(compare(registry, system, entities) <= TRANSFORM_TOLERANCE);
+
+    // 挂到自己的子孙下会成环, setParent 不做修改
+    Entity root = entities[0];
+    Entity descendant = ENTITY_NULL;
+    for (size_t i = 1; i < entities.size() && descendant == ENTITY_NULL; i++) {
+        for (Entity node = registry.transforms().get(entities[i]).parent; node != ENTITY_NULL;
+             node = registry.transforms().get(node).parent) {
+            if (node == root) descendant = entities[i];
+        }
+    }
+    CHECK(descendant != ENTITY_NULL);
+    Entity before = registry.transforms().get(root).parent;
+    registry.setParent(root, descendant);
+    CHECK(registry.transforms().get(root).parent == before);
+    registry.setParent(root, root);
+    CHECK(registry.transforms().get(root).parent == before);
+
+    // 改变父节点后重新排序, 结果仍与参考一致
+    Entity leaf = entities[TRANSFORM_NODES - 1];
+    registry.setParent(leaf, ENTITY_NULL);
+    system.update(registry, pool);
+    CHECK(registry.transforms().get(leaf).parent == ENTITY_NULL);
+    CHECK(compare(registry, system, entities) <= TRANSFORM_TOLERANCE);
+    return CHECK_MAIN_RESULT();
+}
\ No newline at end of file